@@ -0,0 +1,112 @@
+/*
+ * DO NOT ALTER OR REMOVE COPYRIGHT NOTICES OR THIS FILE HEADER.
+ * Copyright 2014-2015 Palo Alto Research Center, Inc. (PARC), a Xerox company.  All Rights Reserved.
+ * The content of this file, whole or in part, is subject to licensing terms.
+ * If distributing this software, include this License Header Notice in each
+ * file and provide the accompanying LICENSE file. 
+ */
+/**
+ * @author Alan Walendowski, Computing Science Laboratory, PARC
+ * @copyright 2014-2015 Palo Alto Research Center, Inc. (PARC), A Xerox Company. All Rights Reserved.
+ */
+
+// Measures the throughput of each SHA-256 implementation in tutorial_Digest.c that this CPU supports, hashing
+// a block of 1200-byte chunks the way the server builds a manifest and the client verifies it.
+//
+//   ./bench_tutorial_Digest [chunk size] [chunk count]
+
+// Include the source file directly so we can time its static implementations one by one.
+#include "../tutorial_Digest.c"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+static double
+_now(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec + now.tv_nsec / 1e9;
+}
+
+/**
+ * Hash every chunk of the block `rounds` times with the specified implementation, check the digests against
+ * the portable implementation's, and print the throughput.
+ */
+static void
+_benchmark(const _TutorialDigestImplementation *implementation, const uint8_t *block, size_t chunkSize,
+           size_t chunkCount, const uint8_t *expected, int rounds)
+{
+    uint8_t *digests = malloc(chunkCount * tutorialDigest_Sha256Length);
+
+    double start = _now();
+    for (int round = 0; round < rounds; round++) {
+        size_t chunk = 0;
+        if (implementation->lanes != NULL) {
+            for (; chunk + implementation->laneCount <= chunkCount; chunk += implementation->laneCount) {
+                implementation->lanes(block + chunk * chunkSize, chunkSize, chunkSize,
+                                      digests + chunk * tutorialDigest_Sha256Length);
+            }
+        }
+        for (; chunk < chunkCount; chunk++) {
+            implementation->single(block + chunk * chunkSize, chunkSize, digests + chunk * tutorialDigest_Sha256Length);
+        }
+    }
+    double elapsed = _now() - start;
+
+    bool matches = memcmp(digests, expected, chunkCount * tutorialDigest_Sha256Length) == 0;
+    double megabytes = (double) chunkSize * chunkCount * rounds / 1e6;
+    printf("%-18s %9.1f MB/s %11.0f chunks/s %s\n", implementation->name, megabytes / elapsed,
+           chunkCount * rounds / elapsed, matches ? "" : "WRONG DIGESTS");
+
+    free(digests);
+}
+
+int
+main(int argc, char *argv[])
+{
+    size_t chunkSize = (argc > 1) ? strtoul(argv[1], NULL, 10) : 1200;
+    size_t chunkCount = (argc > 2) ? strtoul(argv[2], NULL, 10) : 4096;
+    if (chunkSize == 0 || chunkCount == 0) {
+        fprintf(stderr, "usage: %s [chunk size] [chunk count]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    uint8_t *block = malloc(chunkSize * chunkCount);
+    for (size_t i = 0; i < chunkSize * chunkCount; i++) {
+        block[i] = (uint8_t) rand();
+    }
+
+    uint8_t *expected = malloc(chunkCount * tutorialDigest_Sha256Length);
+    for (size_t chunk = 0; chunk < chunkCount; chunk++) {
+        _sha256Portable(block + chunk * chunkSize, chunkSize, expected + chunk * tutorialDigest_Sha256Length);
+    }
+
+    // Aim for about 256 MB per implementation.
+    int rounds = (int) (256e6 / ((double) chunkSize * chunkCount)) + 1;
+
+    printf("%zu chunks of %zu bytes, %d rounds. Chosen implementation: %s\n\n",
+           chunkCount, chunkSize, rounds, tutorialDigest_GetImplementationName());
+
+    _benchmark(&(_TutorialDigestImplementation) { "portable", _sha256Portable, NULL, 0 },
+               block, chunkSize, chunkCount, expected, rounds);
+
+#ifdef _TUTORIAL_DIGEST_X86
+    if (__builtin_cpu_supports("avx2")) {
+        _benchmark(&(_TutorialDigestImplementation) { "avx2x8", _sha256Portable, _sha256Avx2Lanes, 8 },
+                   block, chunkSize, chunkCount, expected, rounds);
+    }
+    if (__builtin_cpu_supports("avx512f")) {
+        _benchmark(&(_TutorialDigestImplementation) { "avx512x16", _sha256Portable, _sha256Avx512Lanes, 16 },
+                   block, chunkSize, chunkCount, expected, rounds);
+    }
+#endif
+
+    printf("\n");
+    _benchmark(_getImplementation(), block, chunkSize, chunkCount, expected, rounds);
+
+    free(expected);
+    free(block);
+    return EXIT_SUCCESS;
+}
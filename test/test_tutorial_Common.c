@@ -0,0 +1,171 @@
+/*
+ * DO NOT ALTER OR REMOVE COPYRIGHT NOTICES OR THIS FILE HEADER.
+ * Copyright 2014-2015 Palo Alto Research Center, Inc. (PARC), a Xerox company.  All Rights Reserved.
+ * The content of this file, whole or in part, is subject to licensing terms.
+ * If distributing this software, include this License Header Notice in each
+ * file and provide the accompanying LICENSE file. 
+ */
+/**
+ * @author Alan Walendowski, Computing Science Laboratory, PARC
+ * @copyright 2014-2015 Palo Alto Research Center, Inc. (PARC), A Xerox Company. All Rights Reserved.
+ */
+
+// Include the file(s) containing the functions to be tested.
+// This permits internal static functions to be visible to this Test Framework.
+#include "../tutorial_Common.c"
+#include "../tutorial_About.c"
+
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <parc/algol/parc_SafeMemory.h>
+#include <LongBow/unit-test.h>
+
+LONGBOW_TEST_RUNNER(tutorial_Common)
+{
+    // The following Test Fixtures will run their corresponding Test Cases.
+    // Test Fixtures are run in the order specified, but all tests should be idempotent.
+    // Never rely on the execution order of tests or share state between them.
+    LONGBOW_RUN_TEST_FIXTURE(Global);
+}
+
+// The Test Runner calls this function once before any Test Fixtures are run.
+LONGBOW_TEST_RUNNER_SETUP(tutorial_Common)
+{
+    return LONGBOW_STATUS_SUCCEEDED;
+}
+
+// The Test Runner calls this function once after all the Test Fixtures are run.
+LONGBOW_TEST_RUNNER_TEARDOWN(tutorial_Common)
+{
+    return LONGBOW_STATUS_SUCCEEDED;
+}
+
+LONGBOW_TEST_FIXTURE(Global)
+{
+    LONGBOW_RUN_TEST_CASE(Global, parseName);
+    LONGBOW_RUN_TEST_CASE(Global, parseNameOfFileInSubdirectory);
+    LONGBOW_RUN_TEST_CASE(Global, parseNameWithChunkSize);
+    LONGBOW_RUN_TEST_CASE(Global, appendFilePath);
+    LONGBOW_RUN_TEST_CASE(Global, isRelativeFilePath);
+}
+
+LONGBOW_TEST_FIXTURE_SETUP(Global)
+{
+    parcMemory_SetInterface(&PARCSafeMemoryAsPARCMemory);
+    return LONGBOW_STATUS_SUCCEEDED;
+}
+
+LONGBOW_TEST_FIXTURE_TEARDOWN(Global)
+{
+    uint32_t outstandingAllocations = parcSafeMemory_ReportAllocation(STDERR_FILENO);
+    if (outstandingAllocations != 0) {
+        printf("%s leaks memory by %d allocations\n", longBowTestCase_GetName(testCase), outstandingAllocations);
+        return LONGBOW_STATUS_MEMORYLEAK;
+    }
+    return LONGBOW_STATUS_SUCCEEDED;
+}
+
+LONGBOW_TEST_CASE(Global, parseName)
+{
+    CCNxName *domainPrefix = ccnxName_CreateFromURI(tutorialCommon_DomainPrefix);
+    CCNxName *name = ccnxName_CreateFromURI("lci:/ccnx/tutorial/fetch/file.txt/chunk=7");
+
+    TutorialNameView view;
+    assertTrue(tutorialCommon_ParseName(name, domainPrefix, &view), "Expected the name to parse");
+    assertTrue(tutorialCommon_NameViewHasCommand(&view, tutorialCommon_CommandFetch), "Expected the fetch command");
+    assertTrue(view.hasChunkNumber && view.chunkNumber == 7, "Expected chunk 7");
+    assertTrue(view.argumentCount == 1, "Expected 1 argument, got %zu", view.argumentCount);
+    assertTrue(tutorialCommon_NameViewHasFileName(&view, "file.txt"), "Expected the file name to match");
+    assertFalse(tutorialCommon_NameViewHasFileName(&view, "file.tx"), "Expected a shorter file name not to match");
+    assertFalse(tutorialCommon_NameViewHasFileName(&view, "file.txt/more"), "Expected a longer path not to match");
+
+    ccnxName_Release(&name);
+    ccnxName_Release(&domainPrefix);
+}
+
+LONGBOW_TEST_CASE(Global, parseNameOfFileInSubdirectory)
+{
+    CCNxName *domainPrefix = ccnxName_CreateFromURI(tutorialCommon_DomainPrefix);
+    CCNxName *name = ccnxName_CreateFromURI("lci:/ccnx/tutorial/fetch/logs/app.log/chunk=0");
+
+    TutorialNameView view;
+    assertTrue(tutorialCommon_ParseName(name, domainPrefix, &view), "Expected the name to parse");
+    assertTrue(view.argumentCount == 2, "Expected 2 arguments, got %zu", view.argumentCount);
+    assertTrue(tutorialCommon_NameViewHasFileName(&view, "logs/app.log"), "Expected the whole path to match");
+    assertFalse(tutorialCommon_NameViewHasFileName(&view, "logs"), "Expected the first part of the path alone not to match");
+    assertFalse(tutorialCommon_NameViewHasFileName(&view, "logs/app.lo"), "Expected a different last part not to match");
+    assertFalse(tutorialCommon_NameViewHasFileName(&view, "logs/app.log/x"), "Expected a longer path not to match");
+    assertFalse(tutorialCommon_NameViewHasFileName(&view, "logs/"), "Expected a path with a missing part not to match");
+
+    char *fileName = tutorialCommon_CreateFileNameFromName(name, domainPrefix);
+    assertTrue(strcmp(fileName, "logs/app.log") == 0, "Expected 'logs/app.log', got '%s'", fileName);
+    parcMemory_Deallocate((void **) &fileName);
+
+    ccnxName_Release(&name);
+    ccnxName_Release(&domainPrefix);
+}
+
+LONGBOW_TEST_CASE(Global, parseNameWithChunkSize)
+{
+    CCNxName *domainPrefix = ccnxName_CreateFromURI(tutorialCommon_DomainPrefix);
+    CCNxName *name = ccnxName_CreateFromURI("lci:/ccnx/tutorial/fetch/logs/app.log");
+    tutorialCommon_AppendChunkSize(name, 8192);
+    CCNxNameSegment *chunkSegment = ccnxNameSegmentNumber_Create(CCNxNameLabelType_CHUNK, 3);
+    ccnxName_Append(name, chunkSegment);
+    ccnxNameSegment_Release(&chunkSegment);
+
+    TutorialNameView view;
+    assertTrue(tutorialCommon_ParseName(name, domainPrefix, &view), "Expected the name to parse");
+    assertTrue(view.hasChunkSize && view.chunkSize == 8192, "Expected chunk size 8192");
+    assertTrue(view.hasChunkNumber && view.chunkNumber == 3, "Expected chunk 3");
+    assertTrue(view.argumentCount == 2, "Expected the chunk size not to be an argument, got %zu arguments", view.argumentCount);
+    assertTrue(tutorialCommon_NameViewHasFileName(&view, "logs/app.log"), "Expected the whole path to match");
+
+    char *fileName = tutorialCommon_CreateFileNameFromName(name, domainPrefix);
+    assertTrue(strcmp(fileName, "logs/app.log") == 0, "Expected 'logs/app.log', got '%s'", fileName);
+    parcMemory_Deallocate((void **) &fileName);
+
+    CCNxName *withoutChunkSize = ccnxName_CreateFromURI("lci:/ccnx/tutorial/fetch/file.txt/chunk=3");
+    assertTrue(tutorialCommon_ParseName(withoutChunkSize, domainPrefix, &view), "Expected the name to parse");
+    assertFalse(view.hasChunkSize, "Expected no chunk size");
+
+    ccnxName_Release(&withoutChunkSize);
+    ccnxName_Release(&name);
+    ccnxName_Release(&domainPrefix);
+}
+
+LONGBOW_TEST_CASE(Global, appendFilePath)
+{
+    CCNxName *name = ccnxName_CreateFromURI("lci:/ccnx/tutorial/fetch");
+    CCNxName *expected = ccnxName_CreateFromURI("lci:/ccnx/tutorial/fetch/a/b/c.txt");
+
+    tutorialCommon_AppendFilePath(name, "a/b/c.txt");
+    assertTrue(ccnxName_Equals(name, expected), "Expected a segment for each part of the path");
+
+    ccnxName_Release(&expected);
+    ccnxName_Release(&name);
+}
+
+LONGBOW_TEST_CASE(Global, isRelativeFilePath)
+{
+    assertTrue(tutorialCommon_IsRelativeFilePath("file.txt", 8), "Expected a file name to be relative");
+    assertTrue(tutorialCommon_IsRelativeFilePath("logs/app.log", 12), "Expected a path to be relative");
+    assertTrue(tutorialCommon_IsRelativeFilePath("..x/y", 5), "Expected a name starting with .. to be relative");
+    assertFalse(tutorialCommon_IsRelativeFilePath("", 0), "Expected an empty path to be rejected");
+    assertFalse(tutorialCommon_IsRelativeFilePath("/etc/passwd", 11), "Expected an absolute path to be rejected");
+    assertFalse(tutorialCommon_IsRelativeFilePath("../x", 4), "Expected a path leaving the directory to be rejected");
+    assertFalse(tutorialCommon_IsRelativeFilePath("a/../../x", 9), "Expected a path leaving the directory to be rejected");
+    assertFalse(tutorialCommon_IsRelativeFilePath("a//b", 4), "Expected an empty part to be rejected");
+    assertFalse(tutorialCommon_IsRelativeFilePath("a/", 2), "Expected a trailing '/' to be rejected");
+    assertFalse(tutorialCommon_IsRelativeFilePath("./a", 3), "Expected a '.' part to be rejected");
+}
+
+int
+main(int argc, char *argv[])
+{
+    LongBowRunner *testRunner = LONGBOW_TEST_RUNNER_CREATE(tutorial_Common);
+    int exitStatus = longBowMain(argc, argv, testRunner, NULL);
+    longBowTestRunner_Destroy(&testRunner);
+    exit(exitStatus);
+}
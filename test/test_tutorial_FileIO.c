@@ -44,9 +44,15 @@ LONGBOW_TEST_FIXTURE(Global)
 {
     LONGBOW_RUN_TEST_CASE(Global, getFileSize);
     LONGBOW_RUN_TEST_CASE(Global, appendFileChunk);
+    LONGBOW_RUN_TEST_CASE(Global, writeFileChunk);
+    LONGBOW_RUN_TEST_CASE(Global, openFileSink);
     LONGBOW_RUN_TEST_CASE(Global, getFileChunk);
+    LONGBOW_RUN_TEST_CASE(Global, getFileChunkFromDescriptor);
     LONGBOW_RUN_TEST_CASE(Global, isFileAvailable);
     LONGBOW_RUN_TEST_CASE(Global, createtDirectoryListing);
+    LONGBOW_RUN_TEST_CASE(Global, createtDirectoryListingOfSubdirectories);
+    LONGBOW_RUN_TEST_CASE(Global, createParentDirectories);
+    LONGBOW_RUN_TEST_CASE(Global, isSameFileVersion);
 }
 
 LONGBOW_TEST_FIXTURE_SETUP(Global)
@@ -123,6 +129,39 @@ LONGBOW_TEST_CASE(Global, getFileChunk)
     parcMemory_Deallocate((void **)&fileName);
 }
 
+LONGBOW_TEST_CASE(Global, getFileChunkFromDescriptor)
+{
+    char *fileName = createTempFileName("/tmp/tutorial_testData-descriptor.XXXXXXXX");
+    size_t chunkSize = 1200;           // arbitrary
+    int numberOfChunksInTestFile = 10; // arbitrary
+
+    FILE *fp = createTestFile(fileName, chunkSize, numberOfChunksInTestFile);
+    fclose(fp);
+
+    int fileDescriptor = open(fileName, O_RDONLY);
+    assertTrue(fileDescriptor >= 0, "Could not open test file '%s'", fileName);
+
+    // Read the chunks out of order from the same descriptor. Each read must be independent of the last.
+    PARCBuffer *bufA = tutorialFileIO_GetFileChunkFromDescriptor(fileDescriptor, chunkSize, 7);
+    PARCBuffer *bufB = tutorialFileIO_GetFileChunkFromDescriptor(fileDescriptor, chunkSize, 2);
+
+    assertTrue(parcBuffer_Remaining(bufA) == chunkSize, "Expected a full chunk");
+    assertTrue('h' == (char) parcBuffer_GetAtIndex(bufA, 0), "Expected 'h' at this location in the chunk buffer");
+    assertTrue('c' == (char) parcBuffer_GetAtIndex(bufB, chunkSize - 1), "Expected 'c' at this location in the chunk buffer");
+
+    // A chunk past the end of the file is empty.
+    PARCBuffer *bufC = tutorialFileIO_GetFileChunkFromDescriptor(fileDescriptor, chunkSize, numberOfChunksInTestFile);
+    assertTrue(parcBuffer_Remaining(bufC) == 0, "Expected an empty chunk past the end of the file");
+
+    parcBuffer_Release(&bufA);
+    parcBuffer_Release(&bufB);
+    parcBuffer_Release(&bufC);
+
+    close(fileDescriptor);
+    unlink(fileName);
+    parcMemory_Deallocate((void **)&fileName);
+}
+
 LONGBOW_TEST_CASE(Global, appendFileChunk)
 {
     char *inFileName = createTempFileName("/tmp/tutorial_testData-src.XXXXXXXX");
@@ -170,6 +209,101 @@ LONGBOW_TEST_CASE(Global, appendFileChunk)
     parcMemory_Deallocate((void **)&outFileName);
 }
 
+LONGBOW_TEST_CASE(Global, writeFileChunk)
+{
+    char *inFileName = createTempFileName("/tmp/tutorial_testData-src.XXXXXXXX");
+    char *outFileName = createTempFileName("/tmp/tutorial_testData-dst.XXXXXXXX");
+
+    size_t chunkSize = 2300;            // arbitrary
+    int numberOfChunksInTestFile = 20;  // arbitrary
+
+    FILE *fp = createTestFile(inFileName, chunkSize, numberOfChunksInTestFile);
+    fprintf(fp, "short final chunk");
+    fclose(fp);
+
+    int finalChunkNumber = numberOfChunksInTestFile;
+
+    TutorialFileSink *sink = tutorialFileIO_CreateFileSink(outFileName, chunkSize);
+
+    // Write the final chunk and the odd chunks first, then fill in the even ones, so that
+    // both coalesced runs and out-of-order writes are exercised.
+    for (int c = finalChunkNumber; c >= 0; c--) {
+        if (c == finalChunkNumber || (c % 2) == 1) {
+            PARCBuffer *buf = tutorialFileIO_GetFileChunk(inFileName, chunkSize, c);
+            assertTrue(tutorialFileIO_WriteFileChunk(sink, buf, c) == parcBuffer_Remaining(buf),
+                       "Expected the whole chunk to be accepted");
+            parcBuffer_Release(&buf);
+        }
+    }
+    for (int c = 0; c < finalChunkNumber; c += 2) {
+        PARCBuffer *buf = tutorialFileIO_GetFileChunk(inFileName, chunkSize, c);
+        tutorialFileIO_WriteFileChunk(sink, buf, c);
+        parcBuffer_Release(&buf);
+    }
+
+    assertTrue(tutorialFileIO_CloseFileSink(&sink), "Expected the file sink to close successfully");
+    assertNull(sink, "Expected the file sink pointer to be cleared");
+
+    assertTrue(tutorialFileIO_GetFileSize(inFileName) == tutorialFileIO_GetFileSize(outFileName),
+               "Expected written file to be the same size");
+
+    PARCBuffer *bufA = tutorialFileIO_GetFileChunk(inFileName, tutorialFileIO_GetFileSize(inFileName), 0);
+    PARCBuffer *bufB = tutorialFileIO_GetFileChunk(outFileName, tutorialFileIO_GetFileSize(outFileName), 0);
+
+    assertTrue(parcBuffer_Equals(bufA, bufB), "Expected the files to be the same");
+
+    parcBuffer_Release(&bufA);
+    parcBuffer_Release(&bufB);
+
+    unlink(inFileName);
+    unlink(outFileName);
+    parcMemory_Deallocate((void **)&inFileName);
+    parcMemory_Deallocate((void **)&outFileName);
+}
+
+LONGBOW_TEST_CASE(Global, openFileSink)
+{
+    char *inFileName = createTempFileName("/tmp/tutorial_testData-src.XXXXXXXX");
+    char *outFileName = createTempFileName("/tmp/tutorial_testData-dst.XXXXXXXX");
+
+    size_t chunkSize = 1200;            // arbitrary
+    int numberOfChunksInTestFile = 10;  // arbitrary
+
+    FILE *fp = createTestFile(inFileName, chunkSize, numberOfChunksInTestFile);
+    fclose(fp);
+
+    // Write the even chunks, as an interrupted transfer might, then reopen the file and write the odd ones.
+    TutorialFileSink *sink = tutorialFileIO_CreateFileSink(outFileName, chunkSize);
+    for (int c = 0; c < numberOfChunksInTestFile; c += 2) {
+        PARCBuffer *buf = tutorialFileIO_GetFileChunk(inFileName, chunkSize, c);
+        tutorialFileIO_WriteFileChunk(sink, buf, c);
+        parcBuffer_Release(&buf);
+    }
+    assertTrue(tutorialFileIO_FlushFileSink(sink), "Expected the file sink to flush successfully");
+    assertTrue(tutorialFileIO_CloseFileSink(&sink), "Expected the file sink to close successfully");
+
+    sink = tutorialFileIO_OpenFileSink(outFileName, chunkSize);
+    for (int c = 1; c < numberOfChunksInTestFile; c += 2) {
+        PARCBuffer *buf = tutorialFileIO_GetFileChunk(inFileName, chunkSize, c);
+        tutorialFileIO_WriteFileChunk(sink, buf, c);
+        parcBuffer_Release(&buf);
+    }
+    assertTrue(tutorialFileIO_CloseFileSink(&sink), "Expected the file sink to close successfully");
+
+    PARCBuffer *bufA = tutorialFileIO_GetFileChunk(inFileName, tutorialFileIO_GetFileSize(inFileName), 0);
+    PARCBuffer *bufB = tutorialFileIO_GetFileChunk(outFileName, tutorialFileIO_GetFileSize(outFileName), 0);
+
+    assertTrue(parcBuffer_Equals(bufA, bufB), "Expected the reopened file to keep the chunks written before");
+
+    parcBuffer_Release(&bufA);
+    parcBuffer_Release(&bufB);
+
+    unlink(inFileName);
+    unlink(outFileName);
+    parcMemory_Deallocate((void **)&inFileName);
+    parcMemory_Deallocate((void **)&outFileName);
+}
+
 LONGBOW_TEST_CASE(Global, getFileSize)
 {
     char *fileName = createTempFileName("/tmp/tutorial_testData-getFileSize.XXXXXXXX");
@@ -215,6 +349,86 @@ LONGBOW_TEST_CASE(Global, createtDirectoryListing)
     parcBuffer_Release(&listing);
 }
 
+LONGBOW_TEST_CASE(Global, createtDirectoryListingOfSubdirectories)
+{
+    char directoryName[] = "/tmp/tutorial_testData-listing.XXXXXXXX";
+    assertNotNull(mkdtemp(directoryName), "Could not create a temporary directory");
+
+    char filePath[sizeof(directoryName) + 32];
+    snprintf(filePath, sizeof(filePath), "%s/sub/dir/file.txt", directoryName);
+    assertTrue(tutorialFileIO_CreateParentDirectories(filePath), "Expected the directories leading to the file to be created");
+    FILE *fp = createTestFile(filePath, 10, 1);
+    fclose(fp);
+
+    PARCBuffer *listing = tutorialFileIO_CreateDirectoryListing(directoryName);
+    char *listingString = parcBuffer_ToString(listing);
+    assertNotNull(strstr(listingString, "  sub/dir/file.txt  (10 bytes)"), "Expected the listing to hold the file below the directory, got '%s'", listingString);
+
+    parcMemory_Deallocate((void **)&listingString);
+    parcBuffer_Release(&listing);
+
+    unlink(filePath);
+    snprintf(filePath, sizeof(filePath), "%s/sub/dir", directoryName);
+    rmdir(filePath);
+    snprintf(filePath, sizeof(filePath), "%s/sub", directoryName);
+    rmdir(filePath);
+    rmdir(directoryName);
+}
+
+LONGBOW_TEST_CASE(Global, createParentDirectories)
+{
+    char directoryName[] = "/tmp/tutorial_testData-parents.XXXXXXXX";
+    assertNotNull(mkdtemp(directoryName), "Could not create a temporary directory");
+
+    char filePath[sizeof(directoryName) + 32];
+    snprintf(filePath, sizeof(filePath), "%s/a/b/file.txt", directoryName);
+
+    assertTrue(tutorialFileIO_CreateParentDirectories(filePath), "Expected the directories to be created");
+    assertTrue(tutorialFileIO_CreateParentDirectories(filePath), "Expected directories that already exist to be accepted");
+
+    struct stat directoryInfo;
+    snprintf(filePath, sizeof(filePath), "%s/a/b", directoryName);
+    assertTrue(stat(filePath, &directoryInfo) == 0 && S_ISDIR(directoryInfo.st_mode), "Expected '%s' to be a directory", filePath);
+
+    rmdir(filePath);
+    snprintf(filePath, sizeof(filePath), "%s/a", directoryName);
+    rmdir(filePath);
+    rmdir(directoryName);
+}
+
+LONGBOW_TEST_CASE(Global, isSameFileVersion)
+{
+    char *fileName = createTempFileName("/tmp/tutorial_testData-fileVersion.XXXXXXXX");
+    FILE *fp = createTestFile(fileName, 10, 2);
+    fclose(fp);
+
+    struct stat originalInfo;
+    assertTrue(stat(fileName, &originalInfo) == 0, "Could not stat '%s'", fileName);
+    assertTrue(tutorialFileIO_IsSameFileVersion(&originalInfo, &originalInfo), "Expected a stat() to match itself");
+
+    TutorialFileVersion version;
+    tutorialFileIO_GetFileVersion(&originalInfo, &version);
+    assertTrue(tutorialFileIO_IsFileVersion(&version, &originalInfo), "Expected a version to match the stat() it came from");
+
+    // Rewrite the file in place, keeping its size, and put its modification time back. The file system's clock
+    // may only tick every few milliseconds, so wait for it first.
+    usleep(20000);
+    fp = createTestFile(fileName, 10, 2);
+    fclose(fp);
+    struct timespec times[2] = { originalInfo.st_atim, originalInfo.st_mtim };
+    assertTrue(utimensat(AT_FDCWD, fileName, times, 0) == 0, "Could not set the times of '%s'", fileName);
+
+    struct stat currentInfo;
+    assertTrue(stat(fileName, &currentInfo) == 0, "Could not stat '%s'", fileName);
+    assertTrue(currentInfo.st_size == originalInfo.st_size && currentInfo.st_mtime == originalInfo.st_mtime,
+               "Expected the size and modification time to be unchanged");
+    assertFalse(tutorialFileIO_IsSameFileVersion(&originalInfo, &currentInfo), "Expected the rewritten file to be a new version");
+    assertFalse(tutorialFileIO_IsFileVersion(&version, &currentInfo), "Expected the rewritten file to be a new version");
+
+    unlink(fileName);
+    parcMemory_Deallocate((void **)&fileName);
+}
+
 int
 main(int argc, char *argv[])
 {
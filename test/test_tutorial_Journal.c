@@ -0,0 +1,390 @@
+/*
+ * DO NOT ALTER OR REMOVE COPYRIGHT NOTICES OR THIS FILE HEADER.
+ * Copyright 2014-2015 Palo Alto Research Center, Inc. (PARC), a Xerox company.  All Rights Reserved.
+ * The content of this file, whole or in part, is subject to licensing terms.
+ * If distributing this software, include this License Header Notice in each
+ * file and provide the accompanying LICENSE file.
+ */
+/**
+ * @author Alan Walendowski, Computing Science Laboratory, PARC
+ * @copyright 2014-2015 Palo Alto Research Center, Inc. (PARC), A Xerox Company. All Rights Reserved.
+ */
+
+// Include the file(s) containing the functions to be tested.
+// This permits internal static functions to be visible to this Test Framework.
+#include "../tutorial_Journal.c"
+#include "../tutorial_FileIO.c"
+
+#include <stdlib.h>
+#include <sys/stat.h>
+
+#include <parc/algol/parc_SafeMemory.h>
+#include <LongBow/unit-test.h>
+
+LONGBOW_TEST_RUNNER(tutorial_Journal)
+{
+    // The following Test Fixtures will run their corresponding Test Cases.
+    // Test Fixtures are run in the order specified, but all tests should be idempotent.
+    // Never rely on the execution order of tests or share state between them.
+    LONGBOW_RUN_TEST_FIXTURE(Global);
+}
+
+// The Test Runner calls this function once before any Test Fixtures are run.
+LONGBOW_TEST_RUNNER_SETUP(tutorial_Journal)
+{
+    return LONGBOW_STATUS_SUCCEEDED;
+}
+
+// The Test Runner calls this function once after all the Test Fixtures are run.
+LONGBOW_TEST_RUNNER_TEARDOWN(tutorial_Journal)
+{
+    return LONGBOW_STATUS_SUCCEEDED;
+}
+
+LONGBOW_TEST_FIXTURE(Global)
+{
+    LONGBOW_RUN_TEST_CASE(Global, openEmpty);
+    LONGBOW_RUN_TEST_CASE(Global, recordChunk);
+    LONGBOW_RUN_TEST_CASE(Global, flushAndResume);
+    LONGBOW_RUN_TEST_CASE(Global, resumeWithoutFile);
+    LONGBOW_RUN_TEST_CASE(Global, delete);
+    LONGBOW_RUN_TEST_CASE(Global, headerMatchesMetadata);
+    LONGBOW_RUN_TEST_CASE(Global, sourceChanged);
+    LONGBOW_RUN_TEST_CASE(Global, loadTruncatedBitmap);
+    LONGBOW_RUN_TEST_CASE(Global, loadBitmapMasksPastFinalChunk);
+}
+
+LONGBOW_TEST_FIXTURE_SETUP(Global)
+{
+    parcMemory_SetInterface(&PARCSafeMemoryAsPARCMemory);
+    return LONGBOW_STATUS_SUCCEEDED;
+}
+
+LONGBOW_TEST_FIXTURE_TEARDOWN(Global)
+{
+    uint32_t outstandingAllocations = parcSafeMemory_ReportAllocation(STDERR_FILENO);
+    if (outstandingAllocations != 0) {
+        printf("%s leaks memory by %d allocations\n", longBowTestCase_GetName(testCase), outstandingAllocations);
+        return LONGBOW_STATUS_MEMORYLEAK;
+    }
+    return LONGBOW_STATUS_SUCCEEDED;
+}
+
+/**
+ * A temporary directory holding a file being fetched, and the name of its journal.
+ */
+typedef struct {
+    char directoryName[64];
+    char fileName[128];
+    char journalName[160];
+} TestFiles;
+
+/**
+ * Create a temporary directory for a test, and, if `withFile` is true, an empty file being fetched in it.
+ * The directory must be removed by calling removeTestFiles().
+ */
+static void
+createTestFiles(TestFiles *files, bool withFile)
+{
+    snprintf(files->directoryName, sizeof(files->directoryName), "/tmp/tutorial_testData-journal.XXXXXXXX");
+    assertNotNull(mkdtemp(files->directoryName), "Could not create a temporary directory");
+    snprintf(files->fileName, sizeof(files->fileName), "%s/fetched", files->directoryName);
+    snprintf(files->journalName, sizeof(files->journalName), "%s%s", files->fileName, _journalSuffix);
+
+    if (withFile) {
+        FILE *fp = fopen(files->fileName, "w");
+        assertNotNull(fp, "Could not create '%s'", files->fileName);
+        fclose(fp);
+    }
+}
+
+static void
+removeTestFiles(TestFiles *files)
+{
+    unlink(files->journalName);
+    unlink(files->fileName);
+    rmdir(files->directoryName);
+}
+
+/**
+ * The metadata of a file of 1 KB chunks, the last of which is `finalChunkNumber`.
+ */
+static TutorialMetadata
+createMetadata(uint64_t finalChunkNumber)
+{
+    TutorialMetadata result;
+    memset(&result, 0, sizeof(result));
+    result.chunkSize = 1024;
+    result.finalChunkNumber = finalChunkNumber;
+    result.fileSize = (finalChunkNumber + 1) * result.chunkSize;
+    result.modificationTime = 1420070400;
+    return result;
+}
+
+static off_t
+getJournalSize(const TestFiles *files)
+{
+    struct stat statbuf;
+    assertTrue(stat(files->journalName, &statbuf) == 0, "Could not stat '%s'", files->journalName);
+    return statbuf.st_size;
+}
+
+/**
+ * Overwrite a word of a journal's bitmap on disk.
+ */
+static void
+writeBitmapWord(const TestFiles *files, size_t word, uint64_t bits)
+{
+    int fd = open(files->journalName, O_WRONLY);
+    assertTrue(fd >= 0, "Could not open '%s'", files->journalName);
+    off_t offset = (off_t) (sizeof(_TutorialJournalHeader) + word * sizeof(uint64_t));
+    assertTrue(pwrite(fd, &bits, sizeof(bits), offset) == (ssize_t) sizeof(bits), "Could not write '%s'", files->journalName);
+    close(fd);
+}
+
+LONGBOW_TEST_CASE(Global, openEmpty)
+{
+    TestFiles files;
+    createTestFiles(&files, true);
+    TutorialMetadata metadata = createMetadata(99);
+
+    TutorialJournal *journal = tutorialJournal_Open(files.fileName, &metadata);
+    assertNotNull(journal, "Expected a journal");
+    assertTrue(tutorialJournal_GetChunkCount(journal) == 0, "Expected a new journal to be empty");
+    assertFalse(tutorialJournal_HasChunk(journal, 0), "Did not expect a new journal to have chunk 0");
+    assertFalse(tutorialJournal_WasSourceChanged(journal), "Did not expect a new journal to see a changed source");
+    assertFalse(tutorialJournal_IsFlushDue(journal), "Did not expect a flush to be due with nothing recorded");
+
+    // The header is followed by a bitmap of two words, for chunks 0 through 99.
+    assertTrue(getJournalSize(&files) == (off_t) (sizeof(_TutorialJournalHeader) + 2 * sizeof(uint64_t)),
+               "Expected the journal's file to hold the header and an empty bitmap");
+
+    tutorialJournal_Release(&journal);
+    assertNull(journal, "Expected the journal to be set to NULL");
+    removeTestFiles(&files);
+}
+
+LONGBOW_TEST_CASE(Global, recordChunk)
+{
+    TestFiles files;
+    createTestFiles(&files, true);
+    TutorialMetadata metadata = createMetadata(99);
+
+    TutorialJournal *journal = tutorialJournal_Open(files.fileName, &metadata);
+    tutorialJournal_RecordChunk(journal, 0);
+    tutorialJournal_RecordChunk(journal, 70);
+    tutorialJournal_RecordChunk(journal, 70);
+    tutorialJournal_RecordChunk(journal, 100);
+
+    assertTrue(tutorialJournal_GetChunkCount(journal) == 2, "Expected 2 chunks, got %llu",
+               (unsigned long long) tutorialJournal_GetChunkCount(journal));
+    assertTrue(tutorialJournal_HasChunk(journal, 0), "Expected chunk 0 to be recorded");
+    assertTrue(tutorialJournal_HasChunk(journal, 70), "Expected chunk 70 to be recorded");
+    assertFalse(tutorialJournal_HasChunk(journal, 1), "Did not expect chunk 1 to be recorded");
+    assertFalse(tutorialJournal_HasChunk(journal, 100), "Did not expect a chunk past the final chunk to be recorded");
+
+    // Both bitmap words are waiting to be written, but the flush interval hasn't passed.
+    assertTrue(journal->firstDirtyWord == 0 && journal->endDirtyWord == 2, "Expected both bitmap words to be dirty");
+    assertFalse(tutorialJournal_IsFlushDue(journal), "Did not expect a flush to be due before the interval");
+
+    tutorialJournal_Release(&journal);
+    removeTestFiles(&files);
+}
+
+LONGBOW_TEST_CASE(Global, flushAndResume)
+{
+    TestFiles files;
+    createTestFiles(&files, true);
+    TutorialMetadata metadata = createMetadata(99);
+
+    TutorialJournal *journal = tutorialJournal_Open(files.fileName, &metadata);
+    tutorialJournal_RecordChunk(journal, 0);
+    tutorialJournal_RecordChunk(journal, 1);
+    tutorialJournal_RecordChunk(journal, 99);
+    assertTrue(tutorialJournal_Flush(journal), "Expected the journal to be written");
+    assertTrue(journal->firstDirtyWord == journal->endDirtyWord, "Expected nothing left to write");
+
+    // A chunk recorded after the last flush is not written.
+    tutorialJournal_RecordChunk(journal, 2);
+    tutorialJournal_Release(&journal);
+
+    journal = tutorialJournal_Open(files.fileName, &metadata);
+    assertFalse(tutorialJournal_WasSourceChanged(journal), "Did not expect a changed source");
+    assertTrue(tutorialJournal_GetChunkCount(journal) == 3, "Expected the 3 flushed chunks, got %llu",
+               (unsigned long long) tutorialJournal_GetChunkCount(journal));
+    assertTrue(tutorialJournal_HasChunk(journal, 0), "Expected chunk 0 to be resumed");
+    assertTrue(tutorialJournal_HasChunk(journal, 1), "Expected chunk 1 to be resumed");
+    assertTrue(tutorialJournal_HasChunk(journal, 99), "Expected chunk 99 to be resumed");
+    assertFalse(tutorialJournal_HasChunk(journal, 2), "Did not expect the unflushed chunk 2 to be resumed");
+
+    tutorialJournal_Release(&journal);
+    removeTestFiles(&files);
+}
+
+LONGBOW_TEST_CASE(Global, resumeWithoutFile)
+{
+    TestFiles files;
+    createTestFiles(&files, true);
+    TutorialMetadata metadata = createMetadata(99);
+
+    TutorialJournal *journal = tutorialJournal_Open(files.fileName, &metadata);
+    tutorialJournal_RecordChunk(journal, 0);
+    tutorialJournal_Flush(journal);
+    tutorialJournal_Release(&journal);
+
+    // The chunks the journal records are gone with the file, so they aren't kept.
+    unlink(files.fileName);
+    journal = tutorialJournal_Open(files.fileName, &metadata);
+    assertTrue(tutorialJournal_GetChunkCount(journal) == 0, "Expected no chunks without the file");
+    assertFalse(tutorialJournal_WasSourceChanged(journal), "Did not expect a changed source");
+
+    tutorialJournal_Release(&journal);
+    removeTestFiles(&files);
+}
+
+LONGBOW_TEST_CASE(Global, delete)
+{
+    TestFiles files;
+    createTestFiles(&files, true);
+    TutorialMetadata metadata = createMetadata(99);
+
+    TutorialJournal *journal = tutorialJournal_Open(files.fileName, &metadata);
+    assertTrue(access(files.journalName, F_OK) == 0, "Expected the journal's file to exist");
+
+    tutorialJournal_Delete(&journal);
+    assertNull(journal, "Expected the journal to be set to NULL");
+    assertTrue(access(files.journalName, F_OK) != 0, "Expected the journal's file to be deleted");
+    assertTrue(access(files.fileName, F_OK) == 0, "Expected the fetched file to be kept");
+
+    removeTestFiles(&files);
+}
+
+LONGBOW_TEST_CASE(Global, headerMatchesMetadata)
+{
+    TutorialMetadata metadata = createMetadata(99);
+
+    _TutorialJournalHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, _journalMagic, sizeof(header.magic));
+    header.fileSize = metadata.fileSize;
+    header.finalChunkNumber = metadata.finalChunkNumber;
+    header.modificationTime = metadata.modificationTime;
+    header.chunkSize = metadata.chunkSize;
+    assertTrue(_headerMatchesMetadata(&header, &metadata), "Expected the header to match");
+
+    // The compression codec isn't part of the file's version.
+    TutorialMetadata other = metadata;
+    other.compression = TutorialCompressionCodec_Zstd;
+    assertTrue(_headerMatchesMetadata(&header, &other), "Expected the header to match whatever the codec");
+
+    other = metadata;
+    other.fileSize++;
+    assertFalse(_headerMatchesMetadata(&header, &other), "Did not expect a different size to match");
+
+    other = metadata;
+    other.finalChunkNumber++;
+    assertFalse(_headerMatchesMetadata(&header, &other), "Did not expect a different final chunk to match");
+
+    other = metadata;
+    other.modificationTime++;
+    assertFalse(_headerMatchesMetadata(&header, &other), "Did not expect a different modification time to match");
+
+    other = metadata;
+    other.chunkSize = 2048;
+    assertFalse(_headerMatchesMetadata(&header, &other), "Did not expect a different chunk size to match");
+}
+
+LONGBOW_TEST_CASE(Global, sourceChanged)
+{
+    TestFiles files;
+    createTestFiles(&files, true);
+    TutorialMetadata metadata = createMetadata(99);
+
+    TutorialJournal *journal = tutorialJournal_Open(files.fileName, &metadata);
+    tutorialJournal_RecordChunk(journal, 0);
+    tutorialJournal_Flush(journal);
+    tutorialJournal_Release(&journal);
+
+    // The file was modified on the server, so the journal describes an older version and is discarded.
+    metadata.modificationTime++;
+    journal = tutorialJournal_Open(files.fileName, &metadata);
+    assertTrue(tutorialJournal_WasSourceChanged(journal), "Expected a changed source");
+    assertTrue(tutorialJournal_GetChunkCount(journal) == 0, "Expected the old chunks to be discarded");
+    tutorialJournal_Release(&journal);
+
+    // The journal was rewritten for the new version.
+    journal = tutorialJournal_Open(files.fileName, &metadata);
+    assertFalse(tutorialJournal_WasSourceChanged(journal), "Did not expect a changed source once rewritten");
+    tutorialJournal_Release(&journal);
+
+    removeTestFiles(&files);
+}
+
+LONGBOW_TEST_CASE(Global, loadTruncatedBitmap)
+{
+    TestFiles files;
+    createTestFiles(&files, true);
+    TutorialMetadata metadata = createMetadata(99);
+
+    TutorialJournal *journal = tutorialJournal_Open(files.fileName, &metadata);
+    tutorialJournal_RecordChunk(journal, 0);
+    tutorialJournal_RecordChunk(journal, 99);
+    tutorialJournal_Flush(journal);
+    tutorialJournal_Release(&journal);
+
+    // Cut the bitmap short, as an interrupted write might.
+    assertTrue(truncate(files.journalName, (off_t) (sizeof(_TutorialJournalHeader) + sizeof(uint64_t))) == 0,
+               "Could not truncate '%s'", files.journalName);
+
+    journal = tutorialJournal_Open(files.fileName, &metadata);
+    assertFalse(tutorialJournal_WasSourceChanged(journal), "Did not expect a changed source");
+    assertTrue(tutorialJournal_GetChunkCount(journal) == 0, "Expected a truncated journal to be discarded");
+    assertFalse(tutorialJournal_HasChunk(journal, 0), "Did not expect chunk 0 from a truncated journal");
+    assertTrue(getJournalSize(&files) == (off_t) (sizeof(_TutorialJournalHeader) + 2 * sizeof(uint64_t)),
+               "Expected the journal's file to be rewritten whole");
+
+    tutorialJournal_Release(&journal);
+    removeTestFiles(&files);
+}
+
+LONGBOW_TEST_CASE(Global, loadBitmapMasksPastFinalChunk)
+{
+    TestFiles files;
+    createTestFiles(&files, true);
+
+    // With chunks 0 through 69, only the low 6 bits of the second word are chunks.
+    TutorialMetadata metadata = createMetadata(69);
+    TutorialJournal *journal = tutorialJournal_Open(files.fileName, &metadata);
+    tutorialJournal_Release(&journal);
+    writeBitmapWord(&files, 1, UINT64_MAX);
+
+    journal = tutorialJournal_Open(files.fileName, &metadata);
+    assertTrue(tutorialJournal_GetChunkCount(journal) == 6, "Expected only chunks 64 through 69, got %llu",
+               (unsigned long long) tutorialJournal_GetChunkCount(journal));
+    assertTrue(tutorialJournal_HasChunk(journal, 69), "Expected the final chunk");
+    assertTrue(journal->bitmap[1] == UINT64_C(0x3f), "Expected the bits past the final chunk to be cleared");
+    tutorialJournal_Release(&journal);
+
+    // When the final chunk is the last bit of a word, the whole word is chunks.
+    unlink(files.journalName);
+    metadata = createMetadata(63);
+    journal = tutorialJournal_Open(files.fileName, &metadata);
+    tutorialJournal_Release(&journal);
+    writeBitmapWord(&files, 0, UINT64_MAX);
+
+    journal = tutorialJournal_Open(files.fileName, &metadata);
+    assertTrue(tutorialJournal_GetChunkCount(journal) == 64, "Expected all 64 chunks, got %llu",
+               (unsigned long long) tutorialJournal_GetChunkCount(journal));
+    tutorialJournal_Release(&journal);
+
+    removeTestFiles(&files);
+}
+
+int
+main(int argc, char *argv[])
+{
+    LongBowRunner *testRunner = LONGBOW_TEST_RUNNER_CREATE(tutorial_Journal);
+    int exitStatus = longBowMain(argc, argv, testRunner, NULL);
+    longBowTestRunner_Destroy(&testRunner);
+    exit(exitStatus);
+}
@@ -0,0 +1,258 @@
+/*
+ * DO NOT ALTER OR REMOVE COPYRIGHT NOTICES OR THIS FILE HEADER.
+ * Copyright 2014-2015 Palo Alto Research Center, Inc. (PARC), a Xerox company.  All Rights Reserved.
+ * The content of this file, whole or in part, is subject to licensing terms.
+ * If distributing this software, include this License Header Notice in each
+ * file and provide the accompanying LICENSE file. 
+ */
+/**
+ * @author Alan Walendowski, Computing Science Laboratory, PARC
+ * @copyright 2014-2015 Palo Alto Research Center, Inc. (PARC), A Xerox Company. All Rights Reserved.
+ */
+
+// Include the file(s) containing the functions to be tested.
+// This permits internal static functions to be visible to this Test Framework.
+#include "../tutorial_ListingQuery.c"
+#include "../tutorial_Common.c"
+#include "../tutorial_About.c"
+
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <parc/algol/parc_SafeMemory.h>
+#include <LongBow/unit-test.h>
+
+LONGBOW_TEST_RUNNER(tutorial_ListingQuery)
+{
+    // The following Test Fixtures will run their corresponding Test Cases.
+    // Test Fixtures are run in the order specified, but all tests should be idempotent.
+    // Never rely on the execution order of tests or share state between them.
+    LONGBOW_RUN_TEST_FIXTURE(Global);
+}
+
+// The Test Runner calls this function once before any Test Fixtures are run.
+LONGBOW_TEST_RUNNER_SETUP(tutorial_ListingQuery)
+{
+    return LONGBOW_STATUS_SUCCEEDED;
+}
+
+// The Test Runner calls this function once after all the Test Fixtures are run.
+LONGBOW_TEST_RUNNER_TEARDOWN(tutorial_ListingQuery)
+{
+    return LONGBOW_STATUS_SUCCEEDED;
+}
+
+LONGBOW_TEST_FIXTURE(Global)
+{
+    LONGBOW_RUN_TEST_CASE(Global, parseWithoutArguments);
+    LONGBOW_RUN_TEST_CASE(Global, parsePrefixAndMatch);
+    LONGBOW_RUN_TEST_CASE(Global, parseSinceAfterAndLimit);
+    LONGBOW_RUN_TEST_CASE(Global, parseMalformed);
+    LONGBOW_RUN_TEST_CASE(Global, createName);
+    LONGBOW_RUN_TEST_CASE(Global, matchesPrefix);
+    LONGBOW_RUN_TEST_CASE(Global, matchesPattern);
+    LONGBOW_RUN_TEST_CASE(Global, matchesSince);
+}
+
+LONGBOW_TEST_FIXTURE_SETUP(Global)
+{
+    parcMemory_SetInterface(&PARCSafeMemoryAsPARCMemory);
+    return LONGBOW_STATUS_SUCCEEDED;
+}
+
+LONGBOW_TEST_FIXTURE_TEARDOWN(Global)
+{
+    uint32_t outstandingAllocations = parcSafeMemory_ReportAllocation(STDERR_FILENO);
+    if (outstandingAllocations != 0) {
+        printf("%s leaks memory by %d allocations\n", longBowTestCase_GetName(testCase), outstandingAllocations);
+        return LONGBOW_STATUS_MEMORYLEAK;
+    }
+    return LONGBOW_STATUS_SUCCEEDED;
+}
+
+/**
+ * Create the name of a 'list' command with the specified arguments, one segment each.
+ * The new CCNxName must eventually be released by calling ccnxName_Release().
+ */
+static CCNxName *
+createListName(const char **arguments, size_t argumentCount)
+{
+    CCNxName *result = ccnxName_CreateFromURI("lci:/ccnx/tutorial/list");
+
+    for (size_t i = 0; i < argumentCount; i++) {
+        CCNxNameSegment *segment = ccnxNameSegment_CreateTypeValueArray(CCNxNameLabelType_NAME, strlen(arguments[i]), arguments[i]);
+        ccnxName_Append(result, segment);
+        ccnxNameSegment_Release(&segment);
+    }
+
+    return result;
+}
+
+/**
+ * Parse the arguments of a 'list' command into a query.
+ *
+ * @return The result of tutorialListingQuery_Parse().
+ */
+static bool
+parseArguments(const char **arguments, size_t argumentCount, TutorialListingQuery *query)
+{
+    CCNxName *domainPrefix = ccnxName_CreateFromURI(tutorialCommon_DomainPrefix);
+    CCNxName *name = createListName(arguments, argumentCount);
+
+    TutorialNameView view;
+    assertTrue(tutorialCommon_ParseName(name, domainPrefix, &view), "Expected the name of a 'list' command to parse");
+    bool result = tutorialListingQuery_Parse(name, &view, query);
+
+    // The query's strings point into the name, so only the numbers are still valid once it is released.
+    query->prefix = NULL;
+    query->pattern = NULL;
+    query->after = NULL;
+
+    ccnxName_Release(&name);
+    ccnxName_Release(&domainPrefix);
+
+    return result;
+}
+
+LONGBOW_TEST_CASE(Global, parseWithoutArguments)
+{
+    TutorialListingQuery query;
+    assertTrue(parseArguments(NULL, 0, &query), "Expected a 'list' command without arguments to parse");
+    assertTrue(query.prefixLength == 0 && query.patternLength == 0 && query.afterLength == 0, "Expected no strings");
+    assertFalse(query.hasModifiedSince, "Expected no modification time");
+    assertTrue(query.limit == 0, "Expected no limit, got %zu", query.limit);
+}
+
+LONGBOW_TEST_CASE(Global, parsePrefixAndMatch)
+{
+    CCNxName *domainPrefix = ccnxName_CreateFromURI(tutorialCommon_DomainPrefix);
+    const char *arguments[] = { "prefix=logs-", "match=*.csv" };
+    CCNxName *name = createListName(arguments, 2);
+
+    TutorialNameView view;
+    TutorialListingQuery query;
+    tutorialCommon_ParseName(name, domainPrefix, &view);
+    assertTrue(tutorialListingQuery_Parse(name, &view, &query), "Expected the query to parse");
+    assertTrue(query.prefixLength == 5 && memcmp(query.prefix, "logs-", 5) == 0,
+               "Expected the prefix 'logs-', got '%.*s'", (int) query.prefixLength, query.prefix);
+    assertTrue(query.patternLength == 5 && memcmp(query.pattern, "*.csv", 5) == 0,
+               "Expected the pattern '*.csv', got '%.*s'", (int) query.patternLength, query.pattern);
+    assertNull(query.after, "Expected no cursor");
+
+    ccnxName_Release(&name);
+    ccnxName_Release(&domainPrefix);
+}
+
+LONGBOW_TEST_CASE(Global, parseSinceAfterAndLimit)
+{
+    CCNxName *domainPrefix = ccnxName_CreateFromURI(tutorialCommon_DomainPrefix);
+    const char *arguments[] = { "since=1420070400", "after=logs/2015/app.log", "limit=100" };
+    CCNxName *name = createListName(arguments, 3);
+
+    TutorialNameView view;
+    TutorialListingQuery query;
+    tutorialCommon_ParseName(name, domainPrefix, &view);
+    assertTrue(tutorialListingQuery_Parse(name, &view, &query), "Expected the query to parse");
+    assertTrue(query.hasModifiedSince && query.modifiedSince == 1420070400LL,
+               "Expected since 1420070400, got %lld", (long long) query.modifiedSince);
+    assertTrue(query.afterLength == 17 && memcmp(query.after, "logs/2015/app.log", 17) == 0,
+               "Expected the cursor 'logs/2015/app.log', got '%.*s'", (int) query.afterLength, query.after);
+    assertTrue(query.limit == 100, "Expected a limit of 100, got %zu", query.limit);
+
+    ccnxName_Release(&name);
+    ccnxName_Release(&domainPrefix);
+}
+
+LONGBOW_TEST_CASE(Global, parseMalformed)
+{
+    const char *malformed[] = {
+        "since=",                       // No number.
+        "since=abc",
+        "since=12x",
+        "since=-5",
+        "since=99999999999999999999",   // More than an int64_t holds.
+        "limit=0",                      // A limit must allow at least one file.
+        "limit=-1",
+        "limit=",
+        "limit=1e3",
+        "prefix",                       // No '='.
+        "chunk=3",                      // Chunks are CHUNK segments, not arguments.
+        "order=name",                   // Not a condition we know.
+    };
+
+    for (size_t i = 0; i < sizeof(malformed) / sizeof(malformed[0]); i++) {
+        TutorialListingQuery query;
+        assertFalse(parseArguments(&malformed[i], 1, &query), "Expected '%s' to be rejected", malformed[i]);
+
+        // A malformed argument spoils the query even after a valid one.
+        const char *arguments[] = { "prefix=a", malformed[i] };
+        assertFalse(parseArguments(arguments, 2, &query), "Expected 'prefix=a/%s' to be rejected", malformed[i]);
+    }
+}
+
+LONGBOW_TEST_CASE(Global, createName)
+{
+    TutorialListingQuery query = {
+        .prefix = "logs-", .prefixLength = 5,
+        .pattern = "*.csv", .patternLength = 5,
+        .after = "logs-9.csv", .afterLength = 10,
+        .hasModifiedSince = true, .modifiedSince = 1420070400LL,
+        .limit = 50
+    };
+    CCNxName *name = tutorialListingQuery_CreateName(&query);
+    CCNxName *domainPrefix = ccnxName_CreateFromURI(tutorialCommon_DomainPrefix);
+
+    TutorialNameView view;
+    TutorialListingQuery parsed;
+    assertTrue(tutorialCommon_ParseName(name, domainPrefix, &view), "Expected the name to parse");
+    assertTrue(tutorialCommon_NameViewHasCommand(&view, tutorialCommon_CommandList), "Expected the 'list' command");
+    assertTrue(tutorialListingQuery_Parse(name, &view, &parsed), "Expected the query to parse back");
+    assertTrue(parsed.prefixLength == 5 && memcmp(parsed.prefix, "logs-", 5) == 0, "Expected the prefix to survive");
+    assertTrue(parsed.patternLength == 5 && memcmp(parsed.pattern, "*.csv", 5) == 0, "Expected the pattern to survive");
+    assertTrue(parsed.afterLength == 10 && memcmp(parsed.after, "logs-9.csv", 10) == 0, "Expected the cursor to survive");
+    assertTrue(parsed.hasModifiedSince && parsed.modifiedSince == 1420070400LL, "Expected the modification time to survive");
+    assertTrue(parsed.limit == 50, "Expected the limit to survive, got %zu", parsed.limit);
+
+    ccnxName_Release(&domainPrefix);
+    ccnxName_Release(&name);
+}
+
+LONGBOW_TEST_CASE(Global, matchesPrefix)
+{
+    TutorialListingQuery query = { .prefix = "logs-", .prefixLength = 5 };
+
+    assertTrue(tutorialListingQuery_Matches(&query, "logs-1.csv", 10, 0), "Expected a name with the prefix to match");
+    assertTrue(tutorialListingQuery_Matches(&query, "logs-", 5, 0), "Expected the prefix itself to match");
+    assertFalse(tutorialListingQuery_Matches(&query, "logs", 4, 0), "Expected a shorter name not to match");
+    assertFalse(tutorialListingQuery_Matches(&query, "app-logs-1", 10, 0), "Expected a name containing the prefix later not to match");
+}
+
+LONGBOW_TEST_CASE(Global, matchesPattern)
+{
+    TutorialListingQuery query = { .pattern = "*.csv", .patternLength = 5 };
+
+    assertTrue(tutorialListingQuery_Matches(&query, "a.csv", 5, 0), "Expected 'a.csv' to match");
+    assertFalse(tutorialListingQuery_Matches(&query, "a.txt", 5, 0), "Expected 'a.txt' not to match");
+    assertFalse(tutorialListingQuery_Matches(&query, "logs/a.csv", 10, 0), "Expected '*' not to match across a '/'");
+
+    TutorialListingQuery nested = { .pattern = "logs/*.csv", .patternLength = 10 };
+    assertTrue(tutorialListingQuery_Matches(&nested, "logs/a.csv", 10, 0), "Expected 'logs/a.csv' to match 'logs/*.csv'");
+}
+
+LONGBOW_TEST_CASE(Global, matchesSince)
+{
+    TutorialListingQuery query = { .hasModifiedSince = true, .modifiedSince = 1000 };
+
+    assertTrue(tutorialListingQuery_Matches(&query, "a", 1, 1000), "Expected a file modified at the time to match");
+    assertTrue(tutorialListingQuery_Matches(&query, "a", 1, 2000), "Expected a file modified after the time to match");
+    assertFalse(tutorialListingQuery_Matches(&query, "a", 1, 999), "Expected a file modified before the time not to match");
+}
+
+int
+main(int argc, char *argv[])
+{
+    LongBowRunner *testRunner = LONGBOW_TEST_RUNNER_CREATE(tutorial_ListingQuery);
+    int exitStatus = longBowMain(argc, argv, testRunner, NULL);
+    longBowTestRunner_Destroy(&testRunner);
+    exit(exitStatus);
+}
@@ -0,0 +1,334 @@
+/*
+ * DO NOT ALTER OR REMOVE COPYRIGHT NOTICES OR THIS FILE HEADER.
+ * Copyright 2014-2015 Palo Alto Research Center, Inc. (PARC), a Xerox company.  All Rights Reserved.
+ * The content of this file, whole or in part, is subject to licensing terms.
+ * If distributing this software, include this License Header Notice in each
+ * file and provide the accompanying LICENSE file.
+ */
+/**
+ * @author Alan Walendowski, Computing Science Laboratory, PARC
+ * @copyright 2014-2015 Palo Alto Research Center, Inc. (PARC), A Xerox Company. All Rights Reserved.
+ */
+
+// Include the file(s) containing the functions to be tested.
+// This permits internal static functions to be visible to this Test Framework.
+#include "../tutorial_Reassembler.c"
+
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <parc/algol/parc_SafeMemory.h>
+#include <LongBow/unit-test.h>
+
+LONGBOW_TEST_RUNNER(tutorial_Reassembler)
+{
+    // The following Test Fixtures will run their corresponding Test Cases.
+    // Test Fixtures are run in the order specified, but all tests should be idempotent.
+    // Never rely on the execution order of tests or share state between them.
+    LONGBOW_RUN_TEST_FIXTURE(Global);
+}
+
+// The Test Runner calls this function once before any Test Fixtures are run.
+LONGBOW_TEST_RUNNER_SETUP(tutorial_Reassembler)
+{
+    return LONGBOW_STATUS_SUCCEEDED;
+}
+
+// The Test Runner calls this function once after all the Test Fixtures are run.
+LONGBOW_TEST_RUNNER_TEARDOWN(tutorial_Reassembler)
+{
+    return LONGBOW_STATUS_SUCCEEDED;
+}
+
+LONGBOW_TEST_FIXTURE(Global)
+{
+    LONGBOW_RUN_TEST_CASE(Global, addInOrder);
+    LONGBOW_RUN_TEST_CASE(Global, addOutOfOrderWithinWindow);
+    LONGBOW_RUN_TEST_CASE(Global, addBeyondWindow);
+    LONGBOW_RUN_TEST_CASE(Global, addWithoutWindow);
+    LONGBOW_RUN_TEST_CASE(Global, addDuplicate);
+    LONGBOW_RUN_TEST_CASE(Global, addOutOfRange);
+    LONGBOW_RUN_TEST_CASE(Global, skipChunk);
+    LONGBOW_RUN_TEST_CASE(Global, isComplete);
+    LONGBOW_RUN_TEST_CASE(Global, releaseHoldingChunks);
+}
+
+LONGBOW_TEST_FIXTURE_SETUP(Global)
+{
+    parcMemory_SetInterface(&PARCSafeMemoryAsPARCMemory);
+    return LONGBOW_STATUS_SUCCEEDED;
+}
+
+LONGBOW_TEST_FIXTURE_TEARDOWN(Global)
+{
+    uint32_t outstandingAllocations = parcSafeMemory_ReportAllocation(STDERR_FILENO);
+    if (outstandingAllocations != 0) {
+        printf("%s leaks memory by %d allocations\n", longBowTestCase_GetName(testCase), outstandingAllocations);
+        return LONGBOW_STATUS_MEMORYLEAK;
+    }
+    return LONGBOW_STATUS_SUCCEEDED;
+}
+
+/**
+ * The chunks a TutorialReassembler has handed to its writer, in the order it wrote them.
+ */
+typedef struct {
+    uint64_t chunkNumbers[32];
+    uint8_t contents[32];  // The byte each chunk held, which is its chunk number.
+    size_t count;
+} TestWrites;
+
+static void
+recordWrite(void *context, const PARCBuffer *chunk, uint64_t chunkNumber)
+{
+    TestWrites *writes = context;
+
+    assertTrue(writes->count < sizeof(writes->chunkNumbers) / sizeof(writes->chunkNumbers[0]), "Too many chunks written");
+    assertTrue(parcBuffer_Remaining(chunk) == 1, "Expected a chunk of 1 byte, got %zu", parcBuffer_Remaining(chunk));
+
+    writes->chunkNumbers[writes->count] = chunkNumber;
+    writes->contents[writes->count] = parcBuffer_GetAtIndex(chunk, 0);
+    writes->count++;
+}
+
+/**
+ * Add a chunk of one byte, holding its own chunk number, to a reassembler. The chunk is released straight
+ * away, so a chunk the reassembler holds is only still valid if it acquired it.
+ */
+static TutorialReassemblerResult
+addChunk(TutorialReassembler *reassembler, uint64_t chunkNumber, uint64_t finalChunkNumber)
+{
+    PARCBuffer *chunk = parcBuffer_Allocate(1);
+    parcBuffer_PutUint8(chunk, (uint8_t) chunkNumber);
+    parcBuffer_Flip(chunk);
+
+    TutorialReassemblerResult result = tutorialReassembler_AddChunk(reassembler, chunk, chunkNumber, finalChunkNumber);
+    parcBuffer_Release(&chunk);
+
+    return result;
+}
+
+/**
+ * Check that exactly the expected chunks were written, in the expected order, each with its own contents.
+ */
+static void
+assertWrites(const TestWrites *writes, const uint64_t *expected, size_t expectedCount)
+{
+    assertTrue(writes->count == expectedCount, "Expected %zu chunks written, got %zu", expectedCount, writes->count);
+    for (size_t i = 0; i < expectedCount; i++) {
+        assertTrue(writes->chunkNumbers[i] == expected[i],
+                   "Expected write %zu to be chunk %llu, got chunk %llu", i,
+                   (unsigned long long) expected[i], (unsigned long long) writes->chunkNumbers[i]);
+        assertTrue(writes->contents[i] == (uint8_t) expected[i],
+                   "Expected chunk %llu to hold its own number, got %u", (unsigned long long) expected[i], writes->contents[i]);
+    }
+}
+
+LONGBOW_TEST_CASE(Global, addInOrder)
+{
+    TestWrites writes = { .count = 0 };
+    TutorialReassembler *reassembler = tutorialReassembler_Create(4, recordWrite, &writes);
+
+    for (uint64_t chunkNumber = 0; chunkNumber <= 4; chunkNumber++) {
+        assertFalse(tutorialReassembler_IsComplete(reassembler), "Did not expect completion before chunk %llu",
+                    (unsigned long long) chunkNumber);
+        assertTrue(addChunk(reassembler, chunkNumber, 4) == TutorialReassemblerResult_Accepted,
+                   "Expected chunk %llu to be accepted", (unsigned long long) chunkNumber);
+        assertTrue(writes.count == chunkNumber + 1, "Expected chunk %llu to be written straight away", (unsigned long long) chunkNumber);
+    }
+
+    uint64_t expected[] = { 0, 1, 2, 3, 4 };
+    assertWrites(&writes, expected, 5);
+    assertTrue(tutorialReassembler_IsComplete(reassembler), "Expected the content to be complete");
+    assertTrue(tutorialReassembler_GetReceivedCount(reassembler) == 5, "Expected 5 chunks received");
+    assertTrue(tutorialReassembler_GetFirstMissingChunk(reassembler) == 5, "Expected the first missing chunk to be past the final chunk");
+    assertTrue(tutorialReassembler_GetFinalChunkNumber(reassembler) == 4, "Expected the final chunk number to be 4");
+
+    tutorialReassembler_Release(&reassembler);
+    assertNull(reassembler, "Expected the reassembler to be set to NULL");
+}
+
+LONGBOW_TEST_CASE(Global, addOutOfOrderWithinWindow)
+{
+    TestWrites writes = { .count = 0 };
+    TutorialReassembler *reassembler = tutorialReassembler_Create(4, recordWrite, &writes);
+
+    // Chunks 2 and 1 arrive ahead of chunk 0, so they are held rather than written.
+    assertTrue(addChunk(reassembler, 2, 3) == TutorialReassemblerResult_Accepted, "Expected chunk 2 to be accepted");
+    assertTrue(addChunk(reassembler, 1, 3) == TutorialReassemblerResult_Accepted, "Expected chunk 1 to be accepted");
+    assertTrue(writes.count == 0, "Expected chunks ahead of the gap to be held, got %zu written", writes.count);
+    assertTrue(tutorialReassembler_HasChunk(reassembler, 1) && tutorialReassembler_HasChunk(reassembler, 2),
+               "Expected held chunks to count as received");
+    assertTrue(tutorialReassembler_GetFirstMissingChunk(reassembler) == 0, "Expected chunk 0 to be missing");
+
+    // Chunk 0 fills the gap, and the held chunks follow it in order.
+    assertTrue(addChunk(reassembler, 0, 3) == TutorialReassemblerResult_Accepted, "Expected chunk 0 to be accepted");
+    uint64_t expectedAfterGap[] = { 0, 1, 2 };
+    assertWrites(&writes, expectedAfterGap, 3);
+    assertTrue(tutorialReassembler_GetFirstMissingChunk(reassembler) == 3, "Expected chunk 3 to be missing");
+    assertFalse(tutorialReassembler_IsComplete(reassembler), "Did not expect completion without chunk 3");
+
+    assertTrue(addChunk(reassembler, 3, 3) == TutorialReassemblerResult_Accepted, "Expected chunk 3 to be accepted");
+    uint64_t expected[] = { 0, 1, 2, 3 };
+    assertWrites(&writes, expected, 4);
+    assertTrue(tutorialReassembler_IsComplete(reassembler), "Expected the content to be complete");
+
+    tutorialReassembler_Release(&reassembler);
+}
+
+LONGBOW_TEST_CASE(Global, addBeyondWindow)
+{
+    TestWrites writes = { .count = 0 };
+    TutorialReassembler *reassembler = tutorialReassembler_Create(2, recordWrite, &writes);
+
+    // Chunk 5 is further ahead of the gap than the window, so it is written in place straight away.
+    assertTrue(addChunk(reassembler, 5, 9) == TutorialReassemblerResult_Accepted, "Expected chunk 5 to be accepted");
+    uint64_t expectedFarAhead[] = { 5 };
+    assertWrites(&writes, expectedFarAhead, 1);
+
+    // Chunk 1 is within the window, so it waits for chunk 0.
+    assertTrue(addChunk(reassembler, 1, 9) == TutorialReassemblerResult_Accepted, "Expected chunk 1 to be accepted");
+    assertTrue(writes.count == 1, "Expected chunk 1 to be held");
+
+    assertTrue(addChunk(reassembler, 0, 9) == TutorialReassemblerResult_Accepted, "Expected chunk 0 to be accepted");
+    uint64_t expected[] = { 5, 0, 1 };
+    assertWrites(&writes, expected, 3);
+    assertTrue(tutorialReassembler_GetFirstMissingChunk(reassembler) == 2, "Expected chunk 2 to be missing");
+    assertTrue(tutorialReassembler_GetReceivedCount(reassembler) == 3, "Expected 3 chunks received");
+    assertFalse(tutorialReassembler_IsComplete(reassembler), "Did not expect completion");
+
+    tutorialReassembler_Release(&reassembler);
+}
+
+LONGBOW_TEST_CASE(Global, addWithoutWindow)
+{
+    TestWrites writes = { .count = 0 };
+    TutorialReassembler *reassembler = tutorialReassembler_Create(0, recordWrite, &writes);
+
+    // With reordering disabled, every chunk is written as it arrives.
+    assertTrue(addChunk(reassembler, 1, 1) == TutorialReassemblerResult_Accepted, "Expected chunk 1 to be accepted");
+    assertTrue(addChunk(reassembler, 0, 1) == TutorialReassemblerResult_Accepted, "Expected chunk 0 to be accepted");
+
+    uint64_t expected[] = { 1, 0 };
+    assertWrites(&writes, expected, 2);
+    assertTrue(tutorialReassembler_IsComplete(reassembler), "Expected the content to be complete");
+
+    tutorialReassembler_Release(&reassembler);
+}
+
+LONGBOW_TEST_CASE(Global, addDuplicate)
+{
+    TestWrites writes = { .count = 0 };
+    TutorialReassembler *reassembler = tutorialReassembler_Create(4, recordWrite, &writes);
+
+    assertTrue(addChunk(reassembler, 0, 2) == TutorialReassemblerResult_Accepted, "Expected chunk 0 to be accepted");
+    assertTrue(addChunk(reassembler, 0, 2) == TutorialReassemblerResult_Duplicate, "Expected a written chunk to be a duplicate");
+
+    assertTrue(addChunk(reassembler, 2, 2) == TutorialReassemblerResult_Accepted, "Expected chunk 2 to be accepted");
+    assertTrue(addChunk(reassembler, 2, 2) == TutorialReassemblerResult_Duplicate, "Expected a held chunk to be a duplicate");
+
+    assertTrue(tutorialReassembler_GetReceivedCount(reassembler) == 2, "Expected duplicates not to be counted");
+    uint64_t expectedBeforeGap[] = { 0 };
+    assertWrites(&writes, expectedBeforeGap, 1);
+
+    // Each chunk is written exactly once.
+    assertTrue(addChunk(reassembler, 1, 2) == TutorialReassemblerResult_Accepted, "Expected chunk 1 to be accepted");
+    uint64_t expected[] = { 0, 1, 2 };
+    assertWrites(&writes, expected, 3);
+    assertTrue(tutorialReassembler_IsComplete(reassembler), "Expected the content to be complete");
+
+    tutorialReassembler_Release(&reassembler);
+}
+
+LONGBOW_TEST_CASE(Global, addOutOfRange)
+{
+    TestWrites writes = { .count = 0 };
+    TutorialReassembler *reassembler = tutorialReassembler_Create(4, recordWrite, &writes);
+
+    assertTrue(addChunk(reassembler, 4, 3) == TutorialReassemblerResult_OutOfRange, "Expected a chunk past the final chunk to be refused");
+    assertTrue(writes.count == 0, "Expected no chunks written");
+    assertFalse(tutorialReassembler_HasChunk(reassembler, 4), "Did not expect a refused chunk to be received");
+    assertTrue(tutorialReassembler_GetReceivedCount(reassembler) == 0, "Expected no chunks received");
+
+    // The final chunk number it carried is still taken as the latest one.
+    assertTrue(tutorialReassembler_GetFinalChunkNumber(reassembler) == 3, "Expected the final chunk number to be 3");
+
+    tutorialReassembler_Release(&reassembler);
+}
+
+LONGBOW_TEST_CASE(Global, skipChunk)
+{
+    TestWrites writes = { .count = 0 };
+    TutorialReassembler *reassembler = tutorialReassembler_Create(4, recordWrite, &writes);
+    tutorialReassembler_SetFinalChunkNumber(reassembler, 3);
+
+    // Chunks 0 and 2 are already on disk from an earlier transfer.
+    tutorialReassembler_SkipChunk(reassembler, 0);
+    tutorialReassembler_SkipChunk(reassembler, 2);
+    tutorialReassembler_SkipChunk(reassembler, 2);
+    assertTrue(writes.count == 0, "Expected skipped chunks never to be written");
+    assertTrue(tutorialReassembler_GetReceivedCount(reassembler) == 2, "Expected skipped chunks to count once each");
+    assertTrue(tutorialReassembler_GetFirstMissingChunk(reassembler) == 1, "Expected chunk 1 to be missing");
+
+    assertTrue(addChunk(reassembler, 2, 3) == TutorialReassemblerResult_Duplicate, "Expected a skipped chunk to be a duplicate");
+
+    // Chunk 1 fills the gap, but the skipped chunk 2 behind it isn't written.
+    assertTrue(addChunk(reassembler, 1, 3) == TutorialReassemblerResult_Accepted, "Expected chunk 1 to be accepted");
+    assertTrue(tutorialReassembler_GetFirstMissingChunk(reassembler) == 3, "Expected chunk 3 to be missing");
+
+    assertTrue(addChunk(reassembler, 3, 3) == TutorialReassemblerResult_Accepted, "Expected chunk 3 to be accepted");
+    uint64_t expected[] = { 1, 3 };
+    assertWrites(&writes, expected, 2);
+    assertTrue(tutorialReassembler_IsComplete(reassembler), "Expected the content to be complete");
+
+    tutorialReassembler_Release(&reassembler);
+}
+
+LONGBOW_TEST_CASE(Global, isComplete)
+{
+    TestWrites writes = { .count = 0 };
+    TutorialReassembler *reassembler = tutorialReassembler_Create(4, recordWrite, &writes);
+
+    assertFalse(tutorialReassembler_IsComplete(reassembler), "Did not expect completion before the final chunk is known");
+    assertTrue(tutorialReassembler_GetFinalChunkNumber(reassembler) == UINT64_MAX, "Expected the final chunk number to be unknown");
+
+    tutorialReassembler_SetFinalChunkNumber(reassembler, 1);
+    assertFalse(tutorialReassembler_IsComplete(reassembler), "Did not expect completion before any chunk arrived");
+
+    // Only chunk 1 has arrived, and it is held waiting for chunk 0, so the content isn't complete yet.
+    addChunk(reassembler, 1, 1);
+    assertFalse(tutorialReassembler_IsComplete(reassembler), "Did not expect completion with chunk 0 missing");
+
+    addChunk(reassembler, 0, 1);
+    assertTrue(tutorialReassembler_IsComplete(reassembler), "Expected the content to be complete");
+
+    // A larger final chunk number, e.g. from a file that grew, makes it incomplete again.
+    assertTrue(addChunk(reassembler, 2, 2) == TutorialReassemblerResult_Accepted, "Expected chunk 2 to be accepted");
+    assertTrue(tutorialReassembler_IsComplete(reassembler), "Expected the content to be complete with chunk 2");
+    tutorialReassembler_SetFinalChunkNumber(reassembler, 3);
+    assertFalse(tutorialReassembler_IsComplete(reassembler), "Did not expect completion with chunk 3 missing");
+
+    tutorialReassembler_Release(&reassembler);
+}
+
+LONGBOW_TEST_CASE(Global, releaseHoldingChunks)
+{
+    TestWrites writes = { .count = 0 };
+    TutorialReassembler *reassembler = tutorialReassembler_Create(4, recordWrite, &writes);
+
+    addChunk(reassembler, 1, 3);
+    addChunk(reassembler, 3, 3);
+
+    // The held chunks are released without being written. The fixture's teardown checks that none leak.
+    tutorialReassembler_Release(&reassembler);
+    assertTrue(writes.count == 0, "Expected held chunks not to be written on release");
+}
+
+int
+main(int argc, char *argv[])
+{
+    LongBowRunner *testRunner = LONGBOW_TEST_RUNNER_CREATE(tutorial_Reassembler);
+    int exitStatus = longBowMain(argc, argv, testRunner, NULL);
+    longBowTestRunner_Destroy(&testRunner);
+    exit(exitStatus);
+}
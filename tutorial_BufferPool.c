@@ -0,0 +1,142 @@
+/*
+ * Copyright (c) 2014-2015, Xerox Corporation (Xerox)and Palo Alto Research Center (PARC)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Patent rights are not granted under this agreement. Patent rights are
+ *       available under FRAND terms.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL XEROX or PARC BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+/**
+ * @author Alan Walendowski, Palo Alto Research Center (Xerox PARC)
+ * @copyright 2014-2015, Xerox Corporation (Xerox)and Palo Alto Research Center (PARC).  All rights reserved.
+ */
+
+#include <LongBow/runtime.h>
+
+#include <parc/algol/parc_Memory.h>
+#include <parc/algol/parc_Object.h>
+
+#include "tutorial_BufferPool.h"
+
+/**
+ * The most buffers checked for one that is free before giving up and allocating a buffer outside the pool.
+ * Buffers are checked in turn, so the one checked first is the one handed out longest ago.
+ */
+static const size_t _maximumScanLength = 8;
+
+struct tutorial_buffer_pool {
+    PARCBuffer **buffers;   // The pool's buffers. Entries past `bufferCount` haven't been allocated yet.
+    size_t bufferCount;
+    size_t capacity;
+    size_t bufferSize;
+    size_t nextBuffer;      // The index of the next buffer to check.
+    TutorialBufferPoolStats stats;
+};
+
+/**
+ * A buffer is in use if anyone else holds a reference to it, or has made their own PARCBuffer
+ * (e.g. with parcBuffer_Slice()) that shares its underlying byte array.
+ */
+static bool
+_isBufferInUse(const PARCBuffer *buffer)
+{
+    return parcObject_GetReferenceCount(buffer) > 1
+           || parcObject_GetReferenceCount(parcBuffer_Array(buffer)) > 1;
+}
+
+/**
+ * Return a buffer of the pool that is no longer in use, allocating a new one if the pool isn't full yet.
+ *
+ * @return A buffer that the pool holds the only reference to, or NULL if none was found.
+ */
+static PARCBuffer *
+_findFreeBuffer(TutorialBufferPool *pool)
+{
+    if (pool->bufferCount < pool->capacity) {
+        PARCBuffer *buffer = parcBuffer_Allocate(pool->bufferSize);
+        pool->buffers[pool->bufferCount++] = buffer;
+        pool->stats.allocatedCount++;
+        return buffer;
+    }
+
+    for (size_t i = 0; i < _maximumScanLength && i < pool->bufferCount; i++) {
+        PARCBuffer *buffer = pool->buffers[pool->nextBuffer];
+        pool->nextBuffer = (pool->nextBuffer + 1) % pool->bufferCount;
+
+        if (_isBufferInUse(buffer) == false) {
+            pool->stats.reusedCount++;
+            return buffer;
+        }
+    }
+
+    return NULL;
+}
+
+TutorialBufferPool *
+tutorialBufferPool_Create(size_t capacity, size_t bufferSize)
+{
+    assertTrue(capacity > 0, "The capacity of a TutorialBufferPool must be greater than 0");
+
+    TutorialBufferPool *result = parcMemory_AllocateAndClear(sizeof(TutorialBufferPool));
+    assertNotNull(result, "parcMemory_AllocateAndClear(%zu) returned NULL", sizeof(TutorialBufferPool));
+
+    result->buffers = parcMemory_AllocateAndClear(capacity * sizeof(PARCBuffer *));
+    assertNotNull(result->buffers, "parcMemory_AllocateAndClear(%zu) returned NULL", capacity * sizeof(PARCBuffer *));
+
+    result->capacity = capacity;
+    result->bufferSize = bufferSize;
+
+    return result;
+}
+
+void
+tutorialBufferPool_Release(TutorialBufferPool **poolP)
+{
+    TutorialBufferPool *pool = *poolP;
+
+    for (size_t i = 0; i < pool->bufferCount; i++) {
+        parcBuffer_Release(&pool->buffers[i]);
+    }
+    parcMemory_Deallocate((void **) &pool->buffers);
+    parcMemory_Deallocate((void **) poolP);
+}
+
+PARCBuffer *
+tutorialBufferPool_GetBuffer(TutorialBufferPool *pool, size_t length)
+{
+    PARCBuffer *buffer = (length <= pool->bufferSize) ? _findFreeBuffer(pool) : NULL;
+
+    if (buffer == NULL) {
+        pool->stats.unpooledCount++;
+        return parcBuffer_Allocate(length);
+    }
+
+    parcBuffer_Clear(buffer);
+    parcBuffer_SetLimit(buffer, length);
+
+    return parcBuffer_Acquire(buffer);
+}
+
+void
+tutorialBufferPool_GetStats(const TutorialBufferPool *pool, TutorialBufferPoolStats *stats)
+{
+    *stats = pool->stats;
+}
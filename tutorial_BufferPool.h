@@ -0,0 +1,100 @@
+/*
+ * Copyright (c) 2014-2015, Xerox Corporation (Xerox)and Palo Alto Research Center (PARC)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Patent rights are not granted under this agreement. Patent rights are
+ *       available under FRAND terms.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL XEROX or PARC BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+/**
+ * @author Alan Walendowski, Palo Alto Research Center (Xerox PARC)
+ * @copyright 2014-2015, Xerox Corporation (Xerox)and Palo Alto Research Center (PARC).  All rights reserved.
+ */
+
+#ifndef tutorial_BufferPool_h
+#define tutorial_BufferPool_h
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <parc/algol/parc_Buffer.h>
+
+/**
+ * A TutorialBufferPool hands out PARCBuffers for the payloads of responses, and takes each one back once every
+ * reference to it, other than the pool's own, has been released: once the response has been sent and dropped
+ * by the Portal and by the content store. A payload buffer is then allocated once and reused for many
+ * responses, instead of being allocated for each response and freed after it is sent.
+ *
+ * Buffers are allocated by the pool the first time they are needed, up to its capacity. A request for a buffer
+ * larger than the pool's buffer size, or made while the buffers it checks are all still in use, gets a new
+ * buffer that isn't part of the pool.
+ *
+ * A TutorialBufferPool must only be used by one thread, so each worker thread has its own. The buffers it
+ * hands out may be released on any thread.
+ */
+typedef struct tutorial_buffer_pool TutorialBufferPool;
+
+/**
+ * Counts of the buffers a TutorialBufferPool has handed out.
+ */
+typedef struct {
+    uint64_t reusedCount;       // Buffers that were reused, each one an allocation avoided.
+    uint64_t allocatedCount;    // Buffers allocated to add to the pool.
+    uint64_t unpooledCount;     // Buffers allocated outside the pool, because it had none free or they were too small.
+} TutorialBufferPoolStats;
+
+/**
+ * Create a TutorialBufferPool. The returned instance must eventually be released by calling
+ * tutorialBufferPool_Release().
+ *
+ * @param [in] capacity The most buffers the pool holds. Must be greater than 0.
+ * @param [in] bufferSize The capacity of each buffer, in bytes.
+ *
+ * @return A new TutorialBufferPool instance.
+ */
+TutorialBufferPool *tutorialBufferPool_Create(size_t capacity, size_t bufferSize);
+
+/**
+ * Release the pool's references to its buffers, and the pool itself. Buffers still in use stay valid until
+ * their last reference is released.
+ *
+ * @param [in,out] poolP A pointer to the pointer to the TutorialBufferPool to release. It will be set to NULL.
+ */
+void tutorialBufferPool_Release(TutorialBufferPool **poolP);
+
+/**
+ * Return a buffer with its position at 0 and its limit at `length`. Its contents are undefined.
+ *
+ * @param [in] pool The TutorialBufferPool to take the buffer from.
+ * @param [in] length The number of bytes needed.
+ *
+ * @return A PARCBuffer that must eventually be released by calling parcBuffer_Release().
+ */
+PARCBuffer *tutorialBufferPool_GetBuffer(TutorialBufferPool *pool, size_t length);
+
+/**
+ * Get the counts of the buffers the pool has handed out since it was created.
+ *
+ * @param [in] pool The TutorialBufferPool to check.
+ * @param [out] stats Filled in with the counts.
+ */
+void tutorialBufferPool_GetStats(const TutorialBufferPool *pool, TutorialBufferPoolStats *stats);
+#endif // tutorial_BufferPool_h
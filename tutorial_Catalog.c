@@ -0,0 +1,424 @@
+/*
+ * Copyright (c) 2014-2015, Xerox Corporation (Xerox)and Palo Alto Research Center (PARC)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Patent rights are not granted under this agreement. Patent rights are
+ *       available under FRAND terms.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL XEROX or PARC BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+/**
+ * @author Alan Walendowski, Palo Alto Research Center (Xerox PARC)
+ * @copyright 2014-2015, Xerox Corporation (Xerox)and Palo Alto Research Center (PARC).  All rights reserved.
+ */
+#include <limits.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <LongBow/runtime.h>
+#include <parc/algol/parc_Memory.h>
+
+#include "tutorial_Catalog.h"
+#include "tutorial_Common.h"
+#include "tutorial_FileIO.h"
+
+/**
+ * The number of slots in a new catalog's hash table. Always a power of 2.
+ */
+static const size_t _initialCapacity = 64;
+
+/**
+ * The fewest chunks a file is split into, unless that would make them smaller than tutorialCommon_ChunkSize.
+ */
+static const uint64_t _minimumChunkCount = 16;
+
+typedef struct {
+    char *fileName;        // Null-terminated, although lookups compare it by length.
+    size_t fileNameLength;
+    TutorialMetadata metadata;
+    struct stat fileInfo;  // From the stat() the metadata was taken from.
+    bool isCompressionKnown; // Whether metadata.compression has been decided for this version of the file.
+} _TutorialCatalogEntry;
+
+typedef struct {
+    uint32_t nameHash;            // Compared before the name itself, to avoid most memcmp() calls.
+    _TutorialCatalogEntry *entry; // NULL if the slot has never been used, _removedEntry if its entry was removed.
+} _TutorialCatalogSlot;
+
+/**
+ * Marks a slot whose entry was removed. A lookup has to keep probing past it, but an insert can re-use it.
+ */
+static _TutorialCatalogEntry _removedEntry;
+
+struct tutorial_catalog {
+    pthread_mutex_t lock;
+    char *directoryPath;
+    uint32_t chunkSize;
+
+    _TutorialCatalogSlot *slots;
+    size_t capacity;       // The number of slots. Always a power of 2.
+    size_t entryCount;     // The number of slots holding an entry.
+    size_t usedSlotCount;  // The number of slots holding an entry or marked as removed.
+};
+
+/**
+ * Return a 32-bit FNV-1a hash of the specified bytes.
+ */
+static uint32_t
+_hashFileName(const char *fileName, size_t fileNameLength)
+{
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < fileNameLength; i++) {
+        hash ^= (uint8_t) fileName[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+/**
+ * Return the chunk size to serve the specified file with. Clients learn it from the file's metadata, rather
+ * than assuming tutorialCommon_ChunkSize, so it may differ from file to file.
+ *
+ * Large files are served with the catalog's chunk size, the largest the path to the clients allows, as that
+ * cuts the number of Interests, signatures and name parses in proportion. A smaller file gets chunks just large
+ * enough to split it into _minimumChunkCount of them, so a client can still keep a window of Interests in
+ * flight for it, but never chunks smaller than tutorialCommon_ChunkSize.
+ */
+static uint32_t
+_getChunkSizeOfFile(const TutorialCatalog *catalog, const struct stat *fileInfo)
+{
+    uint64_t fileSize = (uint64_t) fileInfo->st_size;
+    uint32_t smallest = (catalog->chunkSize < tutorialCommon_ChunkSize) ? catalog->chunkSize : tutorialCommon_ChunkSize;
+    uint64_t result = (fileSize + _minimumChunkCount - 1) / _minimumChunkCount;
+
+    if (result < smallest) {
+        result = smallest;
+    } else if (result > catalog->chunkSize) {
+        result = catalog->chunkSize;
+    }
+
+    return (uint32_t) result;
+}
+
+/**
+ * Return the number of the final chunk of a file of the specified size. It is 0-based, so a file of size 0
+ * (which is sent as a single empty chunk) has a final chunk number of 0.
+ */
+static uint64_t
+_getFinalChunkNumberOfFile(uint64_t fileSize, uint32_t chunkSize)
+{
+    return (fileSize == 0) ? 0 : (fileSize - 1) / chunkSize;
+}
+
+/**
+ * Get the metadata of the named file with stat().
+ *
+ * @return true if the file is a readable regular file, and `fileInfo` was filled in.
+ */
+static bool
+_statFile(const TutorialCatalog *catalog, const char *fileName, size_t fileNameLength, struct stat *fileInfo)
+{
+    char filePath[PATH_MAX];
+
+    if (fileNameLength > INT_MAX) {
+        return false;
+    }
+    int length = snprintf(filePath, sizeof(filePath), "%s/%.*s", catalog->directoryPath, (int) fileNameLength, fileName);
+
+    return length > 0 && (size_t) length < sizeof(filePath)
+           && stat(filePath, fileInfo) == 0 && S_ISREG(fileInfo->st_mode) && access(filePath, R_OK) == 0;
+}
+
+/**
+ * Fill in the entry's metadata from the file's stat() metadata. The chunk size is chosen again each time the file
+ * changes, so a file that was cataloged while it was still being copied in gets the chunk size of its final size.
+ * Clients already fetching it keep their chunks, as they name the chunk size they are fetching with.
+ */
+static void
+_setEntryInfo(const TutorialCatalog *catalog, _TutorialCatalogEntry *entry, const struct stat *fileInfo)
+{
+    entry->fileInfo = *fileInfo;
+    entry->metadata.fileSize = fileInfo->st_size;
+    entry->metadata.chunkSize = _getChunkSizeOfFile(catalog, fileInfo);
+    entry->metadata.finalChunkNumber = _getFinalChunkNumberOfFile(entry->metadata.fileSize, entry->metadata.chunkSize);
+    entry->metadata.modificationTime = fileInfo->st_mtime;
+    entry->metadata.compression = TutorialCompressionCodec_None;
+    entry->isCompressionKnown = false;
+}
+
+/**
+ * Find the slot holding the entry for the named file, using linear probing.
+ *
+ * @return A pointer to the slot, or NULL if the file isn't in the catalog.
+ */
+static _TutorialCatalogSlot *
+_findSlot(const TutorialCatalog *catalog, const char *fileName, size_t fileNameLength, uint32_t nameHash)
+{
+    size_t mask = catalog->capacity - 1;
+
+    for (size_t i = nameHash & mask; catalog->slots[i].entry != NULL; i = (i + 1) & mask) {
+        _TutorialCatalogSlot *slot = &catalog->slots[i];
+        if (slot->nameHash == nameHash && slot->entry != &_removedEntry
+            && slot->entry->fileNameLength == fileNameLength
+            && memcmp(slot->entry->fileName, fileName, fileNameLength) == 0) {
+            return slot;
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * Move every entry into a new table of the specified capacity. This also discards the removed markers.
+ */
+static void
+_resize(TutorialCatalog *catalog, size_t newCapacity)
+{
+    _TutorialCatalogSlot *oldSlots = catalog->slots;
+    size_t oldCapacity = catalog->capacity;
+
+    catalog->slots = parcMemory_AllocateAndClear(newCapacity * sizeof(_TutorialCatalogSlot));
+    assertNotNull(catalog->slots, "parcMemory_AllocateAndClear(%zu) returned NULL", newCapacity * sizeof(_TutorialCatalogSlot));
+    catalog->capacity = newCapacity;
+    catalog->usedSlotCount = catalog->entryCount;
+
+    size_t mask = newCapacity - 1;
+    for (size_t i = 0; i < oldCapacity; i++) {
+        if (oldSlots[i].entry != NULL && oldSlots[i].entry != &_removedEntry) {
+            size_t j = oldSlots[i].nameHash & mask;
+            while (catalog->slots[j].entry != NULL) {
+                j = (j + 1) & mask;
+            }
+            catalog->slots[j] = oldSlots[i];
+        }
+    }
+
+    parcMemory_Deallocate((void **) &oldSlots);
+}
+
+/**
+ * Add a new entry for the named file, which must not already be in the catalog. The table is kept at most
+ * half full, counting removed markers, so probe sequences stay short.
+ */
+static _TutorialCatalogEntry *
+_addEntry(TutorialCatalog *catalog, const char *fileName, size_t fileNameLength, uint32_t nameHash)
+{
+    if ((catalog->usedSlotCount + 1) * 2 > catalog->capacity) {
+        // Grow if the table is full of entries. If it's mostly removed markers, rebuilding it at the same size is enough.
+        size_t newCapacity = ((catalog->entryCount + 1) * 2 > catalog->capacity / 2) ? catalog->capacity * 2 : catalog->capacity;
+        _resize(catalog, newCapacity);
+    }
+
+    _TutorialCatalogEntry *entry = parcMemory_AllocateAndClear(sizeof(_TutorialCatalogEntry));
+    assertNotNull(entry, "parcMemory_AllocateAndClear(%zu) returned NULL", sizeof(_TutorialCatalogEntry));
+
+    // The name may be borrowed from an Interest and not be null-terminated, so copy exactly fileNameLength bytes.
+    entry->fileName = parcMemory_Allocate(fileNameLength + 1);
+    assertNotNull(entry->fileName, "parcMemory_Allocate(%zu) returned NULL", fileNameLength + 1);
+    memcpy(entry->fileName, fileName, fileNameLength);
+    entry->fileName[fileNameLength] = '\0';
+    entry->fileNameLength = fileNameLength;
+
+    size_t mask = catalog->capacity - 1;
+    size_t i = nameHash & mask;
+    while (catalog->slots[i].entry != NULL && catalog->slots[i].entry != &_removedEntry) {
+        i = (i + 1) & mask;
+    }
+    if (catalog->slots[i].entry == NULL) {
+        catalog->usedSlotCount++;
+    }
+    catalog->slots[i].nameHash = nameHash;
+    catalog->slots[i].entry = entry;
+    catalog->entryCount++;
+
+    return entry;
+}
+
+static void
+_destroyEntry(_TutorialCatalogEntry **entryP)
+{
+    parcMemory_Deallocate((void **) &(*entryP)->fileName);
+    parcMemory_Deallocate((void **) entryP);
+}
+
+static void
+_removeSlot(TutorialCatalog *catalog, _TutorialCatalogSlot *slot)
+{
+    _destroyEntry(&slot->entry);
+    slot->entry = &_removedEntry;
+    catalog->entryCount--;
+}
+
+static void
+_removeAllEntries(TutorialCatalog *catalog)
+{
+    for (size_t i = 0; i < catalog->capacity; i++) {
+        if (catalog->slots[i].entry != NULL && catalog->slots[i].entry != &_removedEntry) {
+            _destroyEntry(&catalog->slots[i].entry);
+        }
+    }
+    memset(catalog->slots, 0, catalog->capacity * sizeof(_TutorialCatalogSlot));
+    catalog->entryCount = 0;
+    catalog->usedSlotCount = 0;
+}
+
+TutorialCatalog *
+tutorialCatalog_Create(const char *directoryPath, uint32_t chunkSize)
+{
+    assertTrue(chunkSize > 0, "The chunk size of a TutorialCatalog must be greater than 0");
+
+    TutorialCatalog *result = parcMemory_AllocateAndClear(sizeof(TutorialCatalog));
+    assertNotNull(result, "parcMemory_AllocateAndClear(%zu) returned NULL", sizeof(TutorialCatalog));
+
+    result->directoryPath = parcMemory_StringDuplicate(directoryPath, strlen(directoryPath));
+    result->chunkSize = chunkSize;
+
+    result->slots = parcMemory_AllocateAndClear(_initialCapacity * sizeof(_TutorialCatalogSlot));
+    assertNotNull(result->slots, "parcMemory_AllocateAndClear(%zu) returned NULL", _initialCapacity * sizeof(_TutorialCatalogSlot));
+    result->capacity = _initialCapacity;
+
+    pthread_mutex_init(&result->lock, NULL);
+
+    return result;
+}
+
+void
+tutorialCatalog_Release(TutorialCatalog **catalogP)
+{
+    TutorialCatalog *catalog = *catalogP;
+
+    _removeAllEntries(catalog);
+
+    pthread_mutex_destroy(&catalog->lock);
+    parcMemory_Deallocate((void **) &catalog->slots);
+    parcMemory_Deallocate((void **) &catalog->directoryPath);
+    parcMemory_Deallocate((void **) catalogP);
+}
+
+bool
+tutorialCatalog_Lookup(TutorialCatalog *catalog, const char *fileName, size_t fileNameLength,
+                       TutorialMetadata *metadata, struct stat *fileInfo)
+{
+    uint32_t nameHash = _hashFileName(fileName, fileNameLength);
+    _TutorialCatalogEntry *entry = NULL;
+
+    pthread_mutex_lock(&catalog->lock);
+
+    _TutorialCatalogSlot *slot = _findSlot(catalog, fileName, fileNameLength, nameHash);
+    if (slot != NULL) {
+        entry = slot->entry;
+    } else {
+        // The first time a file is asked for. This stat() is made while holding the lock so that a change
+        // reported while we were making it can't be applied before we add the (then stale) entry.
+        struct stat currentInfo;
+        if (_statFile(catalog, fileName, fileNameLength, &currentInfo)) {
+            entry = _addEntry(catalog, fileName, fileNameLength, nameHash);
+            _setEntryInfo(catalog, entry, &currentInfo);
+        }
+    }
+
+    if (entry != NULL) {
+        *metadata = entry->metadata;
+        if (fileInfo != NULL) {
+            *fileInfo = entry->fileInfo;
+        }
+    }
+
+    pthread_mutex_unlock(&catalog->lock);
+
+    return (entry != NULL);
+}
+
+void
+tutorialCatalog_UpdateFile(TutorialCatalog *catalog, const char *fileName)
+{
+    size_t fileNameLength = strlen(fileName);
+    uint32_t nameHash = _hashFileName(fileName, fileNameLength);
+
+    pthread_mutex_lock(&catalog->lock);
+
+    _TutorialCatalogSlot *slot = _findSlot(catalog, fileName, fileNameLength, nameHash);
+    if (slot != NULL) {
+        struct stat currentInfo;
+        if (_statFile(catalog, fileName, fileNameLength, &currentInfo)) {
+            _setEntryInfo(catalog, slot->entry, &currentInfo);
+        } else {
+            _removeSlot(catalog, slot);
+        }
+    }
+
+    pthread_mutex_unlock(&catalog->lock);
+}
+
+void
+tutorialCatalog_RemoveFile(TutorialCatalog *catalog, const char *fileName)
+{
+    size_t fileNameLength = strlen(fileName);
+    uint32_t nameHash = _hashFileName(fileName, fileNameLength);
+
+    pthread_mutex_lock(&catalog->lock);
+
+    _TutorialCatalogSlot *slot = _findSlot(catalog, fileName, fileNameLength, nameHash);
+    if (slot != NULL) {
+        _removeSlot(catalog, slot);
+    }
+
+    pthread_mutex_unlock(&catalog->lock);
+}
+
+void
+tutorialCatalog_Clear(TutorialCatalog *catalog)
+{
+    pthread_mutex_lock(&catalog->lock);
+    _removeAllEntries(catalog);
+    pthread_mutex_unlock(&catalog->lock);
+}
+
+bool
+tutorialCatalog_IsCompressionKnown(TutorialCatalog *catalog, const char *fileName, size_t fileNameLength)
+{
+    uint32_t nameHash = _hashFileName(fileName, fileNameLength);
+
+    pthread_mutex_lock(&catalog->lock);
+    _TutorialCatalogSlot *slot = _findSlot(catalog, fileName, fileNameLength, nameHash);
+    bool result = (slot != NULL && slot->entry->isCompressionKnown);
+    pthread_mutex_unlock(&catalog->lock);
+
+    return result;
+}
+
+void
+tutorialCatalog_SetCompression(TutorialCatalog *catalog, const char *fileName, size_t fileNameLength,
+                               const struct stat *fileInfo, TutorialCompressionCodec codec)
+{
+    uint32_t nameHash = _hashFileName(fileName, fileNameLength);
+
+    pthread_mutex_lock(&catalog->lock);
+
+    _TutorialCatalogSlot *slot = _findSlot(catalog, fileName, fileNameLength, nameHash);
+    if (slot != NULL && tutorialFileIO_IsSameFileVersion(&slot->entry->fileInfo, fileInfo)) {
+        slot->entry->metadata.compression = codec;
+        slot->entry->isCompressionKnown = true;
+    }
+
+    pthread_mutex_unlock(&catalog->lock);
+}
@@ -0,0 +1,140 @@
+/*
+ * Copyright (c) 2014-2015, Xerox Corporation (Xerox)and Palo Alto Research Center (PARC)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Patent rights are not granted under this agreement. Patent rights are
+ *       available under FRAND terms.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL XEROX or PARC BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+/**
+ * @author Alan Walendowski, Palo Alto Research Center (Xerox PARC)
+ * @copyright 2014-2015, Xerox Corporation (Xerox)and Palo Alto Research Center (PARC).  All rights reserved.
+ */
+
+#ifndef tutorial_Catalog_h
+#define tutorial_Catalog_h
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <sys/stat.h>
+
+#include "tutorial_Metadata.h"
+
+/**
+ * A TutorialCatalog records what the server knows about each file it serves: its size, the chunk size it
+ * is served with, its final chunk number and its modification time. A file is added to the catalog with a
+ * single stat() the first time it is asked for, and after that answering a request for it is a hash table
+ * lookup with no system calls. Entries are refreshed or removed by telling the catalog about files that
+ * have changed, as reported by a TutorialDirectoryWatcher.
+ *
+ * The catalog is an open-addressing hash table keyed by file name. The table itself only holds each
+ * name's hash and a pointer to its entry, so probing touches as little memory as possible. File names
+ * are given with an explicit length, so a name borrowed from an Interest (see TutorialNameView) can be
+ * looked up without copying it.
+ *
+ * A TutorialCatalog may be used by several threads at once.
+ */
+typedef struct tutorial_catalog TutorialCatalog;
+
+/**
+ * Create an empty catalog of the files in the specified directory. The returned instance must eventually
+ * be released by calling tutorialCatalog_Release().
+ *
+ * @param [in] directoryPath A pointer to a string containing the path of the directory being served.
+ * @param [in] chunkSize The chunk size large files are served with. Smaller files get smaller chunks, down to
+ *                       tutorialCommon_ChunkSize. Must be greater than 0.
+ *
+ * @return A new TutorialCatalog instance.
+ */
+TutorialCatalog *tutorialCatalog_Create(const char *directoryPath, uint32_t chunkSize);
+
+/**
+ * Release the memory used by the specified TutorialCatalog.
+ *
+ * @param [in,out] catalogP A pointer to the pointer to the TutorialCatalog to release. It will be set to NULL.
+ */
+void tutorialCatalog_Release(TutorialCatalog **catalogP);
+
+/**
+ * Look up the named file, adding it to the catalog if it hasn't been seen before.
+ *
+ * @param [in] catalog The TutorialCatalog to search.
+ * @param [in] fileName The name of the file, relative to the directory. It does not need to be null-terminated.
+ * @param [in] fileNameLength The length of `fileName`, in bytes.
+ * @param [out] metadata Filled in with the file's metadata.
+ * @param [out] fileInfo If not NULL, filled in with the file's metadata as returned by stat() when it was cataloged.
+ *
+ * @return true If the file is a readable regular file, and `metadata` was filled in.
+ * @return false If it isn't.
+ */
+bool tutorialCatalog_Lookup(TutorialCatalog *catalog, const char *fileName, size_t fileNameLength,
+                            TutorialMetadata *metadata, struct stat *fileInfo);
+
+/**
+ * Refresh the catalog's entry for a file that has been created or modified. A file that isn't in the
+ * catalog is left to be added when it is first asked for. If the file is no longer a readable regular
+ * file, it is removed from the catalog.
+ *
+ * @param [in] catalog The TutorialCatalog to update.
+ * @param [in] fileName The name of the file, relative to the directory.
+ */
+void tutorialCatalog_UpdateFile(TutorialCatalog *catalog, const char *fileName);
+
+/**
+ * Remove a file from the catalog.
+ *
+ * @param [in] catalog The TutorialCatalog to update.
+ * @param [in] fileName The name of the file, relative to the directory.
+ */
+void tutorialCatalog_RemoveFile(TutorialCatalog *catalog, const char *fileName);
+
+/**
+ * Remove every file from the catalog, so each is looked at again the next time it is asked for.
+ *
+ * @param [in] catalog The TutorialCatalog to clear.
+ */
+void tutorialCatalog_Clear(TutorialCatalog *catalog);
+
+/**
+ * Determine whether the codec to offer for the named file has been decided since the file was last cataloged.
+ * Until it has, the file's metadata offers no compression.
+ *
+ * @param [in] catalog The TutorialCatalog to search.
+ * @param [in] fileName The name of the file, relative to the directory. It does not need to be null-terminated.
+ * @param [in] fileNameLength The length of `fileName`, in bytes.
+ *
+ * @return true If tutorialCatalog_SetCompression() has been called for the file's current version.
+ */
+bool tutorialCatalog_IsCompressionKnown(TutorialCatalog *catalog, const char *fileName, size_t fileNameLength);
+
+/**
+ * Record the codec to offer for the named file, as decided by probing it, in the file's metadata. It is only
+ * recorded if the file hasn't changed since `fileInfo` was looked up. When the file changes, it is decided again.
+ *
+ * @param [in] catalog The TutorialCatalog to update.
+ * @param [in] fileName The name of the file, relative to the directory. It does not need to be null-terminated.
+ * @param [in] fileNameLength The length of `fileName`, in bytes.
+ * @param [in] fileInfo The stat() metadata the file was probed with, from tutorialCatalog_Lookup().
+ * @param [in] codec The codec to offer, or TutorialCompressionCodec_None.
+ */
+void tutorialCatalog_SetCompression(TutorialCatalog *catalog, const char *fileName, size_t fileNameLength,
+                                    const struct stat *fileInfo, TutorialCompressionCodec codec);
+#endif // tutorial_Catalog_h
@@ -28,11 +28,24 @@
  * @author Glenn Scott, Alan Walendowski, Palo Alto Research Center (Xerox PARC)
  * @copyright 2014-2015, Xerox Corporation (Xerox)and Palo Alto Research Center (PARC).  All rights reserved.
  */
+#include <fnmatch.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 #include <strings.h>
+#include <time.h>
 
 #include "tutorial_Common.h"
 #include "tutorial_FileIO.h"
+#include "tutorial_Reassembler.h"
+#include "tutorial_Fetcher.h"
+#include "tutorial_CongestionControl.h"
+#include "tutorial_Metadata.h"
+#include "tutorial_Compression.h"
+#include "tutorial_ListingChunk.h"
+#include "tutorial_ListingQuery.h"
+#include "tutorial_Manifest.h"
+#include "tutorial_Journal.h"
 #include "tutorial_About.h"
 
 #include <LongBow/runtime.h>
@@ -67,73 +80,339 @@ _setupConsumerPortalFactory(void)
 }
 
 /**
- * Given a sequential chunk of a 'list' response, append it to the in-memory buffer
- * that holds the listing. When the directory listing is complete, return it as a
- * string. The string must be freed by the caller.
+ * The settings given to tutorial_Client on the command line.
+ */
+typedef struct {
+    size_t windowSize;                                   // The maximum number of chunk Interests outstanding. 0 leaves it to the chunked Portal.
+    const TutorialCongestionControl *congestionControl;  // Decides how many of those Interests to send at once.
+    bool useManifest;                                    // Fetch the file's manifest first, and check each chunk against it.
+    TutorialListingQuery listingQuery;                   // The conditions of a 'list' command. Its limit is the page size.
+} _TutorialClientOptions;
+
+/**
+ * The state of a single 'list', 'meta', 'manifest' or 'fetch' transfer. Chunks may arrive in any order, and more
+ * than once, so they're put back together by a TutorialReassembler, which writes each one at its offset in either
+ * the file being fetched or, for 'meta' and 'manifest', in memory. Each chunk of a 'list' response holds whole
+ * entries, so it is checked as it arrives and kept as it is.
+ */
+typedef struct {
+    const char *command;               // tutorialCommon_CommandList, _CommandMeta, _CommandManifest or _CommandFetch.
+    const char *fileName;              // The name of the file being fetched, or whose metadata is being fetched.
+    uint32_t chunkSize;                // The chunk size the content is served with.
+    const CCNxName *domainPrefix;      // The domain prefix of the content, e.g. 'lci:/ccnx/tutorial'.
+    TutorialReassembler *reassembler;
+
+    struct timespec startTime;         // When the transfer started, for reporting throughput.
+    double lastProgressReport;         // Seconds since startTime that progress was last printed.
+    uint64_t bytesReceived;
+    bool isQuiet;                      // Don't print the listing, or the progress of a fetched file.
+
+    TutorialFileSink *fileSink;        // Where the chunks of a fetched file are written.
+    TutorialJournal *journal;          // Records which chunks of the fetched file are on disk, so the fetch can be resumed.
+    const TutorialManifest *manifest;  // If not NULL, each chunk of the fetched file is checked against it.
+    uint64_t rejectedChunkCount;       // Chunks that didn't match their digest in the manifest, or couldn't be decompressed.
+    bool isCompressed;                 // The file's chunks are fetched with 'cfetch', compressed with the codec in its metadata.
+    uint64_t compressedBytesReceived;  // The size of the compressed chunks, as they were sent.
+
+    uint8_t *contents;                 // Where the chunks of a 'meta' or 'manifest' response are assembled.
+    size_t contentsLength;
+    size_t contentsCapacity;
+
+    PARCBuffer **listingChunks;        // The chunks of a 'list' response, by chunk number. Missing ones are NULL.
+    size_t listingChunkCapacity;
+} _TutorialClientTransfer;
+
+/**
+ * Write a chunk of a 'meta' or 'manifest' response at its offset in the in-memory contents of the transfer.
+ * This is a TutorialReassemblerWriter.
  *
- * @param [in] payload A PARCBuffer containing the chunk of the directory listing to be appended.
+ * @param [in] transferArg A pointer to the _TutorialClientTransfer.
+ * @param [in] payload A PARCBuffer containing the chunk of the response.
  * @param [in] chunkNumber The number of the chunk that this payload belongs to.
- * @param [in] finalChunkNumber The number of the final chunk in this list response.
- *
- * @return A string containing the complete directory listing, or NULL if the complete directory
- *         listing hasn't yet been received.
  */
-static char *
-_assembleDirectoryListing(PARCBuffer *payload, uint64_t chunkNumber, uint64_t finalChunkNumber)
+static void
+_writeContentsChunk(void *transferArg, const PARCBuffer *payload, uint64_t chunkNumber)
 {
-    char *result = NULL;
-    static PARCBufferComposer *directoryList = NULL;
+    _TutorialClientTransfer *transfer = transferArg;
 
-    if (directoryList == NULL) {
-        directoryList = parcBufferComposer_Create();
+    size_t offset = (size_t) (chunkNumber * transfer->chunkSize);
+    size_t length = parcBuffer_Remaining(payload);
+
+    if (offset + length > transfer->contentsCapacity) {
+        size_t newCapacity = (transfer->contentsCapacity > 0) ? transfer->contentsCapacity : transfer->chunkSize;
+        while (newCapacity < offset + length) {
+            newCapacity *= 2;
+        }
+        transfer->contents = parcMemory_Reallocate(transfer->contents, newCapacity);
+        assertNotNull(transfer->contents, "parcMemory_Reallocate(%zu) returned NULL", newCapacity);
+        transfer->contentsCapacity = newCapacity;
     }
 
-    parcBufferComposer_PutBuffer(directoryList, payload);
+    memcpy(transfer->contents + offset, parcBuffer_Overlay((PARCBuffer *) payload, 0), length);
 
-    if (chunkNumber == finalChunkNumber) {
-        PARCBuffer *buffer = parcBufferComposer_ProduceBuffer(directoryList);
+    if (offset + length > transfer->contentsLength) {
+        transfer->contentsLength = offset + length;
+    }
+}
 
-        // Since this was the last chunk, return the completed directory listing.
-        result = parcBuffer_ToString(buffer);
-        parcBuffer_Release(&buffer);
-        parcBufferComposer_Release(&directoryList);
+/**
+ * Keep a chunk of a 'list' response, which has already been checked, under its chunk number.
+ * This is a TutorialReassemblerWriter.
+ *
+ * @param [in] transferArg A pointer to the _TutorialClientTransfer.
+ * @param [in] payload A PARCBuffer containing the chunk of the listing.
+ * @param [in] chunkNumber The number of the chunk.
+ */
+static void
+_writeListingChunk(void *transferArg, const PARCBuffer *payload, uint64_t chunkNumber)
+{
+    _TutorialClientTransfer *transfer = transferArg;
+
+    if (chunkNumber >= transfer->listingChunkCapacity) {
+        size_t newCapacity = (transfer->listingChunkCapacity > 0) ? transfer->listingChunkCapacity : 16;
+        while (newCapacity <= chunkNumber) {
+            newCapacity *= 2;
+        }
+        transfer->listingChunks = parcMemory_Reallocate(transfer->listingChunks, newCapacity * sizeof(PARCBuffer *));
+        assertNotNull(transfer->listingChunks, "parcMemory_Reallocate(%zu) returned NULL", newCapacity * sizeof(PARCBuffer *));
+        memset(transfer->listingChunks + transfer->listingChunkCapacity, 0,
+               (newCapacity - transfer->listingChunkCapacity) * sizeof(PARCBuffer *));
+        transfer->listingChunkCapacity = newCapacity;
     }
 
-    return result;
+    transfer->listingChunks[chunkNumber] = parcBuffer_Acquire((PARCBuffer *) payload);
 }
 
 /**
- * Given a sequential chunk of a 'fetch' response, append it to the file that we are assembling.
- * Return true if the final chunk has been written, false otherwise.
+ * Write a chunk of a 'fetch' response at its offset in the file that we are assembling.
+ * This is a TutorialReassemblerWriter.
  *
- * @param [in] fileName The full name of the file to write the payload in to.
- * @param [in] payload A PARCBuffer containing the chunk of the file to write.
+ * @param [in] transferArg A pointer to the _TutorialClientTransfer.
+ * @param [in] payload A PARCBuffer containing the chunk of the file.
  * @param [in] chunkNumber The number of the chunk to be written.
- * @param [in] finalChunkNumber The number of the final chunk in the file.
+ */
+static void
+_writeFileChunk(void *transferArg, const PARCBuffer *payload, uint64_t chunkNumber)
+{
+    _TutorialClientTransfer *transfer = transferArg;
+
+    tutorialFileIO_WriteFileChunk(transfer->fileSink, payload, chunkNumber);
+
+    if (transfer->journal != NULL) {
+        tutorialJournal_RecordChunk(transfer->journal, chunkNumber);
+
+        // The journal may only claim chunks that are on disk, so the file is flushed before it.
+        if (tutorialJournal_IsFlushDue(transfer->journal) && tutorialFileIO_FlushFileSink(transfer->fileSink)) {
+            tutorialJournal_Flush(transfer->journal);
+        }
+    }
+}
+
+/**
+ * Return the number of seconds that have passed since the specified time, as measured by CLOCK_MONOTONIC.
+ */
+static double
+_secondsSince(const struct timespec *startTime)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (double) (now.tv_sec - startTime->tv_sec) + (double) (now.tv_nsec - startTime->tv_nsec) / 1e9;
+}
+
+/**
+ * Return the command that the command given by the user (or an abbreviation of it) stands for.
+ */
+static const char *
+_findCommand(const char *command)
+{
+    const char *commands[] = { tutorialCommon_CommandFetch, tutorialCommon_CommandMeta, tutorialCommon_CommandManifest };
+
+    for (size_t i = 0; i < sizeof(commands) / sizeof(commands[0]); i++) {
+        if (strncasecmp(command, commands[i], strlen(command)) == 0) {
+            return commands[i];
+        }
+    }
+    return tutorialCommon_CommandList;
+}
+
+/**
+ * Open the file about to be fetched by a transfer, and its journal. If the journal shows that an earlier fetch of
+ * the same version of the file was interrupted, the chunks it wrote are kept and counted as received, so that
+ * only the missing chunks are asked for. Otherwise the file is created, or truncated.
  *
- * @return true if the entire file has been written, false otherwise.
+ * @param [in,out] transfer The _TutorialClientTransfer of the file.
+ * @param [in] metadata The file's metadata.
+ */
+static void
+_openFetchedFile(_TutorialClientTransfer *transfer, const TutorialMetadata *metadata)
+{
+    transfer->journal = tutorialJournal_Open(transfer->fileName, metadata);
+
+    // The metadata tells us every chunk of the file up front, so the missing ones can all be asked for at once.
+    tutorialReassembler_SetFinalChunkNumber(transfer->reassembler, metadata->finalChunkNumber);
+
+    if (tutorialJournal_WasSourceChanged(transfer->journal)) {
+        printf("File '%s' has changed since it was partly fetched. Fetching it from the start.\n", transfer->fileName);
+    }
+
+    uint64_t chunkCount = tutorialJournal_GetChunkCount(transfer->journal);
+    if (chunkCount == 0) {
+        transfer->fileSink = tutorialFileIO_CreateFileSink(transfer->fileName, transfer->chunkSize);
+    } else {
+        transfer->fileSink = tutorialFileIO_OpenFileSink(transfer->fileName, transfer->chunkSize);
+        for (uint64_t chunkNumber = 0; chunkNumber <= metadata->finalChunkNumber; chunkNumber++) {
+            if (tutorialJournal_HasChunk(transfer->journal, chunkNumber)) {
+                tutorialReassembler_SkipChunk(transfer->reassembler, chunkNumber);
+            }
+        }
+        printf("Resuming '%s': %llu of its %llu chunks were fetched before.\n", transfer->fileName,
+               (unsigned long long) chunkCount, (unsigned long long) metadata->finalChunkNumber + 1);
+    }
+}
+
+/**
+ * Prepare to receive the response to a 'list', 'meta', 'manifest' or 'fetch' command. A fetched file is opened
+ * here, and kept open until the transfer is finished. Given the file's metadata, a fetch resumes where an earlier,
+ * interrupted one left off; otherwise the file is created (or truncated).
+ *
+ * @param [out] transfer The _TutorialClientTransfer to initialize.
+ * @param [in] command The command being issued.
+ * @param [in] targetName The name of the file being fetched, or NULL.
+ * @param [in] chunkSize The chunk size the content is served with.
+ * @param [in] domainPrefix The domain prefix of the content being requested.
+ * @param [in] metadata The metadata of the file being fetched, or NULL.
+ */
+static void
+_initializeTransfer(_TutorialClientTransfer *transfer, const char *command, const char *targetName,
+                    uint32_t chunkSize, const CCNxName *domainPrefix, const TutorialMetadata *metadata)
+{
+    memset(transfer, 0, sizeof(*transfer));
+
+    transfer->fileName = targetName;
+    transfer->chunkSize = chunkSize;
+    transfer->domainPrefix = domainPrefix;
+    clock_gettime(CLOCK_MONOTONIC, &transfer->startTime);
+
+    transfer->command = _findCommand(command);
+
+    if (transfer->command == tutorialCommon_CommandFetch) {
+        transfer->reassembler = tutorialReassembler_Create(tutorialReassembler_DefaultReorderWindow, _writeFileChunk, transfer);
+
+        // A file from a subdirectory of the directory being served is written to the same subdirectory here.
+        if (tutorialFileIO_CreateParentDirectories(targetName) == false) {
+            printf("tutorial_Client: Could not create the directories leading to '%s'.\n", targetName);
+        }
+        if (metadata != NULL) {
+            // Only ask for compressed chunks if we can decompress them.
+            transfer->isCompressed = (metadata->compression != TutorialCompressionCodec_None
+                                      && tutorialCompression_IsCodecAvailable(metadata->compression));
+            _openFetchedFile(transfer, metadata);
+        } else {
+            transfer->fileSink = tutorialFileIO_CreateFileSink(targetName, chunkSize);
+        }
+    } else if (transfer->command == tutorialCommon_CommandList) {
+        // There's nothing to gain from holding listing chunks back to keep them in order.
+        transfer->reassembler = tutorialReassembler_Create(0, _writeListingChunk, transfer);
+    } else {
+        transfer->reassembler = tutorialReassembler_Create(tutorialReassembler_DefaultReorderWindow, _writeContentsChunk, transfer);
+    }
+}
+
+/**
+ * Return the command to name the Interests of a transfer with. A fetched file whose metadata offers a codec we
+ * have is fetched with 'cfetch'; otherwise it is the transfer's own command.
+ *
+ * @param [in] transfer The _TutorialClientTransfer the Interests are for.
+ *
+ * @return The command to put in the Interests' names.
+ */
+static const char *
+_getRequestCommand(const _TutorialClientTransfer *transfer)
+{
+    return transfer->isCompressed ? tutorialCommon_CommandFetchCompressed : transfer->command;
+}
+
+/**
+ * Release the resources held by a transfer, closing (and flushing) the fetched file, if any. The file's journal is
+ * deleted once the file is complete, and otherwise brought up to date and kept, so the fetch can be resumed.
+ *
+ * @param [in,out] transfer The _TutorialClientTransfer to finish.
+ *
+ * @return true If the transfer was complete and any fetched file was successfully written.
  */
 static bool
-_assembleFile(const char *fileName, const PARCBuffer *payload, uint64_t chunkNumber, uint64_t finalChunkNumber)
+_finishTransfer(_TutorialClientTransfer *transfer)
 {
-    if (chunkNumber == 0) {
-        // If we're the first chunk (chunk #0), then make sure we're starting with an empty file.
-        tutorialFileIO_DeleteFile(fileName);
+    bool result = tutorialReassembler_IsComplete(transfer->reassembler);
+
+    tutorialReassembler_Release(&transfer->reassembler);
+
+    if (transfer->fileSink != NULL) {
+        bool isWritten = tutorialFileIO_CloseFileSink(&transfer->fileSink);
+        result = isWritten && result;
+
+        if (transfer->journal != NULL && result) {
+            tutorialJournal_Delete(&transfer->journal);
+        } else if (transfer->journal != NULL) {
+            if (isWritten) {
+                tutorialJournal_Flush(transfer->journal); // The file has been flushed and closed, so this is safe.
+            }
+            tutorialJournal_Release(&transfer->journal);
+        }
+    }
+    if (transfer->contents != NULL) {
+        parcMemory_Deallocate((void **) &transfer->contents);
+    }
+    if (transfer->listingChunks != NULL) {
+        for (size_t i = 0; i < transfer->listingChunkCapacity; i++) {
+            if (transfer->listingChunks[i] != NULL) {
+                parcBuffer_Release(&transfer->listingChunks[i]);
+            }
+        }
+        parcMemory_Deallocate((void **) &transfer->listingChunks);
     }
 
-    // Note that the tutorialFileIO_AppendFileChunk() function should be replaced with something that keeps
-    // an open file pointer instead of repeatedly re-opening it. This method simply opens (possibly creating)
-    // the file and appends the specified payload). It is not an efficient implementation.
-    tutorialFileIO_AppendFileChunk(fileName, payload);
+    return result;
+}
+
+/**
+ * Print a directory listing that has been received in full, one line per file, in the form
+ * "  <file name>  (<size> bytes)". The chunks are in file name order, so the lines are too.
+ *
+ * @param [in] transfer The _TutorialClientTransfer of the 'list' command.
+ * @param [out] lastEntry If not NULL, and the listing isn't empty, filled in with its last entry, whose file name
+ *                        points into the transfer's chunks.
+ *
+ * @return The number of files in the listing.
+ */
+static size_t
+_printDirectoryListing(const _TutorialClientTransfer *transfer, TutorialListingEntry *lastEntry)
+{
+    size_t result = 0;
+
+    for (size_t i = 0; i < transfer->listingChunkCapacity && transfer->listingChunks[i] != NULL; i++) {
+        TutorialListingChunkCursor cursor;
+        TutorialListingEntry entry;
 
-    return (chunkNumber == finalChunkNumber); // true, if we just wrote the final chunk
+        tutorialListingChunk_Open(transfer->listingChunks[i], &cursor); // It was checked when it arrived.
+        while (tutorialListingChunk_NextEntry(&cursor, &entry)) {
+            printf("  %.*s  (%llu bytes)\n", (int) entry.fileNameLength, entry.fileName, (unsigned long long) entry.fileSize);
+            if (lastEntry != NULL) {
+                *lastEntry = entry;
+            }
+            result++;
+        }
+    }
+
+    return result;
 }
 
 /**
  * Receive a chunk of a directory listing and add it to the directory listing that we're
- * building. When it's complete, print it and return true. We assume the chunks arrive in the
- * correct order.
+ * building. When it's complete, print it and return true. A chunk that isn't a well formed
+ * chunk of a listing is discarded and counted in the transfer's rejectedChunkCount, so it is asked for again.
  *
+ * @param [in] transfer The _TutorialClientTransfer the chunk belongs to.
  * @param [in] payload A PARCBuffer containing the chunk of the directory listing to write.
  * @param [in] chunkNumber The number of the chunk to be written.
  * @param [in] finalChunkNumber The number of the final chunk in the directory listing.
@@ -141,105 +420,226 @@ _assembleFile(const char *fileName, const PARCBuffer *payload, uint64_t chunkNum
  * @return true if the entire listing has been received, false otherwise.
  */
 static bool
-_receiveDirectoryListingChunk(PARCBuffer *payload, uint64_t chunkNumber, uint64_t finalChunkNumber)
+_receiveDirectoryListingChunk(_TutorialClientTransfer *transfer, const PARCBuffer *payload,
+                              uint64_t chunkNumber, uint64_t finalChunkNumber)
 {
     bool result = false;
-    char *directoryList = _assembleDirectoryListing(payload, chunkNumber, finalChunkNumber);
 
-    // When the directory listing is complete, dirListing will be non-NULL.
-    if (directoryList != NULL) {
-        printf("Directory Listing follows:\n");
-        printf("%s", directoryList);
-        parcMemory_Deallocate((void **) &directoryList);
+    TutorialListingChunkCursor cursor;
+    if (tutorialListingChunk_Open(payload, &cursor) == false) {
+        fprintf(stderr, "tutorial_Client: chunk %llu of the directory listing is damaged. Discarding it.\n",
+                (unsigned long long) chunkNumber);
+        transfer->rejectedChunkCount++;
+        return false;
+    }
+
+    if (tutorialReassembler_AddChunk(transfer->reassembler, payload, chunkNumber, finalChunkNumber) == TutorialReassemblerResult_Accepted
+        && tutorialReassembler_IsComplete(transfer->reassembler)) {
+        if (transfer->isQuiet == false) {
+            printf("Directory Listing follows:\n");
+            _printDirectoryListing(transfer, NULL);
+        }
         result = true;
     }
     return result;
 }
 
 /*
- * Receive a chunk of a file and append it to the local file of the specified name. When the file is
- * complete, print a message stating so and return true. Otherwise, print a message showing the
- * file transfer progress and return false. We assume the file chunks arrive in the correct order.
+ * Receive a chunk of a file and write it to the local file of the specified name. When every chunk of
+ * the file has been received, print a message stating so and return true. Otherwise, print a message showing
+ * the file transfer progress and throughput, at most a few times a second, and return false. Chunks may
+ * arrive in any order; duplicates are ignored.
  *
- * @param [in] fileName The full path to the file to be received.
+ * @param [in] transfer The _TutorialClientTransfer the chunk belongs to.
  * @param [in] payload A PARCBuffer containing the chunk of the file to write.
  * @param [in] chunkNumber The number of the chunk to be written.
- * @param [in] finalChunkNumber The number of the final chunk in the directory listing.
+ * @param [in] finalChunkNumber The number of the final chunk in the file.
  *
  * @return true if the entire file has been written, false otherwise.
  */
 static bool
-_receiveFileChunk(const char *fileName, const PARCBuffer *payload, uint64_t chunkNumber, uint64_t finalChunkNumber)
+_receiveFileChunk(_TutorialClientTransfer *transfer, const PARCBuffer *payload, uint64_t chunkNumber, uint64_t finalChunkNumber)
 {
-    bool isComplete = _assembleFile(fileName, payload, chunkNumber, finalChunkNumber);
+    if (tutorialReassembler_AddChunk(transfer->reassembler, payload, chunkNumber, finalChunkNumber) != TutorialReassemblerResult_Accepted) {
+        return false;
+    }
+
+    transfer->bytesReceived += parcBuffer_Remaining(payload);
+
+    bool isComplete = tutorialReassembler_IsComplete(transfer->reassembler);
+    double elapsedSeconds = _secondsSince(&transfer->startTime);
+    double megabytesPerSecond = (elapsedSeconds > 0.0) ? (transfer->bytesReceived / elapsedSeconds) / (1024.0 * 1024.0) : 0.0;
 
     if (isComplete) {
-        printf("File '%s' has been fully transferred in %ld chunks.\n", fileName, (unsigned long) finalChunkNumber + 1L);
-    } else {
-        printf("File '%s' has been %04.2f%% transferred.\r", fileName,
-               ((float) chunkNumber / (float) finalChunkNumber) * 100.0f);
+        printf("File '%s' has been fully transferred in %ld chunks (%llu bytes in %.2f seconds, %.2f MB/s).\n",
+               transfer->fileName, (unsigned long) finalChunkNumber + 1L,
+               (unsigned long long) transfer->bytesReceived, elapsedSeconds, megabytesPerSecond);
+    } else if (transfer->isQuiet == false && elapsedSeconds - transfer->lastProgressReport >= 0.25) {
+        printf("File '%s' has been %04.2f%% transferred, at %.2f MB/s.\r", transfer->fileName,
+               ((float) tutorialReassembler_GetReceivedCount(transfer->reassembler) / (float) (finalChunkNumber + 1)) * 100.0f,
+               megabytesPerSecond);
         fflush(stdout);
+        transfer->lastProgressReport = elapsedSeconds;
     }
 
     return isComplete;
 }
 
+/**
+ * Check a chunk of a fetched file against its digest in the file's manifest, if the transfer has one.
+ * Chunks that don't match are counted and reported.
+ *
+ * @param [in] transfer The _TutorialClientTransfer the chunk belongs to.
+ * @param [in] payload A PARCBuffer containing the chunk of the file.
+ * @param [in] chunkNumber The number of the chunk.
+ *
+ * @return true If the chunk should be accepted.
+ */
+static bool
+_verifyFileChunk(_TutorialClientTransfer *transfer, const PARCBuffer *payload, uint64_t chunkNumber)
+{
+    if (transfer->manifest == NULL || tutorialManifest_VerifyChunk(transfer->manifest, chunkNumber, payload)) {
+        return true;
+    }
+
+    fprintf(stderr, "tutorial_Client: chunk %llu of '%s' does not match the file's manifest. Discarding it.\n",
+            (unsigned long long) chunkNumber, transfer->fileName);
+    transfer->rejectedChunkCount++;
+    return false;
+}
+
+/**
+ * Decompress a compressed chunk of the file being fetched. A chunk that can't be decompressed, or is larger than a
+ * chunk can be, is discarded and counted in the transfer's rejectedChunkCount, so it is asked for again. The new
+ * PARCBuffer must eventually be released by calling parcBuffer_Release().
+ *
+ * @param [in] transfer The _TutorialClientTransfer the chunk belongs to.
+ * @param [in] payload A PARCBuffer containing the compressed chunk.
+ * @param [in] chunkNumber The number of the chunk.
+ *
+ * @return A new PARCBuffer containing the chunk of the file, or NULL if it was discarded.
+ */
+static PARCBuffer *
+_decompressFileChunk(_TutorialClientTransfer *transfer, const PARCBuffer *payload, uint64_t chunkNumber)
+{
+    PARCBuffer *result = tutorialCompression_DecompressChunk(payload, transfer->chunkSize);
+
+    if (result == NULL) {
+        fprintf(stderr, "tutorial_Client: chunk %llu of '%s' could not be decompressed. Discarding it.\n",
+                (unsigned long long) chunkNumber, transfer->fileName);
+        transfer->rejectedChunkCount++;
+    }
+    return result;
+}
+
 /**
  * Receive a ContentObject message that comes back from the tutorial_Server in response to an Interest we sent.
- * This message will be a chunk of the requested content, and should be received in ordered sequence.
- * Depending on the CCNxName in the content object, we hand it off to either _receiveFileChunk() or
- * _receiveDirectoryListingChunk() to process.
+ * This message will be a chunk of the requested content, and may arrive in any order. Depending on the
+ * CCNxName in the content object, we hand it off to either _receiveFileChunk() or _receiveDirectoryListingChunk()
+ * to process, or, for 'meta' and 'manifest', simply collect it. ContentObjects that don't belong to the transfer
+ * are ignored. If the transfer has the file's manifest, a chunk of the file that doesn't match its digest is
+ * discarded and counted in the transfer's rejectedChunkCount.
  *
+ * @param [in] transfer The _TutorialClientTransfer we're receiving.
  * @param [in] contentObject A CCNxContentObject containing a response to an CCNxInterest we sent.
  * @param [in] domainPrefix A CCNxName containing the domain prefix of the content we requested.
  *
- * @return The number of chunks of the content left to transfer.
+ * @return true If every chunk of the content has now been received.
  */
-static uint64_t
-_receiveContentObject(CCNxContentObject *contentObject, const CCNxName *domainPrefix)
+static bool
+_receiveContentObject(_TutorialClientTransfer *transfer, CCNxContentObject *contentObject, const CCNxName *domainPrefix)
 {
+    bool result = false;
     CCNxName *contentName = ccnxContentObject_GetName(contentObject);
 
-    uint64_t chunkNumber = tutorialCommon_GetChunkNumberFromName(contentName);
+    // Get the type of the incoming message. Was it a response to a 'fetch', 'meta' or a 'list' command?
+    TutorialNameView nameView;
+    if (tutorialCommon_ParseName(contentName, domainPrefix, &nameView) == false || nameView.hasChunkNumber == false) {
+        return false; // Not a response to anything we asked for.
+    }
+
+    uint64_t chunkNumber = nameView.chunkNumber;
 
     // Get the number of the final chunk, as specified by the sender.
     uint64_t finalChunkNumberSpecifiedByServer = ccnxContentObject_GetFinalChunkNumber(contentObject);
 
-    // Get the type of the incoming message. Was it a response to a fetch' or a 'list' command?
-    char *command = tutorialCommon_CreateCommandStringFromName(contentName, domainPrefix);
-
     // Process the payload.
     PARCBuffer *payload = ccnxContentObject_GetPayload(contentObject);
 
-    if (strncasecmp(command, tutorialCommon_CommandList, strlen(command)) == 0) {
+    if (tutorialCommon_NameViewHasCommand(&nameView, tutorialCommon_CommandList)) {
         // This is a chunk of the directory listing.
-        _receiveDirectoryListingChunk(payload, chunkNumber, finalChunkNumberSpecifiedByServer);
-    } else if (strncasecmp(command, tutorialCommon_CommandFetch, strlen(command)) == 0) {
+        if (transfer->command == tutorialCommon_CommandList) {
+            result = _receiveDirectoryListingChunk(transfer, payload, chunkNumber, finalChunkNumberSpecifiedByServer);
+        }
+    } else if (tutorialCommon_NameViewHasCommand(&nameView, tutorialCommon_CommandFetch)) {
         // This is a chunk of a file.
-        char *fileName = tutorialCommon_CreateFileNameFromName(contentName);
-        _receiveFileChunk(fileName, payload, chunkNumber, finalChunkNumberSpecifiedByServer);
-        parcMemory_Deallocate((void **) &fileName);
+        if (transfer->command == tutorialCommon_CommandFetch && tutorialCommon_NameViewHasFileName(&nameView, transfer->fileName)
+            && _verifyFileChunk(transfer, payload, chunkNumber)) {
+            result = _receiveFileChunk(transfer, payload, chunkNumber, finalChunkNumberSpecifiedByServer);
+        }
+    } else if (tutorialCommon_NameViewHasCommand(&nameView, tutorialCommon_CommandFetchCompressed)) {
+        // This is a compressed chunk of a file. The manifest describes the chunk as it was before compression.
+        if (transfer->isCompressed && tutorialCommon_NameViewHasFileName(&nameView, transfer->fileName)) {
+            PARCBuffer *chunk = _decompressFileChunk(transfer, payload, chunkNumber);
+            if (chunk != NULL) {
+                if (_verifyFileChunk(transfer, chunk, chunkNumber)) {
+                    uint64_t bytesReceived = transfer->bytesReceived;
+                    result = _receiveFileChunk(transfer, chunk, chunkNumber, finalChunkNumberSpecifiedByServer);
+                    if (transfer->bytesReceived > bytesReceived) {
+                        transfer->compressedBytesReceived += parcBuffer_Remaining(payload); // Not a duplicate.
+                    }
+                }
+                parcBuffer_Release(&chunk);
+            }
+        }
+    } else if (tutorialCommon_NameViewHasCommand(&nameView, tutorialCommon_CommandMeta)
+               || tutorialCommon_NameViewHasCommand(&nameView, tutorialCommon_CommandManifest)) {
+        // This is a chunk of a file's metadata or manifest.
+        if (tutorialCommon_NameViewHasCommand(&nameView, transfer->command)
+            && tutorialCommon_NameViewHasFileName(&nameView, transfer->fileName)) {
+            tutorialReassembler_AddChunk(transfer->reassembler, payload, chunkNumber, finalChunkNumberSpecifiedByServer);
+            result = tutorialReassembler_IsComplete(transfer->reassembler);
+        }
     } else {
-        printf("tutorial_Client: Unknown command: %s\n", command);
+        printf("tutorial_Client: Unknown command: %.*s\n", (int) nameView.commandLength, nameView.command);
     }
 
-    parcMemory_Deallocate((void **) &command);
+    return result;
+}
+
+/**
+ * Hand a response received by a TutorialFetcher to _receiveContentObject(). This is a TutorialFetcherReceiver.
+ *
+ * @param [in] transferArg A pointer to the _TutorialClientTransfer.
+ * @param [in] contentObject A CCNxContentObject containing a response to one of the fetcher's Interests.
+ *
+ * @return false If the response was a chunk that didn't match the file's manifest, so it should be asked for again.
+ */
+static bool
+_receiveFetchedContentObject(void *transferArg, CCNxContentObject *contentObject)
+{
+    _TutorialClientTransfer *transfer = transferArg;
+    uint64_t rejectedChunkCount = transfer->rejectedChunkCount;
 
-    return (finalChunkNumberSpecifiedByServer - chunkNumber); // number of chunks left to transfer
+    _receiveContentObject(transfer, contentObject, transfer->domainPrefix);
+
+    return transfer->rejectedChunkCount == rejectedChunkCount;
 }
 
 /**
- * Create and return a CCNxInterest whose Name contains our commend (e.g. "fetch" or "list"),
- * and, optionally, the name of a target object (e.g. "file.txt"). The newly created CCNxInterest
- * must eventually be released by calling ccnxInterest_Release().
+ * Create and return a CCNxName that contains our command (e.g. "fetch" or "list"), and, optionally, the
+ * name of a target object (e.g. "file.txt", or "logs/app.log" for a file in a subdirectory, which takes a
+ * segment for each part of its path). A 'fetch' or 'cfetch' name also carries the chunk size the file is
+ * fetched with. The newly created CCNxName must eventually be released by calling ccnxName_Release().
  *
- * @param command The command to embed in the created CCNxInterest.
+ * @param command The command to embed in the created CCNxName.
  * @param targetName The name of the content, if any, that the command applies to.
+ * @param chunkSize The chunk size the content is served with.
  *
- * @return A newly created CCNxInterest for the specified command and targetName.
+ * @return A newly created CCNxName for the specified command and targetName.
  */
-static CCNxInterest *
-_createInterest(const char *command, const char *targetName)
+static CCNxName *
+_createContentName(const char *command, const char *targetName, uint32_t chunkSize)
 {
     CCNxName *interestName = ccnxName_CreateFromURI(tutorialCommon_DomainPrefix); // Start with the prefix. We append to this.
 
@@ -252,19 +652,35 @@ _createInterest(const char *command, const char *targetName)
     ccnxName_Append(interestName, commandSegment);
     ccnxNameSegment_Release(&commandSegment);
 
-    // If we have a target, then create another NameSegment for it and append that.
+    // If we have a target, then append a NameSegment for each part of its path.
     if (targetName != NULL) {
-        // Create a NameSegment for our target object
-        PARCBuffer *targetBuf = parcBuffer_WrapCString((char *) targetName);
-        CCNxNameSegment *targetSegment = ccnxNameSegment_CreateTypeValue(CCNxNameLabelType_NAME, targetBuf);
-        parcBuffer_Release(&targetBuf);
-
+        tutorialCommon_AppendFilePath(interestName, targetName);
+    }
 
-        // Append it to the ccnxName.
-        ccnxName_Append(interestName, targetSegment);
-        ccnxNameSegment_Release(&targetSegment);
+    // The server splits the file with the chunk size from the metadata we read, even if it has changed since.
+    if (strcasecmp(command, tutorialCommon_CommandFetch) == 0 || strcasecmp(command, tutorialCommon_CommandFetchCompressed) == 0) {
+        tutorialCommon_AppendChunkSize(interestName, chunkSize);
     }
 
+    return interestName;
+}
+
+/**
+ * Create and return a CCNxInterest whose Name contains our commend (e.g. "fetch" or "list"),
+ * and, optionally, the name of a target object (e.g. "file.txt"). The newly created CCNxInterest
+ * must eventually be released by calling ccnxInterest_Release().
+ *
+ * @param command The command to embed in the created CCNxInterest.
+ * @param targetName The name of the content, if any, that the command applies to.
+ * @param chunkSize The chunk size the content is served with.
+ *
+ * @return A newly created CCNxInterest for the specified command and targetName.
+ */
+static CCNxInterest *
+_createInterest(const char *command, const char *targetName, uint32_t chunkSize)
+{
+    CCNxName *interestName = _createContentName(command, targetName, chunkSize);
+
     CCNxInterest *result = ccnxInterest_CreateSimple(interestName);
     ccnxName_Release(&interestName);
 
@@ -277,11 +693,13 @@ _createInterest(const char *command, const char *targetName)
  * portal message types except those that are CCNxContentObjects.
  *
  * @param portal An instance of CCNxPortal to read from.
+ * @param transfer The _TutorialClientTransfer to receive the content into.
+ * @param domainPrefix A CCNxName containing the domain prefix of the content we requested.
  *
  * @return true If the requested content has been fully received, false otherwise.
  */
 static bool
-_receiveResponseToIssuedInterest(CCNxPortal *portal, const CCNxName *domainPrefix)
+_receiveResponseToIssuedInterest(CCNxPortal *portal, _TutorialClientTransfer *transfer, const CCNxName *domainPrefix)
 {
     bool isTransferComplete = false;
 
@@ -292,11 +710,10 @@ _receiveResponseToIssuedInterest(CCNxPortal *portal, const CCNxName *domainPrefi
             if (ccnxMetaMessage_IsContentObject(response)) {
                 CCNxContentObject *contentObject = ccnxMetaMessage_GetContentObject(response);
 
-                // Receive the content message. This returns the number of blocks remaining
-                // in the transfer. If it returns 0, it was the final block of the content
-                // and we're done.
+                // Receive the content message. This returns true once every chunk of the
+                // content, from 0 to the final chunk, has been received.
 
-                if (_receiveContentObject(contentObject, domainPrefix) == 0) {
+                if (_receiveContentObject(transfer, contentObject, domainPrefix)) {
                     isTransferComplete = true;
                 }
             }
@@ -307,42 +724,789 @@ _receiveResponseToIssuedInterest(CCNxPortal *portal, const CCNxName *domainPrefi
     return isTransferComplete;
 }
 
+/**
+ * Issue our own Interest for each chunk of the content with the specified name, keeping up to `options->windowSize`
+ * of them outstanding, and receive the responses into the specified transfer.
+ *
+ * @param portal A CCNxPortal created with ccnxPortalRTA_Message.
+ * @param transfer The _TutorialClientTransfer to receive the content into.
+ * @param contentName The name of the content, without a chunk segment.
+ * @param options The settings given on the command line.
+ * @param statistics If not NULL, filled in with the fetcher's counters at the end of the transfer.
+ *
+ * @return true If the requested content has been fully received, false otherwise.
+ */
+static bool
+_fetchNameWithPipelinedInterests(CCNxPortal *portal, _TutorialClientTransfer *transfer, const CCNxName *contentName,
+                                 const _TutorialClientOptions *options, TutorialFetcherStatistics *statistics)
+{
+    TutorialFetcher *fetcher = tutorialFetcher_Create(portal, contentName, options->windowSize, options->congestionControl,
+                                                      transfer->reassembler, _receiveFetchedContentObject, transfer);
+
+    bool result = tutorialFetcher_Run(fetcher);
+
+    if (statistics != NULL) {
+        tutorialFetcher_GetStatistics(fetcher, statistics);
+    }
+
+    tutorialFetcher_Release(&fetcher);
+
+    return result;
+}
+
+/**
+ * Issue our own Interest for each chunk of the content named by the given command and optional target, keeping
+ * up to `options->windowSize` of them outstanding, and receive the responses into the specified transfer.
+ *
+ * @param portal A CCNxPortal created with ccnxPortalRTA_Message.
+ * @param transfer The _TutorialClientTransfer to receive the content into.
+ * @param command The command to be handled.
+ * @param targetName The name of the target content, if any, that the command applies to.
+ * @param options The settings given on the command line.
+ * @param statistics If not NULL, filled in with the fetcher's counters at the end of the transfer.
+ *
+ * @return true If the requested content has been fully received, false otherwise.
+ */
+static bool
+_fetchWithPipelinedInterests(CCNxPortal *portal, _TutorialClientTransfer *transfer,
+                             const char *command, const char *targetName, const _TutorialClientOptions *options,
+                             TutorialFetcherStatistics *statistics)
+{
+    CCNxName *contentName = _createContentName(command, targetName, transfer->chunkSize);
+
+    bool result = _fetchNameWithPipelinedInterests(portal, transfer, contentName, options, statistics);
+
+    ccnxName_Release(&contentName);
+
+    return result;
+}
+
+/**
+ * Fetch the response to a 'meta' or 'manifest' command into memory. We always do this with our own Interests,
+ * on a Portal of its own.
+ *
+ * @param factory The CCNxPortalFactory to create the Portal with.
+ * @param command The command to issue.
+ * @param fileName The name of the file.
+ * @param chunkSize The chunk size the response is served with.
+ * @param windowSize The maximum number of Interests to keep outstanding.
+ * @param domainPrefix A CCNxName containing the domain prefix of the file.
+ *
+ * @return A new PARCBuffer containing the response, or NULL if it wasn't received. It must eventually be
+ *         released by calling parcBuffer_Release().
+ */
+static PARCBuffer *
+_fetchContents(CCNxPortalFactory *factory, const char *command, const char *fileName, uint32_t chunkSize, size_t windowSize,
+               const CCNxName *domainPrefix)
+{
+    PARCBuffer *result = NULL;
+
+    CCNxPortal *portal = ccnxPortalFactory_CreatePortal(factory, ccnxPortalRTA_Message);
+    assertNotNull(portal, "Expected a non-null CCNxPortal pointer.");
+
+    _TutorialClientTransfer transfer;
+    _initializeTransfer(&transfer, command, fileName, chunkSize, domainPrefix, NULL);
+    transfer.isQuiet = true;
+
+    const _TutorialClientOptions options = {
+        .windowSize = windowSize,
+        .congestionControl = &tutorialCongestionControl_Fixed
+    };
+
+    if (_fetchWithPipelinedInterests(portal, &transfer, command, fileName, &options, NULL)
+        && transfer.contents != NULL) {
+        result = parcBuffer_CreateFromArray(transfer.contents, transfer.contentsLength);
+    }
+
+    _finishTransfer(&transfer);
+    ccnxPortal_Release(&portal);
+
+    return result;
+}
+
+/**
+ * Fetch the metadata of the specified file, which tells us the chunk size the server uses for it. The metadata
+ * is a single chunk.
+ *
+ * @param factory The CCNxPortalFactory to create the Portal with.
+ * @param fileName The name of the file.
+ * @param domainPrefix A CCNxName containing the domain prefix of the file.
+ * @param metadata Filled in with the file's metadata.
+ *
+ * @return true If the metadata was received and understood.
+ */
+static bool
+_fetchMetadata(CCNxPortalFactory *factory, const char *fileName, const CCNxName *domainPrefix, TutorialMetadata *metadata)
+{
+    bool result = false;
+
+    PARCBuffer *contents = _fetchContents(factory, tutorialCommon_CommandMeta, fileName, tutorialCommon_ChunkSize, 1, domainPrefix);
+    if (contents != NULL) {
+        result = tutorialMetadata_Parse(contents, metadata);
+        parcBuffer_Release(&contents);
+    }
+
+    return result;
+}
+
+/**
+ * Parse a file's manifest, and check it against the metadata we already have, so we know it describes the same
+ * version of the file.
+ *
+ * @param contents A PARCBuffer containing the manifest.
+ * @param metadata The file's metadata.
+ *
+ * @return A new TutorialManifest, or NULL if it can't be parsed or doesn't match the metadata. It must eventually
+ *         be released by calling tutorialManifest_Release().
+ */
+static TutorialManifest *
+_createCheckedManifest(PARCBuffer *contents, const TutorialMetadata *metadata)
+{
+    TutorialManifest *result = tutorialManifest_Parse(contents);
+
+    if (result != NULL) {
+        const TutorialMetadata *manifestMetadata = tutorialManifest_GetMetadata(result);
+        if (manifestMetadata->fileSize != metadata->fileSize || manifestMetadata->chunkSize != metadata->chunkSize
+            || manifestMetadata->modificationTime != metadata->modificationTime) {
+            tutorialManifest_Release(&result); // The file changed between the two requests.
+        }
+    }
+
+    return result;
+}
+
+/**
+ * Fetch the manifest of the specified file, listing the digest of each of its chunks. The manifest is served in
+ * chunks of the file's chunk size, and is checked against the metadata we already have.
+ *
+ * @param factory The CCNxPortalFactory to create the Portal with.
+ * @param fileName The name of the file.
+ * @param domainPrefix A CCNxName containing the domain prefix of the file.
+ * @param metadata The file's metadata.
+ * @param windowSize The maximum number of Interests to keep outstanding.
+ *
+ * @return A new TutorialManifest, or NULL if it wasn't received or doesn't match the metadata. It must eventually
+ *         be released by calling tutorialManifest_Release().
+ */
+static TutorialManifest *
+_fetchManifest(CCNxPortalFactory *factory, const char *fileName, const CCNxName *domainPrefix, const TutorialMetadata *metadata,
+               size_t windowSize)
+{
+    TutorialManifest *result = NULL;
+
+    PARCBuffer *contents = _fetchContents(factory, tutorialCommon_CommandManifest, fileName, metadata->chunkSize, windowSize, domainPrefix);
+    if (contents != NULL) {
+        result = _createCheckedManifest(contents, metadata);
+        parcBuffer_Release(&contents);
+    }
+
+    return result;
+}
+
 /**
  * Given a command (e.g "fetch") and an optional target name (e.g. "file.txt"), create an appropriate CCNxInterest
- * and write it to the Portal.
+ * and write it to the Portal. If a window size was given, we instead issue an Interest for each chunk ourselves,
+ * keeping a window of them outstanding, rather than leaving flow control to the chunked Portal.
  *
+ * @param factory The CCNxPortalFactory to create Portals with.
  * @param command The command to be handled.
  * @param targetName The name of the target content, if any, that the command applies to.
+ * @param options The settings given on the command line.
  *
  * @return true If a CCNxInterest for the specified command and optional target was successfully issued and answered.
  */
 static bool
-_executeUserCommand(const char *command, const char *targetName)
+_executeUserCommand(CCNxPortalFactory *factory, const char *command, const char *targetName, const _TutorialClientOptions *options)
 {
+    size_t windowSize = options->windowSize;
     bool result = false;
-    CCNxPortalFactory *factory = _setupConsumerPortalFactory();
 
-    CCNxPortal *portal = ccnxPortalFactory_CreatePortal(factory, ccnxPortalRTA_Chunked);
+    CCNxPortal *portal = ccnxPortalFactory_CreatePortal(factory, (windowSize > 0) ? ccnxPortalRTA_Message : ccnxPortalRTA_Chunked);
+
+    assertNotNull(portal, "Expected a non-null CCNxPortal pointer.");
+
+    CCNxName *domainPrefix = ccnxName_CreateFromURI(tutorialCommon_DomainPrefix);  // e.g. 'lci:/ccnx/tutorial'
+
+    // A file may be served with any chunk size, so find out which before fetching it.
+    uint32_t chunkSize = tutorialCommon_ChunkSize;
+    bool isChunkSizeKnown = true;
+    TutorialManifest *manifest = NULL;
+    TutorialMetadata metadata;
+    const TutorialMetadata *fileMetadata = NULL;
+    if (_findCommand(command) == tutorialCommon_CommandFetch) {
+        isChunkSizeKnown = _fetchMetadata(factory, targetName, domainPrefix, &metadata);
+        if (isChunkSizeKnown) {
+            chunkSize = metadata.chunkSize;
+            fileMetadata = &metadata;
+        } else {
+            printf("tutorial_Client: Could not get the metadata of '%s'. Is it being served?\n", targetName);
+        }
+
+        // The manifest's digests let us check each chunk, and tell us every chunk of the file up front.
+        if (isChunkSizeKnown && options->useManifest) {
+            manifest = _fetchManifest(factory, targetName, domainPrefix, &metadata, windowSize);
+            if (manifest == NULL) {
+                printf("tutorial_Client: Could not get the manifest of '%s'.\n", targetName);
+                isChunkSizeKnown = false;
+            }
+        }
+    }
+
+    if (isChunkSizeKnown) {
+        _TutorialClientTransfer transfer;
+        _initializeTransfer(&transfer, command, targetName, chunkSize, domainPrefix, fileMetadata);
+
+        if (manifest != NULL) {
+            transfer.manifest = manifest;
+            tutorialReassembler_SetFinalChunkNumber(transfer.reassembler, tutorialManifest_GetMetadata(manifest)->finalChunkNumber);
+        }
+
+        if (windowSize > 0) {
+            TutorialFetcherStatistics statistics;
+            _fetchWithPipelinedInterests(portal, &transfer, _getRequestCommand(&transfer), targetName, options, &statistics);
+            printf("Sent %llu Interests (%llu retransmitted), smoothed round trip time %.3f ms, final '%s' window %zu.\n",
+                   (unsigned long long) statistics.interestsSent, (unsigned long long) statistics.retransmissions,
+                   statistics.smoothedRoundTripMicroseconds / 1000.0, options->congestionControl->name, statistics.window);
+        } else if (tutorialReassembler_IsComplete(transfer.reassembler) == false) {
+            // Given the user's command and optional target, create an Interest.
+            CCNxInterest *interest = _createInterest(_getRequestCommand(&transfer), targetName, chunkSize);
+
+            // Send the Interest through the Portal, and wait for a response.
+            CCNxMetaMessage *message = ccnxMetaMessage_CreateFromInterest(interest);
+            if (ccnxPortal_Send(portal, message, CCNxStackTimeout_Never)) {
+                _receiveResponseToIssuedInterest(portal, &transfer, domainPrefix);
+            }
+
+            ccnxMetaMessage_Release(&message);
+            ccnxInterest_Release(&interest);
+        }
+
+        if (manifest != NULL) {
+            printf("Checked every chunk against the file's manifest; %llu did not match and were fetched again.\n",
+                   (unsigned long long) transfer.rejectedChunkCount);
+        }
+        if (transfer.isCompressed) {
+            printf("Fetched compressed with %s: %llu bytes sent for %llu bytes of the file.\n",
+                   tutorialCompression_GetCodecName(metadata.compression), (unsigned long long) transfer.compressedBytesReceived,
+                   (unsigned long long) transfer.bytesReceived);
+        }
+
+        result = _finishTransfer(&transfer);
+    }
+
+    if (manifest != NULL) {
+        tutorialManifest_Release(&manifest);
+    }
+    ccnxName_Release(&domainPrefix);
+    ccnxPortal_Release(&portal);
+
+    return result;
+}
+
+/**
+ * The most files _fetchFiles() fetches at once. Each of them holds an open file and a reassembler until it's done.
+ */
+#define _maximumConcurrentFiles 16
+
+/**
+ * The stages of fetching a file in _fetchFiles(): its metadata, then its manifest, if the user asked for one,
+ * and then the file itself.
+ */
+typedef enum {
+    _TutorialClientFileStage_Metadata,
+    _TutorialClientFileStage_Manifest,
+    _TutorialClientFileStage_Contents
+} _TutorialClientFileStage;
+
+/**
+ * A file being fetched by _fetchFiles(), with the transfer and fetcher of its current stage.
+ */
+typedef struct {
+    bool isActive;
+    const char *fileName;
+    _TutorialClientFileStage stage;
+    TutorialMetadata metadata;
+    TutorialManifest *manifest;        // The file's manifest, if the user asked for one and it has been fetched.
+    _TutorialClientTransfer transfer;
+    TutorialFetcher *fetcher;
+} _TutorialClientFileFetch;
+
+/**
+ * Start the specified stage of fetching a file: prepare its transfer, and create a fetcher for it on the shared Portal.
+ *
+ * @param fetch The _TutorialClientFileFetch of the file.
+ * @param stage The stage to start.
+ * @param portal The CCNxPortal shared by every file, created with ccnxPortalRTA_Message.
+ * @param domainPrefix A CCNxName containing the domain prefix of the file.
+ * @param options The settings given on the command line.
+ */
+static void
+_startFileStage(_TutorialClientFileFetch *fetch, _TutorialClientFileStage stage, CCNxPortal *portal,
+                const CCNxName *domainPrefix, const _TutorialClientOptions *options)
+{
+    const char *command = tutorialCommon_CommandMeta;
+    uint32_t chunkSize = tutorialCommon_ChunkSize;
+    size_t windowSize = 1; // The metadata is a single chunk.
+    const TutorialCongestionControl *congestionControl = &tutorialCongestionControl_Fixed;
+
+    if (stage == _TutorialClientFileStage_Manifest) {
+        command = tutorialCommon_CommandManifest;
+        chunkSize = fetch->metadata.chunkSize;
+        windowSize = options->windowSize;
+    } else if (stage == _TutorialClientFileStage_Contents) {
+        command = tutorialCommon_CommandFetch;
+        chunkSize = fetch->metadata.chunkSize;
+        windowSize = options->windowSize;
+        congestionControl = options->congestionControl;
+    }
+
+    fetch->stage = stage;
+    _initializeTransfer(&fetch->transfer, command, fetch->fileName, chunkSize, domainPrefix,
+                        (stage == _TutorialClientFileStage_Contents) ? &fetch->metadata : NULL);
+    fetch->transfer.isQuiet = true; // The progress lines of several files would overwrite each other.
+
+    if (stage == _TutorialClientFileStage_Contents && fetch->manifest != NULL) {
+        fetch->transfer.manifest = fetch->manifest;
+        tutorialReassembler_SetFinalChunkNumber(fetch->transfer.reassembler, tutorialManifest_GetMetadata(fetch->manifest)->finalChunkNumber);
+    }
+
+    CCNxName *contentName = _createContentName(_getRequestCommand(&fetch->transfer), fetch->fileName, chunkSize);
+    fetch->fetcher = tutorialFetcher_Create(portal, contentName, windowSize, congestionControl,
+                                            fetch->transfer.reassembler, _receiveFetchedContentObject, &fetch->transfer);
+    ccnxName_Release(&contentName);
+}
+
+/**
+ * Finish the current stage of fetching a file, whose fetcher has finished, and start the next stage, if there is one.
+ *
+ * @param fetch The _TutorialClientFileFetch of the file.
+ * @param portal The CCNxPortal shared by every file.
+ * @param domainPrefix A CCNxName containing the domain prefix of the file.
+ * @param options The settings given on the command line.
+ * @param fetchedCount Incremented once the file has been fetched.
+ * @param bytesReceived Increased by the size of the file, once it has been fetched.
+ *
+ * @return true If the file is still being fetched.
+ * @return false If it has been fetched, or couldn't be.
+ */
+static bool
+_advanceFileFetch(_TutorialClientFileFetch *fetch, CCNxPortal *portal, const CCNxName *domainPrefix,
+                  const _TutorialClientOptions *options, size_t *fetchedCount, uint64_t *bytesReceived)
+{
+    _TutorialClientTransfer *transfer = &fetch->transfer;
+    _TutorialClientFileStage nextStage = fetch->stage;
+    bool isFetched = false;
+
+    tutorialFetcher_Release(&fetch->fetcher);
+
+    PARCBuffer *contents = NULL;
+    if (tutorialReassembler_IsComplete(transfer->reassembler) && transfer->contents != NULL) {
+        contents = parcBuffer_Wrap(transfer->contents, transfer->contentsLength, 0, transfer->contentsLength);
+    }
+
+    if (fetch->stage == _TutorialClientFileStage_Metadata) {
+        if (contents != NULL && tutorialMetadata_Parse(contents, &fetch->metadata)) {
+            nextStage = options->useManifest ? _TutorialClientFileStage_Manifest : _TutorialClientFileStage_Contents;
+        } else {
+            printf("tutorial_Client: Could not get the metadata of '%s'. Is it being served?\n", fetch->fileName);
+        }
+    } else if (fetch->stage == _TutorialClientFileStage_Manifest) {
+        fetch->manifest = (contents != NULL) ? _createCheckedManifest(contents, &fetch->metadata) : NULL;
+        if (fetch->manifest != NULL) {
+            nextStage = _TutorialClientFileStage_Contents;
+        } else {
+            printf("tutorial_Client: Could not get the manifest of '%s'.\n", fetch->fileName);
+        }
+    } else {
+        if (fetch->manifest != NULL && transfer->rejectedChunkCount > 0) {
+            printf("%llu chunks of '%s' did not match the file's manifest and were fetched again.\n",
+                   (unsigned long long) transfer->rejectedChunkCount, fetch->fileName);
+        }
+        isFetched = tutorialReassembler_IsComplete(transfer->reassembler);
+        if (isFetched == false) {
+            printf("tutorial_Client: Could not fetch '%s'.\n", fetch->fileName);
+        }
+    }
+
+    if (contents != NULL) {
+        parcBuffer_Release(&contents);
+    }
+    if (_finishTransfer(transfer) && isFetched) {
+        (*fetchedCount)++;
+        *bytesReceived += transfer->bytesReceived;
+    }
+
+    if (nextStage != fetch->stage) {
+        _startFileStage(fetch, nextStage, portal, domainPrefix, options);
+        return true;
+    }
+
+    if (fetch->manifest != NULL) {
+        tutorialManifest_Release(&fetch->manifest);
+    }
+    fetch->isActive = false;
+    return false;
+}
 
+/**
+ * Fetch every one of the specified files, up to _maximumConcurrentFiles of them at once, over a single Portal.
+ * Each file has its own fetcher and reassembler, but the total number of Interests outstanding for all of them
+ * is kept to `options->windowSize`. The files take turns at sending first, so that none of them is starved.
+ *
+ * @param factory The CCNxPortalFactory to create the Portal with.
+ * @param fileNames The names of the files to fetch.
+ * @param fileCount The number of names in `fileNames`.
+ * @param options The settings given on the command line. `options->windowSize` must be greater than 0.
+ *
+ * @return true If every file was fetched.
+ */
+static bool
+_fetchFiles(CCNxPortalFactory *factory, char **fileNames, size_t fileCount, const _TutorialClientOptions *options)
+{
+    CCNxPortal *portal = ccnxPortalFactory_CreatePortal(factory, ccnxPortalRTA_Message);
     assertNotNull(portal, "Expected a non-null CCNxPortal pointer.");
 
-    // Given the user's command and optional target, create an Interest.
-    CCNxInterest *interest = _createInterest(command, targetName);
+    CCNxName *domainPrefix = ccnxName_CreateFromURI(tutorialCommon_DomainPrefix);
+
+    _TutorialClientFileFetch fetches[_maximumConcurrentFiles];
+    memset(fetches, 0, sizeof(fetches));
+
+    size_t nextFile = 0;
+    size_t activeCount = 0;
+    size_t fetchedCount = 0;
+    size_t firstSender = 0;
+    uint64_t bytesReceived = 0;
+
+    struct timespec startTime;
+    clock_gettime(CLOCK_MONOTONIC, &startTime);
+
+    while (ccnxPortal_IsError(portal) == false) {
+        // Move finished files on to their next stage, and start new files in the slots that frees.
+        for (size_t i = 0; i < _maximumConcurrentFiles; i++) {
+            _TutorialClientFileFetch *fetch = &fetches[i];
+            if (fetch->isActive && tutorialFetcher_IsFinished(fetch->fetcher)
+                && _advanceFileFetch(fetch, portal, domainPrefix, options, &fetchedCount, &bytesReceived) == false) {
+                activeCount--;
+            }
+            if (fetch->isActive == false && nextFile < fileCount) {
+                fetch->isActive = true;
+                fetch->fileName = fileNames[nextFile++];
+                fetch->manifest = NULL;
+                _startFileStage(fetch, _TutorialClientFileStage_Metadata, portal, domainPrefix, options);
+                activeCount++;
+            }
+        }
+        if (activeCount == 0) {
+            break;
+        }
+
+        uint64_t timeUntilNextTimeout = UINT64_MAX;
+        size_t outstandingCount = 0;
+        for (size_t i = 0; i < _maximumConcurrentFiles; i++) {
+            if (fetches[i].isActive) {
+                uint64_t timeout = tutorialFetcher_RetransmitExpiredInterests(fetches[i].fetcher);
+                if (timeout < timeUntilNextTimeout) {
+                    timeUntilNextTimeout = timeout;
+                }
+                outstandingCount += tutorialFetcher_GetOutstandingCount(fetches[i].fetcher);
+            }
+        }
+
+        for (size_t i = 0; i < _maximumConcurrentFiles && outstandingCount < options->windowSize; i++) {
+            _TutorialClientFileFetch *fetch = &fetches[(firstSender + i) % _maximumConcurrentFiles];
+            if (fetch->isActive) {
+                outstandingCount += tutorialFetcher_SendInterests(fetch->fetcher, options->windowSize - outstandingCount);
+            }
+        }
+        firstSender = (firstSender + 1) % _maximumConcurrentFiles;
+
+        // Wait for a response, but no longer than it takes for the next Interest to time out.
+        if (timeUntilNextTimeout == UINT64_MAX) {
+            timeUntilNextTimeout = 0;
+        }
+        CCNxMetaMessage *response = ccnxPortal_Receive(portal, CCNxStackTimeout_MicroSeconds(timeUntilNextTimeout));
+
+        if (response != NULL) {
+            if (ccnxMetaMessage_IsContentObject(response)) {
+                CCNxContentObject *contentObject = ccnxMetaMessage_GetContentObject(response);
+
+                // Hand the response to the file it belongs to. There are only a few files in flight, so just look.
+                for (size_t i = 0; i < _maximumConcurrentFiles; i++) {
+                    if (fetches[i].isActive && tutorialFetcher_ReceiveContentObject(fetches[i].fetcher, contentObject)) {
+                        break;
+                    }
+                }
+            }
+            ccnxMetaMessage_Release(&response);
+        }
+    }
+
+    // If the Portal failed, give up on the files still being fetched.
+    for (size_t i = 0; i < _maximumConcurrentFiles; i++) {
+        if (fetches[i].isActive) {
+            tutorialFetcher_Release(&fetches[i].fetcher);
+            _finishTransfer(&fetches[i].transfer);
+            if (fetches[i].manifest != NULL) {
+                tutorialManifest_Release(&fetches[i].manifest);
+            }
+        }
+    }
+
+    double elapsedSeconds = _secondsSince(&startTime);
+    double megabytesPerSecond = (elapsedSeconds > 0.0) ? (bytesReceived / elapsedSeconds) / (1024.0 * 1024.0) : 0.0;
+    printf("Fetched %zu of %zu files (%llu bytes in %.2f seconds, %.2f MB/s).\n", fetchedCount, fileCount,
+           (unsigned long long) bytesReceived, elapsedSeconds, megabytesPerSecond);
+
+    ccnxName_Release(&domainPrefix);
+    ccnxPortal_Release(&portal);
+
+    return fetchedCount == fileCount;
+}
+
+/**
+ * A growing list of the names of the files to fetch. Every name is owned by the list.
+ */
+typedef struct {
+    char **names;
+    size_t count;
+    size_t capacity;
+} _TutorialClientFileNames;
+
+/**
+ * Add a copy of the first `length` bytes of `name` to the specified list of file names.
+ */
+static void
+_addFileName(_TutorialClientFileNames *fileNames, const char *name, size_t length)
+{
+    if (fileNames->count == fileNames->capacity) {
+        fileNames->capacity = (fileNames->capacity > 0) ? fileNames->capacity * 2 : 16;
+        fileNames->names = parcMemory_Reallocate(fileNames->names, fileNames->capacity * sizeof(char *));
+        assertNotNull(fileNames->names, "parcMemory_Reallocate(%zu) returned NULL", fileNames->capacity * sizeof(char *));
+    }
+    fileNames->names[fileNames->count++] = parcMemory_StringDuplicate(name, length);
+}
+
+/**
+ * Release the names held by the specified list of file names.
+ */
+static void
+_releaseFileNames(_TutorialClientFileNames *fileNames)
+{
+    for (size_t i = 0; i < fileNames->count; i++) {
+        parcMemory_Deallocate((void **) &fileNames->names[i]);
+    }
+    if (fileNames->names != NULL) {
+        parcMemory_Deallocate((void **) &fileNames->names);
+    }
+}
 
-    // Send the Interest through the Portal, and wait for a response.
-    CCNxMetaMessage *message = ccnxMetaMessage_CreateFromInterest(interest);
-    if (ccnxPortal_Send(portal, message, CCNxStackTimeout_Never)) {
-        CCNxName *domainPrefix = ccnxName_CreateFromURI(tutorialCommon_DomainPrefix);  // e.g. 'lci:/ccnx/tutorial'
+static int
+_compareFileNames(const void *a, const void *b)
+{
+    return strcmp(*(char *const *) a, *(char *const *) b);
+}
 
-        result = _receiveResponseToIssuedInterest(portal, domainPrefix);
+/**
+ * Sort the specified list of file names, and remove any duplicates, so that no file is fetched twice at once.
+ */
+static void
+_sortFileNames(_TutorialClientFileNames *fileNames)
+{
+    qsort(fileNames->names, fileNames->count, sizeof(char *), _compareFileNames);
 
-        ccnxName_Release(&domainPrefix);
+    size_t uniqueCount = 0;
+    for (size_t i = 0; i < fileNames->count; i++) {
+        if (uniqueCount > 0 && strcmp(fileNames->names[uniqueCount - 1], fileNames->names[i]) == 0) {
+            parcMemory_Deallocate((void **) &fileNames->names[i]);
+        } else {
+            fileNames->names[uniqueCount++] = fileNames->names[i];
+        }
     }
+    fileNames->count = uniqueCount;
+}
 
-    ccnxMetaMessage_Release(&message);
-    ccnxInterest_Release(&interest);
+/**
+ * Determine whether a file name given to 'fetch' is a pattern (e.g. "*.csv") to match against the directory listing.
+ */
+static bool
+_isFileNamePattern(const char *fileName)
+{
+    return strpbrk(fileName, "*?[") != NULL;
+}
+
+/**
+ * Fetch the server's directory listing, or the part of it that meets the conditions of a query, with our own
+ * Interests on a Portal of its own.
+ *
+ * @param factory The CCNxPortalFactory to create the Portal with.
+ * @param windowSize The maximum number of Interests to keep outstanding.
+ * @param query The conditions the files must meet.
+ * @param transfer The _TutorialClientTransfer to receive the listing into. It must be finished with
+ *                 _finishTransfer(), whether or not the listing was received.
+ *
+ * @return true If the whole listing was received.
+ */
+static bool
+_fetchDirectoryListing(CCNxPortalFactory *factory, size_t windowSize, const TutorialListingQuery *query,
+                       _TutorialClientTransfer *transfer)
+{
+    CCNxPortal *portal = ccnxPortalFactory_CreatePortal(factory, ccnxPortalRTA_Message);
+    assertNotNull(portal, "Expected a non-null CCNxPortal pointer.");
+
+    CCNxName *domainPrefix = ccnxName_CreateFromURI(tutorialCommon_DomainPrefix);
+
+    _initializeTransfer(transfer, tutorialCommon_CommandList, NULL, tutorialCommon_ChunkSize, domainPrefix, NULL);
+    transfer->isQuiet = true;
+
+    const _TutorialClientOptions options = {
+        .windowSize = windowSize,
+        .congestionControl = &tutorialCongestionControl_Fixed
+    };
+    CCNxName *contentName = tutorialListingQuery_CreateName(query);
+    bool result = _fetchNameWithPipelinedInterests(portal, transfer, contentName, &options, NULL);
+    ccnxName_Release(&contentName);
+
+    transfer->domainPrefix = NULL; // It's only needed while receiving.
+    ccnxName_Release(&domainPrefix);
     ccnxPortal_Release(&portal);
-    ccnxPortalFactory_Release(&factory);
+
+    return result;
+}
+
+/**
+ * Add the name of every file in a directory listing that matches the specified pattern to a list of file names.
+ *
+ * @param listing The _TutorialClientTransfer the whole listing was received by.
+ * @param pattern A shell wildcard pattern, as understood by fnmatch().
+ * @param fileNames The list to add the matching names to.
+ *
+ * @return The number of files that matched.
+ */
+static size_t
+_addMatchingFileNames(const _TutorialClientTransfer *listing, const char *pattern, _TutorialClientFileNames *fileNames)
+{
+    size_t result = 0;
+
+    for (size_t i = 0; i < listing->listingChunkCapacity && listing->listingChunks[i] != NULL; i++) {
+        TutorialListingChunkCursor cursor;
+        TutorialListingEntry entry;
+
+        tutorialListingChunk_Open(listing->listingChunks[i], &cursor); // It was checked when it arrived.
+        while (tutorialListingChunk_NextEntry(&cursor, &entry)) {
+            char *name = parcMemory_StringDuplicate(entry.fileName, entry.fileNameLength);
+            if (tutorialCommon_IsRelativeFilePath(entry.fileName, entry.fileNameLength) == false) {
+                // We write the file by this name, so one that would leave the current directory is never fetched.
+                printf("tutorial_Client: Ignoring '%s' in the directory listing, as it isn't a relative path.\n", name);
+            } else if (fnmatch(pattern, name, FNM_PATHNAME) == 0) {
+                _addFileName(fileNames, name, strlen(name));
+                result++;
+            }
+            parcMemory_Deallocate((void **) &name);
+        }
+    }
+
+    return result;
+}
+
+/**
+ * Turn the file names given to 'fetch' into the list of files to fetch. A name that is a pattern is replaced by
+ * the names of the files in the server's directory listing that it matches. The server does the matching, so only
+ * the matching part of the listing is fetched for each pattern.
+ *
+ * @param factory The CCNxPortalFactory to create Portals with.
+ * @param arguments The file names and patterns given on the command line.
+ * @param argumentCount The number of entries in `arguments`.
+ * @param windowSize The maximum number of Interests to keep outstanding while fetching the listing.
+ * @param fileNames The list to add the names of the files to fetch to.
+ *
+ * @return true If every pattern matched at least one file.
+ */
+static bool
+_collectFileNames(CCNxPortalFactory *factory, char **arguments, size_t argumentCount, size_t windowSize,
+                  _TutorialClientFileNames *fileNames)
+{
+    bool result = true;
+
+    for (size_t i = 0; i < argumentCount && result; i++) {
+        if (_isFileNamePattern(arguments[i]) == false) {
+            if (tutorialCommon_IsRelativeFilePath(arguments[i], strlen(arguments[i])) == false) {
+                printf("tutorial_Client: '%s' isn't the relative path of a file being served.\n", arguments[i]);
+                result = false;
+            }
+            _addFileName(fileNames, arguments[i], strlen(arguments[i]));
+            continue;
+        }
+
+        TutorialListingQuery query = { .pattern = arguments[i], .patternLength = strlen(arguments[i]) };
+        _TutorialClientTransfer listing;
+        if (_fetchDirectoryListing(factory, windowSize, &query, &listing) == false) {
+            printf("tutorial_Client: Could not get the directory listing to match '%s' against.\n", arguments[i]);
+            result = false;
+        } else if (_addMatchingFileNames(&listing, arguments[i], fileNames) == 0) {
+            printf("tutorial_Client: No files being served match '%s'.\n", arguments[i]);
+            result = false;
+        }
+        _finishTransfer(&listing);
+    }
+
+    _sortFileNames(fileNames);
+    return result;
+}
+
+/**
+ * List the files being served that meet the conditions of a query, a page at a time if the query has a limit.
+ * Each page is asked for with its cursor set to the last file of the page before, until a page isn't full.
+ *
+ * @param factory The CCNxPortalFactory to create Portals with.
+ * @param query The conditions the files must meet. Its limit, if any, is the number of files in a page.
+ * @param windowSize The maximum number of Interests to keep outstanding while fetching each page.
+ *
+ * @return true If every page was received.
+ */
+static bool
+_listFiles(CCNxPortalFactory *factory, const TutorialListingQuery *query, size_t windowSize)
+{
+    bool result = true;
+    TutorialListingQuery pageQuery = *query;
+    char *cursor = NULL;
+    size_t fileCount = 0;
+    size_t pageCount = 0;
+    size_t pageFileCount;
+
+    printf("Directory Listing follows:\n");
+    do {
+        _TutorialClientTransfer page;
+        pageFileCount = 0;
+
+        result = _fetchDirectoryListing(factory, windowSize, &pageQuery, &page);
+        if (result) {
+            TutorialListingEntry lastEntry;
+            pageFileCount = _printDirectoryListing(&page, &lastEntry);
+            fileCount += pageFileCount;
+            pageCount++;
+
+            if (pageFileCount > 0) {
+                // The last entry points into the page, so keep a copy of it for the next page's cursor.
+                if (cursor != NULL) {
+                    parcMemory_Deallocate((void **) &cursor);
+                }
+                cursor = parcMemory_StringDuplicate(lastEntry.fileName, lastEntry.fileNameLength);
+                pageQuery.after = cursor;
+                pageQuery.afterLength = lastEntry.fileNameLength;
+            }
+        } else {
+            printf("tutorial_Client: Could not get page %zu of the directory listing.\n", pageCount + 1);
+        }
+        _finishTransfer(&page);
+    } while (result && query->limit > 0 && pageFileCount == query->limit);
+
+    if (result) {
+        printf("%zu files, in %zu page%s.\n", fileCount, pageCount, (pageCount == 1) ? "" : "s");
+    }
+
+    if (cursor != NULL) {
+        parcMemory_Deallocate((void **) &cursor);
+    }
 
     return result;
 }
@@ -361,9 +1525,22 @@ _displayUsage(char *programName)
     printf(" the tutorialServer application, which should be running when this application is used. A CCNx\n");
     printf(" forwarder (e.g. Metis) must also be running.\n\n");
 
-    printf("Usage: %s  [-h] [-v] [ list | fetch <filename> ]\n", programName);
+    printf("Usage: %s  [-h] [-v] [-w <window>] [-c fixed|aimd|delay] [-m] [-p <prefix>] [-s <seconds>] [-n <files>]\n", programName);
+    printf("           [ list [<pattern>] | fetch <filename> ... ]\n");
     printf("  '%s list' will list the files in the directory served by tutorial_Server\n", programName);
+    printf("  '%s list \"*.csv\"' will list only the files that match the pattern. The server does the matching\n", programName);
+    printf("  '%s -p logs- list' will list only the files whose names start with 'logs-'\n", programName);
+    printf("  '%s -s 1700000000 list' will list only the files modified at or after that time (seconds since the epoch)\n", programName);
+    printf("  '%s -n 1000 list' will list the files 1000 at a time, asking for each page once the last has arrived\n", programName);
     printf("  '%s fetch <filename>' will fetch the specified filename\n", programName);
+    printf("  '%s fetch <filename> <filename> \"*.csv\"' will fetch those files, and every file in the list that matches\n", programName);
+    printf("      the pattern, %d at a time over one Portal, with up to %zu chunk Interests outstanding in all (or -w)\n",
+           _maximumConcurrentFiles, tutorialFetcher_DefaultWindowSize);
+    printf("  '%s -w 64 fetch <filename>' will fetch it with up to 64 chunk Interests outstanding at once\n", programName);
+    printf("  '%s -c delay fetch <filename>' will fetch it with a window sized by the 'delay' congestion control\n", programName);
+    printf("      (up to %zu Interests, unless -w is given). 'aimd' is also available; '-w' alone uses 'fixed'.\n",
+           tutorialFetcher_DefaultWindowSize);
+    printf("  '%s -m fetch <filename>' will fetch the file's manifest first, and check every chunk against its digest\n", programName);
     printf("  '%s -v' will show the tutorial demo code version\n", programName);
     printf("  '%s -h' will show this help\n\n", programName);
 }
@@ -378,7 +1555,23 @@ main(int argc, char *argv[argc])
     bool needToShowUsage = false;
     bool shouldExit = false;
 
-    status = tutorialCommon_processCommandLineArguments(argc, argv, &commandArgCount, commandArgs, &needToShowUsage, &shouldExit);
+    const char *windowSizeOption = NULL;
+    const char *congestionControlOption = NULL;
+    const char *manifestOption = NULL;
+    const char *prefixOption = NULL;
+    const char *modifiedSinceOption = NULL;
+    const char *pageSizeOption = NULL;
+    TutorialCommonOption options[] = {
+        { .option = 'w', .takesValue = true, .value = &windowSizeOption },
+        { .option = 'c', .takesValue = true, .value = &congestionControlOption },
+        { .option = 'm', .takesValue = false, .value = &manifestOption },
+        { .option = 'p', .takesValue = true, .value = &prefixOption },
+        { .option = 's', .takesValue = true, .value = &modifiedSinceOption },
+        { .option = 'n', .takesValue = true, .value = &pageSizeOption },
+        { .option = '\0' }
+    };
+
+    status = tutorialCommon_processCommandLineArguments(argc, argv, options, &commandArgCount, commandArgs, &needToShowUsage, &shouldExit);
 
     if (needToShowUsage) {
         _displayUsage(argv[0]);
@@ -388,16 +1581,90 @@ main(int argc, char *argv[argc])
         exit(status);
     }
 
-    if (commandArgCount == 2
+    _TutorialClientOptions clientOptions = {
+        .windowSize = 0,
+        .congestionControl = &tutorialCongestionControl_Fixed
+    };
+    if (congestionControlOption != NULL) {
+        clientOptions.congestionControl = tutorialCongestionControl_FindByName(congestionControlOption);
+        if (clientOptions.congestionControl == NULL) {
+            printf("tutorial_Client: Unknown congestion control '%s'\n", congestionControlOption);
+            _displayUsage(argv[0]);
+            exit(EXIT_FAILURE);
+        }
+        clientOptions.windowSize = tutorialFetcher_DefaultWindowSize;
+    }
+    if (manifestOption != NULL) {
+        // Chunks that fail their check are asked for again, which needs our own Interests rather than the chunked Portal's.
+        clientOptions.useManifest = true;
+        clientOptions.windowSize = tutorialFetcher_DefaultWindowSize;
+    }
+    if (windowSizeOption != NULL) {
+        clientOptions.windowSize = strtoul(windowSizeOption, NULL, 10);
+    }
+    if (clientOptions.useManifest && clientOptions.windowSize == 0) {
+        clientOptions.windowSize = tutorialFetcher_DefaultWindowSize;
+    }
+    if (prefixOption != NULL) {
+        clientOptions.listingQuery.prefix = prefixOption;
+        clientOptions.listingQuery.prefixLength = strlen(prefixOption);
+    }
+    if (modifiedSinceOption != NULL) {
+        clientOptions.listingQuery.hasModifiedSince = true;
+        clientOptions.listingQuery.modifiedSince = strtoll(modifiedSinceOption, NULL, 10);
+    }
+    if (pageSizeOption != NULL) {
+        clientOptions.listingQuery.limit = strtoul(pageSizeOption, NULL, 10);
+    }
+    bool hasListingQuery = (prefixOption != NULL || modifiedSinceOption != NULL || clientOptions.listingQuery.limit > 0);
+
+    // Every command shares one factory, so the keystore is only opened once.
+    CCNxPortalFactory *factory = NULL;
+
+    if (commandArgCount == 2 && _isFileNamePattern(commandArgs[1]) == false
         && (strncmp(tutorialCommon_CommandFetch, commandArgs[0], strlen(commandArgs[0])) == 0)) {        // "fetch <filename>"
-        status = _executeUserCommand(commandArgs[0], commandArgs[1]) ? EXIT_SUCCESS : EXIT_FAILURE;
-    } else if (commandArgCount == 1
+        if (tutorialCommon_IsRelativeFilePath(commandArgs[1], strlen(commandArgs[1]))) {
+            factory = _setupConsumerPortalFactory();
+            status = _executeUserCommand(factory, commandArgs[0], commandArgs[1], &clientOptions) ? EXIT_SUCCESS : EXIT_FAILURE;
+        } else {
+            printf("tutorial_Client: '%s' isn't the relative path of a file being served.\n", commandArgs[1]);
+            status = EXIT_FAILURE;
+        }
+    } else if (commandArgCount >= 2
+               && (strncmp(tutorialCommon_CommandFetch, commandArgs[0], strlen(commandArgs[0])) == 0)) { // "fetch <filename> ..."
+        // Files fetched together share a Portal, which needs our own Interests rather than the chunked Portal's.
+        if (clientOptions.windowSize == 0) {
+            clientOptions.windowSize = tutorialFetcher_DefaultWindowSize;
+        }
+        factory = _setupConsumerPortalFactory();
+        _TutorialClientFileNames fileNames = { .names = NULL, .count = 0, .capacity = 0 };
+        status = EXIT_FAILURE;
+        if (_collectFileNames(factory, &commandArgs[1], (size_t) commandArgCount - 1, clientOptions.windowSize, &fileNames)
+            && _fetchFiles(factory, fileNames.names, fileNames.count, &clientOptions)) {
+            status = EXIT_SUCCESS;
+        }
+        _releaseFileNames(&fileNames);
+    } else if (commandArgCount == 1 && hasListingQuery == false
                && (strncmp(tutorialCommon_CommandList, commandArgs[0], strlen(commandArgs[0])) == 0)) {  // "list"
-        status = _executeUserCommand(commandArgs[0], NULL) ? EXIT_SUCCESS : EXIT_FAILURE;
+        factory = _setupConsumerPortalFactory();
+        status = _executeUserCommand(factory, commandArgs[0], NULL, &clientOptions) ? EXIT_SUCCESS : EXIT_FAILURE;
+    } else if ((commandArgCount == 1 || commandArgCount == 2)
+               && (strncmp(tutorialCommon_CommandList, commandArgs[0], strlen(commandArgs[0])) == 0)) {  // "list <pattern>"
+        if (commandArgCount == 2) {
+            clientOptions.listingQuery.pattern = commandArgs[1];
+            clientOptions.listingQuery.patternLength = strlen(commandArgs[1]);
+        }
+        factory = _setupConsumerPortalFactory();
+        size_t windowSize = (clientOptions.windowSize > 0) ? clientOptions.windowSize : tutorialFetcher_DefaultWindowSize;
+        status = _listFiles(factory, &clientOptions.listingQuery, windowSize) ? EXIT_SUCCESS : EXIT_FAILURE;
     } else {
         status = EXIT_FAILURE;
         _displayUsage(argv[0]);
     }
 
+    if (factory != NULL) {
+        ccnxPortalFactory_Release(&factory);
+    }
+
     exit(status);
 }
@@ -29,6 +29,10 @@
  * @copyright 2014-2015, Xerox Corporation (Xerox)and Palo Alto Research Center (PARC).  All rights reserved.
  */
 #include <stdio.h>
+#include <string.h>
+#include <strings.h>
+#include <time.h>
+#include <unistd.h>
 
 #include "tutorial_Common.h"
 #include "tutorial_About.h"
@@ -37,10 +41,15 @@
 
 #include <ccnx/common/ccnx_NameSegmentNumber.h>
 
+#include <parc/algol/parc_Memory.h>
+
 #include <parc/security/parc_Security.h>
 #include <parc/security/parc_PublicKeySignerPkcs12Store.h>
 #include <parc/security/parc_IdentityFile.h>
 
+#include <openssl/pkcs12.h>
+#include <openssl/x509.h>
+
 /**
  * The CCNx Name prefix we'll use for the tutorial.
  */
@@ -52,6 +61,17 @@ const char *tutorialCommon_DomainPrefix = "lci:/ccnx/tutorial";
  */
 const uint32_t tutorialCommon_ChunkSize = 1200;
 
+/**
+ * The largest chunk size the server may use for a file. A ContentObject's payload length is carried in
+ * 16 bits, so this leaves room for the rest of the message.
+ */
+const uint32_t tutorialCommon_MaximumChunkSize = 63 * 1024;
+
+/**
+ * The type of the name segment that carries the chunk size a file is fetched with.
+ */
+const CCNxNameLabelType tutorialCommon_ChunkSizeLabelType = CCNxNameLabelType_APP0;
+
 /**
  * The string we use for the 'fetch' command.
  */
@@ -62,6 +82,58 @@ const char *tutorialCommon_CommandFetch = "fetch";
  */
 const char *tutorialCommon_CommandList = "list";
 
+/**
+ * The string we use for the 'meta' command.
+ */
+const char *tutorialCommon_CommandMeta = "meta";
+
+/**
+ * The string we use for the 'manifest' command.
+ */
+const char *tutorialCommon_CommandManifest = "manifest";
+
+/**
+ * The string we use for the 'cfetch' command.
+ */
+const char *tutorialCommon_CommandFetchCompressed = "cfetch";
+
+/**
+ * A keystore whose certificate expires within this many days is replaced when it is loaded, so that a program
+ * that keeps running for a while after starting doesn't sign with an expired certificate.
+ */
+static const unsigned int _identityRenewalDays = 7;
+
+/**
+ * Determine whether the certificate in a PKCS#12 keystore will have expired by the specified time. A keystore that
+ * can't be read here is left for the security library to report on, rather than replaced.
+ *
+ * @return true If the keystore's certificate could be read, and expires at or before `time`.
+ */
+static bool
+_isCertificateExpiringBy(const char *keystoreName, const char *keystorePassword, time_t time)
+{
+    bool result = false;
+
+    FILE *file = fopen(keystoreName, "rb");
+    if (file == NULL) {
+        return false;
+    }
+    PKCS12 *keystore = d2i_PKCS12_fp(file, NULL);
+    fclose(file);
+
+    EVP_PKEY *privateKey = NULL;
+    X509 *certificate = NULL;
+    if (keystore != NULL && PKCS12_parse(keystore, keystorePassword, &privateKey, &certificate, NULL) == 1 && certificate != NULL) {
+        result = X509_cmp_time(X509_get_notAfter(certificate), &time) <= 0;
+    }
+
+    X509_free(certificate);
+    EVP_PKEY_free(privateKey);
+    PKCS12_free(keystore);
+
+    return result;
+}
+
 PARCIdentity *
 tutorialCommon_CreateAndGetIdentity(const char *keystoreName, const char *keystorePassword, const char *subjectName)
 {
@@ -70,12 +142,25 @@ tutorialCommon_CreateAndGetIdentity(const char *keystoreName, const char *keysto
     unsigned int keyLength = 1024;
     unsigned int validityDays = 30;
 
-    bool success = parcPublicKeySignerPkcs12Store_CreateFile(keystoreName, keystorePassword, subjectName, keyLength, validityDays);
-    assertTrue(success,
-               "parcPublicKeySignerPkcs12Store_CreateFile('%s', '%s', '%s', %d, %d) failed.",
-               keystoreName, keystorePassword, subjectName, keyLength, validityDays);
-
     PARCIdentityFile *identityFile = parcIdentityFile_Create(keystoreName, keystorePassword);
+
+    // Keep using an existing keystore, so that chunks published ahead of time are signed with the same key
+    // the server signs with when it is running. Its certificate is self-signed, and never renewed by anyone
+    // else, so once it is about to expire a new identity is created in its place.
+    time_t renewalTime = time(NULL) + (time_t) _identityRenewalDays * 86400;
+    if (parcIdentityFile_Exists(identityFile) && _isCertificateExpiringBy(keystoreName, keystorePassword, renewalTime)) {
+        printf("The certificate in '%s' has expired, or expires within %u days. Creating a new identity;"
+               " files published with the old one should be published again.\n", keystoreName, _identityRenewalDays);
+        unlink(keystoreName);
+    }
+
+    if (parcIdentityFile_Exists(identityFile) == false) {
+        bool success = parcPublicKeySignerPkcs12Store_CreateFile(keystoreName, keystorePassword, subjectName, keyLength, validityDays);
+        assertTrue(success,
+                   "parcPublicKeySignerPkcs12Store_CreateFile('%s', '%s', '%s', %d, %d) failed.",
+                   keystoreName, keystorePassword, subjectName, keyLength, validityDays);
+    }
+
     PARCIdentity *result = parcIdentity_Create(identityFile, PARCIdentityFileAsPARCIdentity);
     parcIdentityFile_Release(&identityFile);
 
@@ -111,21 +196,96 @@ tutorialCommon_GetChunkNumberFromName(const CCNxName *name)
     return ccnxNameSegmentNumber_Value(chunkNumberSegment);
 }
 
+/**
+ * Return a pointer to the bytes of a name segment's value, and its length, without copying them.
+ */
+static const char *
+_getSegmentBytes(const CCNxNameSegment *segment, size_t *length)
+{
+    PARCBuffer *value = ccnxNameSegment_GetValue(segment);
+    *length = parcBuffer_Remaining(value);
+    return parcBuffer_Overlay(value, 0); // Overlaying 0 bytes doesn't move the buffer's position.
+}
+
 char *
-tutorialCommon_CreateFileNameFromName(const CCNxName *name)
+tutorialCommon_CreateFileNameFromName(const CCNxName *name, const CCNxName *domainPrefix)
 {
-    // For the Tutorial, the second to last NameSegment is the filename.
-    CCNxNameSegment *fileNameSegment = ccnxName_GetSegment(name, ccnxName_GetSegmentCount(name) - 2); // '-2' because we want the second to last segment
+    // For the Tutorial, the NameSegments between the command and the chunk number are the parts of the file's path.
+    TutorialNameView view;
+    if (tutorialCommon_ParseName(name, domainPrefix, &view) == false || view.argumentCount == 0) {
+        return NULL;
+    }
 
-    assertTrue(ccnxNameSegment_GetType(fileNameSegment) == CCNxNameLabelType_NAME,
-               "Last segment is the wrong type, expected CCNxNameLabelType %02X got %02X",
-               CCNxNameLabelType_NAME,
-               ccnxNameSegment_GetType(fileNameSegment))
-    {
-        ccnxName_Display(name, 0); // This executes only if the enclosing assertion fails
+    size_t length = 0;
+    for (size_t i = 0; i < view.argumentCount; i++) {
+        CCNxNameSegment *segment = ccnxName_GetSegment(name, view.argumentIndex + i);
+        length += parcBuffer_Remaining(ccnxNameSegment_GetValue(segment)) + 1; // +1 for the '/' or trailing null.
+    }
+
+    char *result = parcMemory_Allocate(length);
+    assertNotNull(result, "parcMemory_Allocate(%zu) returned NULL", length);
+
+    char *next = result;
+    for (size_t i = 0; i < view.argumentCount; i++) {
+        size_t segmentLength;
+        const char *segmentBytes = _getSegmentBytes(ccnxName_GetSegment(name, view.argumentIndex + i), &segmentLength);
+        if (i > 0) {
+            *next++ = '/';
+        }
+        memcpy(next, segmentBytes, segmentLength);
+        next += segmentLength;
+    }
+    *next = '\0';
+
+    return result; // This memory must be freed by the caller.
+}
+
+void
+tutorialCommon_AppendFilePath(CCNxName *name, const char *filePath)
+{
+    for (const char *part = filePath; *part != '\0'; ) {
+        size_t partLength = strcspn(part, "/");
+        if (partLength > 0) {
+            CCNxNameSegment *segment = ccnxNameSegment_CreateTypeValueArray(CCNxNameLabelType_NAME, partLength, part);
+            ccnxName_Append(name, segment);
+            ccnxNameSegment_Release(&segment);
+        }
+        part += partLength;
+        if (*part == '/') {
+            part++;
+        }
     }
+}
 
-    return ccnxNameSegment_ToString(fileNameSegment); // This memory must be freed by the caller.
+void
+tutorialCommon_AppendChunkSize(CCNxName *name, uint32_t chunkSize)
+{
+    CCNxNameSegment *segment = ccnxNameSegmentNumber_Create(tutorialCommon_ChunkSizeLabelType, chunkSize);
+    ccnxName_Append(name, segment);
+    ccnxNameSegment_Release(&segment);
+}
+
+bool
+tutorialCommon_IsRelativeFilePath(const char *filePath, size_t filePathLength)
+{
+    if (filePathLength == 0 || filePath[0] == '/' || memchr(filePath, '\0', filePathLength) != NULL) {
+        return false;
+    }
+
+    for (size_t start = 0; start <= filePathLength; ) {
+        const char *separator = memchr(filePath + start, '/', filePathLength - start);
+        size_t end = (separator != NULL) ? (size_t) (separator - filePath) : filePathLength;
+        size_t partLength = end - start;
+
+        if (partLength == 0
+            || (partLength == 1 && filePath[start] == '.')
+            || (partLength == 2 && filePath[start] == '.' && filePath[start + 1] == '.')) {
+            return false;
+        }
+        start = end + 1;
+    }
+
+    return true;
 }
 
 char *
@@ -145,8 +305,116 @@ tutorialCommon_CreateCommandStringFromName(const CCNxName *name, const CCNxName
     return ccnxNameSegment_ToString(commandSegment); // This memory must be freed by the caller.
 }
 
+bool
+tutorialCommon_ParseName(const CCNxName *name, const CCNxName *domainPrefix, TutorialNameView *view)
+{
+    size_t segmentCount = ccnxName_GetSegmentCount(name);
+    size_t commandIndex = ccnxName_GetSegmentCount(domainPrefix);
+
+    memset(view, 0, sizeof(*view));
+
+    if (segmentCount <= commandIndex) {
+        return false;
+    }
+
+    // The chunk number, if there is one, is the last segment.
+    size_t endOfFileName = segmentCount;
+    CCNxNameSegment *lastSegment = ccnxName_GetSegment(name, segmentCount - 1);
+    if (ccnxNameSegment_GetType(lastSegment) == CCNxNameLabelType_CHUNK) {
+        view->hasChunkNumber = true;
+        view->chunkNumber = ccnxNameSegmentNumber_Value(lastSegment);
+        endOfFileName--;
+    }
+
+    // The chunk size, if there is one, comes just before the chunk number.
+    if (endOfFileName > commandIndex + 1) {
+        CCNxNameSegment *chunkSizeSegment = ccnxName_GetSegment(name, endOfFileName - 1);
+        if (ccnxNameSegment_GetType(chunkSizeSegment) == tutorialCommon_ChunkSizeLabelType) {
+            view->hasChunkSize = true;
+            view->chunkSize = ccnxNameSegmentNumber_Value(chunkSizeSegment);
+            endOfFileName--;
+        }
+    }
+
+    CCNxNameSegment *commandSegment = ccnxName_GetSegment(name, commandIndex);
+    if (commandIndex >= endOfFileName || ccnxNameSegment_GetType(commandSegment) != CCNxNameLabelType_NAME) {
+        return false;
+    }
+    view->command = _getSegmentBytes(commandSegment, &view->commandLength);
+    view->argumentIndex = commandIndex + 1;
+    view->argumentCount = endOfFileName - commandIndex - 1;
+    view->name = name;
+
+    if (commandIndex + 1 < endOfFileName) {
+        CCNxNameSegment *fileNameSegment = ccnxName_GetSegment(name, commandIndex + 1);
+        if (ccnxNameSegment_GetType(fileNameSegment) == CCNxNameLabelType_NAME) {
+            view->fileName = _getSegmentBytes(fileNameSegment, &view->fileNameLength);
+        }
+    }
+
+    return true;
+}
+
+bool
+tutorialCommon_NameViewHasCommand(const TutorialNameView *view, const char *command)
+{
+    size_t commandLength = strlen(command);
+    return view->commandLength == commandLength && strncasecmp(view->command, command, commandLength) == 0;
+}
+
+bool
+tutorialCommon_NameViewHasFileName(const TutorialNameView *view, const char *fileName)
+{
+    if (view->fileName == NULL) {
+        return false;
+    }
+
+    // Each argument segment must be the next part of the path, and there must be no parts left over.
+    const char *part = fileName;
+    for (size_t i = 0; i < view->argumentCount; i++) {
+        CCNxNameSegment *segment = ccnxName_GetSegment(view->name, view->argumentIndex + i);
+        if (ccnxNameSegment_GetType(segment) != CCNxNameLabelType_NAME) {
+            return false;
+        }
+
+        size_t segmentLength;
+        const char *segmentBytes = _getSegmentBytes(segment, &segmentLength);
+        size_t partLength = strcspn(part, "/");
+        if (partLength != segmentLength || memcmp(part, segmentBytes, partLength) != 0) {
+            return false;
+        }
+
+        part += partLength;
+        if (*part == '/' && i + 1 < view->argumentCount) {
+            part++;
+        }
+    }
+
+    return *part == '\0';
+}
+
+/**
+ * Find the description of the specified option character in a list of program-specific options.
+ *
+ * @return A pointer to the matching TutorialCommonOption, or NULL if there isn't one.
+ */
+static const TutorialCommonOption *
+_findOption(const TutorialCommonOption *options, char option)
+{
+    const TutorialCommonOption *result = NULL;
+
+    for (const TutorialCommonOption *candidate = options; candidate != NULL && candidate->option != '\0'; candidate++) {
+        if (candidate->option == option) {
+            result = candidate;
+            break;
+        }
+    }
+
+    return result;
+}
+
 int
-tutorialCommon_processCommandLineArguments(int argc, char **argv,
+tutorialCommon_processCommandLineArguments(int argc, char **argv, const TutorialCommonOption *options,
                                            int *commandArgCount, char **commandArgs,
                                            bool *needToShowUsage, bool *shouldExit)
 {
@@ -157,6 +425,7 @@ tutorialCommon_processCommandLineArguments(int argc, char **argv,
     for (size_t i = 1; i < argc; i++) {
         char *arg = argv[i];
         if (arg[0] == '-') {
+            const TutorialCommonOption *option = _findOption(options, arg[1]);
             switch (arg[1]) {
                 case 'h': {
                     *needToShowUsage = true;
@@ -168,10 +437,18 @@ tutorialCommon_processCommandLineArguments(int argc, char **argv,
                     *shouldExit = true;
                     break;
                 }
-                default: { // Unexpected '-' option.
-                    *needToShowUsage = true;
-                    *shouldExit = true;
-                    status = EXIT_FAILURE;
+                default: {
+                    if (option != NULL && option->takesValue == false) {
+                        *option->value = arg;
+                    } else if (option != NULL && arg[2] != '\0') { // e.g. "-t4"
+                        *option->value = &arg[2];
+                    } else if (option != NULL && i + 1 < argc) {  // e.g. "-t 4"
+                        *option->value = argv[++i];
+                    } else { // Unexpected '-' option, or a missing value.
+                        *needToShowUsage = true;
+                        *shouldExit = true;
+                        status = EXIT_FAILURE;
+                    }
                     break;
                 }
             }
@@ -32,6 +32,8 @@
 #ifndef tutorial_Common_h
 #define tutorial_Common_h
 
+#include <stdbool.h>
+#include <stddef.h>
 #include <stdint.h>
 
 #include <parc/security/parc_Identity.h>
@@ -55,6 +57,20 @@ extern const char *tutorialCommon_DomainPrefix;
  */
 extern const uint32_t tutorialCommon_ChunkSize;
 
+/**
+ * The largest chunk size the server may use for a file. A ContentObject's payload length is carried in
+ * 16 bits, so this leaves room for the rest of the message. Sizes above 1200 are only suitable where the
+ * path between client and server carries jumbo frames, or is local.
+ */
+extern const uint32_t tutorialCommon_MaximumChunkSize;
+
+/**
+ * The type of the name segment that carries the chunk size a file is fetched with. Clients put it just before
+ * the chunk number of each 'fetch' and 'cfetch' name, with the chunk size they learned from the file's metadata,
+ * so the server splits the file the way the client expects even if it would now choose a different size.
+ */
+extern const CCNxNameLabelType tutorialCommon_ChunkSizeLabelType;
+
 /**
  * The string we use for the 'fetch' command.
  */
@@ -65,9 +81,27 @@ extern const char *tutorialCommon_CommandFetch;
  */
 extern const char *tutorialCommon_CommandList;
 
+/**
+ * The string we use for the 'meta' command, which returns the metadata of a file (its size, chunk size, etc).
+ */
+extern const char *tutorialCommon_CommandMeta;
+
+/**
+ * The string we use for the 'manifest' command, which returns the SHA-256 digest of every chunk of a file.
+ */
+extern const char *tutorialCommon_CommandManifest;
 
 /**
- * Creates and returns a new randomly generated Identity, which is required for signing.
+ * The string we use for the 'cfetch' command, which returns a chunk of a file compressed with the codec named
+ * in the file's metadata. See tutorial_Compression.h.
+ */
+extern const char *tutorialCommon_CommandFetchCompressed;
+
+
+/**
+ * Returns the Identity saved in the specified keystore, which is required for signing. If the keystore
+ * doesn't exist yet, or its self-signed certificate has expired or expires within a week, a new randomly
+ * generated Identity, valid for 30 days, is saved to it first.
  * In a real application, you would actually use a real Identity. The returned instance
  * must eventually be released by calling parcIdentity_Release().
  *
@@ -76,7 +110,7 @@ extern const char *tutorialCommon_CommandList;
  * @param [in] subjectName The name of the owner of the identity.
  *
  *
- * @return A new, randomly generated, PARCIdentity instance.
+ * @return A new PARCIdentity instance.
  */
 PARCIdentity *tutorialCommon_CreateAndGetIdentity(const char *keystoreName, const char *keystorePassword, const char *subjectName);
 
@@ -104,14 +138,46 @@ uint64_t tutorialCommon_GetChunkNumberFromName(const CCNxName *name);
 
 /**
  * Given a CCNxName instance, structured for this tutorial, return a string representation
- * of the file name in the CCNxName. For the tutorial, this is located in the second to
- * last CCnxNameSegment in the CCNxName. The string returned here must eventually be freed
- * by calling parcMemory_Deallocate().
+ * of the file name in the CCNxName. For the tutorial, this is made of the CCNxNameSegments between
+ * the command and the chunk number, joined with '/', so a file in a subdirectory of the directory
+ * being served is named by a segment for each directory, and one for the file. The string returned
+ * here must eventually be freed by calling parcMemory_Deallocate().
  *
  * @param [in] name A CCNxName instance from which to extract the filename.
- * @return A C string representation of the filename encoded in the supplied CCNxName instance.
+ * @param [in] domainPrefix The domain prefix that `name` starts with.
+ * @return A C string representation of the filename encoded in the supplied CCNxName instance,
+ *         or NULL if it doesn't name a file.
+ */
+char *tutorialCommon_CreateFileNameFromName(const CCNxName *name, const CCNxName *domainPrefix);
+
+/**
+ * Append the name of a file to a CCNxName, as a segment for each of the '/'-separated parts of its path,
+ * e.g. "logs/2015/app.log" is appended as the three segments "logs", "2015" and "app.log".
+ *
+ * @param [in,out] name The CCNxName to append to.
+ * @param [in] filePath The path of the file, relative to the directory being served.
+ */
+void tutorialCommon_AppendFilePath(CCNxName *name, const char *filePath);
+
+/**
+ * Append a segment carrying the chunk size a file is fetched with to a CCNxName. See tutorialCommon_ChunkSizeLabelType.
+ *
+ * @param [in,out] name The CCNxName to append to, ending with the name of the file.
+ * @param [in] chunkSize The chunk size to fetch the file with.
+ */
+void tutorialCommon_AppendChunkSize(CCNxName *name, uint32_t chunkSize);
+
+/**
+ * Determine whether a file path, relative to a directory, stays within that directory: it isn't empty or
+ * absolute, and none of its '/'-separated parts is empty, "." or "..". The client checks the names of the files it
+ * is about to write with this, whether they were given on the command line or came from the server's listing.
+ *
+ * @param [in] filePath The path to check. It does not need to be null-terminated.
+ * @param [in] filePathLength The length of `filePath`, in bytes.
+ *
+ * @return true If the path stays within the directory.
  */
-char *tutorialCommon_CreateFileNameFromName(const CCNxName *name);
+bool tutorialCommon_IsRelativeFilePath(const char *filePath, size_t filePathLength);
 
 /**
  * Given a CCNxName instance, structured for this tutorial, return a string representation
@@ -124,14 +190,95 @@ char *tutorialCommon_CreateFileNameFromName(const CCNxName *name);
  */
 char *tutorialCommon_CreateCommandStringFromName(const CCNxName *name, const CCNxName *domainPrefix);
 
+/**
+ * A view of the parts of a tutorial CCNxName: the command (e.g. "fetch"), the file name, if any, the chunk size,
+ * if any, and the chunk number, if any. A name has the form
+ * <domain prefix>/<command>[/<file name>...][/<chunk size>][/chunk=<number>], where the chunk size is a segment
+ * of type tutorialCommon_ChunkSizeLabelType. The segments between the command and the chunk size, or the chunk
+ * number, are the command's arguments; for most commands, they are the name of
+ * the file, one segment for each part of its path. The file name of the view is the first of them, which is the
+ * whole name of a file at the top of the directory being served. The server resolves the rest with a
+ * TutorialPathIndex.
+ *
+ * The command and file name point directly at the bytes of the name's segments. They are not null-terminated,
+ * so they're compared with their lengths and printed with "%.*s". Nothing is allocated, and the view is only
+ * valid for as long as the CCNxName it was parsed from.
+ */
+typedef struct {
+    const char *command;       // The bytes of the command segment.
+    size_t commandLength;
+    const char *fileName;      // The bytes of the file name segment, or NULL if the name has none.
+    size_t fileNameLength;
+    bool hasChunkNumber;
+    uint64_t chunkNumber;      // The chunk number, if hasChunkNumber is true.
+    bool hasChunkSize;
+    uint64_t chunkSize;        // The chunk size the client is fetching with, if hasChunkSize is true. Not checked.
+    size_t argumentIndex;      // The index of the segment following the command.
+    size_t argumentCount;      // The number of segments between the command and the chunk size or chunk number.
+    const CCNxName *name;      // The name the view was parsed from.
+} TutorialNameView;
+
+/**
+ * Parse a CCNxName structured for this tutorial into a TutorialNameView, without allocating any memory.
+ *
+ * @param [in] name A CCNxName instance to parse.
+ * @param [in] domainPrefix The domain prefix that `name` starts with.
+ * @param [out] view Filled in with the parts of the name.
+ *
+ * @return true If the name has a command segment following the domain prefix.
+ * @return false If it doesn't, in which case it isn't a tutorial name.
+ */
+bool tutorialCommon_ParseName(const CCNxName *name, const CCNxName *domainPrefix, TutorialNameView *view);
+
+/**
+ * Determine whether a parsed name's command is the specified command, ignoring case.
+ *
+ * @param [in] view A TutorialNameView filled in by tutorialCommon_ParseName().
+ * @param [in] command The command to compare with, e.g. tutorialCommon_CommandFetch.
+ *
+ * @return true If the command is the same.
+ */
+bool tutorialCommon_NameViewHasCommand(const TutorialNameView *view, const char *command);
+
+/**
+ * Determine whether a parsed name's arguments are the specified file name: one segment for each part of its path,
+ * so "logs/app.log" matches a name ending in /logs/app.log.
+ *
+ * @param [in] view A TutorialNameView filled in by tutorialCommon_ParseName().
+ * @param [in] fileName The file name to compare with.
+ *
+ * @return true If the name has a file name, and it is the same.
+ */
+bool tutorialCommon_NameViewHasFileName(const TutorialNameView *view, const char *fileName);
+
+/**
+ * Describes a program-specific command line option, such as "-m" or "-t 4". An array of these,
+ * terminated by an entry whose `option` is '\0', can be passed to tutorialCommon_processCommandLineArguments().
+ */
+typedef struct {
+    /** The option character, e.g. 'm' for "-m". */
+    char option;
+
+    /** If true, the option requires a value, given either as "-t4" or "-t 4". */
+    bool takesValue;
+
+    /**
+     * Set to the option's value when the option is present on the command line. For an option that doesn't
+     * take a value, this is set to the option argument itself, so a non-NULL value means the option was given.
+     */
+    const char **value;
+} TutorialCommonOption;
+
 /**
  * Process our command line arguments. If we're given '-h' or '-v', we handle them by displaying
- * the usage help or version, respectively. Unexpected will cause a return value of EXIT_FAILURE.
+ * the usage help or version, respectively. Options described by `options` are recognized and their
+ * values stored. Any other '-' option will cause a return value of EXIT_FAILURE.
  * While processing the argument array, we also populate a list of pointers to non '-' arguments
  * and return those in the `commandArgs` parameter.
  *
  * @param [in] argc The count of command line arguments in `argv`.
  * @param [in] argv A pointer to the list of command line argument strings.
+ * @param [in] options An array of program-specific options, terminated by an entry with option '\0'. May be NULL.
  * @param [out] commandArgCount A pointer to a int which will contain the number of non '-' arguments in `argv`.
  * @param [out] commandArgs A pointer to an array of pointers. The pointers will be set to the non '-' arguments
  *                          that were passed in in `argv`.
@@ -142,7 +289,7 @@ char *tutorialCommon_CreateCommandStringFromName(const CCNxName *name, const CCN
  *
  * @return EXIT_FAILURE if an unexpected '-' option was encountered. EXIT_SUCCESS otherwise.
  */
-int tutorialCommon_processCommandLineArguments(int argc, char **argv,
+int tutorialCommon_processCommandLineArguments(int argc, char **argv, const TutorialCommonOption *options,
                                                int *commandArgCount, char **commandArgs,
                                                bool *needToShowUsage, bool *shouldExit);
 #endif // tutorial_Common.h
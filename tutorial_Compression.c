@@ -0,0 +1,292 @@
+/*
+ * Copyright (c) 2014-2015, Xerox Corporation (Xerox)and Palo Alto Research Center (PARC)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Patent rights are not granted under this agreement. Patent rights are
+ *       available under FRAND terms.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL XEROX or PARC BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+/**
+ * @author Alan Walendowski, Palo Alto Research Center (Xerox PARC)
+ * @copyright 2014-2015, Xerox Corporation (Xerox)and Palo Alto Research Center (PARC).  All rights reserved.
+ */
+#include <pthread.h>
+#include <string.h>
+#include <strings.h>
+
+#ifdef TUTORIAL_USE_ZSTD
+#include <zstd.h>
+#endif
+#ifdef TUTORIAL_USE_LZ4
+#include <lz4.h>
+#endif
+
+#include <LongBow/runtime.h>
+#include <parc/algol/parc_Memory.h>
+
+#include "tutorial_Compression.h"
+
+// A sample has to compress to this fraction of its size or less for its file to be worth compressing.
+static const double _probeThreshold = 0.9;
+
+#ifdef TUTORIAL_USE_ZSTD
+// The fastest zstd level. The chunks are small, and the server compresses them as they are asked for.
+static const int _zstdLevel = 1;
+
+// zstd contexts are large and slow to set up, so each thread keeps one of each for as long as it runs.
+static pthread_once_t _zstdContextKeyOnce = PTHREAD_ONCE_INIT;
+static pthread_key_t _zstdCompressionContextKey;
+static pthread_key_t _zstdDecompressionContextKey;
+
+static void
+_freeZstdCompressionContext(void *context)
+{
+    ZSTD_freeCCtx(context);
+}
+
+static void
+_freeZstdDecompressionContext(void *context)
+{
+    ZSTD_freeDCtx(context);
+}
+
+static void
+_createZstdContextKeys(void)
+{
+    pthread_key_create(&_zstdCompressionContextKey, _freeZstdCompressionContext);
+    pthread_key_create(&_zstdDecompressionContextKey, _freeZstdDecompressionContext);
+}
+
+static ZSTD_CCtx *
+_getZstdCompressionContext(void)
+{
+    pthread_once(&_zstdContextKeyOnce, _createZstdContextKeys);
+    ZSTD_CCtx *result = pthread_getspecific(_zstdCompressionContextKey);
+    if (result == NULL) {
+        result = ZSTD_createCCtx();
+        assertNotNull(result, "ZSTD_createCCtx() returned NULL");
+        pthread_setspecific(_zstdCompressionContextKey, result);
+    }
+    return result;
+}
+
+static ZSTD_DCtx *
+_getZstdDecompressionContext(void)
+{
+    pthread_once(&_zstdContextKeyOnce, _createZstdContextKeys);
+    ZSTD_DCtx *result = pthread_getspecific(_zstdDecompressionContextKey);
+    if (result == NULL) {
+        result = ZSTD_createDCtx();
+        assertNotNull(result, "ZSTD_createDCtx() returned NULL");
+        pthread_setspecific(_zstdDecompressionContextKey, result);
+    }
+    return result;
+}
+#endif
+
+/**
+ * Return the most bytes that compressing `length` bytes with the specified codec can produce.
+ */
+static size_t
+_getCompressBound(TutorialCompressionCodec codec, size_t length)
+{
+#ifdef TUTORIAL_USE_ZSTD
+    if (codec == TutorialCompressionCodec_Zstd) {
+        return ZSTD_compressBound(length);
+    }
+#endif
+#ifdef TUTORIAL_USE_LZ4
+    if (codec == TutorialCompressionCodec_Lz4) {
+        return (size_t) LZ4_compressBound((int) length);
+    }
+#endif
+    return length;
+}
+
+/**
+ * Compress `length` bytes into `compressed`, which has room for `capacity` bytes.
+ *
+ * @return The length of the compressed bytes, or 0 if they couldn't be compressed.
+ */
+static size_t
+_compress(TutorialCompressionCodec codec, const uint8_t *bytes, size_t length, uint8_t *compressed, size_t capacity)
+{
+#ifdef TUTORIAL_USE_ZSTD
+    if (codec == TutorialCompressionCodec_Zstd) {
+        size_t result = ZSTD_compressCCtx(_getZstdCompressionContext(), compressed, capacity, bytes, length, _zstdLevel);
+        return ZSTD_isError(result) ? 0 : result;
+    }
+#endif
+#ifdef TUTORIAL_USE_LZ4
+    if (codec == TutorialCompressionCodec_Lz4) {
+        int result = LZ4_compress_default((const char *) bytes, (char *) compressed, (int) length, (int) capacity);
+        return (result > 0) ? (size_t) result : 0;
+    }
+#endif
+    return 0;
+}
+
+/**
+ * Decompress `length` bytes into `bytes`, which has room for `capacity` bytes.
+ *
+ * @return true If the bytes were decompressed, and `*decompressedLength` was set to their length.
+ */
+static bool
+_decompress(TutorialCompressionCodec codec, const uint8_t *compressed, size_t length, uint8_t *bytes, size_t capacity,
+            size_t *decompressedLength)
+{
+#ifdef TUTORIAL_USE_ZSTD
+    if (codec == TutorialCompressionCodec_Zstd) {
+        size_t result = ZSTD_decompressDCtx(_getZstdDecompressionContext(), bytes, capacity, compressed, length);
+        *decompressedLength = result;
+        return ZSTD_isError(result) == 0;
+    }
+#endif
+#ifdef TUTORIAL_USE_LZ4
+    if (codec == TutorialCompressionCodec_Lz4) {
+        int result = LZ4_decompress_safe((const char *) compressed, (char *) bytes, (int) length, (int) capacity);
+        *decompressedLength = (result >= 0) ? (size_t) result : 0;
+        return result >= 0;
+    }
+#endif
+    return false;
+}
+
+const char *
+tutorialCompression_GetCodecName(TutorialCompressionCodec codec)
+{
+    switch (codec) {
+        case TutorialCompressionCodec_Zstd:
+            return "zstd";
+        case TutorialCompressionCodec_Lz4:
+            return "lz4";
+        default:
+            return "none";
+    }
+}
+
+bool
+tutorialCompression_FindCodec(const char *name, TutorialCompressionCodec *codec)
+{
+    const TutorialCompressionCodec codecs[] = { TutorialCompressionCodec_Zstd, TutorialCompressionCodec_Lz4 };
+
+    for (size_t i = 0; i < sizeof(codecs) / sizeof(codecs[0]); i++) {
+        if (strcasecmp(name, tutorialCompression_GetCodecName(codecs[i])) == 0 && tutorialCompression_IsCodecAvailable(codecs[i])) {
+            *codec = codecs[i];
+            return true;
+        }
+    }
+    return false;
+}
+
+bool
+tutorialCompression_IsCodecAvailable(TutorialCompressionCodec codec)
+{
+    switch (codec) {
+        case TutorialCompressionCodec_None:
+            return true;
+#ifdef TUTORIAL_USE_ZSTD
+        case TutorialCompressionCodec_Zstd:
+            return true;
+#endif
+#ifdef TUTORIAL_USE_LZ4
+        case TutorialCompressionCodec_Lz4:
+            return true;
+#endif
+        default:
+            return false;
+    }
+}
+
+TutorialCompressionCodec
+tutorialCompression_ProbeCodec(TutorialCompressionCodec codec, const PARCBuffer *sample)
+{
+    size_t length = parcBuffer_Remaining(sample);
+    if (codec == TutorialCompressionCodec_None || tutorialCompression_IsCodecAvailable(codec) == false || length == 0) {
+        return TutorialCompressionCodec_None;
+    }
+
+    size_t capacity = _getCompressBound(codec, length);
+    uint8_t *compressed = parcMemory_Allocate(capacity);
+    assertNotNull(compressed, "parcMemory_Allocate(%zu) returned NULL", capacity);
+
+    size_t compressedLength = _compress(codec, parcBuffer_Overlay((PARCBuffer *) sample, 0), length, compressed, capacity);
+    parcMemory_Deallocate((void **) &compressed);
+
+    bool isWorthCompressing = compressedLength > 0 && compressedLength <= length * _probeThreshold;
+    return isWorthCompressing ? codec : TutorialCompressionCodec_None;
+}
+
+PARCBuffer *
+tutorialCompression_CompressChunk(TutorialCompressionCodec codec, const PARCBuffer *chunk)
+{
+    const uint8_t *bytes = parcBuffer_Overlay((PARCBuffer *) chunk, 0); // We're un-const'ing for parcBuffer_Overlay, but we do not change the buffer state.
+    size_t length = parcBuffer_Remaining(chunk);
+
+    size_t capacity = 1 + ((codec != TutorialCompressionCodec_None) ? _getCompressBound(codec, length) : 0);
+    if (capacity < 1 + length) {
+        capacity = 1 + length;
+    }
+
+    PARCBuffer *result = parcBuffer_Allocate(capacity);
+    uint8_t *payload = parcBuffer_Overlay(result, 0);
+
+    size_t compressedLength = _compress(codec, bytes, length, payload + 1, capacity - 1);
+    if (compressedLength > 0 && compressedLength < length) {
+        payload[0] = (uint8_t) codec;
+    } else {
+        // It didn't get any smaller, so store it as it is.
+        payload[0] = (uint8_t) TutorialCompressionCodec_None;
+        memcpy(payload + 1, bytes, length);
+        compressedLength = length;
+    }
+
+    parcBuffer_SetLimit(result, 1 + compressedLength);
+    return result;
+}
+
+PARCBuffer *
+tutorialCompression_DecompressChunk(const PARCBuffer *payload, size_t maximumLength)
+{
+    const uint8_t *bytes = parcBuffer_Overlay((PARCBuffer *) payload, 0); // We're un-const'ing for parcBuffer_Overlay, but we do not change the buffer state.
+    size_t length = parcBuffer_Remaining(payload);
+
+    if (length == 0) {
+        return NULL;
+    }
+
+    TutorialCompressionCodec codec = (TutorialCompressionCodec) bytes[0];
+    if (codec == TutorialCompressionCodec_None) {
+        return (length - 1 <= maximumLength) ? parcBuffer_CreateFromArray(bytes + 1, length - 1) : NULL;
+    }
+    if (tutorialCompression_IsCodecAvailable(codec) == false) {
+        return NULL;
+    }
+
+    PARCBuffer *result = parcBuffer_Allocate(maximumLength);
+    size_t decompressedLength = 0;
+    if (_decompress(codec, bytes + 1, length - 1, parcBuffer_Overlay(result, 0), maximumLength, &decompressedLength)) {
+        parcBuffer_SetLimit(result, decompressedLength);
+    } else {
+        parcBuffer_Release(&result);
+    }
+    return result;
+}
@@ -0,0 +1,116 @@
+/*
+ * Copyright (c) 2014-2015, Xerox Corporation (Xerox)and Palo Alto Research Center (PARC)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Patent rights are not granted under this agreement. Patent rights are
+ *       available under FRAND terms.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL XEROX or PARC BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+/**
+ * @author Alan Walendowski, Palo Alto Research Center (Xerox PARC)
+ * @copyright 2014-2015, Xerox Corporation (Xerox)and Palo Alto Research Center (PARC).  All rights reserved.
+ */
+
+#ifndef tutorial_Compression_h
+#define tutorial_Compression_h
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include <parc/algol/parc_Buffer.h>
+
+/**
+ * The codecs the chunks of a file may be compressed with. Codecs are only available if the tutorial was built with
+ * their libraries: 'make USE_ZSTD=1' for zstd and 'make USE_LZ4=1' for LZ4.
+ *
+ * These values are sent in a file's metadata and in every compressed chunk, so they must never change.
+ */
+typedef enum {
+    TutorialCompressionCodec_None = 0,
+    TutorialCompressionCodec_Zstd = 1,
+    TutorialCompressionCodec_Lz4 = 2
+} TutorialCompressionCodec;
+
+/**
+ * Get the name of the specified codec, e.g. "zstd".
+ *
+ * @param [in] codec A TutorialCompressionCodec.
+ *
+ * @return The codec's name, or "none".
+ */
+const char *tutorialCompression_GetCodecName(TutorialCompressionCodec codec);
+
+/**
+ * Find the codec with the specified name, as given on the command line.
+ *
+ * @param [in] name The name of a codec, e.g. "lz4".
+ * @param [out] codec Set to the codec.
+ *
+ * @return true If the name is a codec this build of the tutorial can compress and decompress with.
+ */
+bool tutorialCompression_FindCodec(const char *name, TutorialCompressionCodec *codec);
+
+/**
+ * Determine whether this build of the tutorial can compress and decompress with the specified codec.
+ *
+ * @param [in] codec A TutorialCompressionCodec.
+ *
+ * @return true If the codec is available. TutorialCompressionCodec_None always is.
+ */
+bool tutorialCompression_IsCodecAvailable(TutorialCompressionCodec codec);
+
+/**
+ * Decide whether a file is worth compressing, by compressing a sample of it (e.g. its first few chunks) and seeing
+ * how much smaller it gets. Text, logs and CSV files typically shrink to a third of their size or less, while files
+ * that are already compressed, such as images and archives, don't shrink at all.
+ *
+ * @param [in] codec The codec the file would be compressed with.
+ * @param [in] sample A PARCBuffer containing a sample of the file, from its position to its limit.
+ *
+ * @return `codec` If the sample shrank enough to be worth compressing the file, otherwise TutorialCompressionCodec_None.
+ */
+TutorialCompressionCodec tutorialCompression_ProbeCodec(TutorialCompressionCodec codec, const PARCBuffer *sample);
+
+/**
+ * Create the payload of a compressed chunk. Its first byte is the codec the rest of it is compressed with. A chunk
+ * that doesn't get any smaller is stored as it is, after a TutorialCompressionCodec_None byte, so every chunk of a
+ * file can be fetched compressed, whether or not that part of the file compresses. The returned buffer must
+ * eventually be released by calling parcBuffer_Release().
+ *
+ * @param [in] codec The codec to compress with.
+ * @param [in] chunk A PARCBuffer containing the chunk, from its position to its limit. Its position is not changed.
+ *
+ * @return A new PARCBuffer, ready to be read.
+ */
+PARCBuffer *tutorialCompression_CompressChunk(TutorialCompressionCodec codec, const PARCBuffer *chunk);
+
+/**
+ * Recover a chunk from the payload of a compressed chunk created by tutorialCompression_CompressChunk().
+ * The returned buffer must eventually be released by calling parcBuffer_Release().
+ *
+ * @param [in] payload A PARCBuffer containing the compressed chunk, from its position to its limit.
+ * @param [in] maximumLength The largest the chunk can be: the file's chunk size.
+ *
+ * @return A new PARCBuffer containing the chunk, or NULL if the payload is damaged, larger than `maximumLength`
+ *         when decompressed, or uses a codec this build doesn't have.
+ */
+PARCBuffer *tutorialCompression_DecompressChunk(const PARCBuffer *payload, size_t maximumLength);
+#endif // tutorial_Compression_h
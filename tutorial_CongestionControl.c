@@ -0,0 +1,258 @@
+/*
+ * Copyright (c) 2014-2015, Xerox Corporation (Xerox)and Palo Alto Research Center (PARC)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Patent rights are not granted under this agreement. Patent rights are
+ *       available under FRAND terms.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL XEROX or PARC BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+/**
+ * @author Alan Walendowski, Palo Alto Research Center (Xerox PARC)
+ * @copyright 2014-2015, Xerox Corporation (Xerox)and Palo Alto Research Center (PARC).  All rights reserved.
+ */
+#include <string.h>
+#include <strings.h>
+
+#include <LongBow/runtime.h>
+#include <parc/algol/parc_Memory.h>
+
+#include "tutorial_CongestionControl.h"
+
+/**
+ * The state shared by the algorithms. Each algorithm uses only the fields it needs.
+ */
+typedef struct {
+    double window;
+    double slowStartThreshold;
+    double maximumWindow;
+
+    uint64_t smoothedRoundTrip;
+    uint64_t minimumRoundTrip;
+    uint64_t periodMinimumRoundTrip;  // The smallest round trip seen since periodStartedAt.
+    uint64_t periodStartedAt;
+    uint64_t lastDecreaseAt;
+} _TutorialCongestionState;
+
+// The window a fetcher starts with, before it has seen any responses.
+static const double _initialWindow = 2.0;
+
+// The delay-based algorithm aims to keep between _alpha and _beta of its Interests queued in the network.
+static const double _alpha = 2.0;
+static const double _beta = 4.0;
+
+// The delay-based algorithm replaces its minimum round trip time with the smallest one seen in the last
+// period of this length, in case the path has changed.
+static const uint64_t _minimumRoundTripLifetime = 10000000;
+
+static void *
+_create(size_t maximumWindow)
+{
+    assertTrue(maximumWindow > 0, "The maximum window must be greater than 0");
+
+    _TutorialCongestionState *result = parcMemory_AllocateAndClear(sizeof(_TutorialCongestionState));
+    assertNotNull(result, "parcMemory_AllocateAndClear(%zu) returned NULL", sizeof(_TutorialCongestionState));
+
+    result->maximumWindow = (double) maximumWindow;
+    result->window = (_initialWindow < result->maximumWindow) ? _initialWindow : result->maximumWindow;
+    result->slowStartThreshold = result->maximumWindow;
+
+    return result;
+}
+
+static void
+_release(void **stateP)
+{
+    parcMemory_Deallocate(stateP);
+}
+
+static size_t
+_getWindow(const void *stateArg)
+{
+    const _TutorialCongestionState *state = stateArg;
+    return (state->window < 1.0) ? 1 : (size_t) state->window;
+}
+
+static void
+_setWindow(_TutorialCongestionState *state, double window)
+{
+    if (window < 1.0) {
+        window = 1.0;
+    } else if (window > state->maximumWindow) {
+        window = state->maximumWindow;
+    }
+    state->window = window;
+}
+
+static void
+_updateSmoothedRoundTrip(_TutorialCongestionState *state, uint64_t roundTrip)
+{
+    if (roundTrip > 0) {
+        state->smoothedRoundTrip = (state->smoothedRoundTrip == 0) ? roundTrip : (7 * state->smoothedRoundTrip + roundTrip) / 8;
+    }
+}
+
+/**
+ * Reduce the window by the given factor, but only once per round trip, since a burst of timeouts is
+ * usually a single congestion event.
+ */
+static void
+_decreaseWindow(_TutorialCongestionState *state, double factor, uint64_t now)
+{
+    if (now - state->lastDecreaseAt >= state->smoothedRoundTrip) {
+        state->slowStartThreshold = (state->window * factor > 2.0) ? state->window * factor : 2.0;
+        _setWindow(state, state->slowStartThreshold);
+        state->lastDecreaseAt = now;
+    }
+}
+
+// Fixed
+
+static void
+_fixedOnResponse(void *stateArg, uint64_t roundTrip, uint64_t now)
+{
+}
+
+static void
+_fixedOnTimeout(void *stateArg, uint64_t now)
+{
+}
+
+static size_t
+_fixedGetWindow(const void *stateArg)
+{
+    const _TutorialCongestionState *state = stateArg;
+    return (size_t) state->maximumWindow;
+}
+
+const TutorialCongestionControl tutorialCongestionControl_Fixed = {
+    .name       = "fixed",
+    .create     = _create,
+    .release    = _release,
+    .onResponse = _fixedOnResponse,
+    .onTimeout  = _fixedOnTimeout,
+    .getWindow  = _fixedGetWindow
+};
+
+// AIMD
+
+static void
+_aimdOnResponse(void *stateArg, uint64_t roundTrip, uint64_t now)
+{
+    _TutorialCongestionState *state = stateArg;
+
+    _updateSmoothedRoundTrip(state, roundTrip);
+
+    if (state->window < state->slowStartThreshold) {
+        _setWindow(state, state->window + 1.0);                   // Slow start: double every round trip.
+    } else {
+        _setWindow(state, state->window + 1.0 / state->window);   // Congestion avoidance: one more per round trip.
+    }
+}
+
+static void
+_aimdOnTimeout(void *stateArg, uint64_t now)
+{
+    _decreaseWindow(stateArg, 0.5, now);
+}
+
+const TutorialCongestionControl tutorialCongestionControl_AIMD = {
+    .name       = "aimd",
+    .create     = _create,
+    .release    = _release,
+    .onResponse = _aimdOnResponse,
+    .onTimeout  = _aimdOnTimeout,
+    .getWindow  = _getWindow
+};
+
+// Delay-based
+
+static void
+_delayOnResponse(void *stateArg, uint64_t roundTrip, uint64_t now)
+{
+    _TutorialCongestionState *state = stateArg;
+
+    if (roundTrip == 0) {
+        return; // No measurement, so nothing to go on.
+    }
+
+    _updateSmoothedRoundTrip(state, roundTrip);
+
+    if (state->periodMinimumRoundTrip == 0 || roundTrip < state->periodMinimumRoundTrip) {
+        state->periodMinimumRoundTrip = roundTrip;
+    }
+    if (state->minimumRoundTrip == 0 || roundTrip < state->minimumRoundTrip) {
+        state->minimumRoundTrip = roundTrip;
+    }
+    if (now - state->periodStartedAt > _minimumRoundTripLifetime) {
+        state->minimumRoundTrip = state->periodMinimumRoundTrip;
+        state->periodMinimumRoundTrip = roundTrip;
+        state->periodStartedAt = now;
+    }
+
+    // The number of our Interests (or their responses) sitting in queues: the window, times the fraction
+    // of the round trip that is spent queueing rather than travelling.
+    double queued = state->window * (1.0 - (double) state->minimumRoundTrip / (double) state->smoothedRoundTrip);
+
+    if (state->window < state->slowStartThreshold && queued < _alpha) {
+        _setWindow(state, state->window + 1.0);
+    } else {
+        if (state->window < state->slowStartThreshold) {
+            state->slowStartThreshold = state->window; // Queues are starting to build. Leave slow start.
+        }
+        if (queued < _alpha) {
+            _setWindow(state, state->window + 1.0 / state->window);
+        } else if (queued > _beta) {
+            _setWindow(state, state->window - 1.0 / state->window);
+        }
+    }
+}
+
+static void
+_delayOnTimeout(void *stateArg, uint64_t now)
+{
+    _decreaseWindow(stateArg, 0.7, now);
+}
+
+const TutorialCongestionControl tutorialCongestionControl_Delay = {
+    .name       = "delay",
+    .create     = _create,
+    .release    = _release,
+    .onResponse = _delayOnResponse,
+    .onTimeout  = _delayOnTimeout,
+    .getWindow  = _getWindow
+};
+
+const TutorialCongestionControl *
+tutorialCongestionControl_FindByName(const char *name)
+{
+    static const TutorialCongestionControl *algorithms[] = {
+        &tutorialCongestionControl_Fixed,
+        &tutorialCongestionControl_AIMD,
+        &tutorialCongestionControl_Delay,
+    };
+
+    for (size_t i = 0; i < sizeof(algorithms) / sizeof(algorithms[0]); i++) {
+        if (strcasecmp(name, algorithms[i]->name) == 0) {
+            return algorithms[i];
+        }
+    }
+    return NULL;
+}
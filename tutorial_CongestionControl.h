@@ -0,0 +1,99 @@
+/*
+ * Copyright (c) 2014-2015, Xerox Corporation (Xerox)and Palo Alto Research Center (PARC)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Patent rights are not granted under this agreement. Patent rights are
+ *       available under FRAND terms.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL XEROX or PARC BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+/**
+ * @author Alan Walendowski, Palo Alto Research Center (Xerox PARC)
+ * @copyright 2014-2015, Xerox Corporation (Xerox)and Palo Alto Research Center (PARC).  All rights reserved.
+ */
+
+#ifndef tutorial_CongestionControl_h
+#define tutorial_CongestionControl_h
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * A TutorialCongestionControl is a congestion control algorithm for a TutorialFetcher. It decides how many
+ * Interests the fetcher may have outstanding, based on the responses and timeouts the fetcher reports to it.
+ * Each algorithm is a table of functions operating on its own private state, so new algorithms can be added
+ * without changing the fetcher.
+ *
+ * Three algorithms are provided:
+ *  - "fixed" always allows the maximum window.
+ *  - "aimd" grows the window by one Interest per response in slow start, then by one Interest per round trip,
+ *    and halves it when an Interest times out.
+ *  - "delay" estimates how many of its Interests are queued in the network from the growth of the round trip
+ *    time above the smallest one seen (as TCP Vegas does), and keeps that number small. It backs off before
+ *    forwarder queues build up, which lets many clients share a link without inflating each other's delay.
+ */
+typedef struct {
+    /** The name used to select the algorithm, e.g. "aimd". */
+    const char *name;
+
+    /** Create the algorithm's state for a fetcher whose window may not exceed `maximumWindow`. */
+    void *(*create)(size_t maximumWindow);
+
+    /** Release the state created by `create`, and set `*stateP` to NULL. */
+    void (*release)(void **stateP);
+
+    /**
+     * Called for each response to an outstanding Interest. `roundTripMicroseconds` is 0 if the Interest
+     * had been retransmitted, as its round trip can't be measured.
+     */
+    void (*onResponse)(void *state, uint64_t roundTripMicroseconds, uint64_t nowMicroseconds);
+
+    /** Called each time an outstanding Interest times out. */
+    void (*onTimeout)(void *state, uint64_t nowMicroseconds);
+
+    /** Return the number of Interests that may currently be outstanding. Always at least 1. */
+    size_t (*getWindow)(const void *state);
+} TutorialCongestionControl;
+
+/**
+ * An algorithm that always allows `maximumWindow` Interests outstanding.
+ */
+extern const TutorialCongestionControl tutorialCongestionControl_Fixed;
+
+/**
+ * Additive increase, multiplicative decrease, with slow start.
+ */
+extern const TutorialCongestionControl tutorialCongestionControl_AIMD;
+
+/**
+ * A delay-based algorithm that keeps the number of its Interests queued in the network small.
+ */
+extern const TutorialCongestionControl tutorialCongestionControl_Delay;
+
+/**
+ * Find a congestion control algorithm by name.
+ *
+ * @param [in] name The name of the algorithm, e.g. "aimd".
+ *
+ * @return The algorithm with the given name, or NULL if there is none.
+ */
+const TutorialCongestionControl *tutorialCongestionControl_FindByName(const char *name);
+#endif // tutorial_CongestionControl_h
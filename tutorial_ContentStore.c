@@ -0,0 +1,281 @@
+/*
+ * Copyright (c) 2014-2015, Xerox Corporation (Xerox)and Palo Alto Research Center (PARC)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Patent rights are not granted under this agreement. Patent rights are
+ *       available under FRAND terms.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL XEROX or PARC BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+/**
+ * @author Alan Walendowski, Palo Alto Research Center (Xerox PARC)
+ * @copyright 2014-2015, Xerox Corporation (Xerox)and Palo Alto Research Center (PARC).  All rights reserved.
+ */
+#include <pthread.h>
+
+#include <LongBow/runtime.h>
+#include <parc/algol/parc_Memory.h>
+
+#include "tutorial_ContentStore.h"
+#include "tutorial_FileIO.h"
+
+const size_t tutorialContentStore_DefaultByteBudget = 64 * 1024 * 1024;
+
+/**
+ * An estimate of the memory used by a ContentObject besides its payload (its name, dictionary, etc).
+ */
+static const size_t _contentObjectOverhead = 256;
+
+typedef struct tutorial_content_store_entry {
+    CCNxContentObject *contentObject;
+    CCNxName *name;          // Borrowed from contentObject.
+    uint32_t nameHash;
+    size_t size;             // Bytes charged against the store's budget.
+
+    TutorialFileVersion sourceVersion; // Of the file this ContentObject was built from, when it was built.
+
+    struct tutorial_content_store_entry *nextInBucket;
+
+    // The LRU list. The most recently used entry is at the head.
+    struct tutorial_content_store_entry *newer;
+    struct tutorial_content_store_entry *older;
+} _TutorialContentStoreEntry;
+
+struct tutorial_content_store {
+    pthread_mutex_t lock;
+
+    _TutorialContentStoreEntry **buckets;
+    size_t bucketCount;      // Always a power of 2.
+
+    _TutorialContentStoreEntry *newest;
+    _TutorialContentStoreEntry *oldest;
+
+    size_t count;
+    size_t byteCount;
+    size_t byteBudget;
+};
+
+static _TutorialContentStoreEntry **
+_bucketForHash(const TutorialContentStore *store, uint32_t nameHash)
+{
+    return &store->buckets[nameHash & (store->bucketCount - 1)];
+}
+
+static void
+_unlinkFromLRU(TutorialContentStore *store, _TutorialContentStoreEntry *entry)
+{
+    if (entry->newer != NULL) {
+        entry->newer->older = entry->older;
+    } else {
+        store->newest = entry->older;
+    }
+    if (entry->older != NULL) {
+        entry->older->newer = entry->newer;
+    } else {
+        store->oldest = entry->newer;
+    }
+    entry->newer = entry->older = NULL;
+}
+
+static void
+_linkAsNewest(TutorialContentStore *store, _TutorialContentStoreEntry *entry)
+{
+    entry->older = store->newest;
+    entry->newer = NULL;
+    if (store->newest != NULL) {
+        store->newest->newer = entry;
+    }
+    store->newest = entry;
+    if (store->oldest == NULL) {
+        store->oldest = entry;
+    }
+}
+
+/**
+ * Remove the entry from the hash table and the LRU list, and release it.
+ */
+static void
+_removeEntry(TutorialContentStore *store, _TutorialContentStoreEntry *entry)
+{
+    _TutorialContentStoreEntry **link = _bucketForHash(store, entry->nameHash);
+    while (*link != entry) {
+        link = &(*link)->nextInBucket;
+    }
+    *link = entry->nextInBucket;
+
+    _unlinkFromLRU(store, entry);
+
+    store->count--;
+    store->byteCount -= entry->size;
+
+    ccnxContentObject_Release(&entry->contentObject);
+    parcMemory_Deallocate((void **) &entry);
+}
+
+static _TutorialContentStoreEntry *
+_findEntry(const TutorialContentStore *store, const CCNxName *name, uint32_t nameHash)
+{
+    _TutorialContentStoreEntry *entry = *_bucketForHash(store, nameHash);
+    while (entry != NULL && (entry->nameHash != nameHash || ccnxName_Equals(entry->name, name) == false)) {
+        entry = entry->nextInBucket;
+    }
+    return entry;
+}
+
+/**
+ * Double the number of hash buckets, so the chains stay short as the store fills.
+ */
+static void
+_growBuckets(TutorialContentStore *store)
+{
+    size_t oldBucketCount = store->bucketCount;
+    _TutorialContentStoreEntry **oldBuckets = store->buckets;
+
+    store->bucketCount = oldBucketCount * 2;
+    store->buckets = parcMemory_AllocateAndClear(store->bucketCount * sizeof(_TutorialContentStoreEntry *));
+    assertNotNull(store->buckets, "parcMemory_AllocateAndClear(%zu) returned NULL", store->bucketCount * sizeof(_TutorialContentStoreEntry *));
+
+    for (size_t i = 0; i < oldBucketCount; i++) {
+        _TutorialContentStoreEntry *entry = oldBuckets[i];
+        while (entry != NULL) {
+            _TutorialContentStoreEntry *next = entry->nextInBucket;
+            _TutorialContentStoreEntry **bucket = _bucketForHash(store, entry->nameHash);
+            entry->nextInBucket = *bucket;
+            *bucket = entry;
+            entry = next;
+        }
+    }
+
+    parcMemory_Deallocate((void **) &oldBuckets);
+}
+
+static bool
+_isEntryValid(const _TutorialContentStoreEntry *entry, const struct stat *sourceInfo)
+{
+    return tutorialFileIO_IsFileVersion(&entry->sourceVersion, sourceInfo);
+}
+
+TutorialContentStore *
+tutorialContentStore_Create(size_t byteBudget)
+{
+    TutorialContentStore *result = parcMemory_AllocateAndClear(sizeof(TutorialContentStore));
+    assertNotNull(result, "parcMemory_AllocateAndClear(%zu) returned NULL", sizeof(TutorialContentStore));
+
+    result->bucketCount = 1024;
+    result->buckets = parcMemory_AllocateAndClear(result->bucketCount * sizeof(_TutorialContentStoreEntry *));
+    assertNotNull(result->buckets, "parcMemory_AllocateAndClear(%zu) returned NULL", result->bucketCount * sizeof(_TutorialContentStoreEntry *));
+
+    result->byteBudget = byteBudget;
+
+    pthread_mutex_init(&result->lock, NULL);
+
+    return result;
+}
+
+void
+tutorialContentStore_Release(TutorialContentStore **storeP)
+{
+    TutorialContentStore *store = *storeP;
+
+    while (store->oldest != NULL) {
+        _removeEntry(store, store->oldest);
+    }
+
+    pthread_mutex_destroy(&store->lock);
+
+    parcMemory_Deallocate((void **) &store->buckets);
+    parcMemory_Deallocate((void **) storeP);
+}
+
+CCNxContentObject *
+tutorialContentStore_Get(TutorialContentStore *store, const CCNxName *name, const struct stat *sourceInfo)
+{
+    CCNxContentObject *result = NULL;
+    uint32_t nameHash = ccnxName_HashCode(name);
+
+    pthread_mutex_lock(&store->lock);
+
+    _TutorialContentStoreEntry *entry = _findEntry(store, name, nameHash);
+
+    if (entry != NULL && _isEntryValid(entry, sourceInfo) == false) {
+        _removeEntry(store, entry); // The file has changed since this was built.
+    } else if (entry != NULL) {
+        _unlinkFromLRU(store, entry);
+        _linkAsNewest(store, entry);
+        result = ccnxContentObject_Acquire(entry->contentObject);
+    }
+
+    pthread_mutex_unlock(&store->lock);
+
+    return result;
+}
+
+void
+tutorialContentStore_Put(TutorialContentStore *store, const CCNxContentObject *contentObject, const struct stat *sourceInfo)
+{
+    CCNxName *name = ccnxContentObject_GetName(contentObject);
+    uint32_t nameHash = ccnxName_HashCode(name);
+
+    PARCBuffer *payload = ccnxContentObject_GetPayload(contentObject);
+    size_t size = _contentObjectOverhead + (payload != NULL ? parcBuffer_Remaining(payload) : 0);
+
+    pthread_mutex_lock(&store->lock);
+
+    _TutorialContentStoreEntry *existing = _findEntry(store, name, nameHash);
+    if (existing != NULL) {
+        _removeEntry(store, existing);
+    }
+
+    if (size <= store->byteBudget) {
+        while (store->byteCount + size > store->byteBudget) {
+            _removeEntry(store, store->oldest);
+        }
+
+        if (store->count >= store->bucketCount) {
+            _growBuckets(store);
+        }
+
+        _TutorialContentStoreEntry *entry = parcMemory_AllocateAndClear(sizeof(_TutorialContentStoreEntry));
+        assertNotNull(entry, "parcMemory_AllocateAndClear(%zu) returned NULL", sizeof(_TutorialContentStoreEntry));
+
+        entry->contentObject = ccnxContentObject_Acquire(contentObject);
+        entry->name = ccnxContentObject_GetName(entry->contentObject);
+        entry->nameHash = nameHash;
+        entry->size = size;
+        tutorialFileIO_GetFileVersion(sourceInfo, &entry->sourceVersion);
+
+        _TutorialContentStoreEntry **bucket = _bucketForHash(store, nameHash);
+        entry->nextInBucket = *bucket;
+        *bucket = entry;
+
+        _linkAsNewest(store, entry);
+
+        store->count++;
+        store->byteCount += size;
+    }
+
+    pthread_mutex_unlock(&store->lock);
+}
+
+size_t
+tutorialContentStore_Count(const TutorialContentStore *store)
+{
+    return store->count;
+}
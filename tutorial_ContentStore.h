@@ -0,0 +1,109 @@
+/*
+ * Copyright (c) 2014-2015, Xerox Corporation (Xerox)and Palo Alto Research Center (PARC)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Patent rights are not granted under this agreement. Patent rights are
+ *       available under FRAND terms.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL XEROX or PARC BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+/**
+ * @author Alan Walendowski, Palo Alto Research Center (Xerox PARC)
+ * @copyright 2014-2015, Xerox Corporation (Xerox)and Palo Alto Research Center (PARC).  All rights reserved.
+ */
+
+#ifndef tutorial_ContentStore_h
+#define tutorial_ContentStore_h
+
+#include <stdbool.h>
+#include <sys/stat.h>
+
+#include <ccnx/common/ccnx_Name.h>
+#include <ccnx/common/ccnx_ContentObject.h>
+
+/**
+ * A TutorialContentStore is a small in-process cache of the CCNxContentObjects the server has built,
+ * keyed by their full CCNxName (prefix/command/file/chunk). Repeated requests for the same chunk, such as
+ * retransmissions or many clients fetching the same popular file, can then be answered with a lookup
+ * instead of reading the file and building a new ContentObject.
+ *
+ * The store holds at most a configurable number of payload bytes, evicting the least recently used
+ * ContentObjects to stay within that budget. Each entry remembers the version of the file it was built from
+ * (see TutorialFileVersion), and is discarded if the file has changed when it is looked up.
+ *
+ * A TutorialContentStore may be used by several threads at once.
+ */
+typedef struct tutorial_content_store TutorialContentStore;
+
+/**
+ * The default number of bytes a TutorialContentStore may hold.
+ */
+extern const size_t tutorialContentStore_DefaultByteBudget;
+
+/**
+ * Create a new, empty, TutorialContentStore. The returned instance must eventually be released
+ * by calling tutorialContentStore_Release().
+ *
+ * @param [in] byteBudget The maximum number of bytes of ContentObjects to hold.
+ *
+ * @return A new TutorialContentStore instance.
+ */
+TutorialContentStore *tutorialContentStore_Create(size_t byteBudget);
+
+/**
+ * Release all ContentObjects held by the specified TutorialContentStore and release its memory.
+ *
+ * @param [in,out] storeP A pointer to the pointer to the TutorialContentStore to release. It will be set to NULL.
+ */
+void tutorialContentStore_Release(TutorialContentStore **storeP);
+
+/**
+ * Look up the ContentObject with the specified name. If the file it was built from no longer matches
+ * `sourceInfo`, the stale ContentObject is removed and NULL is returned. A returned ContentObject must
+ * eventually be released by calling ccnxContentObject_Release().
+ *
+ * @param [in] store The TutorialContentStore to search.
+ * @param [in] name The full CCNxName of the ContentObject to find.
+ * @param [in] sourceInfo The current metadata of the file the ContentObject would have been built from.
+ *
+ * @return The matching CCNxContentObject, with an added reference, or NULL if there isn't a valid one.
+ */
+CCNxContentObject *tutorialContentStore_Get(TutorialContentStore *store, const CCNxName *name, const struct stat *sourceInfo);
+
+/**
+ * Add a ContentObject to the store, keyed by its name, replacing any existing ContentObject with the same
+ * name. Least recently used ContentObjects are evicted to keep the store within its byte budget. A
+ * ContentObject larger than the whole budget is not stored.
+ *
+ * @param [in] store The TutorialContentStore to add to.
+ * @param [in] contentObject The CCNxContentObject to add. The store acquires its own reference.
+ * @param [in] sourceInfo The metadata of the file the ContentObject was built from.
+ */
+void tutorialContentStore_Put(TutorialContentStore *store, const CCNxContentObject *contentObject, const struct stat *sourceInfo);
+
+/**
+ * Return the number of ContentObjects currently held in the store.
+ *
+ * @param [in] store The TutorialContentStore to inspect.
+ *
+ * @return The number of ContentObjects in the store.
+ */
+size_t tutorialContentStore_Count(const TutorialContentStore *store);
+#endif // tutorial_ContentStore_h
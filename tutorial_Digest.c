@@ -0,0 +1,385 @@
+/*
+ * Copyright (c) 2014-2015, Xerox Corporation (Xerox)and Palo Alto Research Center (PARC)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Patent rights are not granted under this agreement. Patent rights are
+ *       available under FRAND terms.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL XEROX or PARC BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+/**
+ * @author Alan Walendowski, Palo Alto Research Center (Xerox PARC)
+ * @copyright 2014-2015, Xerox Corporation (Xerox)and Palo Alto Research Center (PARC).  All rights reserved.
+ */
+#include <pthread.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include <openssl/sha.h>
+
+#include "tutorial_Digest.h"
+
+#if defined(__GNUC__) && defined(__x86_64__)
+#define _TUTORIAL_DIGEST_X86 1
+#include <cpuid.h>
+#include <immintrin.h>
+#endif
+
+/**
+ * Computes the digests of `count` messages of the same length, which start `stride` bytes apart, writing them one
+ * after another to `digests`.
+ */
+typedef void (_TutorialDigestLanes)(const uint8_t *messages, size_t stride, size_t length, uint8_t *digests);
+
+/**
+ * An implementation of SHA-256. `single` hashes one message, and `lanes` (if not NULL) hashes `laneCount`
+ * messages of the same length at once, with one message in each lane of a SIMD register.
+ */
+typedef struct {
+    const char *name;
+    void (*single)(const void *bytes, size_t length, uint8_t *digest);
+    _TutorialDigestLanes *lanes;
+    size_t laneCount;
+} _TutorialDigestImplementation;
+
+static const uint32_t _sha256InitialState[8] = {
+    0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19
+};
+
+static const uint32_t _sha256RoundConstants[64] __attribute__((aligned(16))) = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+    0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+    0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+};
+
+/**
+ * Write the padding that follows the last partial block of a message of the specified length: the remaining
+ * bytes, a 1 bit, zeros, and the message length in bits. The tail is one block long, or two if the length
+ * doesn't fit in the first.
+ *
+ * @return The number of 64-byte blocks written to `tail`, which must have room for 128 bytes.
+ */
+static size_t
+_padTail(const uint8_t *message, size_t length, uint8_t tail[128])
+{
+    size_t remainder = length % 64;
+    size_t blockCount = (remainder + 9 <= 64) ? 1 : 2;
+
+    memcpy(tail, message + length - remainder, remainder);
+    tail[remainder] = 0x80;
+    memset(tail + remainder + 1, 0, blockCount * 64 - remainder - 1);
+
+    uint64_t bitLength = (uint64_t) length * 8;
+    for (int i = 0; i < 8; i++) {
+        tail[blockCount * 64 - 1 - i] = (uint8_t) (bitLength >> (8 * i));
+    }
+
+    return blockCount;
+}
+
+/**
+ * Write the eight state words of a finished hash as a big-endian digest.
+ */
+static void
+_putDigest(const uint32_t state[8], uint8_t *digest)
+{
+    for (int i = 0; i < 8; i++) {
+        digest[4 * i] = (uint8_t) (state[i] >> 24);
+        digest[4 * i + 1] = (uint8_t) (state[i] >> 16);
+        digest[4 * i + 2] = (uint8_t) (state[i] >> 8);
+        digest[4 * i + 3] = (uint8_t) state[i];
+    }
+}
+
+/**
+ * The portable implementation, from OpenSSL's libcrypto.
+ */
+static void
+_sha256Portable(const void *bytes, size_t length, uint8_t *digest)
+{
+    SHA256(bytes, length, digest);
+}
+
+#ifdef _TUTORIAL_DIGEST_X86
+
+#define _ror256(x, n) _mm256_or_si256(_mm256_srli_epi32((x), (n)), _mm256_slli_epi32((x), 32 - (n)))
+
+/**
+ * Hash `blockCount` whole blocks of eight messages at once with AVX2, one message in each 32-bit lane. Lane i's
+ * blocks start at `data + i * stride`. The state is kept transposed: state[j] holds word j of every lane.
+ */
+__attribute__((target("avx2")))
+static void
+_sha256Avx2Blocks(__m256i state[8], const uint8_t *data, size_t stride, size_t blockCount)
+{
+    const __m256i byteSwap = _mm256_set_epi8(12, 13, 14, 15, 8, 9, 10, 11, 4, 5, 6, 7, 0, 1, 2, 3,
+                                             12, 13, 14, 15, 8, 9, 10, 11, 4, 5, 6, 7, 0, 1, 2, 3);
+    const __m256i offsets = _mm256_mullo_epi32(_mm256_set1_epi32((int) stride), _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7));
+
+    for (size_t block = 0; block < blockCount; block++, data += 64) {
+        __m256i a = state[0], b = state[1], c = state[2], d = state[3];
+        __m256i e = state[4], f = state[5], g = state[6], h = state[7];
+        __m256i w[16];
+
+        for (int t = 0; t < 64; t++) {
+            __m256i word;
+            if (t < 16) {
+                word = _mm256_shuffle_epi8(_mm256_i32gather_epi32((const int *) (data + 4 * t), offsets, 1), byteSwap);
+            } else {
+                __m256i w15 = w[(t - 15) & 15];
+                __m256i w2 = w[(t - 2) & 15];
+                __m256i s0 = _mm256_xor_si256(_mm256_xor_si256(_ror256(w15, 7), _ror256(w15, 18)), _mm256_srli_epi32(w15, 3));
+                __m256i s1 = _mm256_xor_si256(_mm256_xor_si256(_ror256(w2, 17), _ror256(w2, 19)), _mm256_srli_epi32(w2, 10));
+                word = _mm256_add_epi32(_mm256_add_epi32(w[t & 15], s0), _mm256_add_epi32(w[(t - 7) & 15], s1));
+            }
+            w[t & 15] = word;
+
+            __m256i sum1 = _mm256_xor_si256(_mm256_xor_si256(_ror256(e, 6), _ror256(e, 11)), _ror256(e, 25));
+            __m256i choose = _mm256_xor_si256(_mm256_and_si256(e, f), _mm256_andnot_si256(e, g));
+            __m256i t1 = _mm256_add_epi32(_mm256_add_epi32(h, sum1),
+                                          _mm256_add_epi32(choose, _mm256_add_epi32(word, _mm256_set1_epi32((int) _sha256RoundConstants[t]))));
+            __m256i sum0 = _mm256_xor_si256(_mm256_xor_si256(_ror256(a, 2), _ror256(a, 13)), _ror256(a, 22));
+            __m256i majority = _mm256_or_si256(_mm256_and_si256(a, b), _mm256_and_si256(c, _mm256_or_si256(a, b)));
+            __m256i t2 = _mm256_add_epi32(sum0, majority);
+
+            h = g;
+            g = f;
+            f = e;
+            e = _mm256_add_epi32(d, t1);
+            d = c;
+            c = b;
+            b = a;
+            a = _mm256_add_epi32(t1, t2);
+        }
+
+        state[0] = _mm256_add_epi32(state[0], a);
+        state[1] = _mm256_add_epi32(state[1], b);
+        state[2] = _mm256_add_epi32(state[2], c);
+        state[3] = _mm256_add_epi32(state[3], d);
+        state[4] = _mm256_add_epi32(state[4], e);
+        state[5] = _mm256_add_epi32(state[5], f);
+        state[6] = _mm256_add_epi32(state[6], g);
+        state[7] = _mm256_add_epi32(state[7], h);
+    }
+}
+
+__attribute__((target("avx2")))
+static void
+_sha256Avx2Lanes(const uint8_t *messages, size_t stride, size_t length, uint8_t *digests)
+{
+    __m256i state[8];
+    for (int i = 0; i < 8; i++) {
+        state[i] = _mm256_set1_epi32((int) _sha256InitialState[i]);
+    }
+
+    _sha256Avx2Blocks(state, messages, stride, length / 64);
+
+    // Every message has the same length, so they all have the same number of padded tail blocks.
+    uint8_t tails[8][128];
+    size_t tailBlockCount = 0;
+    for (int lane = 0; lane < 8; lane++) {
+        tailBlockCount = _padTail(messages + lane * stride, length, tails[lane]);
+    }
+    _sha256Avx2Blocks(state, tails[0], sizeof(tails[0]), tailBlockCount);
+
+    uint32_t words[8][8];
+    for (int i = 0; i < 8; i++) {
+        _mm256_storeu_si256((__m256i *) words[i], state[i]);
+    }
+    for (int lane = 0; lane < 8; lane++) {
+        uint32_t laneState[8];
+        for (int i = 0; i < 8; i++) {
+            laneState[i] = words[i][lane];
+        }
+        _putDigest(laneState, digests + lane * tutorialDigest_Sha256Length);
+    }
+}
+
+/**
+ * The same as _sha256Avx2Blocks(), but sixteen messages at once with AVX-512, which also has a rotate
+ * instruction and a three-input logic instruction for the choose and majority functions.
+ */
+__attribute__((target("avx512f")))
+static void
+_sha256Avx512Blocks(__m512i state[8], const uint8_t *data, size_t stride, size_t blockCount)
+{
+    const __m512i offsets = _mm512_mullo_epi32(_mm512_set1_epi32((int) stride),
+                                               _mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15));
+
+    for (size_t block = 0; block < blockCount; block++, data += 64) {
+        __m512i a = state[0], b = state[1], c = state[2], d = state[3];
+        __m512i e = state[4], f = state[5], g = state[6], h = state[7];
+        __m512i w[16];
+
+        for (int t = 0; t < 64; t++) {
+            __m512i word;
+            if (t < 16) {
+                // AVX-512F has no byte shuffle, so swap the bytes of each word with rotates and a bit select.
+                __m512i loaded = _mm512_i32gather_epi32(offsets, (const int *) (data + 4 * t), 1);
+                word = _mm512_ternarylogic_epi32(_mm512_rol_epi32(loaded, 8), _mm512_ror_epi32(loaded, 8),
+                                                 _mm512_set1_epi32(0x00ff00ff), 0xE4);
+            } else {
+                __m512i w15 = w[(t - 15) & 15];
+                __m512i w2 = w[(t - 2) & 15];
+                __m512i s0 = _mm512_ternarylogic_epi32(_mm512_ror_epi32(w15, 7), _mm512_ror_epi32(w15, 18), _mm512_srli_epi32(w15, 3), 0x96);
+                __m512i s1 = _mm512_ternarylogic_epi32(_mm512_ror_epi32(w2, 17), _mm512_ror_epi32(w2, 19), _mm512_srli_epi32(w2, 10), 0x96);
+                word = _mm512_add_epi32(_mm512_add_epi32(w[t & 15], s0), _mm512_add_epi32(w[(t - 7) & 15], s1));
+            }
+            w[t & 15] = word;
+
+            __m512i sum1 = _mm512_ternarylogic_epi32(_mm512_ror_epi32(e, 6), _mm512_ror_epi32(e, 11), _mm512_ror_epi32(e, 25), 0x96);
+            __m512i choose = _mm512_ternarylogic_epi32(e, f, g, 0xCA);
+            __m512i t1 = _mm512_add_epi32(_mm512_add_epi32(h, sum1),
+                                          _mm512_add_epi32(choose, _mm512_add_epi32(word, _mm512_set1_epi32((int) _sha256RoundConstants[t]))));
+            __m512i sum0 = _mm512_ternarylogic_epi32(_mm512_ror_epi32(a, 2), _mm512_ror_epi32(a, 13), _mm512_ror_epi32(a, 22), 0x96);
+            __m512i majority = _mm512_ternarylogic_epi32(a, b, c, 0xE8);
+            __m512i t2 = _mm512_add_epi32(sum0, majority);
+
+            h = g;
+            g = f;
+            f = e;
+            e = _mm512_add_epi32(d, t1);
+            d = c;
+            c = b;
+            b = a;
+            a = _mm512_add_epi32(t1, t2);
+        }
+
+        state[0] = _mm512_add_epi32(state[0], a);
+        state[1] = _mm512_add_epi32(state[1], b);
+        state[2] = _mm512_add_epi32(state[2], c);
+        state[3] = _mm512_add_epi32(state[3], d);
+        state[4] = _mm512_add_epi32(state[4], e);
+        state[5] = _mm512_add_epi32(state[5], f);
+        state[6] = _mm512_add_epi32(state[6], g);
+        state[7] = _mm512_add_epi32(state[7], h);
+    }
+}
+
+__attribute__((target("avx512f")))
+static void
+_sha256Avx512Lanes(const uint8_t *messages, size_t stride, size_t length, uint8_t *digests)
+{
+    __m512i state[8];
+    for (int i = 0; i < 8; i++) {
+        state[i] = _mm512_set1_epi32((int) _sha256InitialState[i]);
+    }
+
+    _sha256Avx512Blocks(state, messages, stride, length / 64);
+
+    uint8_t tails[16][128];
+    size_t tailBlockCount = 0;
+    for (int lane = 0; lane < 16; lane++) {
+        tailBlockCount = _padTail(messages + lane * stride, length, tails[lane]);
+    }
+    _sha256Avx512Blocks(state, tails[0], sizeof(tails[0]), tailBlockCount);
+
+    uint32_t words[8][16];
+    for (int i = 0; i < 8; i++) {
+        _mm512_storeu_si512(words[i], state[i]);
+    }
+    for (int lane = 0; lane < 16; lane++) {
+        uint32_t laneState[8];
+        for (int i = 0; i < 8; i++) {
+            laneState[i] = words[i][lane];
+        }
+        _putDigest(laneState, digests + lane * tutorialDigest_Sha256Length);
+    }
+}
+
+#endif // _TUTORIAL_DIGEST_X86
+
+static _TutorialDigestImplementation _implementation = { "portable", _sha256Portable, NULL, 0 };
+static pthread_once_t _implementationOnce = PTHREAD_ONCE_INIT;
+
+/**
+ * Choose the lanes to hash blocks of chunks with. Single messages are always hashed by OpenSSL, which uses the
+ * SHA instructions (SHA-NI) itself where the CPU has them: a SHA-NI kernel of our own was no faster than it.
+ * `make bench` showed AVX-512 lanes hashing 16 chunks at a time at more than twice OpenSSL's throughput, with or
+ * without SHA-NI. AVX2 lanes hash 8 chunks at about three times the speed of OpenSSL's code without SHA-NI,
+ * but no faster than OpenSSL with it, so they are only used on CPUs that have AVX2 and not SHA-NI.
+ */
+static void
+_chooseImplementation(void)
+{
+#ifdef _TUTORIAL_DIGEST_X86
+    __builtin_cpu_init();
+
+    unsigned int eax, ebx, ecx, edx;
+    bool hasShaNi = __get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx) && (ebx & bit_SHA) != 0;
+
+    if (__builtin_cpu_supports("avx512f")) {
+        _implementation = (_TutorialDigestImplementation) { "avx512x16", _sha256Portable, _sha256Avx512Lanes, 16 };
+    } else if (__builtin_cpu_supports("avx2") && hasShaNi == false) {
+        _implementation = (_TutorialDigestImplementation) { "avx2x8", _sha256Portable, _sha256Avx2Lanes, 8 };
+    }
+#endif
+}
+
+static const _TutorialDigestImplementation *
+_getImplementation(void)
+{
+    pthread_once(&_implementationOnce, _chooseImplementation);
+    return &_implementation;
+}
+
+const char *
+tutorialDigest_GetImplementationName(void)
+{
+    return _getImplementation()->name;
+}
+
+void
+tutorialDigest_Sha256(const void *bytes, size_t length, uint8_t digest[tutorialDigest_Sha256Length])
+{
+    _getImplementation()->single(bytes, length, digest);
+}
+
+size_t
+tutorialDigest_Sha256Chunks(const uint8_t *bytes, size_t length, size_t chunkSize, uint8_t *digests)
+{
+    const _TutorialDigestImplementation *implementation = _getImplementation();
+    size_t count = 0;
+    size_t offset = 0;
+
+    // Hash as many whole chunks as possible a lane's worth at a time, and the rest one by one.
+    if (implementation->lanes != NULL) {
+        size_t groupLength = implementation->laneCount * chunkSize;
+        while (length - offset >= groupLength) {
+            implementation->lanes(bytes + offset, chunkSize, chunkSize, digests + count * tutorialDigest_Sha256Length);
+            offset += groupLength;
+            count += implementation->laneCount;
+        }
+    }
+
+    do {
+        size_t chunkLength = (length - offset < chunkSize) ? (length - offset) : chunkSize;
+        implementation->single(bytes + offset, chunkLength, digests + count * tutorialDigest_Sha256Length);
+        offset += chunkLength;
+        count++;
+    } while (offset < length);
+
+    return count;
+}
@@ -0,0 +1,75 @@
+/*
+ * Copyright (c) 2014-2015, Xerox Corporation (Xerox)and Palo Alto Research Center (PARC)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Patent rights are not granted under this agreement. Patent rights are
+ *       available under FRAND terms.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL XEROX or PARC BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+/**
+ * @author Alan Walendowski, Palo Alto Research Center (Xerox PARC)
+ * @copyright 2014-2015, Xerox Corporation (Xerox)and Palo Alto Research Center (PARC).  All rights reserved.
+ */
+
+#ifndef tutorial_Digest_h
+#define tutorial_Digest_h
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * The length of a SHA-256 digest, in bytes.
+ */
+#define tutorialDigest_Sha256Length 32
+
+/**
+ * Return the name of the SHA-256 implementation chosen for this CPU, e.g. "avx512x16" or "portable". The choice
+ * is made the first time a digest is computed. Single chunks are always hashed with OpenSSL's libcrypto
+ * ("portable"), and blocks of chunks 16 or 8 at once with AVX-512, or AVX2 on CPUs without the SHA instructions,
+ * wherever that beats libcrypto.
+ *
+ * @return A static string naming the implementation.
+ */
+const char *tutorialDigest_GetImplementationName(void);
+
+/**
+ * Compute the SHA-256 digest of the specified bytes.
+ *
+ * @param [in] bytes The bytes to hash.
+ * @param [in] length The number of bytes to hash.
+ * @param [out] digest Filled in with the digest.
+ */
+void tutorialDigest_Sha256(const void *bytes, size_t length, uint8_t digest[tutorialDigest_Sha256Length]);
+
+/**
+ * Compute the SHA-256 digest of each chunk of a block of consecutive chunks. Every chunk is `chunkSize` bytes
+ * except the last, which may be shorter. A block of length 0 is a single empty chunk, as an empty file is
+ * sent as one empty chunk.
+ *
+ * @param [in] bytes The block of chunks.
+ * @param [in] length The length of the block, in bytes.
+ * @param [in] chunkSize The size of each chunk. Must be greater than 0.
+ * @param [out] digests Filled in with the digest of each chunk, one after another.
+ *
+ * @return The number of digests written.
+ */
+size_t tutorialDigest_Sha256Chunks(const uint8_t *bytes, size_t length, size_t chunkSize, uint8_t *digests);
+#endif // tutorial_Digest_h
@@ -0,0 +1,582 @@
+/*
+ * Copyright (c) 2014-2015, Xerox Corporation (Xerox)and Palo Alto Research Center (PARC)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Patent rights are not granted under this agreement. Patent rights are
+ *       available under FRAND terms.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL XEROX or PARC BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+/**
+ * @author Alan Walendowski, Palo Alto Research Center (Xerox PARC)
+ * @copyright 2014-2015, Xerox Corporation (Xerox)and Palo Alto Research Center (PARC).  All rights reserved.
+ */
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <LongBow/runtime.h>
+#include <parc/algol/parc_Memory.h>
+
+#include "tutorial_DirectoryListing.h"
+#include "tutorial_ListingChunk.h"
+
+typedef struct {
+    char *fileName;
+    size_t fileSize;
+    int64_t modificationTime;
+} _TutorialDirectoryListingEntry;
+
+/**
+ * The number of query results a listing keeps, so that fetching the chunks of a query only runs it once.
+ */
+static const size_t _queryResultCapacity = 16;
+
+/**
+ * The encoded chunks of the result of a query.
+ */
+typedef struct {
+    char *key;                // The query's conditions, from _createQueryKey(), or NULL if the slot is unused.
+    uint64_t generation;      // The listing's generation when the query was run.
+    uint64_t lastUsed;        // When the result was last asked for, in the listing's count of queries.
+    PARCBuffer **chunks;
+    size_t chunkCount;
+} _TutorialListingQueryResult;
+
+struct tutorial_directory_listing {
+    pthread_mutex_t lock;
+    TutorialPathIndex *pathIndex; // The files being served, which the listing is built from.
+    uint32_t chunkSize;
+
+    _TutorialDirectoryListingEntry *entries; // Sorted by fileName.
+    size_t entryCount;
+    size_t entryCapacity;
+
+    PARCBuffer **snapshot; // The encoded chunks, or NULL if the listing has changed since the last snapshot was built.
+    size_t snapshotChunkCount;
+
+    uint64_t generation;   // Counts the changes to the listing.
+    uint64_t queryCount;
+    _TutorialListingQueryResult *queryResults; // The results of the most recently asked queries.
+};
+
+/**
+ * Find the position of the named file in the sorted entries, using a binary search.
+ *
+ * @return true if the file is in the listing, in which case `index` is set to its position.
+ *         false if it isn't, in which case `index` is set to the position it would be inserted at.
+ */
+static bool
+_findEntry(const TutorialDirectoryListing *listing, const char *fileName, size_t *index)
+{
+    size_t low = 0;
+    size_t high = listing->entryCount;
+
+    while (low < high) {
+        size_t middle = low + (high - low) / 2;
+        int comparison = strcmp(listing->entries[middle].fileName, fileName);
+        if (comparison == 0) {
+            *index = middle;
+            return true;
+        } else if (comparison < 0) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+
+    *index = low;
+    return false;
+}
+
+static void
+_releaseChunks(PARCBuffer ***chunksP, size_t chunkCount)
+{
+    for (size_t i = 0; i < chunkCount; i++) {
+        parcBuffer_Release(&(*chunksP)[i]);
+    }
+    parcMemory_Deallocate((void **) chunksP);
+}
+
+/**
+ * Note that the listing has changed. Its snapshot is released, and the results of queries are run again when
+ * their first chunk is next asked for.
+ */
+static void
+_invalidateSnapshot(TutorialDirectoryListing *listing)
+{
+    listing->generation++;
+
+    if (listing->snapshot != NULL) {
+        _releaseChunks(&listing->snapshot, listing->snapshotChunkCount);
+        listing->snapshotChunkCount = 0;
+    }
+}
+
+/**
+ * Remove the entry for a file, or the entries for every file below a directory.
+ */
+static void
+_removeEntries(TutorialDirectoryListing *listing, const char *path)
+{
+    size_t index;
+    if (_findEntry(listing, path, &index)) {
+        parcMemory_Deallocate((void **) &listing->entries[index].fileName);
+        memmove(&listing->entries[index], &listing->entries[index + 1],
+                (listing->entryCount - index - 1) * sizeof(_TutorialDirectoryListingEntry));
+        listing->entryCount--;
+        _invalidateSnapshot(listing);
+    }
+
+    // The files below a directory sort together, from where "<path>/" would be.
+    char directoryPrefix[strlen(path) + 2];
+    size_t directoryPrefixLength = snprintf(directoryPrefix, sizeof(directoryPrefix), "%s/", path);
+
+    _findEntry(listing, directoryPrefix, &index);
+    size_t end = index;
+    while (end < listing->entryCount && strncmp(listing->entries[end].fileName, directoryPrefix, directoryPrefixLength) == 0) {
+        parcMemory_Deallocate((void **) &listing->entries[end].fileName);
+        end++;
+    }
+    if (end > index) {
+        memmove(&listing->entries[index], &listing->entries[end],
+                (listing->entryCount - end) * sizeof(_TutorialDirectoryListingEntry));
+        listing->entryCount -= end - index;
+        _invalidateSnapshot(listing);
+    }
+}
+
+/**
+ * Make room for one more entry at the end of the listing's entries.
+ */
+static void
+_growEntries(TutorialDirectoryListing *listing)
+{
+    if (listing->entryCount == listing->entryCapacity) {
+        listing->entryCapacity = (listing->entryCapacity == 0) ? 64 : listing->entryCapacity * 2;
+        listing->entries = parcMemory_Reallocate(listing->entries, listing->entryCapacity * sizeof(_TutorialDirectoryListingEntry));
+        assertNotNull(listing->entries, "parcMemory_Reallocate(%zu) returned NULL", listing->entryCapacity * sizeof(_TutorialDirectoryListingEntry));
+    }
+}
+
+/**
+ * Add or update the entry for a file in the path index. This is a TutorialPathIndexVisitor.
+ */
+static void
+_updateEntry(void *listingArg, const TutorialListingEntry *file)
+{
+    TutorialDirectoryListing *listing = listingArg;
+    size_t index;
+
+    if (_findEntry(listing, file->fileName, &index)) {
+        if (listing->entries[index].fileSize != file->fileSize
+            || listing->entries[index].modificationTime != file->modificationTime) {
+            listing->entries[index].fileSize = file->fileSize;
+            listing->entries[index].modificationTime = file->modificationTime;
+            _invalidateSnapshot(listing);
+        }
+    } else {
+        _growEntries(listing);
+        memmove(&listing->entries[index + 1], &listing->entries[index],
+                (listing->entryCount - index) * sizeof(_TutorialDirectoryListingEntry));
+        listing->entries[index].fileName = parcMemory_StringDuplicate(file->fileName, file->fileNameLength);
+        listing->entries[index].fileSize = file->fileSize;
+        listing->entries[index].modificationTime = file->modificationTime;
+        listing->entryCount++;
+        _invalidateSnapshot(listing);
+    }
+}
+
+/**
+ * Add an entry for a file in the path index to the end of the listing, leaving it to be sorted once every file has
+ * been added. This is a TutorialPathIndexVisitor.
+ */
+static void
+_appendEntry(void *listingArg, const TutorialListingEntry *file)
+{
+    TutorialDirectoryListing *listing = listingArg;
+
+    _growEntries(listing);
+    listing->entries[listing->entryCount].fileName = parcMemory_StringDuplicate(file->fileName, file->fileNameLength);
+    listing->entries[listing->entryCount].fileSize = file->fileSize;
+    listing->entries[listing->entryCount].modificationTime = file->modificationTime;
+    listing->entryCount++;
+}
+
+static void
+_removeAllEntries(TutorialDirectoryListing *listing)
+{
+    for (size_t i = 0; i < listing->entryCount; i++) {
+        parcMemory_Deallocate((void **) &listing->entries[i].fileName);
+    }
+    listing->entryCount = 0;
+    _invalidateSnapshot(listing);
+}
+
+static int
+_compareEntries(const void *a, const void *b)
+{
+    return strcmp(((const _TutorialDirectoryListingEntry *) a)->fileName, ((const _TutorialDirectoryListingEntry *) b)->fileName);
+}
+
+/**
+ * Fill an empty listing with every file in the path index. They are sorted once, rather than inserted in order.
+ */
+static void
+_listAllFiles(TutorialDirectoryListing *listing)
+{
+    tutorialPathIndex_VisitFiles(listing->pathIndex, "", _appendEntry, listing);
+    qsort(listing->entries, listing->entryCount, sizeof(_TutorialDirectoryListingEntry), _compareEntries);
+    _invalidateSnapshot(listing);
+}
+
+static TutorialListingEntry
+_getListingEntry(const _TutorialDirectoryListingEntry *entry)
+{
+    TutorialListingEntry result = {
+        .fileName = entry->fileName,
+        .fileNameLength = strlen(entry->fileName),
+        .fileSize = entry->fileSize,
+        .modificationTime = entry->modificationTime
+    };
+    return result;
+}
+
+/**
+ * Return the index in the listing's entries of the `i`th entry to be encoded: the `i`th of `selected`, or of
+ * all the entries if `selected` is NULL.
+ */
+static size_t
+_getSelectedEntry(const size_t *selected, size_t i)
+{
+    return (selected != NULL) ? selected[i] : i;
+}
+
+/**
+ * Return the number of consecutive selected entries, starting at `first`, that fit in a chunk of the listing.
+ * That is always at least one, so an entry too long for any chunk still gets a chunk of its own.
+ *
+ * @param [out] chunkLength Set to the encoded length of the chunk holding those entries.
+ */
+static size_t
+_countEntriesInChunk(const TutorialDirectoryListing *listing, const size_t *selected, size_t selectedCount,
+                     size_t first, size_t *chunkLength)
+{
+    size_t result = 0;
+    size_t length = tutorialListingChunk_HeaderLength;
+
+    while (first + result < selectedCount && result < tutorialListingChunk_MaximumEntryCount) {
+        const char *fileName = listing->entries[_getSelectedEntry(selected, first + result)].fileName;
+        size_t entryLength = tutorialListingChunk_GetEntryLength(strlen(fileName));
+        if (result > 0 && length + entryLength > listing->chunkSize) {
+            break;
+        }
+        length += entryLength;
+        result++;
+    }
+
+    *chunkLength = length;
+    return result;
+}
+
+/**
+ * Encode entries of the listing into chunks that each hold whole entries. There is always at least one chunk.
+ *
+ * @param [in] selected The indexes of the entries to encode, in order, or NULL to encode all of them.
+ * @param [in] selectedCount The number of entries to encode.
+ * @param [out] chunkCount Set to the number of chunks.
+ *
+ * @return An array of the chunks, which must eventually be released with _releaseChunks().
+ */
+static PARCBuffer **
+_encodeEntries(const TutorialDirectoryListing *listing, const size_t *selected, size_t selectedCount, size_t *chunkCount)
+{
+    size_t capacity = 1;
+    PARCBuffer **result = parcMemory_Allocate(capacity * sizeof(PARCBuffer *));
+    assertNotNull(result, "parcMemory_Allocate(%zu) returned NULL", capacity * sizeof(PARCBuffer *));
+    *chunkCount = 0;
+
+    size_t index = 0;
+    do {
+        size_t chunkLength;
+        size_t entryCount = _countEntriesInChunk(listing, selected, selectedCount, index, &chunkLength);
+
+        PARCBuffer *chunk = parcBuffer_Allocate(chunkLength);
+        uint8_t *bytes = tutorialListingChunk_PutHeader(parcBuffer_Overlay(chunk, 0), entryCount);
+        for (size_t i = 0; i < entryCount; i++) {
+            TutorialListingEntry entry = _getListingEntry(&listing->entries[_getSelectedEntry(selected, index + i)]);
+            bytes = tutorialListingChunk_PutEntry(bytes, &entry);
+        }
+        index += entryCount;
+
+        if (*chunkCount == capacity) {
+            capacity *= 2;
+            result = parcMemory_Reallocate(result, capacity * sizeof(PARCBuffer *));
+            assertNotNull(result, "parcMemory_Reallocate(%zu) returned NULL", capacity * sizeof(PARCBuffer *));
+        }
+        result[(*chunkCount)++] = chunk;
+    } while (index < selectedCount);
+
+    return result;
+}
+
+static void
+_createSnapshot(TutorialDirectoryListing *listing)
+{
+    listing->snapshot = _encodeEntries(listing, NULL, listing->entryCount, &listing->snapshotChunkCount);
+}
+
+TutorialDirectoryListing *
+tutorialDirectoryListing_Create(TutorialPathIndex *pathIndex, uint32_t chunkSize)
+{
+    assertTrue(chunkSize > tutorialListingChunk_HeaderLength, "The chunk size of a listing must be greater than its header");
+
+    TutorialDirectoryListing *result = parcMemory_AllocateAndClear(sizeof(TutorialDirectoryListing));
+    assertNotNull(result, "parcMemory_AllocateAndClear(%zu) returned NULL", sizeof(TutorialDirectoryListing));
+
+    result->pathIndex = pathIndex;
+    result->chunkSize = chunkSize;
+    pthread_mutex_init(&result->lock, NULL);
+
+    result->queryResults = parcMemory_AllocateAndClear(_queryResultCapacity * sizeof(_TutorialListingQueryResult));
+    assertNotNull(result->queryResults, "parcMemory_AllocateAndClear(%zu) returned NULL", _queryResultCapacity * sizeof(_TutorialListingQueryResult));
+
+    _listAllFiles(result);
+
+    return result;
+}
+
+void
+tutorialDirectoryListing_Release(TutorialDirectoryListing **listingP)
+{
+    TutorialDirectoryListing *listing = *listingP;
+
+    _removeAllEntries(listing);
+    if (listing->entries != NULL) {
+        parcMemory_Deallocate((void **) &listing->entries);
+    }
+
+    for (size_t i = 0; i < _queryResultCapacity; i++) {
+        if (listing->queryResults[i].key != NULL) {
+            parcMemory_Deallocate((void **) &listing->queryResults[i].key);
+            _releaseChunks(&listing->queryResults[i].chunks, listing->queryResults[i].chunkCount);
+        }
+    }
+    parcMemory_Deallocate((void **) &listing->queryResults);
+
+    pthread_mutex_destroy(&listing->lock);
+    parcMemory_Deallocate((void **) listingP);
+}
+
+void
+tutorialDirectoryListing_UpdateFile(TutorialDirectoryListing *listing, const char *fileName)
+{
+    pthread_mutex_lock(&listing->lock);
+    if (tutorialPathIndex_VisitFiles(listing->pathIndex, fileName, _updateEntry, listing) == 0) {
+        _removeEntries(listing, fileName); // It's gone, or it's a directory with nothing left in it.
+    }
+    pthread_mutex_unlock(&listing->lock);
+}
+
+void
+tutorialDirectoryListing_RemoveFile(TutorialDirectoryListing *listing, const char *fileName)
+{
+    pthread_mutex_lock(&listing->lock);
+    _removeEntries(listing, fileName);
+    pthread_mutex_unlock(&listing->lock);
+}
+
+void
+tutorialDirectoryListing_Rescan(TutorialDirectoryListing *listing)
+{
+    pthread_mutex_lock(&listing->lock);
+    _removeAllEntries(listing);
+    _listAllFiles(listing);
+    pthread_mutex_unlock(&listing->lock);
+}
+
+PARCBuffer *
+tutorialDirectoryListing_AcquireChunk(TutorialDirectoryListing *listing, uint64_t chunkNumber, uint64_t *finalChunkNumber)
+{
+    PARCBuffer *result = NULL;
+
+    pthread_mutex_lock(&listing->lock);
+
+    if (listing->snapshot == NULL) {
+        _createSnapshot(listing);
+    }
+    *finalChunkNumber = listing->snapshotChunkCount - 1; // There is always at least one chunk.
+    if (chunkNumber < listing->snapshotChunkCount) {
+        // Each caller gets its own slice, to set the position and limit of.
+        result = parcBuffer_Slice(listing->snapshot[chunkNumber]);
+    }
+
+    pthread_mutex_unlock(&listing->lock);
+
+    return result;
+}
+
+/**
+ * Return the index of the first entry that could meet a query: the first whose name starts with its prefix, and
+ * sorts after its cursor.
+ */
+static size_t
+_findFirstQueryEntry(const TutorialDirectoryListing *listing, const TutorialListingQuery *query)
+{
+    size_t result = 0;
+
+    if (query->prefix != NULL) {
+        char prefix[query->prefixLength + 1];
+        memcpy(prefix, query->prefix, query->prefixLength);
+        prefix[query->prefixLength] = '\0';
+        _findEntry(listing, prefix, &result); // If there's no entry named just the prefix, this is where it would go.
+    }
+
+    if (query->after != NULL) {
+        char after[query->afterLength + 1];
+        memcpy(after, query->after, query->afterLength);
+        after[query->afterLength] = '\0';
+
+        size_t index;
+        if (_findEntry(listing, after, &index)) {
+            index++; // Skip the cursor itself.
+        }
+        if (index > result) {
+            result = index;
+        }
+    }
+
+    return result;
+}
+
+/**
+ * Return the size of the buffer _createQueryKey() needs for a query: its strings, plus room for their lengths,
+ * the numbers and the separators.
+ */
+static size_t
+_getQueryKeySize(const TutorialListingQuery *query)
+{
+    return query->prefixLength + query->patternLength + query->afterLength + 128;
+}
+
+/**
+ * Write a string that identifies a query by all of its conditions into `key`.
+ */
+static void
+_createQueryKey(const TutorialListingQuery *query, char *key, size_t keySize)
+{
+    // Each string is preceded by its length, so no string can be mistaken for part of another.
+    snprintf(key, keySize, "%zu:%.*s|%zu:%.*s|%zu:%.*s|%d:%lld|%llu",
+             query->prefixLength, (int) query->prefixLength, (query->prefix != NULL) ? query->prefix : "",
+             query->patternLength, (int) query->patternLength, (query->pattern != NULL) ? query->pattern : "",
+             query->afterLength, (int) query->afterLength, (query->after != NULL) ? query->after : "",
+             query->hasModifiedSince, (long long) query->modifiedSince, (unsigned long long) query->limit);
+}
+
+/**
+ * Run a query against the listing, and encode the matching entries into chunks.
+ */
+static void
+_runQuery(const TutorialDirectoryListing *listing, const TutorialListingQuery *query, _TutorialListingQueryResult *queryResult)
+{
+    size_t *selected = parcMemory_Allocate((listing->entryCount + 1) * sizeof(size_t));
+    assertNotNull(selected, "parcMemory_Allocate(%zu) returned NULL", (listing->entryCount + 1) * sizeof(size_t));
+    size_t selectedCount = 0;
+
+    for (size_t i = _findFirstQueryEntry(listing, query);
+         i < listing->entryCount && (query->limit == 0 || selectedCount < query->limit); i++) {
+        const _TutorialDirectoryListingEntry *entry = &listing->entries[i];
+        size_t fileNameLength = strlen(entry->fileName);
+
+        if (query->prefix != NULL
+            && (fileNameLength < query->prefixLength || memcmp(entry->fileName, query->prefix, query->prefixLength) != 0)) {
+            break; // The names that start with the prefix are all together, and we've passed them.
+        }
+        if (tutorialListingQuery_Matches(query, entry->fileName, fileNameLength, entry->modificationTime)) {
+            selected[selectedCount++] = i;
+        }
+    }
+
+    queryResult->chunks = _encodeEntries(listing, selected, selectedCount, &queryResult->chunkCount);
+    queryResult->generation = listing->generation;
+
+    parcMemory_Deallocate((void **) &selected);
+}
+
+/**
+ * Find the result of a query, running it if it hasn't been run, or if the listing has changed since and the first
+ * chunk is asked for. The result replaces the least recently used one. The listing's lock must be held.
+ */
+static const _TutorialListingQueryResult *
+_getQueryResult(TutorialDirectoryListing *listing, const TutorialListingQuery *query, uint64_t chunkNumber)
+{
+    char key[_getQueryKeySize(query)];
+    _createQueryKey(query, key, sizeof(key));
+
+    _TutorialListingQueryResult *result = NULL;
+    _TutorialListingQueryResult *leastRecentlyUsed = &listing->queryResults[0];
+    for (size_t i = 0; i < _queryResultCapacity && result == NULL; i++) {
+        _TutorialListingQueryResult *candidate = &listing->queryResults[i];
+        if (candidate->key != NULL && strcmp(candidate->key, key) == 0) {
+            result = candidate;
+        } else if (candidate->key == NULL || (leastRecentlyUsed->key != NULL && candidate->lastUsed < leastRecentlyUsed->lastUsed)) {
+            leastRecentlyUsed = candidate;
+        }
+    }
+
+    // A client fetching a query asks for its first chunk first. The rest come from the same result, even if the
+    // listing changes meanwhile, so that no entry is repeated or skipped where the chunks' boundaries would move.
+    if (result != NULL && result->generation != listing->generation && chunkNumber == 0) {
+        _releaseChunks(&result->chunks, result->chunkCount);
+        _runQuery(listing, query, result);
+    } else if (result == NULL) {
+        result = leastRecentlyUsed;
+        if (result->key != NULL) {
+            parcMemory_Deallocate((void **) &result->key);
+            _releaseChunks(&result->chunks, result->chunkCount);
+        }
+        result->key = parcMemory_StringDuplicate(key, strlen(key));
+        _runQuery(listing, query, result);
+    }
+    result->lastUsed = ++listing->queryCount;
+
+    return result;
+}
+
+PARCBuffer *
+tutorialDirectoryListing_AcquireQueryChunk(TutorialDirectoryListing *listing, const TutorialListingQuery *query,
+                                           uint64_t chunkNumber, uint64_t *finalChunkNumber)
+{
+    PARCBuffer *result = NULL;
+
+    pthread_mutex_lock(&listing->lock);
+
+    const _TutorialListingQueryResult *queryResult = _getQueryResult(listing, query, chunkNumber);
+    *finalChunkNumber = queryResult->chunkCount - 1; // There is always at least one chunk.
+    if (chunkNumber < queryResult->chunkCount) {
+        // Each caller gets its own slice, to set the position and limit of.
+        result = parcBuffer_Slice(queryResult->chunks[chunkNumber]);
+    }
+
+    pthread_mutex_unlock(&listing->lock);
+
+    return result;
+}
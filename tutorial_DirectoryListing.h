@@ -0,0 +1,130 @@
+/*
+ * Copyright (c) 2014-2015, Xerox Corporation (Xerox)and Palo Alto Research Center (PARC)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Patent rights are not granted under this agreement. Patent rights are
+ *       available under FRAND terms.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL XEROX or PARC BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+/**
+ * @author Alan Walendowski, Palo Alto Research Center (Xerox PARC)
+ * @copyright 2014-2015, Xerox Corporation (Xerox)and Palo Alto Research Center (PARC).  All rights reserved.
+ */
+
+#ifndef tutorial_DirectoryListing_h
+#define tutorial_DirectoryListing_h
+
+#include <stdint.h>
+
+#include <parc/algol/parc_Buffer.h>
+
+#include "tutorial_ListingQuery.h"
+#include "tutorial_PathIndex.h"
+
+/**
+ * A TutorialDirectoryListing holds the listing of the files being served, sorted by their paths relative to the
+ * directory being served, in the chunked binary form described in tutorial_ListingChunk.h. The listing is built
+ * from a TutorialPathIndex, and then kept up to date by telling it about individual files and directories that have
+ * changed, so answering a 'list' request doesn't have to walk the tree and check the size of every file in it.
+ *
+ * The listing is served from an immutable snapshot of its encoded chunks. A new snapshot is only built when the
+ * listing has changed since the last one was taken, and chunks already handed out are never modified.
+ * A TutorialDirectoryListing may be used by several threads at once.
+ *
+ * Because its entries are kept sorted, the listing also serves as an index for TutorialListingQuery: a query with a
+ * prefix or a cursor only looks at the entries from where they start, and stops at the end of the prefix or the limit.
+ */
+typedef struct tutorial_directory_listing TutorialDirectoryListing;
+
+/**
+ * Create a listing of the files in the specified path index. The returned instance must eventually be released by
+ * calling tutorialDirectoryListing_Release(), before the path index is released.
+ *
+ * @param [in] pathIndex The TutorialPathIndex of the files being served.
+ * @param [in] chunkSize The size of the chunks the listing is served in. Each chunk holds as many whole entries as fit.
+ *
+ * @return A new TutorialDirectoryListing instance.
+ */
+TutorialDirectoryListing *tutorialDirectoryListing_Create(TutorialPathIndex *pathIndex, uint32_t chunkSize);
+
+/**
+ * Release the memory used by the specified TutorialDirectoryListing. Snapshots that have been acquired
+ * remain valid until they are released.
+ *
+ * @param [in,out] listingP A pointer to the pointer to the TutorialDirectoryListing to release. It will be set to NULL.
+ */
+void tutorialDirectoryListing_Release(TutorialDirectoryListing **listingP);
+
+/**
+ * Update the listing's entry for a file that has been created or modified, or the entries for every file below a
+ * directory, from the path index. The path index must have been updated first. Files that are no longer in it are
+ * removed from the listing.
+ *
+ * @param [in] listing The TutorialDirectoryListing to update.
+ * @param [in] fileName The path of the file or directory, relative to the directory being served.
+ */
+void tutorialDirectoryListing_UpdateFile(TutorialDirectoryListing *listing, const char *fileName);
+
+/**
+ * Remove a file, or every file below a directory, from the listing.
+ *
+ * @param [in] listing The TutorialDirectoryListing to update.
+ * @param [in] fileName The path of the file or directory, relative to the directory being served.
+ */
+void tutorialDirectoryListing_RemoveFile(TutorialDirectoryListing *listing, const char *fileName);
+
+/**
+ * Discard the listing and rebuild it from the path index, which must have been rescanned first.
+ *
+ * @param [in] listing The TutorialDirectoryListing to rebuild.
+ */
+void tutorialDirectoryListing_Rescan(TutorialDirectoryListing *listing);
+
+/**
+ * Return a chunk of the current snapshot of the listing. An empty listing is a single chunk with no entries.
+ * The returned PARCBuffer is a slice of the snapshot, and must eventually be released by calling parcBuffer_Release().
+ *
+ * @param [in] listing The TutorialDirectoryListing to take a chunk of.
+ * @param [in] chunkNumber The number of the chunk.
+ * @param [out] finalChunkNumber Set to the number of the final chunk of the snapshot.
+ *
+ * @return A new PARCBuffer containing the chunk, or NULL if the snapshot has no such chunk.
+ */
+PARCBuffer *tutorialDirectoryListing_AcquireChunk(TutorialDirectoryListing *listing, uint64_t chunkNumber, uint64_t *finalChunkNumber);
+
+/**
+ * Return a chunk of the part of the listing that meets the conditions of a query. It is encoded and chunked just
+ * like the whole listing. The query is run once, when its first chunk is asked for, and its chunks are kept with
+ * those of the other recently asked queries, so each chunk after the first is returned without running it again.
+ * Those chunks are used until the first chunk is asked for again after the listing has changed, so a client
+ * fetching every chunk gets a consistent result. An empty result is a single chunk with no entries.
+ * The returned PARCBuffer is a slice of the kept chunk, and must eventually be released by calling parcBuffer_Release().
+ *
+ * @param [in] listing The TutorialDirectoryListing to query.
+ * @param [in] query The conditions the files must meet.
+ * @param [in] chunkNumber The number of the chunk of the result.
+ * @param [out] finalChunkNumber Set to the number of the final chunk of the result.
+ *
+ * @return A new PARCBuffer containing the chunk, or NULL if the result has no such chunk.
+ */
+PARCBuffer *tutorialDirectoryListing_AcquireQueryChunk(TutorialDirectoryListing *listing, const TutorialListingQuery *query,
+                                                       uint64_t chunkNumber, uint64_t *finalChunkNumber);
+#endif // tutorial_DirectoryListing_h
@@ -0,0 +1,395 @@
+/*
+ * Copyright (c) 2014-2015, Xerox Corporation (Xerox)and Palo Alto Research Center (PARC)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Patent rights are not granted under this agreement. Patent rights are
+ *       available under FRAND terms.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL XEROX or PARC BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+/**
+ * @author Alan Walendowski, Palo Alto Research Center (Xerox PARC)
+ * @copyright 2014-2015, Xerox Corporation (Xerox)and Palo Alto Research Center (PARC).  All rights reserved.
+ */
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#ifdef __linux__
+#include <sys/inotify.h>
+#endif
+
+#include <LongBow/runtime.h>
+#include <parc/algol/parc_Memory.h>
+
+#include "tutorial_DirectoryWatcher.h"
+#include "tutorial_PathIndex.h"
+
+#ifdef __linux__
+
+/**
+ * A directory in the tree that has an inotify watch.
+ */
+typedef struct {
+    int watchDescriptor;
+    char *path;           // Relative to the directory being watched. "" for the directory itself.
+} _TutorialWatchedDirectory;
+
+#endif
+
+struct tutorial_directory_watcher {
+    pthread_mutex_t lock; // Serializes tutorialDirectoryWatcher_ProcessChanges().
+    char *directoryPath;
+
+#ifdef __linux__
+    int inotifyDescriptor;
+    _TutorialWatchedDirectory *watched; // Sorted by watch descriptor, which inotify hands out in increasing order.
+    size_t watchedCount;
+    size_t watchedCapacity;
+#else
+    struct timespec lastModificationTime;
+#endif
+};
+
+#ifdef __linux__
+
+/**
+ * The inotify events that can change what a directory listing or a file's contents look like.
+ */
+static const uint32_t _watchedEvents = IN_CREATE | IN_CLOSE_WRITE | IN_MODIFY | IN_ATTRIB
+                                       | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO
+                                       | IN_DELETE_SELF | IN_MOVE_SELF;
+
+/**
+ * Find the directory with the specified watch descriptor, using a binary search.
+ *
+ * @return true if it is being watched, in which case `index` is set to its position.
+ *         false if it isn't, in which case `index` is set to the position it would be inserted at.
+ */
+static bool
+_findWatchedDirectory(const TutorialDirectoryWatcher *watcher, int watchDescriptor, size_t *index)
+{
+    size_t low = 0;
+    size_t high = watcher->watchedCount;
+
+    while (low < high) {
+        size_t middle = low + (high - low) / 2;
+        if (watcher->watched[middle].watchDescriptor == watchDescriptor) {
+            *index = middle;
+            return true;
+        } else if (watcher->watched[middle].watchDescriptor < watchDescriptor) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+
+    *index = low;
+    return false;
+}
+
+static void
+_removeWatchedDirectory(TutorialDirectoryWatcher *watcher, size_t index)
+{
+    parcMemory_Deallocate((void **) &watcher->watched[index].path);
+    memmove(&watcher->watched[index], &watcher->watched[index + 1],
+            (watcher->watchedCount - index - 1) * sizeof(_TutorialWatchedDirectory));
+    watcher->watchedCount--;
+}
+
+/**
+ * Watch a directory of the tree, and every directory below it that is served. A directory that is already
+ * watched, because it was renamed within the tree, is recorded under its new path.
+ */
+static void
+_watchTree(TutorialDirectoryWatcher *watcher, const char *path)
+{
+    char directoryPath[strlen(watcher->directoryPath) + strlen(path) + 2]; // +2 for '/' and trailing null.
+    snprintf(directoryPath, sizeof(directoryPath), "%s/%s", watcher->directoryPath, path);
+
+    int watchDescriptor = inotify_add_watch(watcher->inotifyDescriptor, directoryPath, _watchedEvents | IN_ONLYDIR | IN_DONT_FOLLOW);
+    if (watchDescriptor < 0) {
+        return; // It has already gone, can't be read, or the limit on inotify watches has been reached.
+    }
+
+    size_t index;
+    if (_findWatchedDirectory(watcher, watchDescriptor, &index)) {
+        parcMemory_Deallocate((void **) &watcher->watched[index].path);
+    } else {
+        if (watcher->watchedCount == watcher->watchedCapacity) {
+            watcher->watchedCapacity = (watcher->watchedCapacity == 0) ? 16 : watcher->watchedCapacity * 2;
+            watcher->watched = parcMemory_Reallocate(watcher->watched, watcher->watchedCapacity * sizeof(_TutorialWatchedDirectory));
+            assertNotNull(watcher->watched, "parcMemory_Reallocate(%zu) returned NULL", watcher->watchedCapacity * sizeof(_TutorialWatchedDirectory));
+        }
+        memmove(&watcher->watched[index + 1], &watcher->watched[index],
+                (watcher->watchedCount - index) * sizeof(_TutorialWatchedDirectory));
+        watcher->watchedCount++;
+    }
+    watcher->watched[index].watchDescriptor = watchDescriptor;
+    watcher->watched[index].path = parcMemory_StringDuplicate(path, strlen(path));
+
+    // The directory is watched before it is read, so nothing created in it from now on is missed.
+    DIR *stream = opendir(directoryPath);
+    if (stream == NULL) {
+        return;
+    }
+
+    struct dirent *entry;
+    while ((entry = readdir(stream)) != NULL) {
+        struct stat fileInfo;
+        if (tutorialPathIndex_IsDirectoryServed(entry->d_name)
+            && fstatat(dirfd(stream), entry->d_name, &fileInfo, AT_SYMLINK_NOFOLLOW) == 0 && S_ISDIR(fileInfo.st_mode)) {
+            char childPath[strlen(path) + strlen(entry->d_name) + 2];
+            snprintf(childPath, sizeof(childPath), "%s%s%s", path, (path[0] != '\0') ? "/" : "", entry->d_name);
+            _watchTree(watcher, childPath);
+        }
+    }
+
+    closedir(stream);
+}
+
+/**
+ * Stop watching a directory that has left the tree, and every directory below it.
+ */
+static void
+_unwatchTree(TutorialDirectoryWatcher *watcher, const char *path)
+{
+    size_t pathLength = strlen(path);
+
+    for (size_t i = 0; i < watcher->watchedCount; ) {
+        const char *watchedPath = watcher->watched[i].path;
+        if (strncmp(watchedPath, path, pathLength) == 0 && (watchedPath[pathLength] == '\0' || watchedPath[pathLength] == '/')) {
+            inotify_rm_watch(watcher->inotifyDescriptor, watcher->watched[i].watchDescriptor);
+            _removeWatchedDirectory(watcher, i);
+        } else {
+            i++;
+        }
+    }
+}
+
+static void
+_startWatching(TutorialDirectoryWatcher *watcher)
+{
+    watcher->inotifyDescriptor = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    assertTrue(watcher->inotifyDescriptor >= 0, "inotify_init1() failed: %s", strerror(errno));
+
+    _watchTree(watcher, "");
+    assertTrue(watcher->watchedCount > 0, "Couldn't watch directory '%s': %s", watcher->directoryPath, strerror(errno));
+}
+
+static void
+_stopWatching(TutorialDirectoryWatcher *watcher)
+{
+    close(watcher->inotifyDescriptor);
+
+    for (size_t i = 0; i < watcher->watchedCount; i++) {
+        parcMemory_Deallocate((void **) &watcher->watched[i].path);
+    }
+    if (watcher->watched != NULL) {
+        parcMemory_Deallocate((void **) &watcher->watched);
+    }
+}
+
+/**
+ * Report one inotify event, if it changes what is served.
+ *
+ * @return The number of changes reported: 0 or 1.
+ */
+static size_t
+_processEvent(TutorialDirectoryWatcher *watcher, const struct inotify_event *event,
+              TutorialDirectoryChangeHandler *handler, void *context)
+{
+    size_t index;
+    bool isWatched = _findWatchedDirectory(watcher, event->wd, &index);
+
+    if (event->mask & IN_Q_OVERFLOW) {
+        _watchTree(watcher, ""); // Directories created since the overflow aren't watched yet.
+        handler(context, TutorialDirectoryChange_Rescan, NULL);
+        return 1;
+    } else if (isWatched == false) {
+        return 0; // A directory we have already stopped watching.
+    } else if (event->mask & IN_IGNORED) {
+        _removeWatchedDirectory(watcher, index); // The directory was deleted, and its watch removed.
+        return 0;
+    } else if (event->mask & (IN_DELETE_SELF | IN_MOVE_SELF)) {
+        // A directory below the top is reported by its parent. If the top goes, everything may have changed.
+        if (watcher->watched[index].path[0] == '\0') {
+            handler(context, TutorialDirectoryChange_Rescan, NULL);
+            return 1;
+        }
+        return 0;
+    } else if (event->len == 0) {
+        return 0;
+    }
+
+    const char *directoryPath = watcher->watched[index].path;
+    char path[strlen(directoryPath) + strlen(event->name) + 2]; // +2 for '/' and trailing null.
+    snprintf(path, sizeof(path), "%s%s%s", directoryPath, (directoryPath[0] != '\0') ? "/" : "", event->name);
+
+    if ((event->mask & IN_ISDIR) && tutorialPathIndex_IsDirectoryServed(event->name) == false) {
+        return 0;
+    } else if (event->mask & (IN_DELETE | IN_MOVED_FROM)) {
+        if (event->mask & IN_ISDIR) {
+            _unwatchTree(watcher, path);
+        }
+        handler(context, TutorialDirectoryChange_Removed, path);
+    } else if ((event->mask & IN_ISDIR) && (event->mask & (IN_CREATE | IN_MOVED_TO)) == 0) {
+        return 0; // Only the directory itself changed, not what is in it.
+    } else {
+        if (event->mask & IN_ISDIR) {
+            _watchTree(watcher, path);
+        }
+        handler(context, TutorialDirectoryChange_Modified, path);
+    }
+
+    return 1;
+}
+
+static size_t
+_processChanges(TutorialDirectoryWatcher *watcher, TutorialDirectoryChangeHandler *handler, void *context)
+{
+    size_t result = 0;
+    char events[16 * 1024] __attribute__ ((aligned(__alignof__(struct inotify_event))));
+    ssize_t length;
+
+    while ((length = read(watcher->inotifyDescriptor, events, sizeof(events))) > 0) {
+        for (char *next = events; next < events + length; ) {
+            const struct inotify_event *event = (const struct inotify_event *) next;
+            next += sizeof(struct inotify_event) + event->len;
+
+            result += _processEvent(watcher, event, handler, context);
+        }
+    }
+
+    return result;
+}
+
+static bool
+_waitForChanges(TutorialDirectoryWatcher *watcher, uint32_t timeoutMilliseconds)
+{
+    struct pollfd pollDescriptor = { .fd = watcher->inotifyDescriptor, .events = POLLIN };
+    return poll(&pollDescriptor, 1, (int) timeoutMilliseconds) > 0;
+}
+
+#else // Not Linux, so fall back to checking the directory's modification time.
+
+static struct timespec
+_getModificationTime(const char *directoryPath)
+{
+    struct timespec result = { 0, 0 };
+    struct stat directoryInfo;
+
+    if (stat(directoryPath, &directoryInfo) == 0) {
+#ifdef __APPLE__
+        result = directoryInfo.st_mtimespec;
+#else
+        result = directoryInfo.st_mtim;
+#endif
+    }
+
+    return result;
+}
+
+static void
+_startWatching(TutorialDirectoryWatcher *watcher)
+{
+    watcher->lastModificationTime = _getModificationTime(watcher->directoryPath);
+}
+
+static void
+_stopWatching(TutorialDirectoryWatcher *watcher)
+{
+}
+
+static size_t
+_processChanges(TutorialDirectoryWatcher *watcher, TutorialDirectoryChangeHandler *handler, void *context)
+{
+    size_t result = 0;
+    struct timespec modificationTime = _getModificationTime(watcher->directoryPath);
+
+    if (modificationTime.tv_sec != watcher->lastModificationTime.tv_sec
+        || modificationTime.tv_nsec != watcher->lastModificationTime.tv_nsec) {
+        watcher->lastModificationTime = modificationTime;
+        handler(context, TutorialDirectoryChange_Rescan, NULL);
+        result++;
+    }
+
+    return result;
+}
+
+static bool
+_waitForChanges(TutorialDirectoryWatcher *watcher, uint32_t timeoutMilliseconds)
+{
+    // There's nothing to wait on, so just let the interval pass before the modification time is checked again.
+    struct timespec interval = { .tv_sec = timeoutMilliseconds / 1000, .tv_nsec = (timeoutMilliseconds % 1000) * 1000000L };
+    nanosleep(&interval, NULL);
+    return true;
+}
+
+#endif // __linux__
+
+TutorialDirectoryWatcher *
+tutorialDirectoryWatcher_Create(const char *directoryPath)
+{
+    TutorialDirectoryWatcher *result = parcMemory_AllocateAndClear(sizeof(TutorialDirectoryWatcher));
+    assertNotNull(result, "parcMemory_AllocateAndClear(%zu) returned NULL", sizeof(TutorialDirectoryWatcher));
+
+    result->directoryPath = parcMemory_StringDuplicate(directoryPath, strlen(directoryPath));
+    pthread_mutex_init(&result->lock, NULL);
+
+    _startWatching(result);
+
+    return result;
+}
+
+void
+tutorialDirectoryWatcher_Release(TutorialDirectoryWatcher **watcherP)
+{
+    TutorialDirectoryWatcher *watcher = *watcherP;
+
+    _stopWatching(watcher);
+
+    pthread_mutex_destroy(&watcher->lock);
+    parcMemory_Deallocate((void **) &watcher->directoryPath);
+    parcMemory_Deallocate((void **) watcherP);
+}
+
+size_t
+tutorialDirectoryWatcher_ProcessChanges(TutorialDirectoryWatcher *watcher, TutorialDirectoryChangeHandler *handler, void *context)
+{
+    pthread_mutex_lock(&watcher->lock);
+    size_t result = _processChanges(watcher, handler, context);
+    pthread_mutex_unlock(&watcher->lock);
+
+    return result;
+}
+
+bool
+tutorialDirectoryWatcher_WaitForChanges(TutorialDirectoryWatcher *watcher, uint32_t timeoutMilliseconds)
+{
+    return _waitForChanges(watcher, timeoutMilliseconds);
+}
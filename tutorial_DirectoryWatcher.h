@@ -0,0 +1,113 @@
+/*
+ * Copyright (c) 2014-2015, Xerox Corporation (Xerox)and Palo Alto Research Center (PARC)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Patent rights are not granted under this agreement. Patent rights are
+ *       available under FRAND terms.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL XEROX or PARC BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+/**
+ * @author Alan Walendowski, Palo Alto Research Center (Xerox PARC)
+ * @copyright 2014-2015, Xerox Corporation (Xerox)and Palo Alto Research Center (PARC).  All rights reserved.
+ */
+
+#ifndef tutorial_DirectoryWatcher_h
+#define tutorial_DirectoryWatcher_h
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * A TutorialDirectoryWatcher reports changes to the files in a directory, and in the directories below it that are
+ * served (see tutorialPathIndex_IsDirectoryServed()), so that state derived from the tree (such as its listing) can
+ * be updated incrementally instead of being rebuilt for every request.
+ *
+ * On Linux, changes are reported per file using inotify, with a watch on each directory of the tree. A directory
+ * created in or renamed into the tree is watched, and reported as a whole; one deleted or renamed out of it is
+ * reported as a whole too. Elsewhere, the watcher checks the top directory's modification time and reports a
+ * TutorialDirectoryChange_Rescan when it changes. Note that a directory's modification time only changes when
+ * files are added, removed or renamed in it, not when an existing file is written to, or when its subdirectories change.
+ */
+typedef struct tutorial_directory_watcher TutorialDirectoryWatcher;
+
+/**
+ * The kinds of change reported by a TutorialDirectoryWatcher.
+ */
+typedef enum {
+    TutorialDirectoryChange_Modified, // The named file or directory was created, written to, or renamed into the tree.
+    TutorialDirectoryChange_Removed,  // The named file or directory was deleted, or renamed out of the tree.
+    TutorialDirectoryChange_Rescan    // Changes may have been missed. Anything derived from the directory should be rebuilt.
+} TutorialDirectoryChangeType;
+
+/**
+ * The signature of the function called for each change reported by tutorialDirectoryWatcher_ProcessChanges().
+ *
+ * @param [in] context The context pointer given to tutorialDirectoryWatcher_ProcessChanges().
+ * @param [in] changeType The kind of change.
+ * @param [in] fileName The path of the changed file or directory, relative to the directory being watched.
+ *                      NULL for TutorialDirectoryChange_Rescan.
+ */
+typedef void (TutorialDirectoryChangeHandler)(void *context, TutorialDirectoryChangeType changeType, const char *fileName);
+
+/**
+ * Start watching the specified directory for changes. The returned instance must eventually be released
+ * by calling tutorialDirectoryWatcher_Release().
+ *
+ * @param [in] directoryPath A pointer to a string containing the path of the directory to watch.
+ *
+ * @return A new TutorialDirectoryWatcher instance.
+ */
+TutorialDirectoryWatcher *tutorialDirectoryWatcher_Create(const char *directoryPath);
+
+/**
+ * Stop watching the directory and release the watcher's resources.
+ *
+ * @param [in,out] watcherP A pointer to the pointer to the TutorialDirectoryWatcher to release. It will be set to NULL.
+ */
+void tutorialDirectoryWatcher_Release(TutorialDirectoryWatcher **watcherP);
+
+/**
+ * Report any changes to the directory since the last call, by calling `handler` once for each change.
+ * This does not block waiting for changes. It may be called from several threads, and the handler is
+ * never called by more than one thread at a time.
+ *
+ * @param [in] watcher The TutorialDirectoryWatcher to check.
+ * @param [in] handler The function to call for each change.
+ * @param [in] context A pointer passed on to `handler`.
+ *
+ * @return The number of changes reported.
+ */
+size_t tutorialDirectoryWatcher_ProcessChanges(TutorialDirectoryWatcher *watcher, TutorialDirectoryChangeHandler *handler, void *context);
+
+/**
+ * Block until there may be changes to the directory to report, or until the specified time has passed. The
+ * changes themselves are reported by calling tutorialDirectoryWatcher_ProcessChanges() afterwards. On Linux this
+ * waits for inotify events. Elsewhere, where the directory's modification time has to be polled, it waits for
+ * the whole time, and then returns true.
+ *
+ * @param [in] watcher The TutorialDirectoryWatcher to wait on.
+ * @param [in] timeoutMilliseconds The longest time to wait.
+ *
+ * @return true If there may be changes to report.
+ * @return false If the time passed without any.
+ */
+bool tutorialDirectoryWatcher_WaitForChanges(TutorialDirectoryWatcher *watcher, uint32_t timeoutMilliseconds);
+#endif // tutorial_DirectoryWatcher_h
@@ -0,0 +1,387 @@
+/*
+ * Copyright (c) 2014-2015, Xerox Corporation (Xerox)and Palo Alto Research Center (PARC)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Patent rights are not granted under this agreement. Patent rights are
+ *       available under FRAND terms.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL XEROX or PARC BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+/**
+ * @author Alan Walendowski, Palo Alto Research Center (Xerox PARC)
+ * @copyright 2014-2015, Xerox Corporation (Xerox)and Palo Alto Research Center (PARC).  All rights reserved.
+ */
+#include <stdio.h>
+#include <time.h>
+
+#include <LongBow/runtime.h>
+#include <parc/algol/parc_Memory.h>
+
+#include <ccnx/common/ccnx_Interest.h>
+#include <ccnx/common/ccnx_NameSegmentNumber.h>
+
+#include "tutorial_Fetcher.h"
+#include "tutorial_Common.h"
+
+const size_t tutorialFetcher_DefaultWindowSize = 256;
+
+// Retransmission timeout bounds, and the timeout used before any round trip has been measured.
+static const uint64_t _initialTimeoutMicroseconds = 1000000;
+static const uint64_t _minimumTimeoutMicroseconds = 200000;
+static const uint64_t _maximumTimeoutMicroseconds = 8000000;
+
+// How many times an Interest is sent before the transfer is abandoned.
+static const unsigned _maximumTransmissions = 8;
+
+/**
+ * An Interest that has been sent and not yet answered.
+ */
+typedef struct {
+    bool inUse;
+    uint64_t chunkNumber;
+    uint64_t sentAt;       // Microseconds, from _now().
+    uint64_t timeoutAt;    // Microseconds, from _now().
+    unsigned transmissions;
+} _TutorialFetcherRequest;
+
+struct tutorial_fetcher {
+    CCNxPortal *portal;
+    CCNxName *name;
+    size_t nameSegmentCount;
+
+    TutorialReassembler *reassembler;
+    TutorialFetcherReceiver *receiver;
+    void *receiverContext;
+
+    _TutorialFetcherRequest *requests;  // The outstanding Interests. `windowSize` entries.
+    size_t windowSize;                  // The maximum window.
+
+    const TutorialCongestionControl *congestionControl;
+    void *congestionState;
+
+    size_t outstandingCount;
+    uint64_t nextChunkNumber;           // The next chunk that has never been requested.
+
+    // Round trip estimates, as in RFC 6298.
+    uint64_t smoothedRoundTrip;
+    uint64_t roundTripVariation;
+    uint64_t retransmissionTimeout;
+
+    TutorialFetcherStatistics statistics;
+    bool hasFailed;
+};
+
+static uint64_t
+_now(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t) now.tv_sec * 1000000 + (uint64_t) now.tv_nsec / 1000;
+}
+
+/**
+ * Fold a new round trip measurement into the fetcher's estimates, and recompute the retransmission timeout.
+ */
+static void
+_updateRoundTripEstimate(TutorialFetcher *fetcher, uint64_t roundTrip)
+{
+    if (fetcher->smoothedRoundTrip == 0) {
+        fetcher->smoothedRoundTrip = roundTrip;
+        fetcher->roundTripVariation = roundTrip / 2;
+    } else {
+        uint64_t difference = (roundTrip > fetcher->smoothedRoundTrip) ? roundTrip - fetcher->smoothedRoundTrip
+                                                                        : fetcher->smoothedRoundTrip - roundTrip;
+        fetcher->roundTripVariation = (3 * fetcher->roundTripVariation + difference) / 4;
+        fetcher->smoothedRoundTrip = (7 * fetcher->smoothedRoundTrip + roundTrip) / 8;
+    }
+
+    uint64_t timeout = fetcher->smoothedRoundTrip + 4 * fetcher->roundTripVariation;
+    if (timeout < _minimumTimeoutMicroseconds) {
+        timeout = _minimumTimeoutMicroseconds;
+    } else if (timeout > _maximumTimeoutMicroseconds) {
+        timeout = _maximumTimeoutMicroseconds;
+    }
+    fetcher->retransmissionTimeout = timeout;
+    fetcher->statistics.smoothedRoundTripMicroseconds = fetcher->smoothedRoundTrip;
+}
+
+/**
+ * Send (or resend) the Interest for the specified request, and set its timeout.
+ */
+static void
+_sendInterest(TutorialFetcher *fetcher, _TutorialFetcherRequest *request)
+{
+    CCNxName *chunkName = ccnxName_Copy(fetcher->name);
+    CCNxNameSegment *chunkSegment = ccnxNameSegmentNumber_Create(CCNxNameLabelType_CHUNK, request->chunkNumber);
+    ccnxName_Append(chunkName, chunkSegment);
+    ccnxNameSegment_Release(&chunkSegment);
+
+    // Back off exponentially each time an Interest has to be resent.
+    uint64_t timeout = fetcher->retransmissionTimeout << request->transmissions;
+    if (timeout > _maximumTimeoutMicroseconds) {
+        timeout = _maximumTimeoutMicroseconds;
+    }
+
+    CCNxInterest *interest = ccnxInterest_CreateSimple(chunkName);
+    ccnxInterest_SetLifetime(interest, (uint32_t) (timeout / 1000)); // Let the forwarders forget it when we do.
+
+    CCNxMetaMessage *message = ccnxMetaMessage_CreateFromInterest(interest);
+    if (ccnxPortal_Send(fetcher->portal, message, CCNxStackTimeout_Never) == false) {
+        fprintf(stderr, "ccnxPortal_Send failed (error %d). Is the Forwarder running?\n", ccnxPortal_GetError(fetcher->portal));
+    }
+
+    request->sentAt = _now();
+    request->timeoutAt = request->sentAt + timeout;
+    request->transmissions++;
+
+    fetcher->statistics.interestsSent++;
+    if (request->transmissions > 1) {
+        fetcher->statistics.retransmissions++;
+    }
+
+    ccnxMetaMessage_Release(&message);
+    ccnxInterest_Release(&interest);
+    ccnxName_Release(&chunkName);
+}
+
+/**
+ * Issue Interests for chunks that haven't been requested yet, until the window allowed by the congestion control
+ * algorithm is full or `allowance` Interests have been sent. Until the first response tells us the final chunk
+ * number, only chunk 0 is requested. Return the number of Interests sent.
+ */
+static size_t
+_fillWindow(TutorialFetcher *fetcher, size_t allowance)
+{
+    uint64_t finalChunkNumber = tutorialReassembler_GetFinalChunkNumber(fetcher->reassembler);
+    uint64_t lastChunkToRequest = (finalChunkNumber == UINT64_MAX) ? 0 : finalChunkNumber;
+
+    size_t window = fetcher->congestionControl->getWindow(fetcher->congestionState);
+    if (window > fetcher->windowSize) {
+        window = fetcher->windowSize;
+    }
+
+    size_t sentCount = 0;
+    for (size_t i = 0; i < fetcher->windowSize && fetcher->outstandingCount < window && sentCount < allowance; i++) {
+        // Skip any chunks we already have.
+        while (fetcher->nextChunkNumber <= lastChunkToRequest
+               && tutorialReassembler_HasChunk(fetcher->reassembler, fetcher->nextChunkNumber)) {
+            fetcher->nextChunkNumber++;
+        }
+        if (fetcher->nextChunkNumber > lastChunkToRequest) {
+            break;
+        }
+
+        _TutorialFetcherRequest *request = &fetcher->requests[i];
+        if (request->inUse == false) {
+            request->inUse = true;
+            request->chunkNumber = fetcher->nextChunkNumber++;
+            request->transmissions = 0;
+            fetcher->outstandingCount++;
+            _sendInterest(fetcher, request);
+            sentCount++;
+        }
+    }
+    return sentCount;
+}
+
+/**
+ * Resend any Interests whose timeout has passed. Return the number of microseconds until the next timeout.
+ */
+static uint64_t
+_retransmitExpiredInterests(TutorialFetcher *fetcher)
+{
+    uint64_t now = _now();
+    uint64_t nextTimeout = UINT64_MAX;
+
+    for (size_t i = 0; i < fetcher->windowSize; i++) {
+        _TutorialFetcherRequest *request = &fetcher->requests[i];
+        if (request->inUse) {
+            if (request->timeoutAt <= now) {
+                if (request->transmissions >= _maximumTransmissions) {
+                    fprintf(stderr, "tutorial_Fetcher: chunk %llu was not received after %u attempts.\n",
+                            (unsigned long long) request->chunkNumber, request->transmissions);
+                    fetcher->hasFailed = true;
+                    return 0;
+                }
+                fetcher->congestionControl->onTimeout(fetcher->congestionState, now);
+                _sendInterest(fetcher, request);
+            }
+            if (request->timeoutAt < nextTimeout) {
+                nextTimeout = request->timeoutAt;
+            }
+        }
+    }
+
+    return (nextTimeout == UINT64_MAX) ? _initialTimeoutMicroseconds : (nextTimeout > now ? nextTimeout - now : 0);
+}
+
+/**
+ * Match a response to its outstanding Interest, update the round trip estimate, and hand it to the receiver.
+ * Responses that don't match an outstanding Interest (e.g. a second answer to a retransmitted Interest) are ignored.
+ * If the receiver rejects the response, the Interest is sent again, up to the usual number of transmissions.
+ * Return false if the response isn't a chunk of the fetcher's content at all.
+ */
+static bool
+_receiveContentObject(TutorialFetcher *fetcher, CCNxContentObject *contentObject)
+{
+    CCNxName *contentName = ccnxContentObject_GetName(contentObject);
+
+    if (ccnxName_GetSegmentCount(contentName) != fetcher->nameSegmentCount + 1
+        || ccnxName_StartsWith(contentName, fetcher->name) == false) {
+        return false;
+    }
+
+    uint64_t chunkNumber = tutorialCommon_GetChunkNumberFromName(contentName);
+
+    for (size_t i = 0; i < fetcher->windowSize; i++) {
+        _TutorialFetcherRequest *request = &fetcher->requests[i];
+        if (request->inUse && request->chunkNumber == chunkNumber) {
+            // Only time Interests that were sent once, since we can't tell which transmission a response is for.
+            uint64_t now = _now();
+            uint64_t roundTrip = 0;
+            if (request->transmissions == 1) {
+                roundTrip = now - request->sentAt;
+                _updateRoundTripEstimate(fetcher, roundTrip);
+            }
+            fetcher->congestionControl->onResponse(fetcher->congestionState, roundTrip, now);
+
+            request->inUse = false;
+            fetcher->outstandingCount--;
+            fetcher->statistics.responsesReceived++;
+
+            if (fetcher->receiver(fetcher->receiverContext, contentObject) == false) {
+                if (request->transmissions >= _maximumTransmissions) {
+                    fprintf(stderr, "tutorial_Fetcher: chunk %llu was rejected after %u attempts.\n",
+                            (unsigned long long) request->chunkNumber, request->transmissions);
+                    fetcher->hasFailed = true;
+                } else {
+                    request->inUse = true;
+                    fetcher->outstandingCount++;
+                    _sendInterest(fetcher, request);
+                }
+            }
+            break;
+        }
+    }
+    return true;
+}
+
+TutorialFetcher *
+tutorialFetcher_Create(CCNxPortal *portal, const CCNxName *name, size_t windowSize,
+                       const TutorialCongestionControl *congestionControl,
+                       TutorialReassembler *reassembler, TutorialFetcherReceiver *receiver, void *context)
+{
+    assertTrue(windowSize > 0, "The window size of a TutorialFetcher must be greater than 0");
+
+    TutorialFetcher *result = parcMemory_AllocateAndClear(sizeof(TutorialFetcher));
+    assertNotNull(result, "parcMemory_AllocateAndClear(%zu) returned NULL", sizeof(TutorialFetcher));
+
+    result->portal = portal;
+    result->name = ccnxName_Acquire(name);
+    result->nameSegmentCount = ccnxName_GetSegmentCount(name);
+    result->reassembler = reassembler;
+    result->receiver = receiver;
+    result->receiverContext = context;
+    result->windowSize = windowSize;
+    result->congestionControl = congestionControl;
+    result->congestionState = congestionControl->create(windowSize);
+    result->retransmissionTimeout = _initialTimeoutMicroseconds;
+
+    result->requests = parcMemory_AllocateAndClear(windowSize * sizeof(_TutorialFetcherRequest));
+    assertNotNull(result->requests, "parcMemory_AllocateAndClear(%zu) returned NULL", windowSize * sizeof(_TutorialFetcherRequest));
+
+    return result;
+}
+
+void
+tutorialFetcher_Release(TutorialFetcher **fetcherP)
+{
+    assertNotNull(fetcherP, "Parameter must be a non-null pointer to a TutorialFetcher pointer.");
+    TutorialFetcher *fetcher = *fetcherP;
+
+    fetcher->congestionControl->release(&fetcher->congestionState);
+    parcMemory_Deallocate((void **) &fetcher->requests);
+    ccnxName_Release(&fetcher->name);
+    parcMemory_Deallocate((void **) fetcherP);
+}
+
+bool
+tutorialFetcher_Run(TutorialFetcher *fetcher)
+{
+    while (tutorialReassembler_IsComplete(fetcher->reassembler) == false
+           && fetcher->hasFailed == false
+           && ccnxPortal_IsError(fetcher->portal) == false) {
+        _fillWindow(fetcher, SIZE_MAX);
+
+        uint64_t timeUntilNextTimeout = _retransmitExpiredInterests(fetcher);
+        if (fetcher->hasFailed) {
+            break;
+        }
+
+        // Wait for a response, but no longer than it takes for the next Interest to time out.
+        CCNxMetaMessage *response = ccnxPortal_Receive(fetcher->portal, CCNxStackTimeout_MicroSeconds(timeUntilNextTimeout));
+
+        if (response != NULL) {
+            if (ccnxMetaMessage_IsContentObject(response)) {
+                _receiveContentObject(fetcher, ccnxMetaMessage_GetContentObject(response));
+            }
+            ccnxMetaMessage_Release(&response);
+        }
+    }
+
+    return tutorialReassembler_IsComplete(fetcher->reassembler);
+}
+
+bool
+tutorialFetcher_IsFinished(const TutorialFetcher *fetcher)
+{
+    return fetcher->hasFailed || tutorialReassembler_IsComplete(fetcher->reassembler);
+}
+
+size_t
+tutorialFetcher_SendInterests(TutorialFetcher *fetcher, size_t allowance)
+{
+    return tutorialFetcher_IsFinished(fetcher) ? 0 : _fillWindow(fetcher, allowance);
+}
+
+uint64_t
+tutorialFetcher_RetransmitExpiredInterests(TutorialFetcher *fetcher)
+{
+    return tutorialFetcher_IsFinished(fetcher) ? UINT64_MAX : _retransmitExpiredInterests(fetcher);
+}
+
+bool
+tutorialFetcher_ReceiveContentObject(TutorialFetcher *fetcher, CCNxContentObject *contentObject)
+{
+    return _receiveContentObject(fetcher, contentObject);
+}
+
+size_t
+tutorialFetcher_GetOutstandingCount(const TutorialFetcher *fetcher)
+{
+    return tutorialFetcher_IsFinished(fetcher) ? 0 : fetcher->outstandingCount;
+}
+
+void
+tutorialFetcher_GetStatistics(const TutorialFetcher *fetcher, TutorialFetcherStatistics *statistics)
+{
+    *statistics = fetcher->statistics;
+    statistics->window = fetcher->congestionControl->getWindow(fetcher->congestionState);
+}
@@ -0,0 +1,188 @@
+/*
+ * Copyright (c) 2014-2015, Xerox Corporation (Xerox)and Palo Alto Research Center (PARC)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Patent rights are not granted under this agreement. Patent rights are
+ *       available under FRAND terms.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL XEROX or PARC BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+/**
+ * @author Alan Walendowski, Palo Alto Research Center (Xerox PARC)
+ * @copyright 2014-2015, Xerox Corporation (Xerox)and Palo Alto Research Center (PARC).  All rights reserved.
+ */
+
+#ifndef tutorial_Fetcher_h
+#define tutorial_Fetcher_h
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include <ccnx/api/ccnx_Portal/ccnx_Portal.h>
+#include <ccnx/common/ccnx_ContentObject.h>
+#include <ccnx/common/ccnx_Name.h>
+
+#include "tutorial_Reassembler.h"
+#include "tutorial_CongestionControl.h"
+
+/**
+ * A TutorialFetcher retrieves every chunk of a piece of content by issuing its own Interest for each chunk,
+ * keeping a window of them outstanding at once. The size of the window is decided by a TutorialCongestionControl
+ * algorithm, up to a fixed maximum. It is used with a Portal created with
+ * ccnxPortalRTA_Message, so the flow of Interests is under the application's control rather than the
+ * chunked Portal's.
+ *
+ * Each Interest has a retransmission timeout, derived from the measured round trip time in the manner of
+ * RFC 6298. An Interest that isn't answered in time is assumed lost and sent again, with the timeout doubled.
+ *
+ * The fetcher learns the final chunk number from the first response, and uses a TutorialReassembler to tell
+ * which chunks are still needed and when the content is complete. Responses are handed to a
+ * TutorialFetcherReceiver, which is expected to add them to that reassembler.
+ *
+ * A fetcher can either run on its own Portal with tutorialFetcher_Run(), or share a Portal with other fetchers.
+ * In that case the caller owns the receive loop: it sends and resends each fetcher's Interests with
+ * tutorialFetcher_SendInterests() and tutorialFetcher_RetransmitExpiredInterests(), and offers every response it
+ * receives to tutorialFetcher_ReceiveContentObject() until the fetcher it belongs to accepts it.
+ */
+typedef struct tutorial_fetcher TutorialFetcher;
+
+/**
+ * The function a TutorialFetcher calls with each response to one of its Interests.
+ *
+ * @param [in] context The context pointer passed to tutorialFetcher_Create().
+ * @param [in] contentObject The response.
+ *
+ * @return true If the response was accepted.
+ * @return false If it was rejected (e.g. it didn't match its digest), in which case the chunk is asked for again.
+ */
+typedef bool (TutorialFetcherReceiver)(void *context, CCNxContentObject *contentObject);
+
+/**
+ * Counters describing the progress of a TutorialFetcher.
+ */
+typedef struct {
+    uint64_t interestsSent;         // Including retransmissions.
+    uint64_t retransmissions;
+    uint64_t responsesReceived;     // Responses that matched an outstanding Interest.
+    uint64_t smoothedRoundTripMicroseconds;
+    size_t window;                  // The number of Interests currently allowed outstanding.
+} TutorialFetcherStatistics;
+
+/**
+ * The default maximum number of Interests a TutorialFetcher keeps outstanding.
+ */
+extern const size_t tutorialFetcher_DefaultWindowSize;
+
+/**
+ * Create a new TutorialFetcher. The returned instance must eventually be released by calling tutorialFetcher_Release().
+ *
+ * @param [in] portal The CCNxPortal to send Interests and receive responses on.
+ * @param [in] name The name of the content, without a chunk segment, e.g. "lci:/ccnx/tutorial/fetch/file.txt".
+ * @param [in] windowSize The maximum number of Interests to keep outstanding. Must be greater than 0.
+ * @param [in] congestionControl The algorithm that decides how many Interests to keep outstanding, up to `windowSize`.
+ * @param [in] reassembler The TutorialReassembler the received chunks are added to.
+ * @param [in] receiver The function to call with each response.
+ * @param [in] context A pointer passed to `receiver`.
+ *
+ * @return A new TutorialFetcher instance.
+ */
+TutorialFetcher *tutorialFetcher_Create(CCNxPortal *portal, const CCNxName *name, size_t windowSize,
+                                        const TutorialCongestionControl *congestionControl,
+                                        TutorialReassembler *reassembler, TutorialFetcherReceiver *receiver, void *context);
+
+/**
+ * Release the specified TutorialFetcher.
+ *
+ * @param [in,out] fetcherP A pointer to the pointer to the TutorialFetcher to release. It will be set to NULL.
+ */
+void tutorialFetcher_Release(TutorialFetcher **fetcherP);
+
+/**
+ * Issue Interests and process their responses until the content is complete, a chunk has been retransmitted
+ * too many times without an answer, or the Portal reports an error.
+ *
+ * @param [in] fetcher The TutorialFetcher to run.
+ *
+ * @return true If every chunk of the content was received.
+ */
+bool tutorialFetcher_Run(TutorialFetcher *fetcher);
+
+/**
+ * Determine whether the specified TutorialFetcher has finished, either because every chunk of the content was
+ * received or because a chunk has been retransmitted too many times without an answer.
+ *
+ * @param [in] fetcher The TutorialFetcher to inspect.
+ *
+ * @return true If the fetcher won't send any more Interests.
+ */
+bool tutorialFetcher_IsFinished(const TutorialFetcher *fetcher);
+
+/**
+ * Issue Interests for chunks that haven't been requested yet, as the window allows, but no more than `allowance`
+ * of them. Callers sharing a Portal between fetchers use `allowance` to keep the total number of outstanding
+ * Interests under a limit of their own.
+ *
+ * @param [in] fetcher The TutorialFetcher to send Interests for.
+ * @param [in] allowance The maximum number of new Interests to send.
+ *
+ * @return The number of Interests sent.
+ */
+size_t tutorialFetcher_SendInterests(TutorialFetcher *fetcher, size_t allowance);
+
+/**
+ * Resend any of the fetcher's Interests whose retransmission timeout has passed. If one has already been sent too
+ * many times, the fetcher fails and finishes.
+ *
+ * @param [in] fetcher The TutorialFetcher to check.
+ *
+ * @return The number of microseconds until the fetcher's next Interest times out, or UINT64_MAX if it has finished.
+ */
+uint64_t tutorialFetcher_RetransmitExpiredInterests(TutorialFetcher *fetcher);
+
+/**
+ * Offer a response received on the fetcher's Portal to the fetcher. If it is a chunk of the fetcher's content that
+ * answers an outstanding Interest, it is handed to the fetcher's TutorialFetcherReceiver.
+ *
+ * @param [in] fetcher The TutorialFetcher to offer the response to.
+ * @param [in] contentObject The response.
+ *
+ * @return true If the response is a chunk of the fetcher's content, whether or not it was still wanted.
+ * @return false If it belongs to some other content.
+ */
+bool tutorialFetcher_ReceiveContentObject(TutorialFetcher *fetcher, CCNxContentObject *contentObject);
+
+/**
+ * Get the number of the fetcher's Interests that are waiting for a response.
+ *
+ * @param [in] fetcher The TutorialFetcher to inspect.
+ *
+ * @return The number of outstanding Interests, or 0 if the fetcher has finished.
+ */
+size_t tutorialFetcher_GetOutstandingCount(const TutorialFetcher *fetcher);
+
+/**
+ * Get the current counters of the specified TutorialFetcher.
+ *
+ * @param [in] fetcher The TutorialFetcher to inspect.
+ * @param [out] statistics Filled in with the fetcher's counters.
+ */
+void tutorialFetcher_GetStatistics(const TutorialFetcher *fetcher, TutorialFetcherStatistics *statistics);
+#endif // tutorial_Fetcher_h
@@ -0,0 +1,848 @@
+/*
+ * Copyright (c) 2014-2015, Xerox Corporation (Xerox)and Palo Alto Research Center (PARC)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Patent rights are not granted under this agreement. Patent rights are
+ *       available under FRAND terms.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL XEROX or PARC BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+/**
+ * @author Alan Walendowski, Palo Alto Research Center (Xerox PARC)
+ * @copyright 2014-2015, Xerox Corporation (Xerox)and Palo Alto Research Center (PARC).  All rights reserved.
+ */
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <setjmp.h>
+#include <signal.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+#include <LongBow/runtime.h>
+#include <parc/algol/parc_Memory.h>
+#include <parc/algol/parc_Object.h>
+
+#include "tutorial_FileCache.h"
+#include "tutorial_FileIO.h"
+
+const size_t tutorialFileCache_DefaultCapacity = 64;
+
+/**
+ * A read-only memory mapping of a file, and the slices of it that we have handed out. We keep our own
+ * reference to each slice, so a slice whose reference count has dropped to 1 is no longer in use by
+ * anyone else. A mapping is unmapped once it has been retired and none of its slices are in use.
+ */
+typedef struct tutorial_file_mapping {
+    uint8_t *address;
+    size_t length;
+    struct tutorial_guarded_range *guard; // Lets _handleBusError() recognize faults in this mapping.
+
+    PARCBuffer **slices;
+    size_t sliceCount;
+    size_t sliceCapacity;
+
+    struct tutorial_file_mapping *nextRetired;
+} _TutorialFileMapping;
+
+/**
+ * An open file descriptor shared between the cache and the threads reading from it. It is closed when
+ * the last reference is released, so a file evicted from the cache while another thread is reading it
+ * stays open until that read is finished.
+ */
+typedef struct {
+    int fileDescriptor;
+    unsigned referenceCount;
+} _TutorialSharedDescriptor;
+
+typedef struct {
+    char *filePath;       // NULL if this entry is unused.
+    uint32_t pathHash;    // Compared before filePath, to avoid most strcmp() calls.
+    _TutorialSharedDescriptor *descriptor;
+    struct stat fileInfo; // Metadata from the most recent fstat()/stat() of the file.
+    uint64_t lastUsed;    // Value of the cache's useClock when this entry was last used.
+    _TutorialFileMapping *mapping; // Created on first use, if the cache uses memory mapping.
+} _TutorialFileCacheEntry;
+
+struct tutorial_file_cache {
+    pthread_mutex_t lock; // Held while using the entries and mappings, but not while reading a file.
+
+    _TutorialFileCacheEntry *entries;
+    size_t capacity;
+    uint64_t useClock;
+
+    bool useMemoryMapping;
+    _TutorialFileMapping *retiredMappings; // Mappings of changed or evicted files, with slices still in use.
+};
+
+/**
+ * The address range of a memory mapping, registered so that a SIGBUS raised by reading it can be told apart
+ * from one raised elsewhere. Ranges are read by the signal handler without taking a lock, so they are never
+ * freed: an unregistered range has its length set to 0 and is reused by the next mapping.
+ */
+typedef struct tutorial_guarded_range {
+    uintptr_t start;
+    size_t length; // 0 if the range is unused.
+    bool hasFaulted; // Set by _handleBusError() once reading the range has raised SIGBUS.
+    struct tutorial_guarded_range *next;
+} _TutorialGuardedRange;
+
+static pthread_mutex_t _guardedRangesLock = PTHREAD_MUTEX_INITIALIZER;
+static _TutorialGuardedRange *_guardedRanges = NULL; // Only ever pushed onto, so the handler can walk it at any time.
+
+static pthread_once_t _busErrorHandlerOnce = PTHREAD_ONCE_INIT;
+static struct sigaction _previousBusErrorAction;
+static uintptr_t _pageSize;
+
+// Set while the calling thread is probing a slice with _probeMappedRange(), which a fault in a guarded range returns to.
+static __thread sigjmp_buf *_probeRecovery = NULL;
+
+static _TutorialGuardedRange *
+_findGuardedRange(uintptr_t address)
+{
+    for (_TutorialGuardedRange *range = __atomic_load_n(&_guardedRanges, __ATOMIC_ACQUIRE); range != NULL; range = range->next) {
+        uintptr_t start = __atomic_load_n(&range->start, __ATOMIC_ACQUIRE);
+        size_t length = __atomic_load_n(&range->length, __ATOMIC_ACQUIRE);
+        if (address >= start && address - start < length) {
+            return range;
+        }
+    }
+    return NULL;
+}
+
+/**
+ * Reading a page of a MAP_SHARED mapping that lies wholly beyond the end of its file raises SIGBUS. Every slice
+ * is probed by _probeMappedRange() before it is handed out, so a truncation that has already happened makes
+ * the chunk fail, rather than killing the server. A fault in one of our mappings is recorded in its range, so
+ * the mapping is replaced on its next use, and if the faulting thread is probing, it is returned to the probe.
+ * The handler does nothing else, so it only uses async-signal-safe operations.
+ *
+ * Any other SIGBUS, including one raised outside a probe, is passed on to the handler that was installed
+ * before ours.
+ */
+static void
+_handleBusError(int signalNumber, siginfo_t *info, void *context)
+{
+    _TutorialGuardedRange *range = (info->si_code == BUS_ADRERR) ? _findGuardedRange((uintptr_t) info->si_addr) : NULL;
+
+    if (range != NULL) {
+        __atomic_store_n(&range->hasFaulted, true, __ATOMIC_RELEASE);
+        if (_probeRecovery != NULL) {
+            siglongjmp(*_probeRecovery, 1);
+        }
+    }
+
+    if (_previousBusErrorAction.sa_flags & SA_SIGINFO) {
+        _previousBusErrorAction.sa_sigaction(signalNumber, info, context);
+    } else if (_previousBusErrorAction.sa_handler != SIG_DFL && _previousBusErrorAction.sa_handler != SIG_IGN) {
+        _previousBusErrorAction.sa_handler(signalNumber);
+    } else {
+        // Returning re-runs the faulting read, which now raises the signal with its default action.
+        signal(SIGBUS, SIG_DFL);
+    }
+}
+
+static void
+_installBusErrorHandler(void)
+{
+    _pageSize = (uintptr_t) sysconf(_SC_PAGESIZE);
+
+    struct sigaction action;
+    memset(&action, 0, sizeof(action));
+    action.sa_sigaction = _handleBusError;
+    action.sa_flags = SA_SIGINFO | SA_RESTART;
+    sigemptyset(&action.sa_mask);
+
+    int failure = sigaction(SIGBUS, &action, &_previousBusErrorAction);
+    assertFalse(failure, "sigaction(SIGBUS) failed: %s", strerror(errno));
+}
+
+static _TutorialGuardedRange *
+_guardRange(uint8_t *address, size_t length)
+{
+    pthread_mutex_lock(&_guardedRangesLock);
+
+    _TutorialGuardedRange *result = _guardedRanges;
+    while (result != NULL && result->length != 0) {
+        result = result->next;
+    }
+
+    if (result == NULL) {
+        result = parcMemory_AllocateAndClear(sizeof(_TutorialGuardedRange));
+        assertNotNull(result, "parcMemory_AllocateAndClear(%zu) returned NULL", sizeof(_TutorialGuardedRange));
+        result->next = _guardedRanges;
+        __atomic_store_n(&_guardedRanges, result, __ATOMIC_RELEASE);
+    }
+
+    __atomic_store_n(&result->hasFaulted, false, __ATOMIC_RELEASE);
+    __atomic_store_n(&result->start, (uintptr_t) address, __ATOMIC_RELEASE);
+    __atomic_store_n(&result->length, length, __ATOMIC_RELEASE);
+
+    pthread_mutex_unlock(&_guardedRangesLock);
+
+    return result;
+}
+
+static void
+_unguardRange(_TutorialGuardedRange *range)
+{
+    pthread_mutex_lock(&_guardedRangesLock);
+    __atomic_store_n(&range->length, 0, __ATOMIC_RELEASE);
+    pthread_mutex_unlock(&_guardedRangesLock);
+}
+
+/**
+ * Read a byte of every page of the specified region of a mapping, with _handleBusError() set to return here if
+ * one of them has been truncated away. This also faults the pages in, so they are read from the file now
+ * rather than while the chunk is being sent.
+ *
+ * @return true if the whole region could be read, false if part of it is beyond the end of the file.
+ */
+static bool
+_probeMappedRange(const uint8_t *address, size_t length)
+{
+    sigjmp_buf recovery;
+    volatile bool result = false;
+
+    if (sigsetjmp(recovery, 1) == 0) {
+        _probeRecovery = &recovery;
+        uintptr_t end = (uintptr_t) address + length;
+        for (uintptr_t page = (uintptr_t) address & ~(_pageSize - 1); page < end; page += _pageSize) {
+            uintptr_t byte = (page < (uintptr_t) address) ? (uintptr_t) address : page;
+            (void) *(const volatile uint8_t *) byte;
+        }
+        result = true;
+    }
+    _probeRecovery = NULL;
+
+    return result;
+}
+
+/**
+ * Map the file open on the specified descriptor into memory. A file of size 0 gets a mapping with no
+ * address, from which only empty chunks can be sliced.
+ *
+ * @return A new _TutorialFileMapping, or NULL if the file couldn't be mapped.
+ */
+static _TutorialFileMapping *
+_createMapping(int fileDescriptor, size_t length)
+{
+    _TutorialFileMapping *result = NULL;
+    void *address = NULL;
+
+    if (length > 0) {
+        address = mmap(NULL, length, PROT_READ, MAP_SHARED, fileDescriptor, 0);
+    }
+
+    if (address != MAP_FAILED) {
+        result = parcMemory_AllocateAndClear(sizeof(_TutorialFileMapping));
+        assertNotNull(result, "parcMemory_AllocateAndClear(%zu) returned NULL", sizeof(_TutorialFileMapping));
+
+        result->address = address;
+        result->length = length;
+        if (address != NULL) {
+            result->guard = _guardRange(address, length);
+        }
+    }
+
+    return result;
+}
+
+/**
+ * A slice is in use if anyone else holds a reference to it, or has made their own PARCBuffer
+ * (e.g. with parcBuffer_Slice()) that shares its underlying byte array.
+ */
+static bool
+_isSliceInUse(const PARCBuffer *slice)
+{
+    return parcObject_GetReferenceCount(slice) > 1
+           || parcObject_GetReferenceCount(parcBuffer_Array(slice)) > 1;
+}
+
+/**
+ * Release our reference to every slice of the mapping that is no longer in use.
+ *
+ * @return The number of slices still in use.
+ */
+static size_t
+_reapSlices(_TutorialFileMapping *mapping)
+{
+    size_t liveSliceCount = 0;
+
+    for (size_t i = 0; i < mapping->sliceCount; i++) {
+        if (_isSliceInUse(mapping->slices[i]) == false) {
+            parcBuffer_Release(&mapping->slices[i]);
+        } else {
+            mapping->slices[liveSliceCount++] = mapping->slices[i];
+        }
+    }
+    mapping->sliceCount = liveSliceCount;
+
+    return liveSliceCount;
+}
+
+/**
+ * Unmap the mapping and release its memory, along with our references to its slices.
+ */
+static void
+_destroyMapping(_TutorialFileMapping **mappingP)
+{
+    _TutorialFileMapping *mapping = *mappingP;
+
+    for (size_t i = 0; i < mapping->sliceCount; i++) {
+        parcBuffer_Release(&mapping->slices[i]);
+    }
+    if (mapping->slices != NULL) {
+        parcMemory_Deallocate((void **) &mapping->slices);
+    }
+    if (mapping->address != NULL) {
+        _unguardRange(mapping->guard);
+        munmap(mapping->address, mapping->length);
+    }
+
+    parcMemory_Deallocate((void **) mappingP);
+}
+
+/**
+ * Return a new PARCBuffer that wraps the specified region of the mapping without copying it. The
+ * mapping keeps a reference to the slice, so it can tell when the slice is no longer in use.
+ */
+static PARCBuffer *
+_createSlice(_TutorialFileMapping *mapping, size_t offset, size_t length)
+{
+    if (mapping->sliceCount == mapping->sliceCapacity && _reapSlices(mapping) == mapping->sliceCapacity) {
+        size_t newCapacity = (mapping->sliceCapacity == 0) ? 64 : mapping->sliceCapacity * 2;
+        mapping->slices = parcMemory_Reallocate(mapping->slices, newCapacity * sizeof(PARCBuffer *));
+        assertNotNull(mapping->slices, "parcMemory_Reallocate(%zu) returned NULL", newCapacity * sizeof(PARCBuffer *));
+        mapping->sliceCapacity = newCapacity;
+    }
+
+    PARCBuffer *slice = parcBuffer_Wrap(mapping->address + offset, length, 0, length);
+    mapping->slices[mapping->sliceCount++] = slice;
+
+    return parcBuffer_Acquire(slice);
+}
+
+/**
+ * Stop using a mapping for new chunks. If none of its slices are in use it is unmapped now,
+ * otherwise it is kept on the cache's retired list until they have all been released.
+ */
+static void
+_retireMapping(TutorialFileCache *cache, _TutorialFileMapping **mappingP)
+{
+    if (_reapSlices(*mappingP) == 0) {
+        _destroyMapping(mappingP);
+    } else {
+        (*mappingP)->nextRetired = cache->retiredMappings;
+        cache->retiredMappings = *mappingP;
+        *mappingP = NULL;
+    }
+}
+
+/**
+ * Unmap any retired mappings that no longer have slices in use.
+ */
+static void
+_reapRetiredMappings(TutorialFileCache *cache)
+{
+    _TutorialFileMapping **mappingP = &cache->retiredMappings;
+
+    while (*mappingP != NULL) {
+        _TutorialFileMapping *mapping = *mappingP;
+        if (_reapSlices(mapping) == 0) {
+            *mappingP = mapping->nextRetired;
+            _destroyMapping(&mapping);
+        } else {
+            mappingP = &mapping->nextRetired;
+        }
+    }
+}
+
+static _TutorialSharedDescriptor *
+_createDescriptor(int fileDescriptor)
+{
+    _TutorialSharedDescriptor *result = parcMemory_Allocate(sizeof(_TutorialSharedDescriptor));
+    assertNotNull(result, "parcMemory_Allocate(%zu) returned NULL", sizeof(_TutorialSharedDescriptor));
+
+    result->fileDescriptor = fileDescriptor;
+    result->referenceCount = 1;
+
+    return result;
+}
+
+static _TutorialSharedDescriptor *
+_acquireDescriptor(_TutorialSharedDescriptor *descriptor)
+{
+    __atomic_add_fetch(&descriptor->referenceCount, 1, __ATOMIC_RELAXED);
+    return descriptor;
+}
+
+static void
+_releaseDescriptor(_TutorialSharedDescriptor **descriptorP)
+{
+    if (__atomic_sub_fetch(&(*descriptorP)->referenceCount, 1, __ATOMIC_ACQ_REL) == 0) {
+        close((*descriptorP)->fileDescriptor);
+        parcMemory_Deallocate((void **) descriptorP);
+    }
+    *descriptorP = NULL;
+}
+
+/**
+ * Return a 32-bit FNV-1a hash of the specified string.
+ */
+static uint32_t
+_hashFilePath(const char *filePath)
+{
+    uint32_t hash = 2166136261u;
+    for (const char *p = filePath; *p != '\0'; p++) {
+        hash ^= (uint8_t) *p;
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+/**
+ * Close the file held by the specified entry and mark the entry as unused.
+ */
+static void
+_closeEntry(TutorialFileCache *cache, _TutorialFileCacheEntry *entry)
+{
+    if (entry->mapping != NULL) {
+        _retireMapping(cache, &entry->mapping);
+    }
+    if (entry->filePath != NULL) {
+        _releaseDescriptor(&entry->descriptor);
+        parcMemory_Deallocate((void **) &entry->filePath);
+    }
+}
+
+/**
+ * Open the specified file into the given (unused) entry.
+ *
+ * @return true if the file was opened and its metadata read, false otherwise.
+ */
+static bool
+_openEntry(_TutorialFileCacheEntry *entry, const char *filePath, uint32_t pathHash)
+{
+    bool result = false;
+
+    int fileDescriptor = open(filePath, O_RDONLY);
+    if (fileDescriptor >= 0) {
+        if (fstat(fileDescriptor, &entry->fileInfo) == 0 && S_ISREG(entry->fileInfo.st_mode)) {
+            entry->filePath = parcMemory_StringDuplicate(filePath, strlen(filePath));
+            entry->pathHash = pathHash;
+            entry->descriptor = _createDescriptor(fileDescriptor);
+            result = true;
+        } else {
+            close(fileDescriptor);
+        }
+    }
+
+    return result;
+}
+
+/**
+ * Make sure the cached entry still refers to the file at its path. A file that was replaced (e.g. by
+ * a rename) has a different inode, so the old descriptor is closed. A file that was modified in place
+ * keeps its descriptor, and we just refresh the cached metadata. Its memory mapping, if any, no longer
+ * matches the file and is retired.
+ *
+ * The file's current metadata is taken from `knownInfo` if the caller already has it, and from a stat()
+ * of the path otherwise.
+ *
+ * @return true if the entry is still valid, false if it was closed.
+ */
+static bool
+_revalidateEntry(TutorialFileCache *cache, _TutorialFileCacheEntry *entry, const struct stat *knownInfo)
+{
+    bool result = false;
+    struct stat currentInfo;
+
+    if (knownInfo != NULL) {
+        currentInfo = *knownInfo;
+    } else if (stat(entry->filePath, &currentInfo) != 0) {
+        _closeEntry(cache, entry);
+        return false;
+    }
+
+    if (currentInfo.st_dev == entry->fileInfo.st_dev
+        && currentInfo.st_ino == entry->fileInfo.st_ino) {
+        if (entry->mapping != NULL && tutorialFileIO_IsSameFileVersion(&currentInfo, &entry->fileInfo) == false) {
+            _retireMapping(cache, &entry->mapping);
+        }
+        entry->fileInfo = currentInfo; // Size and times may have changed.
+        result = true;
+    } else {
+        _closeEntry(cache, entry);
+    }
+
+    return result;
+}
+
+/**
+ * Find the entry for the specified file, opening it if it isn't already cached. If the cache is full,
+ * the least recently used entry is closed to make room. A cached entry is revalidated against `knownInfo`,
+ * or with a stat() if it is NULL.
+ *
+ * @return A pointer to the entry for the file, or NULL if the file couldn't be opened.
+ */
+static _TutorialFileCacheEntry *
+_lookupEntry(TutorialFileCache *cache, const char *filePath, const struct stat *knownInfo)
+{
+    uint32_t pathHash = _hashFilePath(filePath);
+
+    _TutorialFileCacheEntry *result = NULL;
+    _TutorialFileCacheEntry *leastRecentlyUsed = &cache->entries[0];
+
+    // The cache is small, so a linear scan is cheaper than the system calls it saves us.
+    for (size_t i = 0; i < cache->capacity && result == NULL; i++) {
+        _TutorialFileCacheEntry *entry = &cache->entries[i];
+
+        if (entry->filePath == NULL) {
+            leastRecentlyUsed = entry; // An unused entry is always the best one to replace.
+        } else if (entry->pathHash == pathHash && strcmp(entry->filePath, filePath) == 0) {
+            result = entry;
+        } else if (leastRecentlyUsed->filePath != NULL && entry->lastUsed < leastRecentlyUsed->lastUsed) {
+            leastRecentlyUsed = entry;
+        }
+    }
+
+    if (result != NULL && _revalidateEntry(cache, result, knownInfo) == false) {
+        leastRecentlyUsed = result; // It was closed, so re-use it.
+        result = NULL;
+    }
+
+    if (result == NULL) {
+        _closeEntry(cache, leastRecentlyUsed);
+        if (_openEntry(leastRecentlyUsed, filePath, pathHash)) {
+            result = leastRecentlyUsed;
+        }
+    }
+
+    if (result != NULL) {
+        result->lastUsed = ++cache->useClock;
+    }
+
+    if (cache->retiredMappings != NULL) {
+        _reapRetiredMappings(cache);
+    }
+
+    return result;
+}
+
+/**
+ * Return the specified range of the entry's file as a slice of its memory mapping, mapping the
+ * file first if necessary. The slice ends early if the file does.
+ *
+ * The entry's metadata may be older than the file, as the watcher only reports a truncation after it has
+ * happened. The file's size is checked with fstat() before slicing, and the slice is probed, so a range that
+ * now runs past the end of the file fails instead of being handed out. A mapping longer than the file, or one
+ * that has faulted, is retired and the file mapped again.
+ *
+ * @return A new PARCBuffer wrapping the range, or NULL if the file couldn't be mapped or has been truncated.
+ */
+static PARCBuffer *
+_getMappedFileRange(TutorialFileCache *cache, _TutorialFileCacheEntry *entry, uint64_t offset, size_t length)
+{
+    struct stat currentInfo;
+    if (fstat(entry->descriptor->fileDescriptor, &currentInfo) != 0) {
+        return NULL;
+    }
+
+    uint64_t fileSize = (uint64_t) entry->fileInfo.st_size;
+    uint64_t currentSize = (uint64_t) currentInfo.st_size;
+    uint64_t rangeEnd = (offset + length < fileSize) ? offset + length : fileSize;
+
+    if (entry->mapping != NULL
+        && (entry->mapping->length > currentSize
+            || (entry->mapping->guard != NULL && __atomic_load_n(&entry->mapping->guard->hasFaulted, __ATOMIC_ACQUIRE)))) {
+        _retireMapping(cache, &entry->mapping);
+    }
+
+    if (rangeEnd > currentSize) {
+        return NULL; // The chunk ran past the end of the file, so it no longer has the contents it had.
+    }
+
+    if (entry->mapping == NULL) {
+        entry->mapping = _createMapping(entry->descriptor->fileDescriptor, (fileSize < currentSize) ? fileSize : currentSize);
+    }
+
+    PARCBuffer *result = NULL;
+
+    if (entry->mapping != NULL) {
+        size_t mappingLength = entry->mapping->length;
+        size_t rangeOffset = (offset > mappingLength) ? mappingLength : (size_t) offset; // Past the end of the file, the range is empty.
+        size_t rangeLength = (mappingLength - rangeOffset < length) ? (mappingLength - rangeOffset) : length;
+
+        if (rangeLength == 0) {
+            result = parcBuffer_Allocate(0); // There's nothing to wrap.
+        } else if (_probeMappedRange(entry->mapping->address + rangeOffset, rangeLength)) {
+            result = _createSlice(entry->mapping, rangeOffset, rangeLength);
+        } else {
+            _retireMapping(cache, &entry->mapping);
+        }
+    }
+
+    return result;
+}
+
+TutorialFileCache *
+tutorialFileCache_Create(size_t capacity, bool useMemoryMapping)
+{
+    assertTrue(capacity > 0, "The capacity of a TutorialFileCache must be greater than 0");
+
+    TutorialFileCache *result = parcMemory_AllocateAndClear(sizeof(TutorialFileCache));
+    assertNotNull(result, "parcMemory_AllocateAndClear(%zu) returned NULL", sizeof(TutorialFileCache));
+
+    result->entries = parcMemory_AllocateAndClear(capacity * sizeof(_TutorialFileCacheEntry));
+    assertNotNull(result->entries, "parcMemory_AllocateAndClear(%zu) returned NULL", capacity * sizeof(_TutorialFileCacheEntry));
+
+    result->capacity = capacity;
+    result->useMemoryMapping = useMemoryMapping;
+    if (useMemoryMapping) {
+        pthread_once(&_busErrorHandlerOnce, _installBusErrorHandler);
+    }
+
+    pthread_mutex_init(&result->lock, NULL);
+
+    return result;
+}
+
+bool
+tutorialFileCache_IsMemoryMapped(const TutorialFileCache *cache)
+{
+    return cache->useMemoryMapping;
+}
+
+void
+tutorialFileCache_Release(TutorialFileCache **cacheP)
+{
+    TutorialFileCache *cache = *cacheP;
+
+    for (size_t i = 0; i < cache->capacity; i++) {
+        _closeEntry(cache, &cache->entries[i]);
+    }
+
+    while (cache->retiredMappings != NULL) {
+        _TutorialFileMapping *mapping = cache->retiredMappings;
+        cache->retiredMappings = mapping->nextRetired;
+        _destroyMapping(&mapping);
+    }
+
+    pthread_mutex_destroy(&cache->lock);
+
+    parcMemory_Deallocate((void **) &cache->entries);
+    parcMemory_Deallocate((void **) cacheP);
+}
+
+bool
+tutorialFileCache_GetFileInfo(TutorialFileCache *cache, const char *filePath, struct stat *fileInfo)
+{
+    pthread_mutex_lock(&cache->lock);
+
+    _TutorialFileCacheEntry *entry = _lookupEntry(cache, filePath, NULL);
+
+    if (entry != NULL) {
+        *fileInfo = entry->fileInfo;
+    }
+
+    pthread_mutex_unlock(&cache->lock);
+
+    return (entry != NULL);
+}
+
+/**
+ * Return the specified range of the file, looking its entry up with _lookupEntry(). A range that is read,
+ * rather than sliced from a memory mapping, is read into a buffer from `pool` if it isn't NULL.
+ */
+static PARCBuffer *
+_getFileRange(TutorialFileCache *cache, TutorialBufferPool *pool, const char *filePath, const struct stat *knownInfo,
+              uint64_t offset, size_t length, struct stat *fileInfo)
+{
+    PARCBuffer *result = NULL;
+    _TutorialSharedDescriptor *descriptor = NULL;
+
+    pthread_mutex_lock(&cache->lock);
+
+    _TutorialFileCacheEntry *entry = _lookupEntry(cache, filePath, knownInfo);
+
+    if (entry != NULL) {
+        if (cache->useMemoryMapping) {
+            result = _getMappedFileRange(cache, entry, offset, length);
+        } else {
+            descriptor = _acquireDescriptor(entry->descriptor);
+        }
+        if (fileInfo != NULL) {
+            *fileInfo = entry->fileInfo;
+        }
+    }
+
+    pthread_mutex_unlock(&cache->lock);
+
+    // Read outside of the lock, so a slow read doesn't hold up other threads using the cache.
+    if (descriptor != NULL) {
+        if (pool != NULL) {
+            result = tutorialBufferPool_GetBuffer(pool, length);
+            if (tutorialFileIO_ReadFileRangeIntoBuffer(descriptor->fileDescriptor, offset, result) == false) {
+                parcBuffer_Release(&result);
+            }
+        } else {
+            result = tutorialFileIO_GetFileRangeFromDescriptor(descriptor->fileDescriptor, offset, length);
+        }
+        _releaseDescriptor(&descriptor);
+    }
+
+    return result;
+}
+
+/**
+ * The state of a read submitted by _readKnownFileRange(). It holds a reference to the
+ * file's descriptor, so the file stays open until the read has finished even if it is evicted from the cache.
+ */
+typedef struct {
+    _TutorialSharedDescriptor *descriptor;
+    TutorialFileReadCompletion *completion;
+    void *context;
+} _TutorialFileCacheRead;
+
+static void
+_finishRead(void *readArg, PARCBuffer *chunk)
+{
+    _TutorialFileCacheRead *read = readArg;
+
+    _releaseDescriptor(&read->descriptor);
+    read->completion(read->context, chunk);
+
+    parcMemory_Deallocate((void **) &read);
+}
+
+PARCBuffer *
+tutorialFileCache_GetFileChunk(TutorialFileCache *cache, const char *filePath,
+                               size_t chunkSize, uint64_t chunkNumber, struct stat *fileInfo)
+{
+    return _getFileRange(cache, NULL, filePath, NULL, chunkSize * chunkNumber, chunkSize, fileInfo);
+}
+
+PARCBuffer *
+tutorialFileCache_GetKnownFileChunk(TutorialFileCache *cache, TutorialBufferPool *pool,
+                                    const char *filePath, const struct stat *fileInfo,
+                                    size_t chunkSize, uint64_t chunkNumber)
+{
+    return _getFileRange(cache, pool, filePath, fileInfo, chunkSize * chunkNumber, chunkSize, NULL);
+}
+
+PARCBuffer *
+tutorialFileCache_GetKnownFileRange(TutorialFileCache *cache, const char *filePath, const struct stat *fileInfo,
+                                    uint64_t offset, size_t length)
+{
+    return _getFileRange(cache, NULL, filePath, fileInfo, offset, length, NULL);
+}
+
+void
+tutorialFileCache_AdviseWillNeed(TutorialFileCache *cache, const char *filePath, const struct stat *fileInfo,
+                                 uint64_t offset, size_t length)
+{
+    _TutorialSharedDescriptor *descriptor = NULL;
+
+    pthread_mutex_lock(&cache->lock);
+
+    _TutorialFileCacheEntry *entry = _lookupEntry(cache, filePath, fileInfo);
+    if (entry != NULL) {
+        descriptor = _acquireDescriptor(entry->descriptor);
+    }
+
+    pthread_mutex_unlock(&cache->lock);
+
+    if (descriptor != NULL) {
+        tutorialFileIO_AdviseWillNeed(descriptor->fileDescriptor, offset, length);
+        _releaseDescriptor(&descriptor);
+    }
+}
+
+/**
+ * Submit a read of a range of a file whose metadata is already known to `reader`, as for
+ * tutorialFileCache_ReadKnownFileChunk(), reading it into a buffer from `pool` if one is given.
+ */
+static bool
+_readKnownFileRange(TutorialFileCache *cache, TutorialFileReader *reader, TutorialBufferPool *pool,
+                    const char *filePath, const struct stat *fileInfo, uint64_t offset, size_t length,
+                    TutorialFileReadCompletion *completion, void *context)
+{
+    PARCBuffer *mappedRange = NULL;
+    _TutorialSharedDescriptor *descriptor = NULL;
+
+    pthread_mutex_lock(&cache->lock);
+
+    _TutorialFileCacheEntry *entry = _lookupEntry(cache, filePath, fileInfo);
+
+    if (entry != NULL) {
+        if (cache->useMemoryMapping) {
+            mappedRange = _getMappedFileRange(cache, entry, offset, length);
+        } else {
+            descriptor = _acquireDescriptor(entry->descriptor);
+        }
+    }
+
+    pthread_mutex_unlock(&cache->lock);
+
+    if (entry == NULL) {
+        return false;
+    }
+
+    if (descriptor != NULL) {
+        _TutorialFileCacheRead *read = parcMemory_Allocate(sizeof(_TutorialFileCacheRead));
+        assertNotNull(read, "parcMemory_Allocate(%zu) returned NULL", sizeof(_TutorialFileCacheRead));
+        read->descriptor = descriptor;
+        read->completion = completion;
+        read->context = context;
+
+        PARCBuffer *buffer = (pool != NULL) ? tutorialBufferPool_GetBuffer(pool, length) : NULL;
+        tutorialFileIO_ReadFileRange(reader, descriptor->fileDescriptor, offset, length, buffer, _finishRead, read);
+    } else {
+        // The range is already in memory, so there is nothing to wait for.
+        completion(context, mappedRange);
+        if (mappedRange != NULL) {
+            parcBuffer_Release(&mappedRange);
+        }
+    }
+
+    return true;
+}
+
+bool
+tutorialFileCache_ReadKnownFileChunk(TutorialFileCache *cache, TutorialFileReader *reader, TutorialBufferPool *pool,
+                                     const char *filePath, const struct stat *fileInfo,
+                                     size_t chunkSize, uint64_t chunkNumber,
+                                     TutorialFileReadCompletion *completion, void *context)
+{
+    return _readKnownFileRange(cache, reader, pool, filePath, fileInfo, chunkSize * chunkNumber, chunkSize,
+                               completion, context);
+}
+
+bool
+tutorialFileCache_ReadKnownFileRange(TutorialFileCache *cache, TutorialFileReader *reader,
+                                     const char *filePath, const struct stat *fileInfo,
+                                     uint64_t offset, size_t length,
+                                     TutorialFileReadCompletion *completion, void *context)
+{
+    return _readKnownFileRange(cache, reader, NULL, filePath, fileInfo, offset, length, completion, context);
+}
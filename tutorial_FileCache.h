@@ -0,0 +1,237 @@
+/*
+ * Copyright (c) 2014-2015, Xerox Corporation (Xerox)and Palo Alto Research Center (PARC)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Patent rights are not granted under this agreement. Patent rights are
+ *       available under FRAND terms.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL XEROX or PARC BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+/**
+ * @author Alan Walendowski, Palo Alto Research Center (Xerox PARC)
+ * @copyright 2014-2015, Xerox Corporation (Xerox)and Palo Alto Research Center (PARC).  All rights reserved.
+ */
+
+#ifndef tutorial_FileCache_h
+#define tutorial_FileCache_h
+
+#include <stdbool.h>
+#include <sys/stat.h>
+
+#include <parc/algol/parc_Buffer.h>
+
+#include "tutorial_FileIO.h"
+#include "tutorial_BufferPool.h"
+
+/**
+ * A TutorialFileCache keeps a bounded number of files open so that repeated chunk requests for the
+ * same file don't have to open, seek, read, and close it each time. Entries are keyed by file path
+ * and evicted in least-recently-used order. The metadata returned by fstat() is cached along with
+ * the open file descriptor.
+ *
+ * Each lookup revalidates the cached entry with a single stat() of the path, or against metadata the
+ * caller already has (see tutorialFileCache_GetKnownFileChunk()). If the file has been
+ * replaced (a different device or inode), the cached descriptor is closed and the file re-opened. If the
+ * file has only been changed in place, the cached metadata is refreshed.
+ *
+ * A cache can optionally serve chunks from a read-only memory mapping of each file instead of reading
+ * them into newly allocated buffers. In that mode each file is mapped once, and each chunk is returned
+ * as a PARCBuffer that wraps a slice of the mapping without copying it. A mapping is only unmapped after
+ * the file has changed (or been evicted) and every slice handed out from it has been released, so
+ * ContentObjects still in flight in the transport stack keep their payloads valid.
+ *
+ * Reading a mapped page beyond the end of a file that has been truncated raises SIGBUS. Before a chunk is
+ * sliced, the file's size is checked with fstat() and the chunk's pages are read under a SIGBUS handler, so a
+ * chunk of a truncated file fails rather than killing the server. A slice that has been handed out can't be
+ * checked again, so its holder should send it straight away rather than keep it: a file truncated in the
+ * moment between slicing a chunk and sending it still raises SIGBUS. Any SIGBUS the cache can't recover from
+ * is passed on to the handler installed before it.
+ *
+ * A TutorialFileCache may be used by several threads at once. Chunks are read without holding the cache's
+ * lock, so one slow read doesn't stall other threads.
+ */
+typedef struct tutorial_file_cache TutorialFileCache;
+
+/**
+ * The default number of open files held by a TutorialFileCache.
+ */
+extern const size_t tutorialFileCache_DefaultCapacity;
+
+/**
+ * Create a new TutorialFileCache that will hold at most `capacity` open files. The returned
+ * instance must eventually be released by calling tutorialFileCache_Release().
+ *
+ * @param [in] capacity The maximum number of files to keep open at once. Must be greater than 0.
+ * @param [in] useMemoryMapping If true, chunks are returned as zero-copy slices of a memory mapping of the file.
+ *
+ * @return A new TutorialFileCache instance.
+ */
+TutorialFileCache *tutorialFileCache_Create(size_t capacity, bool useMemoryMapping);
+
+/**
+ * Return whether the specified TutorialFileCache returns chunks as slices of memory mappings.
+ *
+ * @param [in] cache The TutorialFileCache to query.
+ *
+ * @return true If the cache was created to use memory mapping.
+ */
+bool tutorialFileCache_IsMemoryMapped(const TutorialFileCache *cache);
+
+/**
+ * Close all files held by the specified TutorialFileCache and release its memory. Any memory
+ * mappings are unmapped, so no chunk returned by the cache may be used after it is released.
+ *
+ * @param [in,out] cacheP A pointer to the pointer to the TutorialFileCache to release. It will be set to NULL.
+ */
+void tutorialFileCache_Release(TutorialFileCache **cacheP);
+
+/**
+ * Get the metadata for the specified file, opening and caching it if it isn't already cached.
+ *
+ * @param [in] cache The TutorialFileCache to use.
+ * @param [in] filePath A pointer to a string containing the full path of the file.
+ * @param [out] fileInfo A pointer to a struct stat that will be filled in with the file's metadata.
+ *
+ * @return true If the file exists, is readable, and `fileInfo` was filled in.
+ * @return false If the file could not be opened.
+ */
+bool tutorialFileCache_GetFileInfo(TutorialFileCache *cache, const char *filePath, struct stat *fileInfo);
+
+/**
+ * Given a file path and chunk number, retrieve that chunk from the specified file using a cached
+ * file descriptor, or a slice of the file's memory mapping if the cache was created to use one.
+ * The contents of the chunk are returned in a PARCBuffer that must eventually be released via
+ * a call to parcBuffer_Release(&buf). The chunkNumber is 0-based. A chunk that is a slice of a
+ * memory mapping is read-only.
+ *
+ * If `fileInfo` is not NULL, it is filled in with the metadata of the file the chunk was read from,
+ * so the caller doesn't need a separate call to tutorialFileCache_GetFileInfo().
+ *
+ * @param [in] cache The TutorialFileCache to use.
+ * @param [in] filePath A pointer to a string containing the full path of the file.
+ * @param [in] chunkSize The maximum number of bytes to be returned in each chunk.
+ * @param [in] chunkNumber The 0-based number of chunk to return from the file.
+ * @param [out] fileInfo An optional pointer to a struct stat to be filled in with the file's metadata.
+ *
+ * @return A newly created PARCBuffer containing the contents of the specified chunk, or NULL if
+ *         the file did not exist or could not be read.
+ */
+PARCBuffer *tutorialFileCache_GetFileChunk(TutorialFileCache *cache, const char *filePath,
+                                           size_t chunkSize, uint64_t chunkNumber, struct stat *fileInfo);
+
+/**
+ * Retrieve the specified chunk of a file whose current metadata the caller already knows, for example from
+ * a TutorialCatalog kept up to date by a TutorialDirectoryWatcher. A cached entry is revalidated against
+ * `fileInfo` instead of with a stat() of the path, so serving a chunk of an open file makes no system calls
+ * other than the read itself, or the fstat() that checks the size of a memory mapped file. If `fileInfo` is out of date, the chunk may come from an old version of the file.
+ *
+ * The contents of the chunk are returned in a PARCBuffer that must eventually be released via a call to
+ * parcBuffer_Release(&buf). Unless the file is memory mapped, the chunk is read into a buffer from `pool`, if
+ * one is given. The chunkNumber is 0-based.
+ *
+ * @param [in] cache The TutorialFileCache to use.
+ * @param [in] pool The calling thread's TutorialBufferPool to read the chunk into, or NULL to allocate a new buffer.
+ * @param [in] filePath A pointer to a string containing the full path of the file.
+ * @param [in] fileInfo The current metadata of the file, as returned by stat().
+ * @param [in] chunkSize The maximum number of bytes to be returned in each chunk.
+ * @param [in] chunkNumber The 0-based number of chunk to return from the file.
+ *
+ * @return A PARCBuffer containing the contents of the specified chunk, or NULL if the file did not exist or
+ *         could not be read.
+ */
+PARCBuffer *tutorialFileCache_GetKnownFileChunk(TutorialFileCache *cache, TutorialBufferPool *pool,
+                                                const char *filePath, const struct stat *fileInfo,
+                                                size_t chunkSize, uint64_t chunkNumber);
+
+/**
+ * Retrieve an arbitrary range of a file whose current metadata the caller already knows, as for
+ * tutorialFileCache_GetKnownFileChunk(). This lets many chunks be read at once, for example to read ahead
+ * of a client, and then be sliced into chunks with parcBuffer_Slice().
+ *
+ * @param [in] cache The TutorialFileCache to use.
+ * @param [in] filePath A pointer to a string containing the full path of the file.
+ * @param [in] fileInfo The current metadata of the file, as returned by stat().
+ * @param [in] offset The offset in the file of the first byte to return.
+ * @param [in] length The maximum number of bytes to return. Fewer are returned if the file ends first.
+ *
+ * @return A newly created PARCBuffer containing the range, or NULL if the file did not exist or could not be read.
+ */
+PARCBuffer *tutorialFileCache_GetKnownFileRange(TutorialFileCache *cache, const char *filePath, const struct stat *fileInfo,
+                                                uint64_t offset, size_t length);
+
+/**
+ * Hint that the specified range of a file will be read soon, so the kernel can start reading it into the page
+ * cache in the background. See tutorialFileIO_AdviseWillNeed().
+ *
+ * @param [in] cache The TutorialFileCache to use.
+ * @param [in] filePath A pointer to a string containing the full path of the file.
+ * @param [in] fileInfo The current metadata of the file, as returned by stat().
+ * @param [in] offset The offset in the file of the first byte that will be read.
+ * @param [in] length The number of bytes that will be read.
+ */
+void tutorialFileCache_AdviseWillNeed(TutorialFileCache *cache, const char *filePath, const struct stat *fileInfo,
+                                      uint64_t offset, size_t length);
+
+/**
+ * Submit an asynchronous read of the specified chunk of a file whose current metadata the caller already knows,
+ * as for tutorialFileCache_GetKnownFileChunk(). `completion` is called with the chunk by `reader` once the read
+ * has finished. The file is kept open until then. If the cache uses memory mapping, the chunk is sliced from the
+ * mapping and `completion` is called before this returns. Otherwise it is read into a buffer from `pool`, if one
+ * is given.
+ *
+ * @param [in] cache The TutorialFileCache to use.
+ * @param [in] reader The TutorialFileReader to submit the read to.
+ * @param [in] pool The calling thread's TutorialBufferPool to read the chunk into, or NULL to allocate a new buffer.
+ * @param [in] filePath A pointer to a string containing the full path of the file.
+ * @param [in] fileInfo The current metadata of the file, as returned by stat().
+ * @param [in] chunkSize The maximum number of bytes to be returned in each chunk.
+ * @param [in] chunkNumber The 0-based number of chunk to read from the file.
+ * @param [in] completion The function to call with the chunk.
+ * @param [in] context A pointer passed on to `completion`.
+ *
+ * @return true If the read was submitted, in which case `completion` will be called exactly once.
+ * @return false If the file could not be opened. `completion` will not be called.
+ */
+bool tutorialFileCache_ReadKnownFileChunk(TutorialFileCache *cache, TutorialFileReader *reader, TutorialBufferPool *pool,
+                                          const char *filePath, const struct stat *fileInfo,
+                                          size_t chunkSize, uint64_t chunkNumber,
+                                          TutorialFileReadCompletion *completion, void *context);
+
+/**
+ * Submit a read of a range of a file whose metadata is already known, as for tutorialFileCache_ReadKnownFileChunk(),
+ * into a newly allocated buffer. This is used to read many chunks at once without waiting for them.
+ *
+ * @param [in] cache The TutorialFileCache to use.
+ * @param [in] reader The TutorialFileReader to submit the read to.
+ * @param [in] filePath A pointer to a string containing the full path of the file.
+ * @param [in] fileInfo The current metadata of the file, as returned by stat().
+ * @param [in] offset The offset in the file of the first byte to read.
+ * @param [in] length The maximum number of bytes to read.
+ * @param [in] completion The function to call with the range, or with NULL if it could not be read.
+ * @param [in] context A pointer passed on to `completion`.
+ *
+ * @return true If the read was submitted, in which case `completion` will be called exactly once.
+ * @return false If the file could not be opened. `completion` will not be called.
+ */
+bool tutorialFileCache_ReadKnownFileRange(TutorialFileCache *cache, TutorialFileReader *reader,
+                                          const char *filePath, const struct stat *fileInfo,
+                                          uint64_t offset, size_t length,
+                                          TutorialFileReadCompletion *completion, void *context);
+#endif // tutorial_FileCache_h
@@ -29,8 +29,16 @@
  * @copyright 2014-2015, Xerox Corporation (Xerox)and Palo Alto Research Center (PARC).  All rights reserved.
  */
 #include <stdio.h>
+#include <string.h>
 #include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
 #include <unistd.h>
+#include <sys/stat.h>
+
+#ifdef TUTORIAL_USE_IO_URING
+#include <liburing.h>
+#endif
 
 #include <LongBow/runtime.h>
 #include <parc/algol/parc_Memory.h>
@@ -39,42 +47,87 @@
 #include "tutorial_FileIO.h"
 #include "tutorial_Common.h"
 
+/**
+ * Read up to `length` bytes at the given offset of the file, retrying until they have all been read or the end
+ * of the file is reached. pread() reads at an explicit offset, so we never need to seek and the descriptor can
+ * be shared.
+ *
+ * @return The number of bytes read, or -1 if the read failed.
+ */
+static ssize_t
+_readFully(int fileDescriptor, uint8_t *bytes, size_t length, off_t offset)
+{
+    size_t totalNumberOfBytesRead = 0;  // Overall # of bytes read
+
+    while (totalNumberOfBytesRead < length) {
+        ssize_t numberOfBytesRead = pread(fileDescriptor, bytes + totalNumberOfBytesRead,
+                                          length - totalNumberOfBytesRead,
+                                          offset + (off_t) totalNumberOfBytesRead);
+        if (numberOfBytesRead > 0) {
+            totalNumberOfBytesRead += numberOfBytesRead;
+        } else if (numberOfBytesRead == 0) {
+            break; // End of file.
+        } else if (errno != EINTR) {
+            return -1;
+        }
+    }
+
+    return (ssize_t) totalNumberOfBytesRead;
+}
+
 PARCBuffer *
 tutorialFileIO_GetFileChunk(const char *fileName, size_t chunkSize, uint64_t chunkNum)
 {
-    FILE *file = fopen(fileName, "r");
-
-    assertNotNull(file, "Could not open file '%s' - stopping.", fileName);
+    int fileDescriptor = open(fileName, O_RDONLY);
 
-    // When PARCFileInputStream has a Seek() function, consider using it instead of
-    // the following approach.
+    assertTrue(fileDescriptor >= 0, "Could not open file '%s' - stopping.", fileName);
 
-    // Seek to the location of the desired chunk in the file.
-    assertTrue(fseek(file, chunkSize * chunkNum, SEEK_SET) == 0, "Could not seek to desired chunk");
+    PARCBuffer *result = tutorialFileIO_GetFileChunkFromDescriptor(fileDescriptor, chunkSize, chunkNum);
 
-    // If we're here, we were able to seek to the start of the desired chunk
+    close(fileDescriptor);
 
-    PARCBuffer *result = parcBuffer_Allocate(chunkSize);
+    return result;
+}
 
-    size_t numberOfBytesNeeded = chunkSize;
-    size_t numberOfBytesRead = 0;       // # bytes read in each read.
-    size_t totalNumberOfBytesRead = 0;  // Overall # of bytes read
+PARCBuffer *
+tutorialFileIO_GetFileChunkFromDescriptor(int fileDescriptor, size_t chunkSize, uint64_t chunkNum)
+{
+    return tutorialFileIO_GetFileRangeFromDescriptor(fileDescriptor, chunkSize * chunkNum, chunkSize);
+}
 
-    // Read until we get the required number of bytes.
-    while (numberOfBytesNeeded > 0
-           && (numberOfBytesRead = fread(parcBuffer_Overlay(result, 0), 1, numberOfBytesNeeded, file)) > 0) {
-        numberOfBytesNeeded -= numberOfBytesRead;
-        parcBuffer_SetPosition(result, parcBuffer_Position(result) + numberOfBytesRead);
+PARCBuffer *
+tutorialFileIO_GetFileRangeFromDescriptor(int fileDescriptor, uint64_t offset, size_t length)
+{
+    PARCBuffer *result = parcBuffer_Allocate(length);
 
-        totalNumberOfBytesRead += numberOfBytesRead;
+    if (tutorialFileIO_ReadFileRangeIntoBuffer(fileDescriptor, offset, result) == false) {
+        parcBuffer_Release(&result);
     }
 
-    parcBuffer_SetLimit(result, totalNumberOfBytesRead);
-    parcBuffer_Flip(result);
+    return result; // NULL if the read failed.
+}
 
-    fclose(file);
+bool
+tutorialFileIO_ReadFileRangeIntoBuffer(int fileDescriptor, uint64_t offset, PARCBuffer *buffer)
+{
+    uint8_t *bytes = parcBuffer_Overlay(buffer, 0);
 
-    return result;
+    // Read until we get the required number of bytes, or hit the end of the file.
+    ssize_t totalNumberOfBytesRead = _readFully(fileDescriptor, bytes, parcBuffer_Limit(buffer), (off_t) offset);
+
+    if (totalNumberOfBytesRead >= 0) {
+        parcBuffer_SetLimit(buffer, (size_t) totalNumberOfBytesRead);
+    }
+
+    return totalNumberOfBytesRead >= 0;
+}
+
+void
+tutorialFileIO_AdviseWillNeed(int fileDescriptor, uint64_t offset, size_t length)
+{
+#ifdef POSIX_FADV_WILLNEED
+    posix_fadvise(fileDescriptor, (off_t) offset, (off_t) length, POSIX_FADV_WILLNEED);
+#endif
 }
 
 size_t
@@ -98,6 +151,448 @@ tutorialFileIO_AppendFileChunk(const char *fileName, const PARCBuffer *chunk)
     return numBytesWritten;
 }
 
+// The size of the buffer a TutorialFileSink coalesces sequential chunks in, rounded down to a whole number of chunks.
+static const size_t _fileSinkBufferSize = 1024 * 1024;
+
+struct tutorial_file_sink {
+    char *fileName;
+    int fileDescriptor;
+    size_t chunkSize;
+
+    uint8_t *buffer;         // Sequential chunks waiting to be written.
+    size_t bufferCapacity;   // A whole number of chunks, at least one.
+    size_t bufferLength;     // The number of bytes in use in `buffer`.
+    off_t bufferFileOffset;  // The offset in the file of the first byte of `buffer`.
+
+    bool writeFailed;
+};
+
+/**
+ * Write `length` bytes to the sink's file at the given offset, retrying short and interrupted writes.
+ */
+static bool
+_fileSinkWriteAt(TutorialFileSink *sink, const uint8_t *bytes, size_t length, off_t offset)
+{
+    size_t totalNumberOfBytesWritten = 0;
+
+    while (totalNumberOfBytesWritten < length) {
+        ssize_t numberOfBytesWritten = pwrite(sink->fileDescriptor, bytes + totalNumberOfBytesWritten,
+                                              length - totalNumberOfBytesWritten,
+                                              offset + (off_t) totalNumberOfBytesWritten);
+        if (numberOfBytesWritten > 0) {
+            totalNumberOfBytesWritten += numberOfBytesWritten;
+        } else if (numberOfBytesWritten == 0 || errno != EINTR) {
+            // A write that makes no progress (e.g. on a full file system) would otherwise be retried forever.
+            sink->writeFailed = true;
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * Write out the sink's buffered bytes, if any, and empty the buffer.
+ */
+static void
+_fileSinkFlushBuffer(TutorialFileSink *sink)
+{
+    if (sink->bufferLength > 0) {
+        _fileSinkWriteAt(sink, sink->buffer, sink->bufferLength, sink->bufferFileOffset);
+        sink->bufferLength = 0;
+    }
+}
+
+/**
+ * Open the specified file with the given flags, and return a TutorialFileSink for writing its chunks.
+ */
+static TutorialFileSink *
+_createFileSink(const char *fileName, size_t chunkSize, int flags)
+{
+    assertTrue(chunkSize > 0, "The chunk size must be greater than 0.");
+
+    int fileDescriptor = open(fileName, flags, 0644);
+
+    assertTrue(fileDescriptor >= 0, "Could not open file '%s' - stopping.", fileName);
+
+    TutorialFileSink *result = parcMemory_AllocateAndClear(sizeof(TutorialFileSink));
+    assertNotNull(result, "parcMemory_AllocateAndClear(%zu) returned NULL", sizeof(TutorialFileSink));
+
+    result->fileName = parcMemory_StringDuplicate(fileName, strlen(fileName));
+    result->fileDescriptor = fileDescriptor;
+    result->chunkSize = chunkSize;
+
+    size_t chunksPerBuffer = _fileSinkBufferSize / chunkSize;
+    result->bufferCapacity = (chunksPerBuffer > 0 ? chunksPerBuffer : 1) * chunkSize;
+    result->buffer = parcMemory_Allocate(result->bufferCapacity);
+    assertNotNull(result->buffer, "parcMemory_Allocate(%zu) returned NULL", result->bufferCapacity);
+
+    return result;
+}
+
+TutorialFileSink *
+tutorialFileIO_CreateFileSink(const char *fileName, size_t chunkSize)
+{
+    return _createFileSink(fileName, chunkSize, O_WRONLY | O_CREAT | O_TRUNC);
+}
+
+TutorialFileSink *
+tutorialFileIO_OpenFileSink(const char *fileName, size_t chunkSize)
+{
+    return _createFileSink(fileName, chunkSize, O_WRONLY | O_CREAT);
+}
+
+size_t
+tutorialFileIO_WriteFileChunk(TutorialFileSink *sink, const PARCBuffer *chunk, uint64_t chunkNumber)
+{
+    const uint8_t *bytes = parcBuffer_Overlay((PARCBuffer *) chunk, 0); // We're un-const'ing for parcBuffer_Overlay, but we do not change the buffer state.
+    size_t length = parcBuffer_Remaining(chunk);
+    off_t offset = (off_t) (sink->chunkSize * chunkNumber);
+
+    // If this chunk doesn't directly follow the ones already buffered, or won't fit, write those out first.
+    bool isNextInSequence = (offset == sink->bufferFileOffset + (off_t) sink->bufferLength);
+    if (!isNextInSequence || sink->bufferLength + length > sink->bufferCapacity) {
+        _fileSinkFlushBuffer(sink);
+    }
+
+    if (length > sink->bufferCapacity) {
+        // Too big to coalesce. Write it where it belongs.
+        _fileSinkWriteAt(sink, bytes, length, offset);
+    } else {
+        if (sink->bufferLength == 0) {
+            sink->bufferFileOffset = offset;
+        }
+        memcpy(sink->buffer + sink->bufferLength, bytes, length);
+        sink->bufferLength += length;
+
+        if (sink->bufferLength == sink->bufferCapacity) {
+            _fileSinkFlushBuffer(sink);
+        }
+    }
+
+    return length;
+}
+
+bool
+tutorialFileIO_FlushFileSink(TutorialFileSink *sink)
+{
+    _fileSinkFlushBuffer(sink);
+
+    return sink->writeFailed == false && fdatasync(sink->fileDescriptor) == 0;
+}
+
+bool
+tutorialFileIO_CloseFileSink(TutorialFileSink **sinkP)
+{
+    assertNotNull(sinkP, "Parameter must be a non-null pointer to a TutorialFileSink pointer.");
+    TutorialFileSink *sink = *sinkP;
+
+    _fileSinkFlushBuffer(sink);
+
+    bool result = (sink->writeFailed == false);
+
+    if (fsync(sink->fileDescriptor) != 0) {
+        result = false;
+    }
+    if (close(sink->fileDescriptor) != 0) {
+        result = false;
+    }
+
+    if (result == false) {
+        fprintf(stderr, "tutorial_FileIO: Could not completely write file '%s'.\n", sink->fileName);
+    }
+
+    parcMemory_Deallocate((void **) &sink->buffer);
+    parcMemory_Deallocate((void **) &sink->fileName);
+    parcMemory_Deallocate((void **) sinkP);
+
+    return result;
+}
+
+/**
+ * A chunk read submitted to a TutorialFileReader. The reader has a fixed number of these, one per read it can
+ * have in flight.
+ */
+typedef struct {
+    bool isInUse;
+    bool isComplete;       // Set when the read has finished, but its completion function hasn't been called yet.
+
+    int fileDescriptor;
+    off_t offset;
+    PARCBuffer *chunk;     // Given or allocated when the read is submitted, and read into directly, up to its limit.
+    ssize_t result;        // The number of bytes read, or -1 if the read failed. Valid once isComplete is set.
+
+    TutorialFileReadCompletion *completion;
+    void *context;
+} _TutorialFileRead;
+
+struct tutorial_file_reader {
+    _TutorialFileRead *reads;
+    size_t queueDepth;
+    size_t pendingCount;      // The number of reads submitted whose completion function hasn't been called yet.
+
+#ifdef TUTORIAL_USE_IO_URING
+    bool useIoUring;          // False if the kernel doesn't support io_uring, in which case we use pread().
+    struct io_uring ring;
+    size_t unsubmittedCount;  // The number of reads queued in the ring but not yet submitted to the kernel.
+#endif
+};
+
+/**
+ * The number of queued reads at which they are submitted to the kernel without waiting for a call to
+ * tutorialFileIO_CompleteFileChunkReads().
+ */
+static const size_t _fileReaderSubmitBatchSize = 16;
+
+/**
+ * Call the completion function of a finished read, and free its slot.
+ */
+static void
+_deliverRead(TutorialFileReader *reader, _TutorialFileRead *read)
+{
+    if (read->result < 0) {
+        parcBuffer_Release(&read->chunk);
+    } else {
+        parcBuffer_SetLimit(read->chunk, (size_t) read->result);
+    }
+
+    read->isInUse = false;
+    read->isComplete = false;
+    reader->pendingCount--;
+
+    // The slot is free before the completion function is called, so it can submit another read.
+    PARCBuffer *chunk = read->chunk;
+    read->chunk = NULL;
+    read->completion(read->context, chunk);
+
+    if (chunk != NULL) {
+        parcBuffer_Release(&chunk);
+    }
+}
+
+/**
+ * Call the completion function of every read that has finished but not yet been delivered.
+ *
+ * @return The number of reads delivered.
+ */
+static size_t
+_deliverCompletedReads(TutorialFileReader *reader)
+{
+    size_t result = 0;
+
+    for (size_t i = 0; i < reader->queueDepth; i++) {
+        if (reader->reads[i].isComplete) {
+            _deliverRead(reader, &reader->reads[i]);
+            result++;
+        }
+    }
+
+    return result;
+}
+
+#ifdef TUTORIAL_USE_IO_URING
+
+static bool
+_startIoUring(TutorialFileReader *reader)
+{
+    reader->useIoUring = (io_uring_queue_init((unsigned) reader->queueDepth, &reader->ring, 0) == 0);
+    return reader->useIoUring;
+}
+
+static void
+_stopIoUring(TutorialFileReader *reader)
+{
+    if (reader->useIoUring) {
+        io_uring_queue_exit(&reader->ring);
+    }
+}
+
+/**
+ * Queue the read in the ring. It is submitted to the kernel along with the rest of its batch.
+ *
+ * @return true if the read was queued, false if it should be read with pread() instead.
+ */
+static bool
+_queueIoUringRead(TutorialFileReader *reader, _TutorialFileRead *read, size_t length)
+{
+    if (reader->useIoUring == false) {
+        return false;
+    }
+
+    struct io_uring_sqe *submission = io_uring_get_sqe(&reader->ring);
+    assertNotNull(submission, "The io_uring submission queue is full, but we have a free read slot");
+
+    io_uring_prep_read(submission, read->fileDescriptor, parcBuffer_Overlay(read->chunk, 0), (unsigned) length, read->offset);
+    io_uring_sqe_set_data(submission, read);
+
+    if (++reader->unsubmittedCount >= _fileReaderSubmitBatchSize) {
+        io_uring_submit(&reader->ring);
+        reader->unsubmittedCount = 0;
+    }
+
+    return true;
+}
+
+/**
+ * Submit any queued reads, and mark the reads the kernel has finished as complete. If `wait` is true, and
+ * no read has finished yet, wait for one.
+ */
+static void
+_reapIoUringReads(TutorialFileReader *reader, bool wait)
+{
+    if (reader->useIoUring == false) {
+        return;
+    }
+
+    if (reader->unsubmittedCount > 0) {
+        io_uring_submit(&reader->ring);
+        reader->unsubmittedCount = 0;
+    }
+
+    struct io_uring_cqe *completion;
+    int error = wait ? io_uring_wait_cqe(&reader->ring, &completion) : io_uring_peek_cqe(&reader->ring, &completion);
+
+    while (error == 0) {
+        _TutorialFileRead *read = io_uring_cqe_get_data(completion);
+        size_t length = parcBuffer_Limit(read->chunk);
+
+        if (completion->res > 0 && (size_t) completion->res < length) {
+            // A short read. It usually just reached the end of the file, but if not, finish it here.
+            ssize_t remainder = _readFully(read->fileDescriptor, (uint8_t *) parcBuffer_Overlay(read->chunk, 0) + completion->res,
+                                           length - completion->res, read->offset + completion->res);
+            read->result = (remainder < 0) ? -1 : completion->res + remainder;
+        } else {
+            read->result = (completion->res < 0) ? -1 : completion->res;
+        }
+        read->isComplete = true;
+
+        io_uring_cqe_seen(&reader->ring, completion);
+        error = io_uring_peek_cqe(&reader->ring, &completion);
+    }
+}
+
+#else // Built without io_uring, so every read is made with pread().
+
+static bool
+_startIoUring(TutorialFileReader *reader)
+{
+    return false;
+}
+
+static void
+_stopIoUring(TutorialFileReader *reader)
+{
+}
+
+static bool
+_queueIoUringRead(TutorialFileReader *reader, _TutorialFileRead *read, size_t length)
+{
+    return false;
+}
+
+static void
+_reapIoUringReads(TutorialFileReader *reader, bool wait)
+{
+}
+
+#endif // TUTORIAL_USE_IO_URING
+
+TutorialFileReader *
+tutorialFileIO_CreateFileReader(size_t queueDepth)
+{
+    assertTrue(queueDepth > 0, "The queue depth of a TutorialFileReader must be greater than 0");
+
+    TutorialFileReader *result = parcMemory_AllocateAndClear(sizeof(TutorialFileReader));
+    assertNotNull(result, "parcMemory_AllocateAndClear(%zu) returned NULL", sizeof(TutorialFileReader));
+
+    result->reads = parcMemory_AllocateAndClear(queueDepth * sizeof(_TutorialFileRead));
+    assertNotNull(result->reads, "parcMemory_AllocateAndClear(%zu) returned NULL", queueDepth * sizeof(_TutorialFileRead));
+    result->queueDepth = queueDepth;
+
+    _startIoUring(result);
+
+    return result;
+}
+
+void
+tutorialFileIO_ReleaseFileReader(TutorialFileReader **readerP)
+{
+    TutorialFileReader *reader = *readerP;
+
+    while (reader->pendingCount > 0) {
+        tutorialFileIO_CompleteFileChunkReads(reader, true);
+    }
+
+    _stopIoUring(reader);
+
+    parcMemory_Deallocate((void **) &reader->reads);
+    parcMemory_Deallocate((void **) readerP);
+}
+
+bool
+tutorialFileIO_IsFileReaderAsynchronous(const TutorialFileReader *reader)
+{
+#ifdef TUTORIAL_USE_IO_URING
+    return reader->useIoUring;
+#else
+    return false;
+#endif
+}
+
+void
+tutorialFileIO_ReadFileChunk(TutorialFileReader *reader, int fileDescriptor, size_t chunkSize, uint64_t chunkNumber,
+                             PARCBuffer *chunk, TutorialFileReadCompletion *completion, void *context)
+{
+    tutorialFileIO_ReadFileRange(reader, fileDescriptor, chunkSize * chunkNumber, chunkSize, chunk, completion, context);
+}
+
+void
+tutorialFileIO_ReadFileRange(TutorialFileReader *reader, int fileDescriptor, uint64_t offset, size_t length,
+                             PARCBuffer *buffer, TutorialFileReadCompletion *completion, void *context)
+{
+    while (reader->pendingCount == reader->queueDepth) {
+        tutorialFileIO_CompleteFileChunkReads(reader, true);
+    }
+
+    // The queue is short, so a linear scan for a free slot is cheap.
+    _TutorialFileRead *read = NULL;
+    for (size_t i = 0; read == NULL; i++) {
+        if (reader->reads[i].isInUse == false) {
+            read = &reader->reads[i];
+        }
+    }
+
+    read->isInUse = true;
+    read->fileDescriptor = fileDescriptor;
+    read->offset = (off_t) offset;
+    read->chunk = (buffer != NULL) ? buffer : parcBuffer_Allocate(length);
+    read->completion = completion;
+    read->context = context;
+    reader->pendingCount++;
+
+    if (_queueIoUringRead(reader, read, length) == false) {
+        read->result = _readFully(fileDescriptor, parcBuffer_Overlay(read->chunk, 0), length, read->offset);
+        read->isComplete = true;
+    }
+}
+
+size_t
+tutorialFileIO_GetPendingFileChunkReadCount(const TutorialFileReader *reader)
+{
+    return reader->pendingCount;
+}
+
+size_t
+tutorialFileIO_CompleteFileChunkReads(TutorialFileReader *reader, bool wait)
+{
+    if (reader->pendingCount == 0) {
+        return 0;
+    }
+
+    _reapIoUringReads(reader, wait);
+
+    return _deliverCompletedReads(reader);
+}
+
 bool
 tutorialFileIO_IsFileAvailable(const char *filePath)
 {
@@ -121,49 +616,68 @@ tutorialFileIO_GetFileSize(const char *filePath)
     return fileSize;
 }
 
-PARCBuffer *
-tutorialFileIO_CreateDirectoryListing(const char *directoryName)
+/**
+ * Append a line for each readable regular file in a directory, and in the directories below it, to a listing.
+ *
+ * @param [in] directoryListing The PARCBufferComposer to append to.
+ * @param [in] directoryName The path of the directory to read.
+ * @param [in] relativePath The path of the directory relative to the one being listed, or "" for that one.
+ */
+static void
+_appendDirectoryListing(PARCBufferComposer *directoryListing, const char *directoryName, const char *relativePath)
 {
     DIR *directory = opendir(directoryName);
-
-    assertNotNull(directory, "Couldn't open directory '%s' for reading.", directoryName);
-
-    PARCBufferComposer *directoryListing = parcBufferComposer_Create();
+    if (directory == NULL) {
+        return;
+    }
 
     struct dirent *entry;
     while ((entry = readdir(directory)) != NULL) {
+        // We need the full file path to check its size, and the relative one to list it by.
+        char fullFilePath[strlen(directoryName) + strlen(entry->d_name) + 2];
+        snprintf(fullFilePath, sizeof(fullFilePath), "%s/%s", directoryName, entry->d_name);
+        char filePath[strlen(relativePath) + strlen(entry->d_name) + 2];
+        snprintf(filePath, sizeof(filePath), "%s%s%s", relativePath, (relativePath[0] != '\0') ? "/" : "", entry->d_name);
+
         switch (entry->d_type) {
             case DT_REG: {
                 // a regular file
-
-                // We need the full file path to check its size.
-                PARCBufferComposer *fullFilePath = parcBufferComposer_Create();
-                parcBufferComposer_Format(fullFilePath, "%s/%s", directoryName, entry->d_name);
-
-                PARCBuffer *fileNameBuffer = parcBufferComposer_ProduceBuffer(fullFilePath);
-                char *fullFilePathString = parcBuffer_ToString(fileNameBuffer);
-                parcBuffer_Release(&fileNameBuffer);
-
-                if (tutorialFileIO_IsFileAvailable(fullFilePathString)) {
+                if (tutorialFileIO_IsFileAvailable(fullFilePath)) {
                     parcBufferComposer_Format(directoryListing, "  %s  (%zu bytes)\n",
-                                              entry->d_name, tutorialFileIO_GetFileSize(fullFilePathString));
+                                              filePath, tutorialFileIO_GetFileSize(fullFilePath));
                 }
+                break;
+            }
 
-                parcBufferComposer_Release(&fullFilePath);
-                parcMemory_Deallocate((void **) &fullFilePathString);
-
+            case DT_DIR: {
+                // Recurse into subdirectories, except "." and "..", and hidden ones, just as tutorial_Server does.
+                if (entry->d_name[0] != '.') {
+                    _appendDirectoryListing(directoryListing, fullFilePath, filePath);
+                }
                 break;
             }
 
             case DT_LNK:
-            case DT_DIR:
             default:
-                // ignore everything but regular files
+                // ignore everything but regular files and directories
                 break;
         }
     }
 
     closedir(directory);
+}
+
+PARCBuffer *
+tutorialFileIO_CreateDirectoryListing(const char *directoryName)
+{
+    DIR *directory = opendir(directoryName);
+
+    assertNotNull(directory, "Couldn't open directory '%s' for reading.", directoryName);
+    closedir(directory);
+
+    PARCBufferComposer *directoryListing = parcBufferComposer_Create();
+
+    _appendDirectoryListing(directoryListing, directoryName, "");
 
     PARCBuffer *result = parcBufferComposer_ProduceBuffer(directoryListing);
     parcBufferComposer_Release(&directoryListing);
@@ -171,6 +685,24 @@ tutorialFileIO_CreateDirectoryListing(const char *directoryName)
     return result;
 }
 
+bool
+tutorialFileIO_CreateParentDirectories(const char *filePath)
+{
+    char directoryPath[strlen(filePath) + 1];
+    strcpy(directoryPath, filePath);
+
+    // Create each directory on the way to the file in turn, skipping a leading '/'.
+    for (char *separator = strchr(directoryPath + 1, '/'); separator != NULL; separator = strchr(separator + 1, '/')) {
+        *separator = '\0';
+        if (mkdir(directoryPath, 0755) != 0 && errno != EEXIST) {
+            return false;
+        }
+        *separator = '/';
+    }
+
+    return true;
+}
+
 bool
 tutorialFileIO_DeleteFile(const char *fileName)
 {
@@ -178,3 +710,41 @@ tutorialFileIO_DeleteFile(const char *fileName)
     // False could mean the file didn't originally exist.
     return (unlink(fileName) == 0);
 }
+
+void
+tutorialFileIO_GetFileVersion(const struct stat *fileInfo, TutorialFileVersion *version)
+{
+    memset(version, 0, sizeof(*version));
+    version->device = (uint64_t) fileInfo->st_dev;
+    version->inode = (uint64_t) fileInfo->st_ino;
+    version->size = (uint64_t) fileInfo->st_size;
+#ifdef __APPLE__
+    version->modificationSeconds = (int64_t) fileInfo->st_mtimespec.tv_sec;
+    version->modificationNanoseconds = (int64_t) fileInfo->st_mtimespec.tv_nsec;
+    version->changeSeconds = (int64_t) fileInfo->st_ctimespec.tv_sec;
+    version->changeNanoseconds = (int64_t) fileInfo->st_ctimespec.tv_nsec;
+#else
+    version->modificationSeconds = (int64_t) fileInfo->st_mtim.tv_sec;
+    version->modificationNanoseconds = (int64_t) fileInfo->st_mtim.tv_nsec;
+    version->changeSeconds = (int64_t) fileInfo->st_ctim.tv_sec;
+    version->changeNanoseconds = (int64_t) fileInfo->st_ctim.tv_nsec;
+#endif
+}
+
+bool
+tutorialFileIO_IsFileVersion(const TutorialFileVersion *version, const struct stat *fileInfo)
+{
+    TutorialFileVersion currentVersion;
+    tutorialFileIO_GetFileVersion(fileInfo, &currentVersion);
+
+    return memcmp(version, &currentVersion, sizeof(currentVersion)) == 0;
+}
+
+bool
+tutorialFileIO_IsSameFileVersion(const struct stat *fileInfo, const struct stat *otherInfo)
+{
+    TutorialFileVersion version;
+    tutorialFileIO_GetFileVersion(fileInfo, &version);
+
+    return tutorialFileIO_IsFileVersion(&version, otherInfo);
+}
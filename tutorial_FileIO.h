@@ -32,6 +32,10 @@
 #ifndef tutorial_FileIO_h
 #define tutorial_FileIO_h
 
+#include <stdbool.h>
+#include <stdint.h>
+#include <sys/stat.h>
+
 #include <parc/algol/parc_Buffer.h>
 
 /**
@@ -47,6 +51,59 @@
  */
 PARCBuffer *tutorialFileIO_GetFileChunk(const char *fileName, size_t chunkSize, uint64_t chunkNumber);
 
+/**
+ * Given an open file descriptor and chunk number, retrieve that chunk from the file using pread(), so
+ * the descriptor's file offset is not used or changed. This allows a single descriptor to be kept open
+ * and shared between many chunk requests. The contents of the chunk are returned in a PARCBuffer that
+ * must eventually be released via a call to parcBuffer_Release(&buf). The chunkNumber is 0-based.
+ *
+ * @param [in] fileDescriptor A file descriptor open for reading.
+ * @param [in] chunkSize The maximum number of bytes to be returned in each chunk.
+ * @param [in] chunkNumber The 0-based number of chunk to return from the file.
+ *
+ * @return A newly created PARCBuffer containing the contents of the specified chunk, or NULL if the
+ *         file could not be read.
+ */
+PARCBuffer *tutorialFileIO_GetFileChunkFromDescriptor(int fileDescriptor, size_t chunkSize, uint64_t chunkNumber);
+
+/**
+ * Read `length` bytes starting at `offset` of the file open on the given descriptor, using pread(). The bytes
+ * are returned in a PARCBuffer that must eventually be released via a call to parcBuffer_Release(&buf). If
+ * the file ends before `offset + length`, the buffer holds only the bytes up to the end of the file.
+ *
+ * @param [in] fileDescriptor A file descriptor open for reading.
+ * @param [in] offset The offset in the file of the first byte to read.
+ * @param [in] length The maximum number of bytes to read.
+ *
+ * @return A newly created PARCBuffer containing the bytes read, or NULL if the file could not be read.
+ */
+PARCBuffer *tutorialFileIO_GetFileRangeFromDescriptor(int fileDescriptor, uint64_t offset, size_t length);
+
+/**
+ * Read part of the file open on the given descriptor into a buffer the caller already has, such as one from a
+ * TutorialBufferPool, using pread(). As many bytes as the buffer's limit are read, starting at `offset`. On
+ * return the buffer's position is 0 and its limit is the number of bytes read, which is fewer than were asked
+ * for if the file ends first.
+ *
+ * @param [in] fileDescriptor A file descriptor open for reading.
+ * @param [in] offset The offset in the file of the first byte to read.
+ * @param [in,out] buffer The buffer to read into, with its position at 0.
+ *
+ * @return true If the read succeeded.
+ */
+bool tutorialFileIO_ReadFileRangeIntoBuffer(int fileDescriptor, uint64_t offset, PARCBuffer *buffer);
+
+/**
+ * Tell the kernel that the specified range of the file open on the given descriptor will be read soon, so it
+ * can start reading it into the page cache in the background. This is only a hint, and does nothing on
+ * systems without posix_fadvise().
+ *
+ * @param [in] fileDescriptor A file descriptor open for reading.
+ * @param [in] offset The offset in the file of the first byte that will be read.
+ * @param [in] length The number of bytes that will be read.
+ */
+void tutorialFileIO_AdviseWillNeed(int fileDescriptor, uint64_t offset, size_t length);
+
 /**
  * Given a PARCBuffer, append its contents to the file specified by the given fileName.
  *
@@ -57,6 +114,170 @@ PARCBuffer *tutorialFileIO_GetFileChunk(const char *fileName, size_t chunkSize,
  */
 size_t tutorialFileIO_AppendFileChunk(const char *fileName, const PARCBuffer *chunk);
 
+/**
+ * A TutorialFileSink writes the chunks of a file being received to disk through a single open file
+ * descriptor. Chunks that arrive in sequence are coalesced in memory and written out in large,
+ * chunk-aligned blocks. Each chunk is written at its own offset (chunkNumber * chunkSize) with pwrite(),
+ * so chunks that arrive out of order are written in place rather than appended. The file is only
+ * flushed to stable storage when the sink is flushed or closed.
+ */
+typedef struct tutorial_file_sink TutorialFileSink;
+
+/**
+ * Create (or truncate) the specified file and return a TutorialFileSink for writing its chunks.
+ * The returned instance must eventually be closed and released by calling tutorialFileIO_CloseFileSink().
+ *
+ * @param [in] fileName A pointer to a string containing the name of the file to write to.
+ * @param [in] chunkSize The size of every chunk of the file except, possibly, the final one.
+ *
+ * @return A new TutorialFileSink instance.
+ */
+TutorialFileSink *tutorialFileIO_CreateFileSink(const char *fileName, size_t chunkSize);
+
+/**
+ * Open (or create) the specified file without truncating it, and return a TutorialFileSink for writing its chunks.
+ * This is used to resume receiving a file, keeping the chunks already written to it.
+ * The returned instance must eventually be closed and released by calling tutorialFileIO_CloseFileSink().
+ *
+ * @param [in] fileName A pointer to a string containing the name of the file to write to.
+ * @param [in] chunkSize The size of every chunk of the file except, possibly, the final one.
+ *
+ * @return A new TutorialFileSink instance.
+ */
+TutorialFileSink *tutorialFileIO_OpenFileSink(const char *fileName, size_t chunkSize);
+
+/**
+ * Write the contents of the given PARCBuffer as chunk `chunkNumber` of the file. The write may be held
+ * in memory until adjacent chunks arrive, the sink's buffer fills, or the sink is closed.
+ *
+ * @param [in] sink The TutorialFileSink to write to.
+ * @param [in] chunk A pointer to a PARCBuffer containing the bytes of the chunk. Its position is not changed.
+ * @param [in] chunkNumber The 0-based number of the chunk.
+ *
+ * @return The number of bytes accepted.
+ */
+size_t tutorialFileIO_WriteFileChunk(TutorialFileSink *sink, const PARCBuffer *chunk, uint64_t chunkNumber);
+
+/**
+ * Write out any buffered chunks, flush the file to stable storage with fsync(), close it, and release the
+ * TutorialFileSink. On return, `*sinkP` is set to NULL.
+ *
+ * @param [in,out] sinkP A pointer to the TutorialFileSink to close.
+ *
+ * @return true If every chunk was written and the file was successfully flushed.
+ * @return false If any write, the flush, or the close failed.
+ */
+bool tutorialFileIO_CloseFileSink(TutorialFileSink **sinkP);
+
+/**
+ * Write out any buffered chunks and flush the file's data to stable storage with fdatasync(), leaving the sink open.
+ * Once this returns true, every chunk written to the sink so far will survive a crash.
+ *
+ * @param [in] sink The TutorialFileSink to flush.
+ *
+ * @return true If every chunk so far was written and the file was successfully flushed.
+ */
+bool tutorialFileIO_FlushFileSink(TutorialFileSink *sink);
+
+/**
+ * A TutorialFileReader reads file chunks asynchronously, so a single thread can have many reads in flight at
+ * once instead of waiting for each in turn. Each read is made directly into a PARCBuffer allocated when it is
+ * submitted, and that buffer is handed to the read's completion function.
+ *
+ * When built with TUTORIAL_USE_IO_URING defined (`make USE_IO_URING=1`), reads are queued in an io_uring and
+ * submitted to the kernel in batches. Otherwise, or if the kernel doesn't support io_uring, each read is made
+ * with a blocking pread() when it is submitted, and only its completion is deferred.
+ *
+ * Completion functions are only called from within tutorialFileIO_ReadFileChunk(),
+ * tutorialFileIO_CompleteFileChunkReads() and tutorialFileIO_ReleaseFileReader(), on the calling thread.
+ * A TutorialFileReader must only be used by one thread.
+ */
+typedef struct tutorial_file_reader TutorialFileReader;
+
+/**
+ * The signature of the function called when a read submitted to a TutorialFileReader has finished.
+ *
+ * @param [in] context The context pointer given to tutorialFileIO_ReadFileChunk().
+ * @param [in] chunk A PARCBuffer containing the chunk, or NULL if the read failed. It is released after the
+ *             function returns, so acquire it to keep it.
+ */
+typedef void (TutorialFileReadCompletion)(void *context, PARCBuffer *chunk);
+
+/**
+ * Create a TutorialFileReader that can have up to `queueDepth` reads in flight. The returned instance must
+ * eventually be released by calling tutorialFileIO_ReleaseFileReader().
+ *
+ * @param [in] queueDepth The maximum number of reads in flight. Must be greater than 0.
+ *
+ * @return A new TutorialFileReader instance.
+ */
+TutorialFileReader *tutorialFileIO_CreateFileReader(size_t queueDepth);
+
+/**
+ * Wait for any reads still in flight, call their completion functions, and release the TutorialFileReader.
+ * On return, `*readerP` is set to NULL.
+ *
+ * @param [in,out] readerP A pointer to the pointer to the TutorialFileReader to release.
+ */
+void tutorialFileIO_ReleaseFileReader(TutorialFileReader **readerP);
+
+/**
+ * Return true if the reader is using io_uring, or false if it is falling back to blocking reads.
+ *
+ * @param [in] reader The TutorialFileReader to check.
+ */
+bool tutorialFileIO_IsFileReaderAsynchronous(const TutorialFileReader *reader);
+
+/**
+ * Submit a read of the specified chunk of the file open on `fileDescriptor`. `completion` is called with the
+ * chunk once the read has finished. The descriptor must stay open until then. If the reader already has
+ * `queueDepth` reads in flight, this first waits for one of them to finish.
+ *
+ * @param [in] reader The TutorialFileReader to submit the read to.
+ * @param [in] fileDescriptor A file descriptor open for reading.
+ * @param [in] chunkSize The maximum number of bytes to be returned in each chunk.
+ * @param [in] chunkNumber The 0-based number of chunk to read from the file.
+ * @param [in] chunk A buffer to read the chunk into, with its position at 0 and its limit at `chunkSize`, or
+ *             NULL to allocate a new one. The reader takes over the caller's reference to it.
+ * @param [in] completion The function to call when the read has finished.
+ * @param [in] context A pointer passed on to `completion`.
+ */
+void tutorialFileIO_ReadFileChunk(TutorialFileReader *reader, int fileDescriptor, size_t chunkSize, uint64_t chunkNumber,
+                                  PARCBuffer *chunk, TutorialFileReadCompletion *completion, void *context);
+
+/**
+ * Submit a read of an arbitrary range of the file open on `fileDescriptor`, as for tutorialFileIO_ReadFileChunk().
+ * This lets many chunks be read at once, for example to read ahead of a client, without waiting for the read.
+ *
+ * @param [in] reader The TutorialFileReader to submit the read to.
+ * @param [in] fileDescriptor A file descriptor open for reading.
+ * @param [in] offset The offset in the file of the first byte to read.
+ * @param [in] length The maximum number of bytes to read. Fewer are returned if the file ends first.
+ * @param [in] buffer A buffer to read the range into, with its position at 0 and its limit at `length`, or
+ *             NULL to allocate a new one. The reader takes over the caller's reference to it.
+ * @param [in] completion The function to call when the read has finished.
+ * @param [in] context A pointer passed on to `completion`.
+ */
+void tutorialFileIO_ReadFileRange(TutorialFileReader *reader, int fileDescriptor, uint64_t offset, size_t length,
+                                  PARCBuffer *buffer, TutorialFileReadCompletion *completion, void *context);
+
+/**
+ * Return the number of reads that have been submitted but whose completion functions haven't been called yet.
+ *
+ * @param [in] reader The TutorialFileReader to check.
+ */
+size_t tutorialFileIO_GetPendingFileChunkReadCount(const TutorialFileReader *reader);
+
+/**
+ * Submit any reads still queued, and call the completion function of every read that has finished.
+ *
+ * @param [in] reader The TutorialFileReader to check.
+ * @param [in] wait If true, and reads are pending but none have finished, wait for at least one to finish.
+ *
+ * @return The number of completion functions called.
+ */
+size_t tutorialFileIO_CompleteFileChunkReads(TutorialFileReader *reader, bool wait);
+
 /**
  * Check if a file exists and is readable.
  * Return true if it does, false otherwise.
@@ -87,14 +308,69 @@ size_t tutorialFileIO_GetFileSize(const char *fileName);
  */
 bool tutorialFileIO_DeleteFile(const char *fileName);
 
+/**
+ * Create the directories leading to a file, if they don't already exist, so that the file can be created.
+ *
+ * @param [in] filePath A pointer to a string containing the path of the file.
+ *
+ * @return true If every directory leading to the file exists.
+ */
+bool tutorialFileIO_CreateParentDirectories(const char *filePath);
+
 /**
  * Return a PARCBuffer containing a string representing the list of files and their sizes in the directory
- * specified by 'dirName'. File names and sizes in the returned string are seperated by newlines. This
- * function does not recurse into subdirectories.
+ * specified by 'dirName', and in the directories below it. Files in subdirectories are listed by their paths
+ * relative to 'dirName'. File names and sizes in the returned string are seperated by newlines. Hidden
+ * subdirectories, whose names start with '.', aren't listed.
  *
  * The returned PARCBuffer must eventually be released via a call to parcBuffer_Release().
  *
  * @param dirName A pointer to a string containing the name of the directory to inspect.
  */
 PARCBuffer *tutorialFileIO_CreateDirectoryListing(const char *dirName);
+
+/**
+ * The parts of a file's stat() metadata that tell one version of its contents from another: which file it is,
+ * its size, and when it, or its inode, last changed, to the nanosecond. Something built from a file, such as a
+ * response or its metadata, is only still valid while the file's version is the one it was built from. Two
+ * writes within the same second, or a write that keeps the size and restores the modification time, give a
+ * different version. Every field is 64 bits wide, so a version can be written to a file as it is.
+ */
+typedef struct {
+    uint64_t device;
+    uint64_t inode;
+    uint64_t size;
+    int64_t modificationSeconds;
+    int64_t modificationNanoseconds;
+    int64_t changeSeconds;          // The inode's change time, which can't be set back from user space.
+    int64_t changeNanoseconds;
+} TutorialFileVersion;
+
+/**
+ * Fill in the version of a file from its stat() metadata.
+ *
+ * @param [in] fileInfo The stat() metadata of the file.
+ * @param [out] version The TutorialFileVersion to fill in.
+ */
+void tutorialFileIO_GetFileVersion(const struct stat *fileInfo, TutorialFileVersion *version);
+
+/**
+ * Determine whether a file's current stat() metadata is of the specified version.
+ *
+ * @param [in] version A version of the file, from tutorialFileIO_GetFileVersion().
+ * @param [in] fileInfo The current stat() metadata of the file.
+ *
+ * @return true If the file is still the same file, with the same contents, as `version`.
+ */
+bool tutorialFileIO_IsFileVersion(const TutorialFileVersion *version, const struct stat *fileInfo);
+
+/**
+ * Determine whether two stat()s of a file are of the same version of it.
+ *
+ * @param [in] fileInfo The stat() metadata of a file.
+ * @param [in] otherInfo Another stat() metadata, of the same or another file.
+ *
+ * @return true If both are of the same file, with the same contents.
+ */
+bool tutorialFileIO_IsSameFileVersion(const struct stat *fileInfo, const struct stat *otherInfo);
 #endif // tutorial_FileIO_h
@@ -0,0 +1,291 @@
+/*
+ * Copyright (c) 2014-2015, Xerox Corporation (Xerox)and Palo Alto Research Center (PARC)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Patent rights are not granted under this agreement. Patent rights are
+ *       available under FRAND terms.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL XEROX or PARC BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+/**
+ * @author Alan Walendowski, Palo Alto Research Center (Xerox PARC)
+ * @copyright 2014-2015, Xerox Corporation (Xerox)and Palo Alto Research Center (PARC).  All rights reserved.
+ */
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <LongBow/runtime.h>
+#include <parc/algol/parc_Memory.h>
+
+#include "tutorial_Journal.h"
+#include "tutorial_FileIO.h"
+
+const double tutorialJournal_FlushInterval = 2.0;
+
+// Appended to the name of the file being fetched to name its journal.
+static const char *_journalSuffix = ".tutorial_journal";
+
+// The first bytes of every journal, which also identify the version of its layout.
+static const char _journalMagic[8] = { 'T', 'U', 'T', 'J', 'R', 'N', 'L', '1' };
+
+/**
+ * The start of a journal's file. The bitmap follows it, one bit per chunk, in 64-bit words.
+ */
+typedef struct {
+    char magic[8];
+    uint64_t fileSize;
+    uint64_t finalChunkNumber;
+    int64_t modificationTime;
+    uint32_t chunkSize;
+    uint32_t reserved;
+} _TutorialJournalHeader;
+
+struct tutorial_journal {
+    char *journalName;
+    int fileDescriptor;          // -1 if the journal's file couldn't be opened, in which case nothing is written.
+    TutorialMetadata metadata;
+
+    uint64_t *bitmap;            // One bit per chunk, set once the chunk has been handed to the file.
+    size_t bitmapWordCount;
+    uint64_t chunkCount;         // The number of bits set in the bitmap.
+
+    size_t firstDirtyWord;       // The range of words changed since the journal was last written.
+    size_t endDirtyWord;
+    struct timespec lastFlushTime;
+
+    bool wasSourceChanged;
+};
+
+static double
+_secondsSince(const struct timespec *startTime)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (double) (now.tv_sec - startTime->tv_sec) + (double) (now.tv_nsec - startTime->tv_nsec) / 1e9;
+}
+
+/**
+ * Determine whether a journal's header describes the same version of the file as the specified metadata.
+ */
+static bool
+_headerMatchesMetadata(const _TutorialJournalHeader *header, const TutorialMetadata *metadata)
+{
+    return header->fileSize == metadata->fileSize
+           && header->finalChunkNumber == metadata->finalChunkNumber
+           && header->modificationTime == metadata->modificationTime
+           && header->chunkSize == metadata->chunkSize;
+}
+
+/**
+ * Read the bitmap of an existing journal that matches the file, and count the chunks it records. Return false if
+ * the journal is too short to hold the whole bitmap.
+ */
+static bool
+_loadBitmap(TutorialJournal *journal)
+{
+    size_t length = journal->bitmapWordCount * sizeof(uint64_t);
+    if (pread(journal->fileDescriptor, journal->bitmap, length, sizeof(_TutorialJournalHeader)) != (ssize_t) length) {
+        memset(journal->bitmap, 0, length);
+        return false;
+    }
+
+    // Ignore any bits past the final chunk.
+    uint64_t finalBit = journal->metadata.finalChunkNumber % 64;
+    if (finalBit < 63) {
+        journal->bitmap[journal->bitmapWordCount - 1] &= (UINT64_C(1) << (finalBit + 1)) - 1;
+    }
+
+    for (size_t i = 0; i < journal->bitmapWordCount; i++) {
+        journal->chunkCount += (uint64_t) __builtin_popcountll(journal->bitmap[i]);
+    }
+    return true;
+}
+
+/**
+ * Empty the journal's file, and write a new header for the current version of the file, followed by an empty bitmap.
+ */
+static bool
+_resetJournal(TutorialJournal *journal)
+{
+    _TutorialJournalHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, _journalMagic, sizeof(header.magic));
+    header.fileSize = journal->metadata.fileSize;
+    header.finalChunkNumber = journal->metadata.finalChunkNumber;
+    header.modificationTime = journal->metadata.modificationTime;
+    header.chunkSize = journal->metadata.chunkSize;
+
+    off_t length = (off_t) (sizeof(header) + journal->bitmapWordCount * sizeof(uint64_t));
+
+    return ftruncate(journal->fileDescriptor, 0) == 0
+           && ftruncate(journal->fileDescriptor, length) == 0
+           && pwrite(journal->fileDescriptor, &header, sizeof(header), 0) == (ssize_t) sizeof(header);
+}
+
+TutorialJournal *
+tutorialJournal_Open(const char *fileName, const TutorialMetadata *metadata)
+{
+    TutorialJournal *result = parcMemory_AllocateAndClear(sizeof(TutorialJournal));
+    assertNotNull(result, "parcMemory_AllocateAndClear(%zu) returned NULL", sizeof(TutorialJournal));
+
+    size_t nameLength = strlen(fileName) + strlen(_journalSuffix) + 1;
+    result->journalName = parcMemory_Allocate(nameLength);
+    assertNotNull(result->journalName, "parcMemory_Allocate(%zu) returned NULL", nameLength);
+    snprintf(result->journalName, nameLength, "%s%s", fileName, _journalSuffix);
+
+    result->metadata = *metadata;
+    result->bitmapWordCount = (size_t) (metadata->finalChunkNumber / 64) + 1;
+    result->bitmap = parcMemory_AllocateAndClear(result->bitmapWordCount * sizeof(uint64_t));
+    assertNotNull(result->bitmap, "parcMemory_AllocateAndClear(%zu) returned NULL", result->bitmapWordCount * sizeof(uint64_t));
+    clock_gettime(CLOCK_MONOTONIC, &result->lastFlushTime);
+
+    result->fileDescriptor = open(result->journalName, O_RDWR | O_CREAT, 0644);
+    if (result->fileDescriptor < 0) {
+        fprintf(stderr, "tutorial_Journal: Could not open '%s' (%s). The fetch can't be resumed if it is interrupted.\n",
+                result->journalName, strerror(errno));
+        return result;
+    }
+
+    _TutorialJournalHeader header;
+    bool isResumable = false;
+    if (pread(result->fileDescriptor, &header, sizeof(header), 0) == (ssize_t) sizeof(header)
+        && memcmp(header.magic, _journalMagic, sizeof(header.magic)) == 0) {
+        if (_headerMatchesMetadata(&header, metadata) == false) {
+            result->wasSourceChanged = true;
+        } else if (tutorialFileIO_IsFileAvailable(fileName)) {
+            isResumable = _loadBitmap(result);
+        }
+    }
+
+    if (isResumable == false && _resetJournal(result) == false) {
+        fprintf(stderr, "tutorial_Journal: Could not write '%s' (%s). The fetch can't be resumed if it is interrupted.\n",
+                result->journalName, strerror(errno));
+        close(result->fileDescriptor);
+        result->fileDescriptor = -1;
+    }
+
+    return result;
+}
+
+static void
+_releaseJournal(TutorialJournal **journalP, bool shouldDelete)
+{
+    assertNotNull(journalP, "Parameter must be a non-null pointer to a TutorialJournal pointer.");
+    TutorialJournal *journal = *journalP;
+
+    if (journal->fileDescriptor >= 0) {
+        close(journal->fileDescriptor);
+        if (shouldDelete) {
+            unlink(journal->journalName);
+        }
+    }
+
+    parcMemory_Deallocate((void **) &journal->bitmap);
+    parcMemory_Deallocate((void **) &journal->journalName);
+    parcMemory_Deallocate((void **) journalP);
+}
+
+void
+tutorialJournal_Release(TutorialJournal **journalP)
+{
+    _releaseJournal(journalP, false);
+}
+
+void
+tutorialJournal_Delete(TutorialJournal **journalP)
+{
+    _releaseJournal(journalP, true);
+}
+
+bool
+tutorialJournal_HasChunk(const TutorialJournal *journal, uint64_t chunkNumber)
+{
+    if (chunkNumber > journal->metadata.finalChunkNumber) {
+        return false;
+    }
+    return (journal->bitmap[chunkNumber / 64] & (UINT64_C(1) << (chunkNumber % 64))) != 0;
+}
+
+uint64_t
+tutorialJournal_GetChunkCount(const TutorialJournal *journal)
+{
+    return journal->chunkCount;
+}
+
+bool
+tutorialJournal_WasSourceChanged(const TutorialJournal *journal)
+{
+    return journal->wasSourceChanged;
+}
+
+void
+tutorialJournal_RecordChunk(TutorialJournal *journal, uint64_t chunkNumber)
+{
+    if (chunkNumber > journal->metadata.finalChunkNumber || tutorialJournal_HasChunk(journal, chunkNumber)) {
+        return;
+    }
+
+    size_t word = (size_t) (chunkNumber / 64);
+    journal->bitmap[word] |= (UINT64_C(1) << (chunkNumber % 64));
+    journal->chunkCount++;
+
+    if (journal->firstDirtyWord == journal->endDirtyWord) {
+        journal->firstDirtyWord = word;
+        journal->endDirtyWord = word + 1;
+    } else if (word < journal->firstDirtyWord) {
+        journal->firstDirtyWord = word;
+    } else if (word >= journal->endDirtyWord) {
+        journal->endDirtyWord = word + 1;
+    }
+}
+
+bool
+tutorialJournal_IsFlushDue(const TutorialJournal *journal)
+{
+    return journal->firstDirtyWord != journal->endDirtyWord
+           && _secondsSince(&journal->lastFlushTime) >= tutorialJournal_FlushInterval;
+}
+
+bool
+tutorialJournal_Flush(TutorialJournal *journal)
+{
+    if (journal->fileDescriptor < 0) {
+        return false;
+    }
+
+    // Chunks mostly arrive in order, so only a few words have usually changed.
+    bool result = true;
+    if (journal->firstDirtyWord != journal->endDirtyWord) {
+        size_t length = (journal->endDirtyWord - journal->firstDirtyWord) * sizeof(uint64_t);
+        off_t offset = (off_t) (sizeof(_TutorialJournalHeader) + journal->firstDirtyWord * sizeof(uint64_t));
+        result = pwrite(journal->fileDescriptor, journal->bitmap + journal->firstDirtyWord, length, offset) == (ssize_t) length;
+        if (result) {
+            journal->firstDirtyWord = 0;
+            journal->endDirtyWord = 0;
+        }
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &journal->lastFlushTime);
+    return result;
+}
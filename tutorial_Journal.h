@@ -0,0 +1,143 @@
+/*
+ * Copyright (c) 2014-2015, Xerox Corporation (Xerox)and Palo Alto Research Center (PARC)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Patent rights are not granted under this agreement. Patent rights are
+ *       available under FRAND terms.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL XEROX or PARC BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+/**
+ * @author Alan Walendowski, Palo Alto Research Center (Xerox PARC)
+ * @copyright 2014-2015, Xerox Corporation (Xerox)and Palo Alto Research Center (PARC).  All rights reserved.
+ */
+
+#ifndef tutorial_Journal_h
+#define tutorial_Journal_h
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "tutorial_Metadata.h"
+
+/**
+ * A TutorialJournal records which chunks of a file being fetched are safely on disk, so that a fetch that is
+ * interrupted can be resumed without fetching them again. It is kept in a sidecar file next to the file being
+ * fetched, named "<file name>.tutorial_journal", holding the file's metadata as given by the server followed by
+ * a bitmap with one bit per chunk.
+ *
+ * The journal must never claim a chunk that isn't on disk, so a chunk is recorded only once it has been handed
+ * to the file, and the file is flushed before the journal is written. A journal whose metadata doesn't match the
+ * file's current metadata describes an older version of the file, and is discarded.
+ *
+ * The journal is written in host byte order, since it never leaves the machine that wrote it.
+ */
+typedef struct tutorial_journal TutorialJournal;
+
+/**
+ * Open the journal of the specified file. If there is a journal for the same version of the file, described by
+ * `metadata`, and the file still exists, the chunks it records are kept. Otherwise the journal starts out empty.
+ * The returned instance must eventually be released by calling tutorialJournal_Release().
+ *
+ * @param [in] fileName The name of the file being fetched (not of the journal).
+ * @param [in] metadata The metadata of the file, as given by the server.
+ *
+ * @return A new TutorialJournal instance.
+ */
+TutorialJournal *tutorialJournal_Open(const char *fileName, const TutorialMetadata *metadata);
+
+/**
+ * Release the specified TutorialJournal, keeping its file so that the fetch can be resumed. Chunks recorded since
+ * the journal was last flushed are not written, so flush it first if they are on disk.
+ *
+ * @param [in,out] journalP A pointer to the pointer to the TutorialJournal to release. It will be set to NULL.
+ */
+void tutorialJournal_Release(TutorialJournal **journalP);
+
+/**
+ * Delete the journal's file and release the journal. This is done once the file has been completely fetched.
+ *
+ * @param [in,out] journalP A pointer to the pointer to the TutorialJournal to delete. It will be set to NULL.
+ */
+void tutorialJournal_Delete(TutorialJournal **journalP);
+
+/**
+ * Determine whether the journal records the specified chunk as being on disk.
+ *
+ * @param [in] journal The TutorialJournal to inspect.
+ * @param [in] chunkNumber The number of the chunk.
+ *
+ * @return true If the chunk is on disk.
+ */
+bool tutorialJournal_HasChunk(const TutorialJournal *journal, uint64_t chunkNumber);
+
+/**
+ * Get the number of chunks the journal records as being on disk.
+ *
+ * @param [in] journal The TutorialJournal to inspect.
+ *
+ * @return The number of chunks recorded.
+ */
+uint64_t tutorialJournal_GetChunkCount(const TutorialJournal *journal);
+
+/**
+ * Determine whether the journal found a journal for an older version of the file, which it discarded.
+ *
+ * @param [in] journal The TutorialJournal to inspect.
+ *
+ * @return true If the file changed on the server since it was last partly fetched.
+ */
+bool tutorialJournal_WasSourceChanged(const TutorialJournal *journal);
+
+/**
+ * Record that the specified chunk has been handed to the file. It is only written to the journal by the next
+ * call to tutorialJournal_Flush(), which must only be made once the chunk is on disk.
+ *
+ * @param [in] journal The TutorialJournal to update.
+ * @param [in] chunkNumber The number of the chunk.
+ */
+void tutorialJournal_RecordChunk(TutorialJournal *journal, uint64_t chunkNumber);
+
+/**
+ * Determine whether it's time to flush the journal: whether chunks have been recorded since it was last written,
+ * and at least tutorialJournal_FlushInterval seconds have passed.
+ *
+ * @param [in] journal The TutorialJournal to inspect.
+ *
+ * @return true If the file and then the journal should be flushed.
+ */
+bool tutorialJournal_IsFlushDue(const TutorialJournal *journal);
+
+/**
+ * Write the chunks recorded since the journal was last written to its file. The caller must first make sure that
+ * those chunks are on disk, e.g. with tutorialFileIO_FlushFileSink().
+ *
+ * @param [in] journal The TutorialJournal to write.
+ *
+ * @return true If the journal was written.
+ */
+bool tutorialJournal_Flush(TutorialJournal *journal);
+
+/**
+ * How often, in seconds, the journal of a file being fetched is written, at most. This is the most work an
+ * interrupted fetch can lose.
+ */
+extern const double tutorialJournal_FlushInterval;
+#endif // tutorial_Journal_h
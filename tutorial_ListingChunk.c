@@ -0,0 +1,174 @@
+/*
+ * Copyright (c) 2014-2015, Xerox Corporation (Xerox)and Palo Alto Research Center (PARC)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Patent rights are not granted under this agreement. Patent rights are
+ *       available under FRAND terms.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL XEROX or PARC BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+/**
+ * @author Alan Walendowski, Palo Alto Research Center (Xerox PARC)
+ * @copyright 2014-2015, Xerox Corporation (Xerox)and Palo Alto Research Center (PARC).  All rights reserved.
+ */
+#include <string.h>
+
+#include <LongBow/runtime.h>
+
+#include "tutorial_ListingChunk.h"
+
+/**
+ * Identifies a chunk of a directory listing, and the version of its layout.
+ */
+static const uint16_t _listingChunkMagic = 0x4c31; // "L1"
+
+/**
+ * The size of the fixed part of each entry: the length of the file name, the file size and the modification time.
+ */
+static const size_t _entryHeaderLength = 2 + 8 + 8;
+
+const size_t tutorialListingChunk_HeaderLength = 2 + 2;
+
+const size_t tutorialListingChunk_MaximumEntryCount = UINT16_MAX;
+
+static uint8_t *
+_putUint16(uint8_t *bytes, uint16_t value)
+{
+    *bytes++ = (uint8_t) (value >> 8);
+    *bytes++ = (uint8_t) value;
+    return bytes;
+}
+
+static uint8_t *
+_putUint64(uint8_t *bytes, uint64_t value)
+{
+    for (int i = 7; i >= 0; i--) {
+        *bytes++ = (uint8_t) (value >> (8 * i));
+    }
+    return bytes;
+}
+
+static const uint8_t *
+_getUint16(const uint8_t *bytes, uint16_t *value)
+{
+    *value = (uint16_t) ((bytes[0] << 8) | bytes[1]);
+    return bytes + 2;
+}
+
+static const uint8_t *
+_getUint64(const uint8_t *bytes, uint64_t *value)
+{
+    *value = 0;
+    for (int i = 0; i < 8; i++) {
+        *value = (*value << 8) | *bytes++;
+    }
+    return bytes;
+}
+
+size_t
+tutorialListingChunk_GetEntryLength(size_t fileNameLength)
+{
+    return _entryHeaderLength + fileNameLength;
+}
+
+uint8_t *
+tutorialListingChunk_PutHeader(uint8_t *chunk, size_t entryCount)
+{
+    assertTrue(entryCount <= tutorialListingChunk_MaximumEntryCount, "Too many entries for one chunk: %zu", entryCount);
+
+    chunk = _putUint16(chunk, _listingChunkMagic);
+    return _putUint16(chunk, (uint16_t) entryCount);
+}
+
+uint8_t *
+tutorialListingChunk_PutEntry(uint8_t *destination, const TutorialListingEntry *entry)
+{
+    assertTrue(entry->fileNameLength <= UINT16_MAX, "File name too long for a listing: %zu bytes", entry->fileNameLength);
+
+    destination = _putUint16(destination, (uint16_t) entry->fileNameLength);
+    destination = _putUint64(destination, entry->fileSize);
+    destination = _putUint64(destination, (uint64_t) entry->modificationTime);
+    memcpy(destination, entry->fileName, entry->fileNameLength);
+
+    return destination + entry->fileNameLength;
+}
+
+bool
+tutorialListingChunk_Open(const PARCBuffer *chunk, TutorialListingChunkCursor *cursor)
+{
+    size_t length = parcBuffer_Remaining(chunk);
+    if (length < tutorialListingChunk_HeaderLength) {
+        return false;
+    }
+
+    // We're un-const'ing for parcBuffer_Overlay, but we do not change the buffer state.
+    const uint8_t *bytes = parcBuffer_Overlay((PARCBuffer *) chunk, 0);
+    const uint8_t *end = bytes + length;
+
+    uint16_t magic;
+    uint16_t entryCount;
+    bytes = _getUint16(bytes, &magic);
+    bytes = _getUint16(bytes, &entryCount);
+    if (magic != _listingChunkMagic) {
+        return false;
+    }
+
+    cursor->next = bytes;
+    cursor->end = end;
+    cursor->remainingCount = entryCount;
+
+    // Walk the entries once, so that reading them can't run off the end of a damaged chunk.
+    for (uint16_t i = 0; i < entryCount; i++) {
+        uint16_t fileNameLength;
+        if ((size_t) (end - bytes) < _entryHeaderLength) {
+            return false;
+        }
+        _getUint16(bytes, &fileNameLength);
+        if ((size_t) (end - bytes) < tutorialListingChunk_GetEntryLength(fileNameLength)) {
+            return false;
+        }
+        bytes += tutorialListingChunk_GetEntryLength(fileNameLength);
+    }
+
+    return bytes == end;
+}
+
+bool
+tutorialListingChunk_NextEntry(TutorialListingChunkCursor *cursor, TutorialListingEntry *entry)
+{
+    if (cursor->remainingCount == 0) {
+        return false;
+    }
+
+    uint16_t fileNameLength;
+    uint64_t modificationTime;
+    const uint8_t *bytes = cursor->next;
+    bytes = _getUint16(bytes, &fileNameLength);
+    bytes = _getUint64(bytes, &entry->fileSize);
+    bytes = _getUint64(bytes, &modificationTime);
+
+    entry->modificationTime = (int64_t) modificationTime;
+    entry->fileName = (const char *) bytes;
+    entry->fileNameLength = fileNameLength;
+
+    cursor->next = bytes + fileNameLength;
+    cursor->remainingCount--;
+    return true;
+}
@@ -0,0 +1,134 @@
+/*
+ * Copyright (c) 2014-2015, Xerox Corporation (Xerox)and Palo Alto Research Center (PARC)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Patent rights are not granted under this agreement. Patent rights are
+ *       available under FRAND terms.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL XEROX or PARC BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+/**
+ * @author Alan Walendowski, Palo Alto Research Center (Xerox PARC)
+ * @copyright 2014-2015, Xerox Corporation (Xerox)and Palo Alto Research Center (PARC).  All rights reserved.
+ */
+
+#ifndef tutorial_ListingChunk_h
+#define tutorial_ListingChunk_h
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include <parc/algol/parc_Buffer.h>
+
+/**
+ * The 'list' command returns the regular files being served in a compact binary form, sorted by file name and
+ * split so that every chunk holds whole entries. Each chunk can therefore be parsed on its own, as soon as it
+ * arrives and in any order; the human-readable listing is rendered by the client.
+ *
+ * A chunk is a header, giving the layout version and the number of entries in the chunk, followed by the
+ * entries. Each entry is the length of the file name, the file's size and its modification time, followed by
+ * the file name itself, which is not null-terminated. All numbers are in network byte order.
+ *
+ * A chunk holds as many entries as fit in the listing's chunk size. An entry too long to fit in a chunk of its
+ * own (a very long file name) is sent in a chunk of its own that is longer than the chunk size.
+ */
+
+/**
+ * A file in a directory listing.
+ */
+typedef struct {
+    const char *fileName;       // Not null-terminated. When parsed, it points into the chunk.
+    size_t fileNameLength;
+    uint64_t fileSize;
+    int64_t modificationTime;   // In seconds since the epoch.
+} TutorialListingEntry;
+
+/**
+ * The position of the next entry to read from a chunk of a directory listing, from tutorialListingChunk_Open().
+ */
+typedef struct {
+    const uint8_t *next;
+    const uint8_t *end;
+    size_t remainingCount;      // The number of entries still to be read.
+} TutorialListingChunkCursor;
+
+/**
+ * The length of the header at the start of every chunk of a directory listing.
+ */
+extern const size_t tutorialListingChunk_HeaderLength;
+
+/**
+ * The most entries a single chunk of a directory listing can hold.
+ */
+extern const size_t tutorialListingChunk_MaximumEntryCount;
+
+/**
+ * Return the number of bytes an entry with a file name of the specified length takes up in a chunk.
+ *
+ * @param [in] fileNameLength The length of the file name, in bytes.
+ *
+ * @return The encoded length of the entry.
+ */
+size_t tutorialListingChunk_GetEntryLength(size_t fileNameLength);
+
+/**
+ * Write the header of a chunk of a directory listing.
+ *
+ * @param [out] chunk Where to write the header. There must be room for tutorialListingChunk_HeaderLength bytes.
+ * @param [in] entryCount The number of entries that will follow the header. At most tutorialListingChunk_MaximumEntryCount.
+ *
+ * @return A pointer to the byte following the header, where the first entry goes.
+ */
+uint8_t *tutorialListingChunk_PutHeader(uint8_t *chunk, size_t entryCount);
+
+/**
+ * Write an entry of a chunk of a directory listing.
+ *
+ * @param [out] destination Where to write the entry. There must be room for tutorialListingChunk_GetEntryLength() bytes.
+ * @param [in] entry The file to describe. Its file name must be no longer than UINT16_MAX bytes.
+ *
+ * @return A pointer to the byte following the entry, where the next entry goes.
+ */
+uint8_t *tutorialListingChunk_PutEntry(uint8_t *destination, const TutorialListingEntry *entry);
+
+/**
+ * Check that a chunk of a directory listing is well formed, and prepare to read its entries with
+ * tutorialListingChunk_NextEntry().
+ *
+ * @param [in] chunk The chunk. It must not be modified or released while its entries are being read.
+ * @param [out] cursor Set to the first entry of the chunk.
+ *
+ * @return true If the chunk is a well formed chunk of a directory listing.
+ * @return false If it isn't, e.g. it was damaged or uses a layout we don't know.
+ */
+bool tutorialListingChunk_Open(const PARCBuffer *chunk, TutorialListingChunkCursor *cursor);
+
+/**
+ * Read the next entry of a chunk of a directory listing.
+ *
+ * @param [in,out] cursor The cursor from tutorialListingChunk_Open(). It is moved on to the following entry.
+ * @param [out] entry Filled in with the entry. Its file name points into the chunk.
+ *
+ * @return true If an entry was read.
+ * @return false If every entry of the chunk has been read.
+ */
+bool tutorialListingChunk_NextEntry(TutorialListingChunkCursor *cursor, TutorialListingEntry *entry);
+#endif // tutorial_ListingChunk_h
@@ -0,0 +1,206 @@
+/*
+ * Copyright (c) 2014-2015, Xerox Corporation (Xerox)and Palo Alto Research Center (PARC)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Patent rights are not granted under this agreement. Patent rights are
+ *       available under FRAND terms.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL XEROX or PARC BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+/**
+ * @author Alan Walendowski, Palo Alto Research Center (Xerox PARC)
+ * @copyright 2014-2015, Xerox Corporation (Xerox)and Palo Alto Research Center (PARC).  All rights reserved.
+ */
+#include <ctype.h>
+#include <fnmatch.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <ccnx/common/ccnx_NameSegment.h>
+
+#include "tutorial_ListingQuery.h"
+
+/**
+ * Parse a decimal number that fills the whole of [value, value + length).
+ */
+static bool
+_parseNumber(const char *value, size_t length, uint64_t *result)
+{
+    char digits[24];
+
+    if (length == 0 || length >= sizeof(digits)) {
+        return false;
+    }
+    for (size_t i = 0; i < length; i++) {
+        if (isdigit((unsigned char) value[i]) == 0) {
+            return false;
+        }
+    }
+    memcpy(digits, value, length);
+    digits[length] = '\0';
+
+    char *end;
+    *result = strtoull(digits, &end, 10);
+    return (*end == '\0');
+}
+
+/**
+ * Determine whether an argument has the form "<key>=...", and if so, point `value` at what follows the '='.
+ */
+static bool
+_hasKey(const char *argument, size_t argumentLength, const char *key, const char **value, size_t *valueLength)
+{
+    size_t keyLength = strlen(key);
+    if (argumentLength <= keyLength || memcmp(argument, key, keyLength) != 0 || argument[keyLength] != '=') {
+        return false;
+    }
+    *value = argument + keyLength + 1;
+    *valueLength = argumentLength - keyLength - 1;
+    return true;
+}
+
+/**
+ * Apply one argument of a 'list' command to a query.
+ *
+ * @return true If the argument is a condition we know, with a valid value.
+ */
+static bool
+_parseArgument(const char *argument, size_t argumentLength, TutorialListingQuery *query)
+{
+    const char *value;
+    size_t valueLength;
+    uint64_t number;
+
+    if (_hasKey(argument, argumentLength, "prefix", &query->prefix, &query->prefixLength)) {
+        return true;
+    } else if (_hasKey(argument, argumentLength, "match", &query->pattern, &query->patternLength)) {
+        return true;
+    } else if (_hasKey(argument, argumentLength, "after", &query->after, &query->afterLength)) {
+        return true;
+    } else if (_hasKey(argument, argumentLength, "since", &value, &valueLength)) {
+        query->hasModifiedSince = _parseNumber(value, valueLength, &number) && number <= INT64_MAX;
+        query->modifiedSince = (int64_t) number;
+        return query->hasModifiedSince;
+    } else if (_hasKey(argument, argumentLength, "limit", &value, &valueLength)) {
+        bool isValid = _parseNumber(value, valueLength, &number) && number > 0;
+        query->limit = (size_t) number;
+        return isValid;
+    }
+    return false;
+}
+
+bool
+tutorialListingQuery_Parse(const CCNxName *name, const TutorialNameView *view, TutorialListingQuery *query)
+{
+    memset(query, 0, sizeof(*query));
+
+    for (size_t i = 0; i < view->argumentCount; i++) {
+        CCNxNameSegment *segment = ccnxName_GetSegment(name, view->argumentIndex + i);
+        if (ccnxNameSegment_GetType(segment) != CCNxNameLabelType_NAME) {
+            return false;
+        }
+
+        PARCBuffer *value = ccnxNameSegment_GetValue(segment);
+        const char *argument = parcBuffer_Overlay(value, 0); // Overlaying 0 bytes doesn't move the buffer's position.
+        if (_parseArgument(argument, parcBuffer_Remaining(value), query) == false) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * Append a "<key>=<value>" segment to a name.
+ */
+static void
+_appendArgument(CCNxName *name, const char *key, const char *value, size_t valueLength)
+{
+    size_t keyLength = strlen(key);
+    size_t argumentLength = keyLength + 1 + valueLength;
+
+    PARCBuffer *argument = parcBuffer_Allocate(argumentLength);
+    parcBuffer_PutArray(argument, keyLength, (const uint8_t *) key);
+    parcBuffer_PutUint8(argument, '=');
+    parcBuffer_PutArray(argument, valueLength, (const uint8_t *) value);
+    parcBuffer_Flip(argument);
+
+    CCNxNameSegment *segment = ccnxNameSegment_CreateTypeValue(CCNxNameLabelType_NAME, argument);
+    ccnxName_Append(name, segment);
+    ccnxNameSegment_Release(&segment);
+    parcBuffer_Release(&argument);
+}
+
+CCNxName *
+tutorialListingQuery_CreateName(const TutorialListingQuery *query)
+{
+    CCNxName *result = ccnxName_CreateFromURI(tutorialCommon_DomainPrefix);
+
+    PARCBuffer *commandBuffer = parcBuffer_WrapCString((char *) tutorialCommon_CommandList);
+    CCNxNameSegment *commandSegment = ccnxNameSegment_CreateTypeValue(CCNxNameLabelType_NAME, commandBuffer);
+    ccnxName_Append(result, commandSegment);
+    ccnxNameSegment_Release(&commandSegment);
+    parcBuffer_Release(&commandBuffer);
+
+    if (query->prefix != NULL) {
+        _appendArgument(result, "prefix", query->prefix, query->prefixLength);
+    }
+    if (query->pattern != NULL) {
+        _appendArgument(result, "match", query->pattern, query->patternLength);
+    }
+    if (query->hasModifiedSince) {
+        char number[24];
+        int length = snprintf(number, sizeof(number), "%lld", (long long) query->modifiedSince);
+        _appendArgument(result, "since", number, (size_t) length);
+    }
+    if (query->after != NULL) {
+        _appendArgument(result, "after", query->after, query->afterLength);
+    }
+    if (query->limit > 0) {
+        char number[24];
+        int length = snprintf(number, sizeof(number), "%llu", (unsigned long long) query->limit);
+        _appendArgument(result, "limit", number, (size_t) length);
+    }
+
+    return result;
+}
+
+bool
+tutorialListingQuery_Matches(const TutorialListingQuery *query, const char *fileName, size_t fileNameLength,
+                             int64_t modificationTime)
+{
+    if (query->prefix != NULL
+        && (fileNameLength < query->prefixLength || memcmp(fileName, query->prefix, query->prefixLength) != 0)) {
+        return false;
+    }
+    if (query->hasModifiedSince && modificationTime < query->modifiedSince) {
+        return false;
+    }
+    if (query->pattern != NULL) {
+        char pattern[query->patternLength + 1]; // fnmatch() needs a null-terminated pattern.
+        memcpy(pattern, query->pattern, query->patternLength);
+        pattern[query->patternLength] = '\0';
+        if (fnmatch(pattern, fileName, FNM_PATHNAME) != 0) {
+            return false;
+        }
+    }
+    return true;
+}
@@ -0,0 +1,109 @@
+/*
+ * Copyright (c) 2014-2015, Xerox Corporation (Xerox)and Palo Alto Research Center (PARC)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Patent rights are not granted under this agreement. Patent rights are
+ *       available under FRAND terms.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL XEROX or PARC BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+/**
+ * @author Alan Walendowski, Palo Alto Research Center (Xerox PARC)
+ * @copyright 2014-2015, Xerox Corporation (Xerox)and Palo Alto Research Center (PARC).  All rights reserved.
+ */
+
+#ifndef tutorial_ListingQuery_h
+#define tutorial_ListingQuery_h
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include <ccnx/common/ccnx_Name.h>
+
+#include "tutorial_Common.h"
+
+/**
+ * A TutorialListingQuery asks the server for part of its directory listing, rather than all of it, so a client
+ * with a large directory to sync only transfers what it needs. It is carried as arguments of the 'list' command,
+ * one name segment per condition:
+ *
+ *   <domain prefix>/list[/prefix=<text>][/match=<pattern>][/since=<seconds>][/after=<file name>][/limit=<count>]
+ *
+ * - prefix: only files whose names start with <text>.
+ * - match: only files whose names match the shell wildcard <pattern>, as understood by fnmatch() with FNM_PATHNAME.
+ * - since: only files modified at or after <seconds> since the epoch.
+ * - after: only files whose names sort after <file name>. This is the cursor of a paginated listing.
+ * - limit: at most <count> files. If the response holds <count> files, the next page is asked for with `after`
+ *   set to the last of them.
+ *
+ * As with every command, the number of the chunk asked for is the name's final, CHUNK-typed, segment. The
+ * response is a listing in the same chunked binary form as the full listing (see tutorial_ListingChunk.h),
+ * sorted by file name. The strings in a parsed query point directly at the bytes of the name's segments, and are
+ * not null-terminated, so the query is only valid for as long as the CCNxName it was parsed from.
+ */
+typedef struct {
+    const char *prefix;         // NULL if any name will do.
+    size_t prefixLength;
+    const char *pattern;        // NULL if any name will do.
+    size_t patternLength;
+    const char *after;          // NULL to start from the first file.
+    size_t afterLength;
+    bool hasModifiedSince;
+    int64_t modifiedSince;      // In seconds since the epoch, if hasModifiedSince is true.
+    size_t limit;               // 0 for no limit.
+} TutorialListingQuery;
+
+/**
+ * Parse the arguments of a 'list' command into a TutorialListingQuery, without allocating any memory.
+ * A 'list' command without arguments is a query with no conditions.
+ *
+ * @param [in] name The CCNxName of the 'list' command.
+ * @param [in] view The TutorialNameView parsed from `name`.
+ * @param [out] query Filled in with the conditions of the query.
+ *
+ * @return true If every argument is a condition we know, with a valid value.
+ */
+bool tutorialListingQuery_Parse(const CCNxName *name, const TutorialNameView *view, TutorialListingQuery *query);
+
+/**
+ * Create the name of a 'list' command asking for the listing described by a query, without a chunk segment.
+ * The new CCNxName must eventually be released by calling ccnxName_Release().
+ *
+ * @param [in] query The conditions of the query.
+ *
+ * @return A new CCNxName.
+ */
+CCNxName *tutorialListingQuery_CreateName(const TutorialListingQuery *query);
+
+/**
+ * Determine whether a file meets the prefix, pattern and modification time conditions of a query. The `after`
+ * and `limit` conditions depend on the file's place in the listing, so they're left to the caller.
+ *
+ * @param [in] query The conditions of the query.
+ * @param [in] fileName The name of the file. It must be null-terminated.
+ * @param [in] fileNameLength The length of `fileName`, in bytes.
+ * @param [in] modificationTime The file's modification time, in seconds since the epoch.
+ *
+ * @return true If the file meets the conditions.
+ */
+bool tutorialListingQuery_Matches(const TutorialListingQuery *query, const char *fileName, size_t fileNameLength,
+                                  int64_t modificationTime);
+#endif // tutorial_ListingQuery_h
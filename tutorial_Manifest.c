@@ -0,0 +1,213 @@
+/*
+ * Copyright (c) 2014-2015, Xerox Corporation (Xerox)and Palo Alto Research Center (PARC)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Patent rights are not granted under this agreement. Patent rights are
+ *       available under FRAND terms.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL XEROX or PARC BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+/**
+ * @author Alan Walendowski, Palo Alto Research Center (Xerox PARC)
+ * @copyright 2014-2015, Xerox Corporation (Xerox)and Palo Alto Research Center (PARC).  All rights reserved.
+ */
+#include <string.h>
+
+#include <LongBow/runtime.h>
+#include <parc/algol/parc_Memory.h>
+
+#include "tutorial_Manifest.h"
+#include "tutorial_Digest.h"
+
+/**
+ * Identifies a manifest, and the version of its layout.
+ */
+static const uint32_t _manifestMagic = 0x544d4631; // "TMF1"
+
+/**
+ * The size of the header at the start of a manifest: the magic number, the chunk size, the file size, the
+ * final chunk number and the modification time.
+ */
+static const size_t _headerLength = 4 + 4 + 8 + 8 + 8;
+
+struct tutorial_manifest {
+    TutorialMetadata metadata;
+    uint8_t *digests; // tutorialDigest_Sha256Length bytes for each chunk, from 0 to the final chunk.
+};
+
+static uint8_t *
+_putUint32(uint8_t *bytes, uint32_t value)
+{
+    for (int i = 3; i >= 0; i--) {
+        *bytes++ = (uint8_t) (value >> (8 * i));
+    }
+    return bytes;
+}
+
+static uint8_t *
+_putUint64(uint8_t *bytes, uint64_t value)
+{
+    for (int i = 7; i >= 0; i--) {
+        *bytes++ = (uint8_t) (value >> (8 * i));
+    }
+    return bytes;
+}
+
+static const uint8_t *
+_getUint32(const uint8_t *bytes, uint32_t *value)
+{
+    *value = 0;
+    for (int i = 0; i < 4; i++) {
+        *value = (*value << 8) | *bytes++;
+    }
+    return bytes;
+}
+
+static const uint8_t *
+_getUint64(const uint8_t *bytes, uint64_t *value)
+{
+    *value = 0;
+    for (int i = 0; i < 8; i++) {
+        *value = (*value << 8) | *bytes++;
+    }
+    return bytes;
+}
+
+/**
+ * Return the number of chunks of the file described by the metadata.
+ */
+static uint64_t
+_getChunkCount(const TutorialMetadata *metadata)
+{
+    return metadata->finalChunkNumber + 1;
+}
+
+TutorialManifest *
+tutorialManifest_Create(const TutorialMetadata *metadata)
+{
+    TutorialManifest *result = parcMemory_AllocateAndClear(sizeof(TutorialManifest));
+    assertNotNull(result, "parcMemory_AllocateAndClear(%zu) returned NULL", sizeof(TutorialManifest));
+
+    result->metadata = *metadata;
+
+    size_t digestsLength = (size_t) _getChunkCount(metadata) * tutorialDigest_Sha256Length;
+    result->digests = parcMemory_AllocateAndClear(digestsLength);
+    assertNotNull(result->digests, "parcMemory_AllocateAndClear(%zu) returned NULL", digestsLength);
+
+    return result;
+}
+
+void
+tutorialManifest_Release(TutorialManifest **manifestP)
+{
+    TutorialManifest *manifest = *manifestP;
+
+    parcMemory_Deallocate((void **) &manifest->digests);
+    parcMemory_Deallocate((void **) &manifest);
+
+    *manifestP = NULL;
+}
+
+const TutorialMetadata *
+tutorialManifest_GetMetadata(const TutorialManifest *manifest)
+{
+    return &manifest->metadata;
+}
+
+void
+tutorialManifest_AddChunks(TutorialManifest *manifest, uint64_t firstChunkNumber, const PARCBuffer *block)
+{
+    size_t length = parcBuffer_Remaining(block);
+    uint64_t chunkCount = (length == 0) ? 1 : (length + manifest->metadata.chunkSize - 1) / manifest->metadata.chunkSize;
+
+    assertTrue(firstChunkNumber + chunkCount <= _getChunkCount(&manifest->metadata),
+               "Chunks %llu to %llu are not part of the file", (unsigned long long) firstChunkNumber,
+               (unsigned long long) (firstChunkNumber + chunkCount - 1));
+
+    tutorialDigest_Sha256Chunks(parcBuffer_Overlay((PARCBuffer *) block, 0), length, manifest->metadata.chunkSize,
+                                manifest->digests + firstChunkNumber * tutorialDigest_Sha256Length);
+}
+
+bool
+tutorialManifest_VerifyChunk(const TutorialManifest *manifest, uint64_t chunkNumber, const PARCBuffer *chunk)
+{
+    if (chunkNumber >= _getChunkCount(&manifest->metadata)) {
+        return false;
+    }
+
+    uint8_t digest[tutorialDigest_Sha256Length];
+    tutorialDigest_Sha256(parcBuffer_Overlay((PARCBuffer *) chunk, 0), parcBuffer_Remaining(chunk), digest);
+
+    return memcmp(digest, manifest->digests + chunkNumber * tutorialDigest_Sha256Length, tutorialDigest_Sha256Length) == 0;
+}
+
+PARCBuffer *
+tutorialManifest_CreateBuffer(const TutorialManifest *manifest)
+{
+    size_t digestsLength = (size_t) _getChunkCount(&manifest->metadata) * tutorialDigest_Sha256Length;
+
+    PARCBuffer *result = parcBuffer_Allocate(_headerLength + digestsLength);
+    uint8_t *bytes = parcBuffer_Overlay(result, 0);
+
+    bytes = _putUint32(bytes, _manifestMagic);
+    bytes = _putUint32(bytes, manifest->metadata.chunkSize);
+    bytes = _putUint64(bytes, manifest->metadata.fileSize);
+    bytes = _putUint64(bytes, manifest->metadata.finalChunkNumber);
+    bytes = _putUint64(bytes, (uint64_t) manifest->metadata.modificationTime);
+    memcpy(bytes, manifest->digests, digestsLength);
+
+    return result;
+}
+
+TutorialManifest *
+tutorialManifest_Parse(const PARCBuffer *buffer)
+{
+    size_t length = parcBuffer_Remaining(buffer);
+    if (length < _headerLength) {
+        return NULL;
+    }
+
+    const uint8_t *bytes = parcBuffer_Overlay((PARCBuffer *) buffer, 0);
+
+    uint32_t magic;
+    uint64_t modificationTime;
+    TutorialMetadata metadata;
+    memset(&metadata, 0, sizeof(metadata));
+
+    bytes = _getUint32(bytes, &magic);
+    bytes = _getUint32(bytes, &metadata.chunkSize);
+    bytes = _getUint64(bytes, &metadata.fileSize);
+    bytes = _getUint64(bytes, &metadata.finalChunkNumber);
+    bytes = _getUint64(bytes, &modificationTime);
+    metadata.modificationTime = (int64_t) modificationTime;
+
+    // The digests must cover exactly the chunks of a file of this size.
+    uint64_t expectedFinalChunkNumber = (metadata.chunkSize == 0 || metadata.fileSize == 0) ? 0 : (metadata.fileSize - 1) / metadata.chunkSize;
+    if (magic != _manifestMagic || metadata.chunkSize == 0 || metadata.finalChunkNumber != expectedFinalChunkNumber
+        || (length - _headerLength) / tutorialDigest_Sha256Length != _getChunkCount(&metadata)
+        || (length - _headerLength) % tutorialDigest_Sha256Length != 0) {
+        return NULL;
+    }
+
+    TutorialManifest *result = tutorialManifest_Create(&metadata);
+    memcpy(result->digests, bytes, length - _headerLength);
+
+    return result;
+}
@@ -0,0 +1,119 @@
+/*
+ * Copyright (c) 2014-2015, Xerox Corporation (Xerox)and Palo Alto Research Center (PARC)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Patent rights are not granted under this agreement. Patent rights are
+ *       available under FRAND terms.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL XEROX or PARC BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+/**
+ * @author Alan Walendowski, Palo Alto Research Center (Xerox PARC)
+ * @copyright 2014-2015, Xerox Corporation (Xerox)and Palo Alto Research Center (PARC).  All rights reserved.
+ */
+
+#ifndef tutorial_Manifest_h
+#define tutorial_Manifest_h
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <parc/algol/parc_Buffer.h>
+
+#include "tutorial_Metadata.h"
+
+/**
+ * A TutorialManifest lists the SHA-256 digest of every chunk of a file, as returned by the 'manifest' command.
+ * The manifest is sent in ContentObjects like any other content, so it is signed, and a client that has it
+ * can check each chunk of the file against its digest instead of relying on each chunk's own signature.
+ * It also tells the client every chunk of the file up front, so they can all be asked for at once.
+ *
+ * On the wire, a manifest is a fixed header giving the file's metadata, followed by the digests of chunks 0 to
+ * the final chunk, in order. The header's fields are in network byte order.
+ */
+typedef struct tutorial_manifest TutorialManifest;
+
+/**
+ * Create a manifest for a file with the specified metadata. The digests of its chunks are added by calling
+ * tutorialManifest_AddChunks(). The returned instance must eventually be released by calling tutorialManifest_Release().
+ *
+ * @param [in] metadata The metadata of the file.
+ *
+ * @return A new TutorialManifest instance.
+ */
+TutorialManifest *tutorialManifest_Create(const TutorialMetadata *metadata);
+
+/**
+ * Release the memory used by the specified TutorialManifest.
+ *
+ * @param [in,out] manifestP A pointer to the pointer to the TutorialManifest to release. It will be set to NULL.
+ */
+void tutorialManifest_Release(TutorialManifest **manifestP);
+
+/**
+ * Return the metadata of the file that the manifest describes.
+ *
+ * @param [in] manifest The TutorialManifest to inspect.
+ *
+ * @return A pointer to the file's metadata, valid until the manifest is released.
+ */
+const TutorialMetadata *tutorialManifest_GetMetadata(const TutorialManifest *manifest);
+
+/**
+ * Record the digests of a block of consecutive chunks of the file.
+ *
+ * @param [in] manifest The TutorialManifest to add to.
+ * @param [in] firstChunkNumber The number of the first chunk in the block.
+ * @param [in] block The chunks, between the buffer's position and limit. Every chunk but the file's final one
+ *             must be whole.
+ */
+void tutorialManifest_AddChunks(TutorialManifest *manifest, uint64_t firstChunkNumber, const PARCBuffer *block);
+
+/**
+ * Check a chunk of the file against its digest in the manifest.
+ *
+ * @param [in] manifest The TutorialManifest to check against.
+ * @param [in] chunkNumber The number of the chunk.
+ * @param [in] chunk The contents of the chunk, between the buffer's position and limit.
+ *
+ * @return true If the chunk belongs to the file and matches its digest.
+ */
+bool tutorialManifest_VerifyChunk(const TutorialManifest *manifest, uint64_t chunkNumber, const PARCBuffer *chunk);
+
+/**
+ * Create a PARCBuffer containing the wire form of the manifest. The returned buffer must eventually be
+ * released by calling parcBuffer_Release().
+ *
+ * @param [in] manifest The TutorialManifest to encode.
+ *
+ * @return A new PARCBuffer, ready to be read.
+ */
+PARCBuffer *tutorialManifest_CreateBuffer(const TutorialManifest *manifest);
+
+/**
+ * Parse the wire form of a manifest, from the buffer's position to its limit. The buffer's position is not changed.
+ * The returned instance must eventually be released by calling tutorialManifest_Release().
+ *
+ * @param [in] buffer A PARCBuffer containing a manifest created by tutorialManifest_CreateBuffer().
+ *
+ * @return A new TutorialManifest, or NULL if the buffer doesn't contain a well formed manifest.
+ */
+TutorialManifest *tutorialManifest_Parse(const PARCBuffer *buffer);
+#endif // tutorial_Manifest_h
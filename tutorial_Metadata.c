@@ -0,0 +1,122 @@
+/*
+ * Copyright (c) 2014-2015, Xerox Corporation (Xerox)and Palo Alto Research Center (PARC)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Patent rights are not granted under this agreement. Patent rights are
+ *       available under FRAND terms.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL XEROX or PARC BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+/**
+ * @author Alan Walendowski, Palo Alto Research Center (Xerox PARC)
+ * @copyright 2014-2015, Xerox Corporation (Xerox)and Palo Alto Research Center (PARC).  All rights reserved.
+ */
+#include <inttypes.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <LongBow/runtime.h>
+#include <parc/algol/parc_BufferComposer.h>
+
+#include "tutorial_Metadata.h"
+
+PARCBuffer *
+tutorialMetadata_CreateBuffer(const TutorialMetadata *metadata)
+{
+    PARCBufferComposer *composer = parcBufferComposer_Create();
+
+    parcBufferComposer_Format(composer, "fileSize=%" PRIu64 "\n", metadata->fileSize);
+    parcBufferComposer_Format(composer, "chunkSize=%" PRIu32 "\n", metadata->chunkSize);
+    parcBufferComposer_Format(composer, "finalChunkNumber=%" PRIu64 "\n", metadata->finalChunkNumber);
+    parcBufferComposer_Format(composer, "modificationTime=%" PRId64 "\n", metadata->modificationTime);
+    if (metadata->compression != TutorialCompressionCodec_None) {
+        parcBufferComposer_Format(composer, "compression=%d\n", (int) metadata->compression);
+    }
+
+    PARCBuffer *result = parcBufferComposer_ProduceBuffer(composer);
+    parcBufferComposer_Release(&composer);
+
+    return result;
+}
+
+/**
+ * Parse a decimal number that fills the whole of [value, value + length).
+ */
+static bool
+_parseNumber(const char *value, size_t length, uint64_t *result)
+{
+    char digits[24];
+
+    if (length == 0 || length >= sizeof(digits)) {
+        return false;
+    }
+    memcpy(digits, value, length);
+    digits[length] = '\0';
+
+    char *end;
+    *result = strtoull(digits, &end, 10);
+    return (*end == '\0');
+}
+
+bool
+tutorialMetadata_Parse(const PARCBuffer *buffer, TutorialMetadata *metadata)
+{
+    const char *text = parcBuffer_Overlay((PARCBuffer *) buffer, 0); // We're un-const'ing for parcBuffer_Overlay, but we do not change the buffer state.
+    size_t remaining = parcBuffer_Remaining(buffer);
+
+    memset(metadata, 0, sizeof(*metadata));
+    bool hasFileSize = false;
+    bool hasChunkSize = false;
+
+    while (remaining > 0) {
+        const char *endOfLine = memchr(text, '\n', remaining);
+        size_t lineLength = (endOfLine != NULL) ? (size_t) (endOfLine - text) : remaining;
+
+        const char *equals = memchr(text, '=', lineLength);
+        if (equals != NULL) {
+            size_t keyLength = equals - text;
+            const char *value = equals + 1;
+            size_t valueLength = lineLength - keyLength - 1;
+            uint64_t number;
+
+            if (_parseNumber(value, valueLength, &number)) {
+                if (keyLength == strlen("fileSize") && memcmp(text, "fileSize", keyLength) == 0) {
+                    metadata->fileSize = number;
+                    hasFileSize = true;
+                } else if (keyLength == strlen("chunkSize") && memcmp(text, "chunkSize", keyLength) == 0) {
+                    metadata->chunkSize = (uint32_t) number;
+                    hasChunkSize = (number > 0 && number <= UINT32_MAX);
+                } else if (keyLength == strlen("finalChunkNumber") && memcmp(text, "finalChunkNumber", keyLength) == 0) {
+                    metadata->finalChunkNumber = number;
+                } else if (keyLength == strlen("modificationTime") && memcmp(text, "modificationTime", keyLength) == 0) {
+                    metadata->modificationTime = (int64_t) number;
+                } else if (keyLength == strlen("compression") && memcmp(text, "compression", keyLength) == 0) {
+                    metadata->compression = (TutorialCompressionCodec) number;
+                }
+            }
+        }
+
+        size_t consumed = (endOfLine != NULL) ? lineLength + 1 : lineLength;
+        text += consumed;
+        remaining -= consumed;
+    }
+
+    return hasFileSize && hasChunkSize;
+}
@@ -0,0 +1,77 @@
+/*
+ * Copyright (c) 2014-2015, Xerox Corporation (Xerox)and Palo Alto Research Center (PARC)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Patent rights are not granted under this agreement. Patent rights are
+ *       available under FRAND terms.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL XEROX or PARC BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+/**
+ * @author Alan Walendowski, Palo Alto Research Center (Xerox PARC)
+ * @copyright 2014-2015, Xerox Corporation (Xerox)and Palo Alto Research Center (PARC).  All rights reserved.
+ */
+
+#ifndef tutorial_Metadata_h
+#define tutorial_Metadata_h
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <parc/algol/parc_Buffer.h>
+
+#include "tutorial_Compression.h"
+
+/**
+ * The metadata of a file served by tutorial_Server, as returned by the 'meta' command. It tells a client how
+ * the file has been chunked, so the client and server agree on the offset of every chunk.
+ *
+ * On the wire, metadata is plain text: one "key=value" line per field. Keys a reader doesn't recognize
+ * are ignored, so fields can be added without breaking older clients.
+ */
+typedef struct {
+    uint64_t fileSize;           // The size of the file, in bytes.
+    uint32_t chunkSize;          // The size of every chunk of the file except, possibly, the final one.
+    uint64_t finalChunkNumber;   // The number of the final chunk of the file.
+    int64_t modificationTime;    // The file's modification time, in seconds since the epoch.
+    TutorialCompressionCodec compression; // The codec the file's chunks can be fetched compressed with, if any.
+} TutorialMetadata;
+
+/**
+ * Create a PARCBuffer containing the text form of the specified metadata. The returned buffer must
+ * eventually be released by calling parcBuffer_Release().
+ *
+ * @param [in] metadata The metadata to encode.
+ *
+ * @return A new PARCBuffer, ready to be read.
+ */
+PARCBuffer *tutorialMetadata_CreateBuffer(const TutorialMetadata *metadata);
+
+/**
+ * Parse the text form of some metadata, from the buffer's position to its limit. The buffer's position is not changed.
+ *
+ * @param [in] buffer A PARCBuffer containing metadata created by tutorialMetadata_CreateBuffer().
+ * @param [out] metadata Filled in with the parsed metadata.
+ *
+ * @return true If the required fields (fileSize and chunkSize) were present and valid.
+ * @return false Otherwise.
+ */
+bool tutorialMetadata_Parse(const PARCBuffer *buffer, TutorialMetadata *metadata);
+#endif // tutorial_Metadata_h
@@ -0,0 +1,754 @@
+/*
+ * Copyright (c) 2014-2015, Xerox Corporation (Xerox)and Palo Alto Research Center (PARC)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Patent rights are not granted under this agreement. Patent rights are
+ *       available under FRAND terms.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL XEROX or PARC BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+/**
+ * @author Alan Walendowski, Palo Alto Research Center (Xerox PARC)
+ * @copyright 2014-2015, Xerox Corporation (Xerox)and Palo Alto Research Center (PARC).  All rights reserved.
+ */
+#include <dirent.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include <LongBow/runtime.h>
+#include <parc/algol/parc_Memory.h>
+
+#include <ccnx/common/ccnx_NameSegment.h>
+
+#include "tutorial_PathIndex.h"
+
+/**
+ * The number of slots in a directory node's hash table of children, once it has any. Always a power of 2.
+ */
+static const size_t _initialChildCapacity = 8;
+
+typedef struct tutorial_path_node _TutorialPathNode;
+
+struct tutorial_path_node {
+    char *path;                   // Relative to the directory being served, and null-terminated. "" for the directory itself.
+    size_t pathLength;
+    const char *name;             // The last segment of the path, pointing into it.
+    size_t nameLength;
+    uint32_t nameHash;
+
+    bool isDirectory;
+    uint64_t generation;          // The walk of the tree that last found it.
+    uint64_t fileSize;
+    int64_t modificationTime;
+
+    _TutorialPathNode **children; // An open-addressing hash table of the node's children, or NULL if it has none.
+    size_t childCapacity;         // The number of slots in `children`. Always a power of 2.
+    size_t childCount;
+};
+
+struct tutorial_path_index {
+    pthread_rwlock_t lock;        // Held for writing while nodes are added or changed.
+    pthread_mutex_t walkLock;     // Serializes walks and removals, so that nodes a walk is reading aren't released under it.
+    char *directoryPath;
+    char *realDirectoryPath;      // directoryPath with every symbolic link in it resolved, to check where links lead.
+    unsigned walkerCount;
+    uint64_t generation;          // The number of the latest walk.
+    _TutorialPathNode *root;
+};
+
+/**
+ * The directories waiting to be read during a walk of the tree, shared by the threads walking it.
+ */
+typedef struct {
+    TutorialPathIndex *index;
+    uint64_t generation;
+
+    pthread_mutex_t lock;
+    pthread_cond_t hasWork;
+    _TutorialPathNode **pending;  // The directories waiting to be read, as a stack.
+    size_t pendingCount;
+    size_t pendingCapacity;
+    size_t unfinishedCount;       // The directories waiting to be read, or being read. The walk is over when it is 0.
+} _TutorialPathWalk;
+
+/**
+ * Return a 32-bit FNV-1a hash of the specified bytes.
+ */
+static uint32_t
+_hashName(const char *name, size_t nameLength)
+{
+    uint32_t result = 2166136261u;
+
+    for (size_t i = 0; i < nameLength; i++) {
+        result ^= (uint8_t) name[i];
+        result *= 16777619u;
+    }
+
+    return result;
+}
+
+static _TutorialPathNode *
+_createNode(const _TutorialPathNode *parent, const char *name, size_t nameLength, bool isDirectory)
+{
+    _TutorialPathNode *result = parcMemory_AllocateAndClear(sizeof(_TutorialPathNode));
+    assertNotNull(result, "parcMemory_AllocateAndClear(%zu) returned NULL", sizeof(_TutorialPathNode));
+
+    // The root's children are named by their name alone, and everything below them by "<parent's path>/<name>".
+    size_t prefixLength = (parent != NULL && parent->pathLength > 0) ? parent->pathLength + 1 : 0;
+    result->pathLength = prefixLength + nameLength;
+    result->path = parcMemory_Allocate(result->pathLength + 1);
+    assertNotNull(result->path, "parcMemory_Allocate(%zu) returned NULL", result->pathLength + 1);
+
+    if (prefixLength > 0) {
+        memcpy(result->path, parent->path, parent->pathLength);
+        result->path[parent->pathLength] = '/';
+    }
+    memcpy(result->path + prefixLength, name, nameLength);
+    result->path[result->pathLength] = '\0';
+
+    result->name = result->path + prefixLength;
+    result->nameLength = nameLength;
+    result->nameHash = _hashName(name, nameLength);
+    result->isDirectory = isDirectory;
+
+    return result;
+}
+
+static void _releaseNode(_TutorialPathNode **nodeP);
+
+/**
+ * Release everything below a node, leaving it with no children.
+ */
+static void
+_releaseChildren(_TutorialPathNode *node)
+{
+    for (size_t i = 0; i < node->childCapacity; i++) {
+        if (node->children[i] != NULL) {
+            _releaseNode(&node->children[i]);
+        }
+    }
+    if (node->children != NULL) {
+        parcMemory_Deallocate((void **) &node->children);
+    }
+    node->childCapacity = 0;
+    node->childCount = 0;
+}
+
+static void
+_releaseNode(_TutorialPathNode **nodeP)
+{
+    _TutorialPathNode *node = *nodeP;
+
+    _releaseChildren(node);
+    parcMemory_Deallocate((void **) &node->path);
+    parcMemory_Deallocate((void **) nodeP);
+}
+
+static _TutorialPathNode *
+_findChild(const _TutorialPathNode *node, const char *name, size_t nameLength)
+{
+    if (node->children == NULL) {
+        return NULL;
+    }
+
+    uint32_t nameHash = _hashName(name, nameLength);
+    size_t mask = node->childCapacity - 1;
+
+    for (size_t i = nameHash & mask; node->children[i] != NULL; i = (i + 1) & mask) {
+        _TutorialPathNode *child = node->children[i];
+        if (child->nameHash == nameHash && child->nameLength == nameLength && memcmp(child->name, name, nameLength) == 0) {
+            return child;
+        }
+    }
+
+    return NULL;
+}
+
+static void
+_insertChild(_TutorialPathNode *node, _TutorialPathNode *child)
+{
+    size_t mask = node->childCapacity - 1;
+    size_t i = child->nameHash & mask;
+
+    while (node->children[i] != NULL) {
+        i = (i + 1) & mask;
+    }
+    node->children[i] = child;
+}
+
+/**
+ * Take a child out of a node's hash table, and release it and everything below it. The children that follow it
+ * in the same run of occupied slots are shifted back, so that every child can still be reached from the slot its
+ * hash selects. The index's lock must be held for writing.
+ */
+static void
+_removeChild(_TutorialPathNode *node, _TutorialPathNode *child)
+{
+    size_t mask = node->childCapacity - 1;
+    size_t hole = child->nameHash & mask;
+
+    while (node->children[hole] != child) {
+        hole = (hole + 1) & mask;
+    }
+    _releaseNode(&node->children[hole]);
+    node->childCount--;
+
+    for (size_t i = (hole + 1) & mask; node->children[i] != NULL; i = (i + 1) & mask) {
+        // A child can fill the hole unless the slot its hash selects lies after the hole, up to where it is now.
+        size_t home = node->children[i]->nameHash & mask;
+        bool isHomeAfterHole = (hole <= i) ? (hole < home && home <= i) : (hole < home || home <= i);
+        if (isHomeAfterHole == false) {
+            node->children[hole] = node->children[i];
+            node->children[i] = NULL;
+            hole = i;
+        }
+    }
+}
+
+/**
+ * Find the named child of a node, adding it if it isn't there. It is given the specified type, and if it was a
+ * directory that is now a file, everything that was below it is released.
+ * The index's lock must be held for writing.
+ */
+static _TutorialPathNode *
+_addChild(_TutorialPathNode *node, const char *name, size_t nameLength, bool isDirectory)
+{
+    _TutorialPathNode *result = _findChild(node, name, nameLength);
+
+    if (result == NULL) {
+        // Keep the table no more than 3/4 full, so probes stay short.
+        if ((node->childCount + 1) * 4 > node->childCapacity * 3) {
+            _TutorialPathNode **oldChildren = node->children;
+            size_t oldCapacity = node->childCapacity;
+
+            node->childCapacity = (oldCapacity == 0) ? _initialChildCapacity : oldCapacity * 2;
+            node->children = parcMemory_AllocateAndClear(node->childCapacity * sizeof(_TutorialPathNode *));
+            assertNotNull(node->children, "parcMemory_AllocateAndClear(%zu) returned NULL", node->childCapacity * sizeof(_TutorialPathNode *));
+
+            for (size_t i = 0; i < oldCapacity; i++) {
+                if (oldChildren[i] != NULL) {
+                    _insertChild(node, oldChildren[i]);
+                }
+            }
+            if (oldChildren != NULL) {
+                parcMemory_Deallocate((void **) &oldChildren);
+            }
+        }
+
+        result = _createNode(node, name, nameLength, isDirectory);
+        _insertChild(node, result);
+        node->childCount++;
+    } else if (result->isDirectory && isDirectory == false) {
+        _releaseChildren(result);
+    }
+    result->isDirectory = isDirectory;
+
+    return result;
+}
+
+/**
+ * Record that a walk of the tree, or an update, found a node's file or directory.
+ * The index's lock must be held for writing.
+ */
+static void
+_markFound(_TutorialPathNode *node, const struct stat *fileInfo, uint64_t generation)
+{
+    node->generation = generation;
+    if (node->isDirectory == false) {
+        node->fileSize = (uint64_t) fileInfo->st_size;
+        node->modificationTime = (int64_t) fileInfo->st_mtime;
+    }
+}
+
+/**
+ * Release everything below a node that the walk of the specified generation didn't find.
+ * The index's lock must be held for writing.
+ */
+static void
+_sweep(_TutorialPathNode *node, uint64_t generation)
+{
+    size_t staleCount = 0;
+
+    for (size_t i = 0; i < node->childCapacity; i++) {
+        _TutorialPathNode *child = node->children[i];
+        if (child == NULL) {
+            continue;
+        } else if (child->generation != generation) {
+            staleCount++;
+        } else {
+            _sweep(child, generation);
+        }
+    }
+
+    if (staleCount == 0) {
+        return;
+    }
+
+    // Rebuild the table with just the children that were found, rather than shifting children back after
+    // each removal, which could move one past the slots already looked at.
+    _TutorialPathNode **oldChildren = node->children;
+    node->children = parcMemory_AllocateAndClear(node->childCapacity * sizeof(_TutorialPathNode *));
+    assertNotNull(node->children, "parcMemory_AllocateAndClear(%zu) returned NULL", node->childCapacity * sizeof(_TutorialPathNode *));
+
+    for (size_t i = 0; i < node->childCapacity; i++) {
+        if (oldChildren[i] == NULL) {
+            continue;
+        } else if (oldChildren[i]->generation != generation) {
+            _releaseNode(&oldChildren[i]);
+        } else {
+            _insertChild(node, oldChildren[i]);
+        }
+    }
+    node->childCount -= staleCount;
+    parcMemory_Deallocate((void **) &oldChildren);
+}
+
+/**
+ * Determine whether a segment of a relative path is an actual name, rather than empty or one of "." and "..".
+ */
+static bool
+_isNameValid(const char *name, size_t nameLength)
+{
+    return nameLength > 0
+           && (nameLength != 1 || name[0] != '.')
+           && (nameLength != 2 || name[0] != '.' || name[1] != '.');
+}
+
+/**
+ * Find the node at a relative path. The index's lock must be held.
+ *
+ * @return The node, or NULL if the path isn't in the index.
+ */
+static _TutorialPathNode *
+_findNode(const TutorialPathIndex *index, const char *path)
+{
+    _TutorialPathNode *result = index->root;
+
+    for (const char *name = path; *name != '\0' && result != NULL; ) {
+        const char *end = name + strcspn(name, "/");
+        result = _findChild(result, name, end - name);
+        name = (*end == '/') ? end + 1 : end;
+    }
+
+    return result;
+}
+
+/**
+ * Determine whether the file at a full path, once every symbolic link on the way to it is resolved, is inside the
+ * directory being served. A link to a file elsewhere, such as one to /etc/passwd, would otherwise let anyone
+ * who can put a link in the tree serve that file.
+ */
+static bool
+_isRealPathInside(const TutorialPathIndex *index, const char *fullPath)
+{
+    char realPath[PATH_MAX];
+    if (realpath(fullPath, realPath) == NULL) {
+        return false;
+    }
+
+    size_t directoryLength = strlen(index->realDirectoryPath);
+    if (directoryLength == 1) {
+        return true; // The whole file system is being served.
+    }
+    return strncmp(realPath, index->realDirectoryPath, directoryLength) == 0 && realPath[directoryLength] == '/';
+}
+
+/**
+ * Determine whether a path relative to the directory being served stays within it, and only passes through
+ * directories that are served.
+ */
+static bool
+_isPathServed(const char *path, bool isDirectory)
+{
+    for (const char *name = path; ; ) {
+        const char *end = name + strcspn(name, "/");
+        if (_isNameValid(name, end - name) == false) {
+            return false;
+        }
+
+        char directoryName[end - name + 1];
+        memcpy(directoryName, name, end - name);
+        directoryName[end - name] = '\0';
+
+        bool isLastName = (*end == '\0');
+        if ((isLastName == false || isDirectory) && tutorialPathIndex_IsDirectoryServed(directoryName) == false) {
+            return false;
+        }
+        if (isLastName) {
+            return true;
+        }
+        name = end + 1;
+    }
+}
+
+/**
+ * Add the nodes leading to a path that is served, and the node of the path itself.
+ * The index's lock must be held for writing.
+ */
+static _TutorialPathNode *
+_addPath(TutorialPathIndex *index, const char *path, bool isDirectory)
+{
+    _TutorialPathNode *result = index->root;
+
+    for (const char *name = path; ; ) {
+        const char *end = name + strcspn(name, "/");
+        bool isLastName = (*end == '\0');
+
+        result = _addChild(result, name, end - name, isLastName ? isDirectory : true);
+        if (isLastName) {
+            return result;
+        }
+        name = end + 1;
+    }
+}
+
+/**
+ * Add a directory found during a walk to the directories waiting to be read.
+ */
+static void
+_pushDirectory(_TutorialPathWalk *walk, _TutorialPathNode *directory)
+{
+    pthread_mutex_lock(&walk->lock);
+
+    if (walk->pendingCount == walk->pendingCapacity) {
+        walk->pendingCapacity = (walk->pendingCapacity == 0) ? 64 : walk->pendingCapacity * 2;
+        walk->pending = parcMemory_Reallocate(walk->pending, walk->pendingCapacity * sizeof(_TutorialPathNode *));
+        assertNotNull(walk->pending, "parcMemory_Reallocate(%zu) returned NULL", walk->pendingCapacity * sizeof(_TutorialPathNode *));
+    }
+    walk->pending[walk->pendingCount++] = directory;
+    walk->unfinishedCount++;
+
+    pthread_cond_signal(&walk->hasWork);
+    pthread_mutex_unlock(&walk->lock);
+}
+
+/**
+ * Read a directory during a walk: add each readable regular file and served directory in it to the index, and
+ * each directory to the directories waiting to be read. The files are stat()ed outside of the index's lock,
+ * which is only held to add each one, so several directories can be read at once.
+ */
+static void
+_readDirectory(_TutorialPathWalk *walk, _TutorialPathNode *directory)
+{
+    TutorialPathIndex *index = walk->index;
+
+    char directoryPath[strlen(index->directoryPath) + directory->pathLength + 2]; // +2 for '/' and trailing null.
+    snprintf(directoryPath, sizeof(directoryPath), "%s/%s", index->directoryPath, directory->path);
+
+    DIR *stream = opendir(directoryPath);
+    if (stream == NULL) {
+        return; // It was removed or made unreadable since it was found. The sweep will release what was below it.
+    }
+    int directoryDescriptor = dirfd(stream);
+
+    struct dirent *entry;
+    while ((entry = readdir(stream)) != NULL) {
+        struct stat fileInfo;
+        if (_isNameValid(entry->d_name, strlen(entry->d_name)) == false
+            || fstatat(directoryDescriptor, entry->d_name, &fileInfo, AT_SYMLINK_NOFOLLOW) != 0) {
+            continue;
+        }
+
+        // Follow a symbolic link to see whether it leads to a regular file inside the tree. One to a directory
+        // isn't followed, as it could lead out of the tree, or around in a circle.
+        bool isDirectory = S_ISDIR(fileInfo.st_mode) && tutorialPathIndex_IsDirectoryServed(entry->d_name);
+        if (S_ISLNK(fileInfo.st_mode)) {
+            char linkPath[sizeof(directoryPath) + strlen(entry->d_name) + 1]; // +1 for '/'.
+            snprintf(linkPath, sizeof(linkPath), "%s/%s", directoryPath, entry->d_name);
+            if (fstatat(directoryDescriptor, entry->d_name, &fileInfo, 0) != 0 || _isRealPathInside(index, linkPath) == false) {
+                continue;
+            }
+        }
+        bool isFile = S_ISREG(fileInfo.st_mode) && faccessat(directoryDescriptor, entry->d_name, R_OK, 0) == 0;
+
+        if (isFile || isDirectory) {
+            pthread_rwlock_wrlock(&index->lock);
+            _TutorialPathNode *child = _addChild(directory, entry->d_name, strlen(entry->d_name), isDirectory);
+            _markFound(child, &fileInfo, walk->generation);
+            pthread_rwlock_unlock(&index->lock);
+
+            if (isDirectory) {
+                _pushDirectory(walk, child);
+            }
+        }
+    }
+
+    closedir(stream);
+}
+
+/**
+ * Read directories waiting to be read until the walk is over. Every thread walking the tree runs this.
+ */
+static void *
+_walkDirectories(void *walkArg)
+{
+    _TutorialPathWalk *walk = walkArg;
+
+    pthread_mutex_lock(&walk->lock);
+    while (walk->unfinishedCount > 0) {
+        if (walk->pendingCount == 0) {
+            pthread_cond_wait(&walk->hasWork, &walk->lock); // Another thread is reading a directory that may hold more.
+            continue;
+        }
+
+        _TutorialPathNode *directory = walk->pending[--walk->pendingCount];
+        pthread_mutex_unlock(&walk->lock);
+
+        _readDirectory(walk, directory);
+
+        pthread_mutex_lock(&walk->lock);
+        if (--walk->unfinishedCount == 0) {
+            pthread_cond_broadcast(&walk->hasWork); // Wake the idle threads, so they see the walk is over.
+        }
+    }
+    pthread_mutex_unlock(&walk->lock);
+
+    return NULL;
+}
+
+/**
+ * Walk the tree below a directory with the specified number of threads, the calling thread among them, and then
+ * release everything below it that the walk didn't find. The index's walkLock must be held.
+ */
+static void
+_walk(TutorialPathIndex *index, _TutorialPathNode *directory, unsigned walkerCount)
+{
+    _TutorialPathWalk walk = { .index = index };
+    pthread_mutex_init(&walk.lock, NULL);
+    pthread_cond_init(&walk.hasWork, NULL);
+
+    pthread_rwlock_wrlock(&index->lock);
+    walk.generation = ++index->generation;
+    directory->generation = walk.generation;
+    pthread_rwlock_unlock(&index->lock);
+
+    _pushDirectory(&walk, directory);
+
+    pthread_t walkers[walkerCount];
+    for (unsigned i = 1; i < walkerCount; i++) {
+        int failure = pthread_create(&walkers[i], NULL, _walkDirectories, &walk);
+        assertTrue(failure == 0, "pthread_create() failed: %s", strerror(failure));
+    }
+    _walkDirectories(&walk);
+    for (unsigned i = 1; i < walkerCount; i++) {
+        pthread_join(walkers[i], NULL);
+    }
+
+    pthread_rwlock_wrlock(&index->lock);
+    _sweep(directory, walk.generation);
+    pthread_rwlock_unlock(&index->lock);
+
+    if (walk.pending != NULL) {
+        parcMemory_Deallocate((void **) &walk.pending);
+    }
+    pthread_cond_destroy(&walk.hasWork);
+    pthread_mutex_destroy(&walk.lock);
+}
+
+static size_t
+_visitNode(const _TutorialPathNode *node, TutorialPathIndexVisitor *visitor, void *context)
+{
+    size_t result = 0;
+
+    if (node->isDirectory == false) {
+        TutorialListingEntry entry = {
+            .fileName         = node->path,
+            .fileNameLength   = node->pathLength,
+            .fileSize         = node->fileSize,
+            .modificationTime = node->modificationTime
+        };
+        visitor(context, &entry);
+        return 1;
+    }
+
+    for (size_t i = 0; i < node->childCapacity; i++) {
+        if (node->children[i] != NULL) {
+            result += _visitNode(node->children[i], visitor, context);
+        }
+    }
+
+    return result;
+}
+
+TutorialPathIndex *
+tutorialPathIndex_Create(const char *directoryPath, unsigned walkerCount)
+{
+    assertTrue(walkerCount > 0, "A path index must be walked with at least one thread");
+
+    struct stat directoryInfo;
+    assertTrue(stat(directoryPath, &directoryInfo) == 0 && S_ISDIR(directoryInfo.st_mode),
+               "Couldn't open directory '%s' for reading.", directoryPath);
+
+    TutorialPathIndex *result = parcMemory_AllocateAndClear(sizeof(TutorialPathIndex));
+    assertNotNull(result, "parcMemory_AllocateAndClear(%zu) returned NULL", sizeof(TutorialPathIndex));
+
+    result->directoryPath = parcMemory_StringDuplicate(directoryPath, strlen(directoryPath));
+
+    char realDirectoryPath[PATH_MAX];
+    assertNotNull(realpath(directoryPath, realDirectoryPath), "Couldn't resolve the path of directory '%s'.", directoryPath);
+    result->realDirectoryPath = parcMemory_StringDuplicate(realDirectoryPath, strlen(realDirectoryPath));
+    result->walkerCount = walkerCount;
+    pthread_rwlock_init(&result->lock, NULL);
+    pthread_mutex_init(&result->walkLock, NULL);
+
+    result->root = _createNode(NULL, "", 0, true);
+
+    pthread_mutex_lock(&result->walkLock);
+    _walk(result, result->root, result->walkerCount);
+    pthread_mutex_unlock(&result->walkLock);
+
+    return result;
+}
+
+void
+tutorialPathIndex_Release(TutorialPathIndex **indexP)
+{
+    TutorialPathIndex *index = *indexP;
+
+    _releaseNode(&index->root);
+
+    pthread_mutex_destroy(&index->walkLock);
+    pthread_rwlock_destroy(&index->lock);
+    parcMemory_Deallocate((void **) &index->directoryPath);
+    parcMemory_Deallocate((void **) &index->realDirectoryPath);
+    parcMemory_Deallocate((void **) indexP);
+}
+
+bool
+tutorialPathIndex_IsDirectoryServed(const char *directoryName)
+{
+    // This also rules out "." and "..".
+    return directoryName[0] != '.';
+}
+
+bool
+tutorialPathIndex_ResolveName(TutorialPathIndex *index, const CCNxName *name, size_t firstSegment, size_t segmentCount,
+                              char *filePath, size_t filePathSize, size_t *filePathLength)
+{
+    bool result = false;
+
+    pthread_rwlock_rdlock(&index->lock);
+
+    const _TutorialPathNode *node = index->root;
+    for (size_t i = 0; i < segmentCount && node != NULL; i++) {
+        CCNxNameSegment *segment = ccnxName_GetSegment(name, firstSegment + i);
+        if (node->isDirectory == false || ccnxNameSegment_GetType(segment) != CCNxNameLabelType_NAME) {
+            node = NULL;
+        } else {
+            PARCBuffer *value = ccnxNameSegment_GetValue(segment);
+            node = _findChild(node, parcBuffer_Overlay(value, 0), parcBuffer_Remaining(value)); // Overlaying 0 bytes doesn't move the buffer's position.
+        }
+    }
+
+    if (segmentCount > 0 && node != NULL && node->isDirectory == false && node->pathLength < filePathSize) {
+        // The node may be released as soon as the lock is dropped, so the caller gets a copy of its path.
+        memcpy(filePath, node->path, node->pathLength + 1);
+        *filePathLength = node->pathLength;
+        result = true;
+    }
+
+    pthread_rwlock_unlock(&index->lock);
+
+    return result;
+}
+
+void
+tutorialPathIndex_UpdatePath(TutorialPathIndex *index, const char *path)
+{
+    char fullPath[strlen(index->directoryPath) + strlen(path) + 2]; // +2 for '/' and trailing null.
+    snprintf(fullPath, sizeof(fullPath), "%s/%s", index->directoryPath, path);
+
+    struct stat fileInfo;
+    struct stat linkInfo;
+    bool isFound = (stat(fullPath, &fileInfo) == 0 && lstat(fullPath, &linkInfo) == 0);
+    bool isFile = isFound && S_ISREG(fileInfo.st_mode) && access(fullPath, R_OK) == 0
+                  && (S_ISLNK(linkInfo.st_mode) == false || _isRealPathInside(index, fullPath));
+    bool isDirectory = isFound && S_ISDIR(fileInfo.st_mode) && S_ISDIR(linkInfo.st_mode);
+
+    if ((isFile == false && isDirectory == false) || _isPathServed(path, isDirectory) == false) {
+        tutorialPathIndex_RemovePath(index, path);
+        return;
+    }
+
+    pthread_mutex_lock(&index->walkLock);
+
+    pthread_rwlock_wrlock(&index->lock);
+    _TutorialPathNode *node = _addPath(index, path, isDirectory);
+    _markFound(node, &fileInfo, index->generation);
+    pthread_rwlock_unlock(&index->lock);
+
+    // A change is walked on the calling thread. Starting walker threads is only worth it for a whole tree.
+    if (isDirectory) {
+        _walk(index, node, 1);
+    }
+
+    pthread_mutex_unlock(&index->walkLock);
+}
+
+bool
+tutorialPathIndex_RemovePath(TutorialPathIndex *index, const char *path)
+{
+    pthread_mutex_lock(&index->walkLock);
+    pthread_rwlock_wrlock(&index->lock);
+
+    _TutorialPathNode *node = _findNode(index, path);
+    bool result = (node != NULL && node->isDirectory);
+    if (node != NULL && node != index->root) {
+        // Find the node's parent, which is the node at its path without the last name.
+        char parentPath[node->pathLength - node->nameLength + 1];
+        size_t parentPathLength = (node->pathLength > node->nameLength) ? node->pathLength - node->nameLength - 1 : 0;
+        memcpy(parentPath, node->path, parentPathLength);
+        parentPath[parentPathLength] = '\0';
+
+        _removeChild(_findNode(index, parentPath), node);
+    }
+
+    pthread_rwlock_unlock(&index->lock);
+    pthread_mutex_unlock(&index->walkLock);
+
+    return result;
+}
+
+void
+tutorialPathIndex_Rescan(TutorialPathIndex *index)
+{
+    pthread_mutex_lock(&index->walkLock);
+    _walk(index, index->root, index->walkerCount);
+    pthread_mutex_unlock(&index->walkLock);
+}
+
+size_t
+tutorialPathIndex_VisitFiles(TutorialPathIndex *index, const char *path, TutorialPathIndexVisitor *visitor, void *context)
+{
+    pthread_rwlock_rdlock(&index->lock);
+
+    const _TutorialPathNode *node = _findNode(index, path);
+    size_t result = (node != NULL) ? _visitNode(node, visitor, context) : 0;
+
+    pthread_rwlock_unlock(&index->lock);
+
+    return result;
+}
@@ -0,0 +1,159 @@
+/*
+ * Copyright (c) 2014-2015, Xerox Corporation (Xerox)and Palo Alto Research Center (PARC)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Patent rights are not granted under this agreement. Patent rights are
+ *       available under FRAND terms.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL XEROX or PARC BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+/**
+ * @author Alan Walendowski, Palo Alto Research Center (Xerox PARC)
+ * @copyright 2014-2015, Xerox Corporation (Xerox)and Palo Alto Research Center (PARC).  All rights reserved.
+ */
+
+#ifndef tutorial_PathIndex_h
+#define tutorial_PathIndex_h
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include <ccnx/common/ccnx_Name.h>
+
+#include "tutorial_ListingChunk.h"
+
+/**
+ * A TutorialPathIndex maps the names of the files being served, which may be in subdirectories of the directory
+ * being served, to their paths. A file at "<directory>/logs/2015/app.log" is named by the segments
+ * ".../fetch/logs/2015/app.log", and its path relative to the directory is "logs/2015/app.log".
+ *
+ * The index is a trie of the served tree, with one node per file or directory. Each node finds its children
+ * with a hash table keyed by their names, so resolving a name costs one hash lookup per segment of the name,
+ * however many files and directories are being served. A node holds its whole relative path, so resolving
+ * a name also yields the file's path without building it.
+ *
+ * The index is built by walking the tree with several threads at once, one directory each, and is then kept
+ * up to date one path at a time, on the calling thread, as changes are reported by a TutorialDirectoryWatcher. Only the readable
+ * regular files and directories found by walking the tree can be resolved, so a name with a ".." or "."
+ * segment, an empty segment, or a segment containing a '/', can never reach a file outside of it. Directories
+ * whose names start with '.', such as the published store's, aren't served, and symbolic links to directories
+ * aren't followed. Symbolic links to regular files are served only if the file they lead to is inside the tree.
+ *
+ * The node of a file or directory that is gone is released, along with everything below it, so the index only
+ * grows with the tree. That is why tutorialPathIndex_ResolveName() copies the path it finds.
+ *
+ * A TutorialPathIndex may be used by several threads at once.
+ */
+typedef struct tutorial_path_index TutorialPathIndex;
+
+/**
+ * The signature of the function called with each file by tutorialPathIndex_VisitFiles().
+ *
+ * @param [in] context The context pointer given to tutorialPathIndex_VisitFiles().
+ * @param [in] entry The file's path relative to the directory, which is null-terminated, its size and its
+ *                   modification time. It is only valid for the duration of the call.
+ */
+typedef void (TutorialPathIndexVisitor)(void *context, const TutorialListingEntry *entry);
+
+/**
+ * Walk the specified directory, and everything below it, and index every file in it. The returned instance must
+ * eventually be released by calling tutorialPathIndex_Release().
+ *
+ * @param [in] directoryPath A pointer to a string containing the path of the directory being served.
+ * @param [in] walkerCount The number of threads to walk the tree with, including the calling thread. Must be greater than 0.
+ *
+ * @return A new TutorialPathIndex instance.
+ */
+TutorialPathIndex *tutorialPathIndex_Create(const char *directoryPath, unsigned walkerCount);
+
+/**
+ * Release the memory used by the specified TutorialPathIndex.
+ *
+ * @param [in,out] indexP A pointer to the pointer to the TutorialPathIndex to release. It will be set to NULL.
+ */
+void tutorialPathIndex_Release(TutorialPathIndex **indexP);
+
+/**
+ * Determine whether a directory of the specified name is served, and so whether the tree is walked into it.
+ *
+ * @param [in] directoryName The name of the directory, without the path of its parent.
+ *
+ * @return true If the directory's files are served.
+ */
+bool tutorialPathIndex_IsDirectoryServed(const char *directoryName);
+
+/**
+ * Find the file named by consecutive segments of a CCNxName, such as those following the command of an Interest's name.
+ *
+ * @param [in] index The TutorialPathIndex to search.
+ * @param [in] name The CCNxName naming the file.
+ * @param [in] firstSegment The index of the first segment of the file's name within `name`.
+ * @param [in] segmentCount The number of segments in the file's name.
+ * @param [out] filePath A buffer the file's path, relative to the directory, is copied into, null-terminated.
+ * @param [in] filePathSize The size of `filePath`, in bytes.
+ * @param [out] filePathLength Set to the length of the file's path, in bytes.
+ *
+ * @return true If the segments name a readable regular file in the tree, and its path fits in `filePath`.
+ * @return false If they don't, including if any segment would leave the tree.
+ */
+bool tutorialPathIndex_ResolveName(TutorialPathIndex *index, const CCNxName *name, size_t firstSegment, size_t segmentCount,
+                                   char *filePath, size_t filePathSize, size_t *filePathLength);
+
+/**
+ * Bring the index up to date with a file or directory that has been created, modified, or renamed into the
+ * tree. A directory is walked, and everything below it is indexed. If the path no longer leads to a readable
+ * regular file or a directory, it is removed from the index.
+ *
+ * @param [in] index The TutorialPathIndex to update.
+ * @param [in] path The path of the file or directory, relative to the directory being served.
+ */
+void tutorialPathIndex_UpdatePath(TutorialPathIndex *index, const char *path);
+
+/**
+ * Remove a file or directory, and everything below it, from the index.
+ *
+ * @param [in] index The TutorialPathIndex to update.
+ * @param [in] path The path of the file or directory, relative to the directory being served.
+ *
+ * @return true If the path was a directory in the index.
+ */
+bool tutorialPathIndex_RemovePath(TutorialPathIndex *index, const char *path);
+
+/**
+ * Walk the whole tree again, because changes to it may have been missed. Files that are no longer there are
+ * removed from the index, and names that are still there continue to resolve while it is walked.
+ *
+ * @param [in] index The TutorialPathIndex to rebuild.
+ */
+void tutorialPathIndex_Rescan(TutorialPathIndex *index);
+
+/**
+ * Call a function with each file in the index at or below the specified path, in no particular order. The
+ * index can't be changed while this runs, so `visitor` mustn't change it.
+ *
+ * @param [in] index The TutorialPathIndex to visit.
+ * @param [in] path The path of a file or directory relative to the directory being served, or "" for every file.
+ * @param [in] visitor The function to call with each file.
+ * @param [in] context A pointer passed on to `visitor`.
+ *
+ * @return The number of files visited.
+ */
+size_t tutorialPathIndex_VisitFiles(TutorialPathIndex *index, const char *path, TutorialPathIndexVisitor *visitor, void *context);
+#endif // tutorial_PathIndex_h
@@ -0,0 +1,512 @@
+/*
+ * Copyright (c) 2014-2015, Xerox Corporation (Xerox)and Palo Alto Research Center (PARC)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Patent rights are not granted under this agreement. Patent rights are
+ *       available under FRAND terms.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL XEROX or PARC BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+/**
+ * @author Alan Walendowski, Palo Alto Research Center (Xerox PARC)
+ * @copyright 2014-2015, Xerox Corporation (Xerox)and Palo Alto Research Center (PARC).  All rights reserved.
+ */
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <LongBow/runtime.h>
+#include <parc/algol/parc_Memory.h>
+
+#include "tutorial_PublishedStore.h"
+#include "tutorial_FileIO.h"
+
+const char *tutorialPublishedStore_DirectoryName = ".tutorial_published";
+
+/**
+ * The number of sidecars kept open at once.
+ */
+static const size_t _openSidecarCapacity = 64;
+
+/**
+ * How long to wait before looking on disk again for the sidecar of a file that wasn't published, or whose
+ * sidecar was out of date. This keeps requests for unpublished files from costing an open() each.
+ */
+static const time_t _sidecarRecheckSeconds = 1;
+
+/**
+ * Identifies a sidecar file, and the version of its layout. Version 2 names its chunks with their chunk size,
+ * version 3 records the key they were signed with, and version 4 records the version of the file to the
+ * nanosecond, so sidecars of earlier versions are ignored.
+ */
+static const uint32_t _sidecarMagic = 0x34535054; // "TPS4"
+
+/**
+ * The largest key id a sidecar can record. Key ids are SHA-256 digests of the public key.
+ */
+#define _signerKeyIdCapacity 32
+
+/**
+ * The start of a sidecar file. It is followed by an index of chunkCount + 1 offsets, where chunk N's encoded
+ * ContentObject occupies the bytes from offset N up to offset N + 1, and then by the encoded ContentObjects.
+ * Sidecars are only read by the machine that wrote them, so everything is in host byte order.
+ */
+typedef struct {
+    uint32_t magic;
+    uint32_t chunkSize;
+    uint64_t chunkCount;
+    TutorialFileVersion fileVersion; // Of the file the chunks were published from.
+    uint32_t signerKeyIdLength;     // Of the key the chunks were signed with.
+    uint8_t signerKeyId[_signerKeyIdCapacity];
+} _TutorialPublishedHeader;
+
+/**
+ * An open sidecar, shared between the store and the threads reading from it. It is closed when the last
+ * reference is released, so a sidecar that is replaced while another thread is reading it stays open until
+ * that read is finished.
+ */
+typedef struct {
+    int fileDescriptor;
+    unsigned referenceCount;
+    _TutorialPublishedHeader header;
+} _TutorialPublishedSidecar;
+
+typedef struct {
+    char *fileName;                     // NULL if this entry is unused. Null-terminated, although lookups compare it by length.
+    size_t fileNameLength;
+    uint32_t nameHash;                  // Compared before fileName, to avoid most memcmp() calls.
+    _TutorialPublishedSidecar *sidecar; // NULL if the file had no sidecar when we last looked.
+    time_t lastOpened;                  // When we last looked for the sidecar on disk.
+    uint64_t lastUsed;                  // Value of the store's useClock when this entry was last used.
+} _TutorialPublishedStoreEntry;
+
+struct tutorial_published_store {
+    pthread_mutex_t lock; // Held while using the entries, but not while reading a sidecar.
+
+    char *sidecarDirectoryPath;
+
+    uint32_t signerKeyIdLength;
+    uint8_t signerKeyId[_signerKeyIdCapacity];
+
+    _TutorialPublishedStoreEntry *entries;
+    uint64_t useClock;
+};
+
+/**
+ * Return a 32-bit FNV-1a hash of the specified bytes.
+ */
+static uint32_t
+_hashFileName(const char *fileName, size_t fileNameLength)
+{
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < fileNameLength; i++) {
+        hash ^= (uint8_t) fileName[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+/**
+ * Read exactly `length` bytes from the specified offset of a file.
+ *
+ * @return true if all of the bytes were read.
+ */
+static bool
+_readExactly(int fileDescriptor, void *bytes, size_t length, off_t offset)
+{
+    size_t totalNumberOfBytesRead = 0;
+
+    while (totalNumberOfBytesRead < length) {
+        ssize_t numberOfBytesRead = pread(fileDescriptor, (uint8_t *) bytes + totalNumberOfBytesRead,
+                                          length - totalNumberOfBytesRead, offset + (off_t) totalNumberOfBytesRead);
+        if (numberOfBytesRead > 0) {
+            totalNumberOfBytesRead += numberOfBytesRead;
+        } else if (numberOfBytesRead == 0 || errno != EINTR) {
+            return false; // The sidecar is truncated, or couldn't be read.
+        }
+    }
+
+    return true;
+}
+
+/**
+ * Write all `length` bytes to the specified offset of a file.
+ *
+ * @return true if all of the bytes were written.
+ */
+static bool
+_writeFully(int fileDescriptor, const void *bytes, size_t length, off_t offset)
+{
+    size_t totalNumberOfBytesWritten = 0;
+
+    while (totalNumberOfBytesWritten < length) {
+        ssize_t numberOfBytesWritten = pwrite(fileDescriptor, (const uint8_t *) bytes + totalNumberOfBytesWritten,
+                                              length - totalNumberOfBytesWritten, offset + (off_t) totalNumberOfBytesWritten);
+        if (numberOfBytesWritten > 0) {
+            totalNumberOfBytesWritten += numberOfBytesWritten;
+        } else if (numberOfBytesWritten == 0 || errno != EINTR) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * Write the path of a file's sidecar, with an optional suffix, into the caller's buffer.
+ *
+ * @return true If the path fit in the buffer.
+ */
+static bool
+_formatSidecarPath(const TutorialPublishedStore *store, const char *fileName, size_t fileNameLength, const char *suffix,
+                   char *sidecarPath, size_t sidecarPathSize)
+{
+    if (fileNameLength > INT_MAX) {
+        return false;
+    }
+    int length = snprintf(sidecarPath, sidecarPathSize, "%s/%.*s%s", store->sidecarDirectoryPath,
+                          (int) fileNameLength, fileName, suffix);
+
+    return length > 0 && (size_t) length < sidecarPathSize;
+}
+
+/**
+ * Open the sidecar at the specified path and read its header.
+ *
+ * @return A new _TutorialPublishedSidecar with one reference, or NULL if there is no valid sidecar at the path.
+ */
+static _TutorialPublishedSidecar *
+_openSidecar(const char *sidecarPath)
+{
+    _TutorialPublishedSidecar *result = NULL;
+
+    int fileDescriptor = open(sidecarPath, O_RDONLY);
+    if (fileDescriptor >= 0) {
+        _TutorialPublishedHeader header;
+        if (_readExactly(fileDescriptor, &header, sizeof(header), 0) && header.magic == _sidecarMagic) {
+            result = parcMemory_Allocate(sizeof(_TutorialPublishedSidecar));
+            assertNotNull(result, "parcMemory_Allocate(%zu) returned NULL", sizeof(_TutorialPublishedSidecar));
+            result->fileDescriptor = fileDescriptor;
+            result->referenceCount = 1;
+            result->header = header;
+        } else {
+            close(fileDescriptor);
+        }
+    }
+
+    return result;
+}
+
+/**
+ * Release a reference to a sidecar, closing it if it was the last one. Must be called with the store's lock held.
+ */
+static void
+_releaseSidecar(_TutorialPublishedSidecar **sidecarP)
+{
+    _TutorialPublishedSidecar *sidecar = *sidecarP;
+
+    if (sidecar != NULL && --sidecar->referenceCount == 0) {
+        close(sidecar->fileDescriptor);
+        parcMemory_Deallocate((void **) &sidecar);
+    }
+    *sidecarP = NULL;
+}
+
+/**
+ * Return true if the sidecar was published from the file as it is now, with the chunk size it is served with now,
+ * and signed with the key the server signs with now. A sidecar signed with a key that has since been replaced
+ * would send chunks that clients can't verify against the server's current key.
+ */
+static bool
+_isSidecarValid(const TutorialPublishedStore *store, const _TutorialPublishedSidecar *sidecar,
+                const struct stat *fileInfo, uint32_t chunkSize)
+{
+    return sidecar != NULL
+           && sidecar->header.signerKeyIdLength == store->signerKeyIdLength
+           && memcmp(sidecar->header.signerKeyId, store->signerKeyId, store->signerKeyIdLength) == 0
+           && sidecar->header.chunkSize == chunkSize
+           && tutorialFileIO_IsFileVersion(&sidecar->header.fileVersion, fileInfo);
+}
+
+/**
+ * Close the sidecar held by the specified entry and mark the entry as unused.
+ */
+static void
+_closeEntry(_TutorialPublishedStoreEntry *entry)
+{
+    if (entry->fileName != NULL) {
+        _releaseSidecar(&entry->sidecar);
+        parcMemory_Deallocate((void **) &entry->fileName);
+    }
+}
+
+/**
+ * Find the entry for the specified file.
+ *
+ * @return A pointer to the entry, or NULL if the file has no entry. If there is no entry, `leastRecentlyUsedP`
+ *         (if not NULL) is set to the entry that should be replaced to make one.
+ */
+static _TutorialPublishedStoreEntry *
+_findEntry(TutorialPublishedStore *store, const char *fileName, size_t fileNameLength, uint32_t nameHash,
+           _TutorialPublishedStoreEntry **leastRecentlyUsedP)
+{
+    _TutorialPublishedStoreEntry *leastRecentlyUsed = &store->entries[0];
+
+    // The store only keeps a few sidecars open, so a linear scan is cheaper than the system calls it saves us.
+    for (size_t i = 0; i < _openSidecarCapacity; i++) {
+        _TutorialPublishedStoreEntry *entry = &store->entries[i];
+
+        if (entry->fileName == NULL) {
+            leastRecentlyUsed = entry; // An unused entry is always the best one to replace.
+        } else if (entry->nameHash == nameHash && entry->fileNameLength == fileNameLength
+                   && memcmp(entry->fileName, fileName, fileNameLength) == 0) {
+            return entry;
+        } else if (leastRecentlyUsed->fileName != NULL && entry->lastUsed < leastRecentlyUsed->lastUsed) {
+            leastRecentlyUsed = entry;
+        }
+    }
+
+    if (leastRecentlyUsedP != NULL) {
+        *leastRecentlyUsedP = leastRecentlyUsed;
+    }
+    return NULL;
+}
+
+/**
+ * Find the sidecar of the specified file, and take a reference to it if it is valid for the file as it is now.
+ * A file that has no valid sidecar is looked for on disk again at most once every _sidecarRecheckSeconds, so
+ * a file published while the server is running is picked up without looking for it on every request.
+ *
+ * @return The sidecar, which must be released by calling _releaseSidecar(), or NULL if there is no valid one.
+ */
+static _TutorialPublishedSidecar *
+_acquireSidecar(TutorialPublishedStore *store, const char *fileName, size_t fileNameLength,
+                const struct stat *fileInfo, uint32_t chunkSize)
+{
+    uint32_t nameHash = _hashFileName(fileName, fileNameLength);
+
+    _TutorialPublishedStoreEntry *leastRecentlyUsed = NULL;
+    _TutorialPublishedStoreEntry *entry = _findEntry(store, fileName, fileNameLength, nameHash, &leastRecentlyUsed);
+
+    time_t now = time(NULL);
+
+    if (entry == NULL) {
+        entry = leastRecentlyUsed;
+        _closeEntry(entry);
+
+        entry->fileName = parcMemory_Allocate(fileNameLength + 1);
+        assertNotNull(entry->fileName, "parcMemory_Allocate(%zu) returned NULL", fileNameLength + 1);
+        memcpy(entry->fileName, fileName, fileNameLength);
+        entry->fileName[fileNameLength] = '\0';
+        entry->fileNameLength = fileNameLength;
+        entry->nameHash = nameHash;
+        entry->lastOpened = now - _sidecarRecheckSeconds; // Look for it straight away.
+    }
+
+    entry->lastUsed = ++store->useClock;
+
+    if (_isSidecarValid(store, entry->sidecar, fileInfo, chunkSize) == false && now - entry->lastOpened >= _sidecarRecheckSeconds) {
+        // The file may have been published (again) since we last looked.
+        char sidecarPath[PATH_MAX];
+        _releaseSidecar(&entry->sidecar);
+        if (_formatSidecarPath(store, fileName, fileNameLength, "", sidecarPath, sizeof(sidecarPath))) {
+            entry->sidecar = _openSidecar(sidecarPath);
+        }
+        entry->lastOpened = now;
+    }
+
+    _TutorialPublishedSidecar *result = NULL;
+    if (_isSidecarValid(store, entry->sidecar, fileInfo, chunkSize)) {
+        result = entry->sidecar;
+        result->referenceCount++;
+    }
+
+    return result;
+}
+
+TutorialPublishedStore *
+tutorialPublishedStore_Create(const char *directoryPath, const PARCKeyId *signerKeyId)
+{
+    TutorialPublishedStore *result = parcMemory_AllocateAndClear(sizeof(TutorialPublishedStore));
+    assertNotNull(result, "parcMemory_AllocateAndClear(%zu) returned NULL", sizeof(TutorialPublishedStore));
+
+    size_t pathLength = strlen(directoryPath) + 1 + strlen(tutorialPublishedStore_DirectoryName) + 1;
+    result->sidecarDirectoryPath = parcMemory_Allocate(pathLength);
+    assertNotNull(result->sidecarDirectoryPath, "parcMemory_Allocate(%zu) returned NULL", pathLength);
+    snprintf(result->sidecarDirectoryPath, pathLength, "%s/%s", directoryPath, tutorialPublishedStore_DirectoryName);
+
+    const PARCBuffer *keyIdBytes = parcKeyId_GetKeyId(signerKeyId);
+    size_t keyIdLength = parcBuffer_Remaining(keyIdBytes);
+    assertTrue(keyIdLength <= _signerKeyIdCapacity, "Key id of %zu bytes is longer than %d bytes", keyIdLength, _signerKeyIdCapacity);
+    result->signerKeyIdLength = (uint32_t) keyIdLength;
+    memcpy(result->signerKeyId, parcBuffer_Overlay((PARCBuffer *) keyIdBytes, 0), keyIdLength);
+
+    result->entries = parcMemory_AllocateAndClear(_openSidecarCapacity * sizeof(_TutorialPublishedStoreEntry));
+    assertNotNull(result->entries, "parcMemory_AllocateAndClear(%zu) returned NULL", _openSidecarCapacity * sizeof(_TutorialPublishedStoreEntry));
+
+    pthread_mutex_init(&result->lock, NULL);
+
+    return result;
+}
+
+void
+tutorialPublishedStore_Release(TutorialPublishedStore **storeP)
+{
+    TutorialPublishedStore *store = *storeP;
+
+    for (size_t i = 0; i < _openSidecarCapacity; i++) {
+        _closeEntry(&store->entries[i]);
+    }
+
+    pthread_mutex_destroy(&store->lock);
+    parcMemory_Deallocate((void **) &store->entries);
+    parcMemory_Deallocate((void **) &store->sidecarDirectoryPath);
+    parcMemory_Deallocate((void **) &store);
+
+    *storeP = NULL;
+}
+
+bool
+tutorialPublishedStore_PublishFile(TutorialPublishedStore *store, const char *fileName, const struct stat *fileInfo,
+                                   uint32_t chunkSize, uint64_t chunkCount,
+                                   TutorialPublishedChunkEncoder *encoder, void *context)
+{
+    char sidecarPath[PATH_MAX];
+    char temporaryPath[PATH_MAX];
+    size_t fileNameLength = strlen(fileName);
+
+    if (_formatSidecarPath(store, fileName, fileNameLength, "", sidecarPath, sizeof(sidecarPath)) == false
+        || _formatSidecarPath(store, fileName, fileNameLength, ".publishing", temporaryPath, sizeof(temporaryPath)) == false) {
+        return false;
+    }
+
+    // A file in a subdirectory has its sidecar in the same subdirectory of the store.
+    if (tutorialFileIO_CreateParentDirectories(temporaryPath) == false) {
+        return false;
+    }
+
+    int fileDescriptor = open(temporaryPath, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fileDescriptor < 0) {
+        return false;
+    }
+
+    size_t indexLength = (chunkCount + 1) * sizeof(uint64_t);
+    uint64_t *index = parcMemory_Allocate(indexLength);
+    assertNotNull(index, "parcMemory_Allocate(%zu) returned NULL", indexLength);
+
+    // Write each chunk after the header and index, recording where it starts.
+    uint64_t offset = sizeof(_TutorialPublishedHeader) + indexLength;
+    bool result = true;
+
+    for (uint64_t chunkNumber = 0; chunkNumber < chunkCount && result; chunkNumber++) {
+        index[chunkNumber] = offset;
+
+        PARCBuffer *encodedChunk = encoder(context, chunkNumber);
+        if (encodedChunk == NULL) {
+            result = false;
+        } else {
+            size_t length = parcBuffer_Remaining(encodedChunk);
+            result = _writeFully(fileDescriptor, parcBuffer_Overlay(encodedChunk, 0), length, (off_t) offset);
+            offset += length;
+            parcBuffer_Release(&encodedChunk);
+        }
+    }
+    index[chunkCount] = offset;
+
+    _TutorialPublishedHeader header = {
+        .magic                = _sidecarMagic,
+        .chunkSize            = chunkSize,
+        .chunkCount           = chunkCount,
+        .signerKeyIdLength    = store->signerKeyIdLength
+    };
+    tutorialFileIO_GetFileVersion(fileInfo, &header.fileVersion);
+    memcpy(header.signerKeyId, store->signerKeyId, store->signerKeyIdLength);
+
+    result = result
+             && _writeFully(fileDescriptor, index, indexLength, sizeof(header))
+             && _writeFully(fileDescriptor, &header, sizeof(header), 0);
+
+    parcMemory_Deallocate((void **) &index);
+
+    if (close(fileDescriptor) != 0) {
+        result = false;
+    }
+
+    // Readers only ever see a complete sidecar, whether the old one or the new one.
+    if (result && rename(temporaryPath, sidecarPath) != 0) {
+        result = false;
+    }
+    if (result == false) {
+        unlink(temporaryPath);
+    }
+
+    if (result) {
+        // Forget the old sidecar, so the next request for the file opens the new one.
+        pthread_mutex_lock(&store->lock);
+        _TutorialPublishedStoreEntry *entry = _findEntry(store, fileName, fileNameLength, _hashFileName(fileName, fileNameLength), NULL);
+        if (entry != NULL) {
+            _closeEntry(entry);
+        }
+        pthread_mutex_unlock(&store->lock);
+    }
+
+    return result;
+}
+
+PARCBuffer *
+tutorialPublishedStore_GetChunk(TutorialPublishedStore *store, const char *fileName, size_t fileNameLength,
+                                const struct stat *fileInfo, uint32_t chunkSize, uint64_t chunkNumber)
+{
+    pthread_mutex_lock(&store->lock);
+    _TutorialPublishedSidecar *sidecar = _acquireSidecar(store, fileName, fileNameLength, fileInfo, chunkSize);
+    pthread_mutex_unlock(&store->lock);
+
+    if (sidecar == NULL) {
+        return NULL;
+    }
+
+    PARCBuffer *result = NULL;
+
+    if (chunkNumber < sidecar->header.chunkCount) {
+        // The index entries for this chunk and the next give where the chunk starts and ends.
+        uint64_t range[2];
+        off_t indexOffset = (off_t) (sizeof(_TutorialPublishedHeader) + chunkNumber * sizeof(uint64_t));
+
+        if (_readExactly(sidecar->fileDescriptor, range, sizeof(range), indexOffset) && range[0] <= range[1]) {
+            size_t length = (size_t) (range[1] - range[0]);
+            result = tutorialFileIO_GetFileRangeFromDescriptor(sidecar->fileDescriptor, range[0], length);
+
+            if (result != NULL && parcBuffer_Remaining(result) != length) {
+                parcBuffer_Release(&result); // The sidecar is truncated.
+            }
+        }
+    }
+
+    pthread_mutex_lock(&store->lock);
+    _releaseSidecar(&sidecar);
+    pthread_mutex_unlock(&store->lock);
+
+    return result;
+}
@@ -0,0 +1,130 @@
+/*
+ * Copyright (c) 2014-2015, Xerox Corporation (Xerox)and Palo Alto Research Center (PARC)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Patent rights are not granted under this agreement. Patent rights are
+ *       available under FRAND terms.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL XEROX or PARC BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+/**
+ * @author Alan Walendowski, Palo Alto Research Center (Xerox PARC)
+ * @copyright 2014-2015, Xerox Corporation (Xerox)and Palo Alto Research Center (PARC).  All rights reserved.
+ */
+
+#ifndef tutorial_PublishedStore_h
+#define tutorial_PublishedStore_h
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/stat.h>
+
+#include <parc/algol/parc_Buffer.h>
+#include <parc/security/parc_KeyId.h>
+
+/**
+ * A TutorialPublishedStore holds the chunks of files that have been published ahead of time: each chunk's
+ * ContentObject already encoded to wire format and signed. Serving a published chunk is a read from the
+ * store, so the cost of signing it is paid once, when it is published, instead of on every request.
+ *
+ * The chunks of each file are kept in a sidecar file of the same name, in a hidden directory inside the
+ * directory being served. A sidecar records the version of the file it was published from (see
+ * TutorialFileVersion), the chunk size it was published with, and the key id of the key its chunks were signed with.
+ * It is only used while the file, the server's chunk size and the server's key still match, so a file that
+ * changes after it is published, or whose server has a new key, is served by signing each chunk on demand
+ * again until it is re-published.
+ *
+ * A TutorialPublishedStore may be used by several threads at once.
+ */
+typedef struct tutorial_published_store TutorialPublishedStore;
+
+/**
+ * The name of the hidden directory, inside the directory being served, that holds the published sidecars.
+ */
+extern const char *tutorialPublishedStore_DirectoryName;
+
+/**
+ * Encode one chunk of a file being published, returning its wire format. This is called for each chunk in
+ * order, by tutorialPublishedStore_PublishFile().
+ *
+ * @param [in] context The context given to tutorialPublishedStore_PublishFile().
+ * @param [in] chunkNumber The number of the chunk to encode.
+ *
+ * @return A new PARCBuffer containing the chunk's signed, encoded ContentObject between its position and limit,
+ *         or NULL if the chunk couldn't be encoded. It is released by the store.
+ */
+typedef PARCBuffer *(TutorialPublishedChunkEncoder)(void *context, uint64_t chunkNumber);
+
+/**
+ * Create a TutorialPublishedStore for the specified directory. The sidecar directory is created when the
+ * first file is published. The returned instance must eventually be released by calling
+ * tutorialPublishedStore_Release().
+ *
+ * @param [in] directoryPath A pointer to a string containing the path of the directory being served.
+ * @param [in] signerKeyId The key id of the key the server signs with. Files are published as signed with it,
+ *             and only sidecars signed with it are read.
+ *
+ * @return A new TutorialPublishedStore instance.
+ */
+TutorialPublishedStore *tutorialPublishedStore_Create(const char *directoryPath, const PARCKeyId *signerKeyId);
+
+/**
+ * Release the memory and close the sidecars used by the specified TutorialPublishedStore.
+ *
+ * @param [in,out] storeP A pointer to the pointer to the TutorialPublishedStore to release. It will be set to NULL.
+ */
+void tutorialPublishedStore_Release(TutorialPublishedStore **storeP);
+
+/**
+ * Publish every chunk of a file, replacing any sidecar it was published to before. The new sidecar is written
+ * under a temporary name and renamed into place once it is complete, so a server reading from the store never
+ * sees a partly written sidecar.
+ *
+ * @param [in] store The TutorialPublishedStore to publish to.
+ * @param [in] fileName The name of the file, relative to the directory being served.
+ * @param [in] fileInfo The stat() metadata of the file, taken before its chunks were read.
+ * @param [in] chunkSize The chunk size the file is served with.
+ * @param [in] chunkCount The number of chunks to publish.
+ * @param [in] encoder Called to encode and sign each chunk, with the key whose key id the store was created with.
+ * @param [in] context Passed to `encoder`.
+ *
+ * @return true If every chunk was encoded and the sidecar was written.
+ */
+bool tutorialPublishedStore_PublishFile(TutorialPublishedStore *store, const char *fileName, const struct stat *fileInfo,
+                                        uint32_t chunkSize, uint64_t chunkCount,
+                                        TutorialPublishedChunkEncoder *encoder, void *context);
+
+/**
+ * Read the wire format of a published chunk. Sidecars are kept open between requests.
+ *
+ * @param [in] store The TutorialPublishedStore to read from.
+ * @param [in] fileName The name of the file, relative to the directory. It does not need to be null-terminated.
+ * @param [in] fileNameLength The length of `fileName`, in bytes.
+ * @param [in] fileInfo The current stat() metadata of the file, that the sidecar is validated against.
+ * @param [in] chunkSize The chunk size the file is currently served with.
+ * @param [in] chunkNumber The number of the chunk to read.
+ *
+ * @return A new PARCBuffer containing the chunk's encoded ContentObject, or NULL if the file hasn't been
+ *         published since it last changed. It must eventually be released by calling parcBuffer_Release().
+ */
+PARCBuffer *tutorialPublishedStore_GetChunk(TutorialPublishedStore *store, const char *fileName, size_t fileNameLength,
+                                            const struct stat *fileInfo, uint32_t chunkSize, uint64_t chunkNumber);
+#endif // tutorial_PublishedStore_h
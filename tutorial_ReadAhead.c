@@ -0,0 +1,225 @@
+/*
+ * Copyright (c) 2014-2015, Xerox Corporation (Xerox)and Palo Alto Research Center (PARC)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Patent rights are not granted under this agreement. Patent rights are
+ *       available under FRAND terms.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL XEROX or PARC BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+/**
+ * @author Alan Walendowski, Palo Alto Research Center (Xerox PARC)
+ * @copyright 2014-2015, Xerox Corporation (Xerox)and Palo Alto Research Center (PARC).  All rights reserved.
+ */
+#include <pthread.h>
+#include <time.h>
+
+#include <LongBow/runtime.h>
+#include <parc/algol/parc_Memory.h>
+
+#include "tutorial_ReadAhead.h"
+
+const size_t tutorialReadAhead_DefaultMaximumBytes = 4 * 1024 * 1024;
+
+const uint64_t tutorialReadAhead_HorizonMicroseconds = 100 * 1000;
+
+/**
+ * The number of streams tracked at once. When a new stream starts, the least recently used one is forgotten.
+ */
+#define _streamCapacity 64
+
+/**
+ * The number of in-order requests a stream must make before it is read ahead.
+ */
+static const unsigned _sequentialThreshold = 4;
+
+/**
+ * The fewest chunks read ahead at once, however slowly the stream is requesting them.
+ */
+static const uint64_t _minimumReadAheadChunks = 16;
+
+/**
+ * How far a request may skip forward, or fall back, from the next chunk expected by a stream and still belong
+ * to it. Pipelined clients keep many Interests in flight, so their requests arrive a little out of order, and
+ * they retransmit chunks they have already passed.
+ */
+static const uint64_t _skipAheadTolerance = 64;
+static const uint64_t _fallBehindTolerance = 1024;
+
+typedef struct {
+    dev_t device;                  // Together with inode, identifies the file.
+    ino_t inode;
+    bool isInUse;
+
+    uint64_t nextChunkNumber;      // One past the highest chunk requested.
+    uint64_t readAheadEnd;         // One past the last chunk read ahead.
+    unsigned sequentialCount;      // The number of requests that have moved the stream forward.
+
+    uint64_t lastRequestTime;      // Microseconds, from _now().
+    uint64_t meanRequestInterval;  // Smoothed time between requests that moved the stream forward, in microseconds.
+} _TutorialReadAheadStream;
+
+struct tutorial_read_ahead {
+    pthread_mutex_t lock;
+    size_t maximumBytes;
+    _TutorialReadAheadStream streams[_streamCapacity];
+};
+
+static uint64_t
+_now(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t) now.tv_sec * 1000000 + (uint64_t) now.tv_nsec / 1000;
+}
+
+static bool
+_isChunkInStream(const _TutorialReadAheadStream *stream, const struct stat *fileInfo, uint64_t chunkNumber)
+{
+    return stream->isInUse
+           && stream->device == fileInfo->st_dev && stream->inode == fileInfo->st_ino
+           && chunkNumber <= stream->nextChunkNumber + _skipAheadTolerance
+           && chunkNumber + _fallBehindTolerance >= stream->nextChunkNumber;
+}
+
+/**
+ * Find the stream a request belongs to. If there isn't one, start a new stream in place of the least recently used.
+ */
+static _TutorialReadAheadStream *
+_findStream(TutorialReadAhead *readAhead, const struct stat *fileInfo, uint64_t chunkNumber, uint64_t now)
+{
+    _TutorialReadAheadStream *leastRecentlyUsed = &readAhead->streams[0];
+
+    // There are only a few streams, so a linear scan is cheap.
+    for (size_t i = 0; i < _streamCapacity; i++) {
+        _TutorialReadAheadStream *stream = &readAhead->streams[i];
+
+        if (_isChunkInStream(stream, fileInfo, chunkNumber)) {
+            return stream;
+        } else if (stream->isInUse == false) {
+            leastRecentlyUsed = stream;
+        } else if (leastRecentlyUsed->isInUse && stream->lastRequestTime < leastRecentlyUsed->lastRequestTime) {
+            leastRecentlyUsed = stream;
+        }
+    }
+
+    _TutorialReadAheadStream *result = leastRecentlyUsed;
+    result->isInUse = true;
+    result->device = fileInfo->st_dev;
+    result->inode = fileInfo->st_ino;
+    result->nextChunkNumber = chunkNumber;
+    result->readAheadEnd = chunkNumber;
+    result->sequentialCount = 0;
+    result->lastRequestTime = now;
+    result->meanRequestInterval = tutorialReadAhead_HorizonMicroseconds; // Start cautiously, at the minimum depth.
+
+    return result;
+}
+
+/**
+ * Return the number of chunks to read ahead for the stream, based on how quickly it is requesting them.
+ */
+static uint64_t
+_getReadAheadDepth(const TutorialReadAhead *readAhead, const _TutorialReadAheadStream *stream, uint32_t chunkSize)
+{
+    uint64_t maximumChunks = readAhead->maximumBytes / chunkSize;
+    if (maximumChunks < _minimumReadAheadChunks) {
+        maximumChunks = _minimumReadAheadChunks;
+    }
+
+    uint64_t result = maximumChunks;
+    if (stream->meanRequestInterval > 0) {
+        result = tutorialReadAhead_HorizonMicroseconds / stream->meanRequestInterval;
+    }
+
+    if (result < _minimumReadAheadChunks) {
+        result = _minimumReadAheadChunks;
+    } else if (result > maximumChunks) {
+        result = maximumChunks;
+    }
+
+    return result;
+}
+
+TutorialReadAhead *
+tutorialReadAhead_Create(size_t maximumBytes)
+{
+    TutorialReadAhead *result = parcMemory_AllocateAndClear(sizeof(TutorialReadAhead));
+    assertNotNull(result, "parcMemory_AllocateAndClear(%zu) returned NULL", sizeof(TutorialReadAhead));
+
+    result->maximumBytes = maximumBytes;
+    pthread_mutex_init(&result->lock, NULL);
+
+    return result;
+}
+
+void
+tutorialReadAhead_Release(TutorialReadAhead **readAheadP)
+{
+    pthread_mutex_destroy(&(*readAheadP)->lock);
+    parcMemory_Deallocate((void **) readAheadP);
+}
+
+bool
+tutorialReadAhead_RecordRequest(TutorialReadAhead *readAhead, const struct stat *fileInfo, uint32_t chunkSize,
+                                uint64_t chunkNumber, uint64_t finalChunkNumber,
+                                uint64_t *firstChunkNumber, uint64_t *chunkCount)
+{
+    bool result = false;
+    uint64_t now = _now();
+
+    pthread_mutex_lock(&readAhead->lock);
+
+    _TutorialReadAheadStream *stream = _findStream(readAhead, fileInfo, chunkNumber, now);
+
+    // Only requests that move the stream forward count. A retransmission says nothing about the stream's rate.
+    if (chunkNumber >= stream->nextChunkNumber) {
+        int64_t interval = (int64_t) (now - stream->lastRequestTime);
+        stream->meanRequestInterval += (interval - (int64_t) stream->meanRequestInterval) / 8;
+        stream->lastRequestTime = now;
+
+        stream->nextChunkNumber = chunkNumber + 1;
+        stream->sequentialCount++;
+    }
+
+    if (stream->sequentialCount >= _sequentialThreshold && stream->nextChunkNumber <= finalChunkNumber) {
+        uint64_t depth = _getReadAheadDepth(readAhead, stream, chunkSize);
+
+        // Read the next batch once the stream has used half of the chunks read ahead for it.
+        if (stream->readAheadEnd < stream->nextChunkNumber + depth / 2) {
+            uint64_t first = (stream->readAheadEnd > stream->nextChunkNumber) ? stream->readAheadEnd : stream->nextChunkNumber;
+            uint64_t end = first + depth;
+            if (end > finalChunkNumber + 1) {
+                end = finalChunkNumber + 1;
+            }
+
+            if (first < end) {
+                *firstChunkNumber = first;
+                *chunkCount = end - first;
+                stream->readAheadEnd = end;
+                result = true;
+            }
+        }
+    }
+
+    pthread_mutex_unlock(&readAhead->lock);
+
+    return result;
+}
@@ -0,0 +1,103 @@
+/*
+ * Copyright (c) 2014-2015, Xerox Corporation (Xerox)and Palo Alto Research Center (PARC)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Patent rights are not granted under this agreement. Patent rights are
+ *       available under FRAND terms.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL XEROX or PARC BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+/**
+ * @author Alan Walendowski, Palo Alto Research Center (Xerox PARC)
+ * @copyright 2014-2015, Xerox Corporation (Xerox)and Palo Alto Research Center (PARC).  All rights reserved.
+ */
+
+#ifndef tutorial_ReadAhead_h
+#define tutorial_ReadAhead_h
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/stat.h>
+
+/**
+ * A TutorialReadAhead spots clients fetching a file in order, and tells the server when to read the chunks
+ * they will ask for next. The server reads those chunks in one large read and puts them in its content store,
+ * so the Interests that follow are answered from memory instead of each needing its own small read.
+ *
+ * Each stream is a run of requests for one file that keeps moving forward. Several clients fetching the same
+ * file are tracked as separate streams, since their positions in the file differ. A stream is only read ahead
+ * once it has made several requests in a row in order. Requests slightly out of order, such as those from a
+ * pipelined client, or retransmissions of chunks already passed, don't break a stream.
+ *
+ * How far ahead a stream is read follows how fast it is requesting chunks. It is the number of chunks the
+ * stream requests in tutorialReadAhead_HorizonMicroseconds, within a minimum and a byte limit. The next read
+ * ahead starts when the stream has used half of the chunks already read for it.
+ *
+ * A TutorialReadAhead may be used by several threads at once.
+ */
+typedef struct tutorial_read_ahead TutorialReadAhead;
+
+/**
+ * The default maximum number of bytes read ahead for a stream at once.
+ */
+extern const size_t tutorialReadAhead_DefaultMaximumBytes;
+
+/**
+ * How far ahead of a stream to read, measured in the time the stream takes to request the chunks.
+ */
+extern const uint64_t tutorialReadAhead_HorizonMicroseconds;
+
+/**
+ * Create a new TutorialReadAhead. The returned instance must eventually be released by calling
+ * tutorialReadAhead_Release().
+ *
+ * @param [in] maximumBytes The maximum number of bytes to read ahead for a stream at once.
+ *
+ * @return A new TutorialReadAhead instance.
+ */
+TutorialReadAhead *tutorialReadAhead_Create(size_t maximumBytes);
+
+/**
+ * Release the memory used by the specified TutorialReadAhead.
+ *
+ * @param [in,out] readAheadP A pointer to the pointer to the TutorialReadAhead to release. It will be set to NULL.
+ */
+void tutorialReadAhead_Release(TutorialReadAhead **readAheadP);
+
+/**
+ * Record a request for a chunk of a file, and decide whether chunks should be read ahead for the stream it
+ * belongs to. If so, they are considered read as of this call, and won't be returned again for that stream.
+ *
+ * @param [in] readAhead The TutorialReadAhead to update.
+ * @param [in] fileInfo The stat() metadata of the file, which identifies it.
+ * @param [in] chunkSize The chunk size the file is served with.
+ * @param [in] chunkNumber The number of the chunk requested.
+ * @param [in] finalChunkNumber The number of the final chunk of the file.
+ * @param [out] firstChunkNumber Set to the number of the first chunk to read ahead.
+ * @param [out] chunkCount Set to the number of chunks to read ahead.
+ *
+ * @return true If chunks should be read ahead now.
+ * @return false If not, in which case `firstChunkNumber` and `chunkCount` are not changed.
+ */
+bool tutorialReadAhead_RecordRequest(TutorialReadAhead *readAhead, const struct stat *fileInfo, uint32_t chunkSize,
+                                     uint64_t chunkNumber, uint64_t finalChunkNumber,
+                                     uint64_t *firstChunkNumber, uint64_t *chunkCount);
+#endif // tutorial_ReadAhead_h
@@ -0,0 +1,222 @@
+/*
+ * Copyright (c) 2014-2015, Xerox Corporation (Xerox)and Palo Alto Research Center (PARC)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Patent rights are not granted under this agreement. Patent rights are
+ *       available under FRAND terms.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL XEROX or PARC BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+/**
+ * @author Alan Walendowski, Palo Alto Research Center (Xerox PARC)
+ * @copyright 2014-2015, Xerox Corporation (Xerox)and Palo Alto Research Center (PARC).  All rights reserved.
+ */
+#include <string.h>
+
+#include <LongBow/runtime.h>
+#include <parc/algol/parc_Memory.h>
+
+#include "tutorial_Reassembler.h"
+
+const size_t tutorialReassembler_DefaultReorderWindow = 256;
+
+// The number of chunks the bitmap grows by at a time.
+static const uint64_t _bitmapGrowthInBits = 4096;
+
+struct tutorial_reassembler {
+    TutorialReassemblerWriter *writer;
+    void *writerContext;
+
+    // One bit per chunk, set once the chunk has been received. Grows as higher-numbered chunks arrive.
+    uint64_t *bitmap;
+    uint64_t bitmapSizeInBits;
+
+    uint64_t receivedCount;
+    uint64_t firstMissingChunk;  // Every chunk below this has been received and written.
+    uint64_t finalChunkNumber;   // UINT64_MAX until the first chunk arrives.
+
+    // Chunks received ahead of firstMissingChunk, but within the reorder window, are held here until the gap
+    // is filled. Chunk n is held in slot (n % reorderWindow).
+    PARCBuffer **reorderBuffer;
+    size_t reorderWindow;
+};
+
+static bool
+_isBitSet(const TutorialReassembler *reassembler, uint64_t chunkNumber)
+{
+    if (chunkNumber >= reassembler->bitmapSizeInBits) {
+        return false;
+    }
+    return (reassembler->bitmap[chunkNumber / 64] & (UINT64_C(1) << (chunkNumber % 64))) != 0;
+}
+
+static void
+_setBit(TutorialReassembler *reassembler, uint64_t chunkNumber)
+{
+    if (chunkNumber >= reassembler->bitmapSizeInBits) {
+        uint64_t newSizeInBits = ((chunkNumber / _bitmapGrowthInBits) + 1) * _bitmapGrowthInBits;
+        size_t oldWords = reassembler->bitmapSizeInBits / 64;
+        size_t newWords = newSizeInBits / 64;
+
+        reassembler->bitmap = parcMemory_Reallocate(reassembler->bitmap, newWords * sizeof(uint64_t));
+        assertNotNull(reassembler->bitmap, "parcMemory_Reallocate(%zu) returned NULL", newWords * sizeof(uint64_t));
+        memset(reassembler->bitmap + oldWords, 0, (newWords - oldWords) * sizeof(uint64_t));
+        reassembler->bitmapSizeInBits = newSizeInBits;
+    }
+    reassembler->bitmap[chunkNumber / 64] |= (UINT64_C(1) << (chunkNumber % 64));
+}
+
+/**
+ * Move firstMissingChunk past every chunk that has now been received, writing out any that were being held.
+ */
+static void
+_advanceFirstMissingChunk(TutorialReassembler *reassembler)
+{
+    while (_isBitSet(reassembler, reassembler->firstMissingChunk)) {
+        if (reassembler->reorderWindow > 0) {
+            PARCBuffer **slot = &reassembler->reorderBuffer[reassembler->firstMissingChunk % reassembler->reorderWindow];
+            if (*slot != NULL) {
+                reassembler->writer(reassembler->writerContext, *slot, reassembler->firstMissingChunk);
+                parcBuffer_Release(slot);
+            }
+        }
+        reassembler->firstMissingChunk++;
+    }
+}
+
+TutorialReassembler *
+tutorialReassembler_Create(size_t reorderWindow, TutorialReassemblerWriter *writer, void *context)
+{
+    assertNotNull(writer, "A TutorialReassembler needs a writer.");
+
+    TutorialReassembler *result = parcMemory_AllocateAndClear(sizeof(TutorialReassembler));
+    assertNotNull(result, "parcMemory_AllocateAndClear(%zu) returned NULL", sizeof(TutorialReassembler));
+
+    result->writer = writer;
+    result->writerContext = context;
+    result->finalChunkNumber = UINT64_MAX;
+    result->reorderWindow = reorderWindow;
+
+    if (reorderWindow > 0) {
+        result->reorderBuffer = parcMemory_AllocateAndClear(reorderWindow * sizeof(PARCBuffer *));
+        assertNotNull(result->reorderBuffer, "parcMemory_AllocateAndClear(%zu) returned NULL", reorderWindow * sizeof(PARCBuffer *));
+    }
+
+    return result;
+}
+
+void
+tutorialReassembler_Release(TutorialReassembler **reassemblerP)
+{
+    assertNotNull(reassemblerP, "Parameter must be a non-null pointer to a TutorialReassembler pointer.");
+    TutorialReassembler *reassembler = *reassemblerP;
+
+    if (reassembler->reorderBuffer != NULL) {
+        for (size_t i = 0; i < reassembler->reorderWindow; i++) {
+            if (reassembler->reorderBuffer[i] != NULL) {
+                parcBuffer_Release(&reassembler->reorderBuffer[i]);
+            }
+        }
+        parcMemory_Deallocate((void **) &reassembler->reorderBuffer);
+    }
+    if (reassembler->bitmap != NULL) {
+        parcMemory_Deallocate((void **) &reassembler->bitmap);
+    }
+    parcMemory_Deallocate((void **) reassemblerP);
+}
+
+TutorialReassemblerResult
+tutorialReassembler_AddChunk(TutorialReassembler *reassembler, const PARCBuffer *chunk,
+                             uint64_t chunkNumber, uint64_t finalChunkNumber)
+{
+    reassembler->finalChunkNumber = finalChunkNumber;
+
+    if (chunkNumber > finalChunkNumber) {
+        return TutorialReassemblerResult_OutOfRange;
+    }
+    if (_isBitSet(reassembler, chunkNumber)) {
+        return TutorialReassemblerResult_Duplicate;
+    }
+
+    _setBit(reassembler, chunkNumber);
+    reassembler->receivedCount++;
+
+    if (chunkNumber == reassembler->firstMissingChunk) {
+        // This fills the gap. Write it, then everything held behind it.
+        reassembler->writer(reassembler->writerContext, chunk, chunkNumber);
+        reassembler->firstMissingChunk++;
+        _advanceFirstMissingChunk(reassembler);
+    } else if (chunkNumber - reassembler->firstMissingChunk < reassembler->reorderWindow) {
+        // Close enough to hold until the gap is filled. Each slot can only be claimed by one chunk in the window.
+        reassembler->reorderBuffer[chunkNumber % reassembler->reorderWindow] = parcBuffer_Acquire(chunk);
+    } else {
+        // Too far ahead to hold. Write it in place now.
+        reassembler->writer(reassembler->writerContext, chunk, chunkNumber);
+    }
+
+    return TutorialReassemblerResult_Accepted;
+}
+
+bool
+tutorialReassembler_IsComplete(const TutorialReassembler *reassembler)
+{
+    return reassembler->finalChunkNumber != UINT64_MAX
+           && reassembler->firstMissingChunk > reassembler->finalChunkNumber;
+}
+
+bool
+tutorialReassembler_HasChunk(const TutorialReassembler *reassembler, uint64_t chunkNumber)
+{
+    return _isBitSet(reassembler, chunkNumber);
+}
+
+uint64_t
+tutorialReassembler_GetFirstMissingChunk(const TutorialReassembler *reassembler)
+{
+    return reassembler->firstMissingChunk;
+}
+
+uint64_t
+tutorialReassembler_GetReceivedCount(const TutorialReassembler *reassembler)
+{
+    return reassembler->receivedCount;
+}
+
+uint64_t
+tutorialReassembler_GetFinalChunkNumber(const TutorialReassembler *reassembler)
+{
+    return reassembler->finalChunkNumber;
+}
+
+void
+tutorialReassembler_SetFinalChunkNumber(TutorialReassembler *reassembler, uint64_t finalChunkNumber)
+{
+    reassembler->finalChunkNumber = finalChunkNumber;
+}
+
+void
+tutorialReassembler_SkipChunk(TutorialReassembler *reassembler, uint64_t chunkNumber)
+{
+    if (_isBitSet(reassembler, chunkNumber) == false) {
+        _setBit(reassembler, chunkNumber);
+        reassembler->receivedCount++;
+        _advanceFirstMissingChunk(reassembler);
+    }
+}
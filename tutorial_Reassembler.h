@@ -0,0 +1,172 @@
+/*
+ * Copyright (c) 2014-2015, Xerox Corporation (Xerox)and Palo Alto Research Center (PARC)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Patent rights are not granted under this agreement. Patent rights are
+ *       available under FRAND terms.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL XEROX or PARC BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+/**
+ * @author Alan Walendowski, Palo Alto Research Center (Xerox PARC)
+ * @copyright 2014-2015, Xerox Corporation (Xerox)and Palo Alto Research Center (PARC).  All rights reserved.
+ */
+
+#ifndef tutorial_Reassembler_h
+#define tutorial_Reassembler_h
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include <parc/algol/parc_Buffer.h>
+
+/**
+ * A TutorialReassembler puts the chunks of a piece of content back together, whatever order they arrive in.
+ * It keeps a bitmap of the chunks that have been received, so duplicates are ignored, and it only reports
+ * the content as complete once every chunk from 0 to the final chunk has been received.
+ *
+ * Each accepted chunk is handed to a TutorialReassemblerWriter along with its chunk number, so the writer can
+ * put it at its own offset. To keep writes sequential where it can, a reassembler holds chunks that arrive
+ * shortly ahead of the first missing chunk in a bounded reorder buffer, and hands them over in order once the
+ * gap is filled. Chunks that arrive further ahead than that are handed over immediately.
+ */
+typedef struct tutorial_reassembler TutorialReassembler;
+
+/**
+ * The function a TutorialReassembler calls to write out an accepted chunk. The chunk's position must not be changed.
+ *
+ * @param [in] context The context pointer passed to tutorialReassembler_Create().
+ * @param [in] chunk The contents of the chunk.
+ * @param [in] chunkNumber The 0-based number of the chunk.
+ */
+typedef void (TutorialReassemblerWriter)(void *context, const PARCBuffer *chunk, uint64_t chunkNumber);
+
+/**
+ * The outcome of adding a chunk to a TutorialReassembler.
+ */
+typedef enum {
+    TutorialReassemblerResult_Accepted,   // The chunk was new, and has been (or will be) written.
+    TutorialReassemblerResult_Duplicate,  // The chunk had already been received, and was ignored.
+    TutorialReassemblerResult_OutOfRange  // The chunk is beyond the final chunk, and was ignored.
+} TutorialReassemblerResult;
+
+/**
+ * The default number of chunks a TutorialReassembler will hold while waiting for a missing chunk.
+ */
+extern const size_t tutorialReassembler_DefaultReorderWindow;
+
+/**
+ * Create a new TutorialReassembler. The returned instance must eventually be released by calling
+ * tutorialReassembler_Release().
+ *
+ * @param [in] reorderWindow The maximum number of chunks to hold while waiting for a missing chunk. 0 disables reordering.
+ * @param [in] writer The function to call to write out each accepted chunk.
+ * @param [in] context A pointer passed to `writer`.
+ *
+ * @return A new TutorialReassembler instance.
+ */
+TutorialReassembler *tutorialReassembler_Create(size_t reorderWindow, TutorialReassemblerWriter *writer, void *context);
+
+/**
+ * Release the specified TutorialReassembler, along with any chunks it is still holding. Held chunks are not written.
+ *
+ * @param [in,out] reassemblerP A pointer to the pointer to the TutorialReassembler to release. It will be set to NULL.
+ */
+void tutorialReassembler_Release(TutorialReassembler **reassemblerP);
+
+/**
+ * Add a received chunk to the reassembler. `finalChunkNumber` is the final chunk number carried by the
+ * chunk's ContentObject; the most recently reported value is the one used to decide completion.
+ *
+ * @param [in] reassembler The TutorialReassembler to add to.
+ * @param [in] chunk The contents of the chunk. The reassembler acquires a reference if it needs to hold it.
+ * @param [in] chunkNumber The 0-based number of the chunk.
+ * @param [in] finalChunkNumber The number of the final chunk of the content.
+ *
+ * @return The outcome of adding the chunk.
+ */
+TutorialReassemblerResult tutorialReassembler_AddChunk(TutorialReassembler *reassembler, const PARCBuffer *chunk,
+                                                       uint64_t chunkNumber, uint64_t finalChunkNumber);
+
+/**
+ * Determine whether every chunk from 0 to the final chunk has been received and written.
+ *
+ * @param [in] reassembler The TutorialReassembler to check.
+ *
+ * @return true If the content is complete.
+ */
+bool tutorialReassembler_IsComplete(const TutorialReassembler *reassembler);
+
+/**
+ * Determine whether the specified chunk has been received.
+ *
+ * @param [in] reassembler The TutorialReassembler to check.
+ * @param [in] chunkNumber The 0-based number of the chunk.
+ *
+ * @return true If the chunk has been received.
+ */
+bool tutorialReassembler_HasChunk(const TutorialReassembler *reassembler, uint64_t chunkNumber);
+
+/**
+ * Return the number of the lowest-numbered chunk that has not yet been received.
+ *
+ * @param [in] reassembler The TutorialReassembler to check.
+ *
+ * @return The number of the first missing chunk. If the content is complete, this is one past the final chunk.
+ */
+uint64_t tutorialReassembler_GetFirstMissingChunk(const TutorialReassembler *reassembler);
+
+/**
+ * Return the number of distinct chunks that have been received.
+ *
+ * @param [in] reassembler The TutorialReassembler to check.
+ *
+ * @return The number of distinct chunks received.
+ */
+uint64_t tutorialReassembler_GetReceivedCount(const TutorialReassembler *reassembler);
+
+/**
+ * Return the final chunk number most recently reported to the reassembler.
+ *
+ * @param [in] reassembler The TutorialReassembler to check.
+ *
+ * @return The final chunk number, or UINT64_MAX if it isn't known yet.
+ */
+uint64_t tutorialReassembler_GetFinalChunkNumber(const TutorialReassembler *reassembler);
+
+/**
+ * Tell the reassembler the final chunk number before any chunk has been added, e.g. from the content's
+ * manifest, so that every chunk can be asked for at once. Chunks added later still report their own.
+ *
+ * @param [in] reassembler The TutorialReassembler to update.
+ * @param [in] finalChunkNumber The number of the final chunk of the content.
+ */
+void tutorialReassembler_SetFinalChunkNumber(TutorialReassembler *reassembler, uint64_t finalChunkNumber);
+
+/**
+ * Record that the specified chunk is already in place (e.g. written by an earlier, interrupted transfer), so it
+ * counts as received but is never handed to the writer. A copy of it that arrives later is a duplicate.
+ *
+ * @param [in] reassembler The TutorialReassembler to update.
+ * @param [in] chunkNumber The number of the chunk that is already in place.
+ */
+void tutorialReassembler_SkipChunk(TutorialReassembler *reassembler, uint64_t chunkNumber);
+#endif // tutorial_Reassembler_h
@@ -29,11 +29,32 @@
  * @copyright 2014-2015, Xerox Corporation (Xerox)and Palo Alto Research Center (PARC).  All rights reserved.
  */
 
+#include <dirent.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <pthread.h>
+#include <string.h>
 #include <strings.h>
 #include <stdio.h>
+#include <time.h>
+#include <unistd.h>
 
 #include "tutorial_Common.h"
 #include "tutorial_FileIO.h"
+#include "tutorial_FileCache.h"
+#include "tutorial_BufferPool.h"
+#include "tutorial_ContentStore.h"
+#include "tutorial_WorkQueue.h"
+#include "tutorial_DirectoryWatcher.h"
+#include "tutorial_DirectoryListing.h"
+#include "tutorial_ListingQuery.h"
+#include "tutorial_PathIndex.h"
+#include "tutorial_Catalog.h"
+#include "tutorial_ReadAhead.h"
+#include "tutorial_PublishedStore.h"
+#include "tutorial_Metadata.h"
+#include "tutorial_Manifest.h"
+#include "tutorial_Compression.h"
 #include "tutorial_About.h"
 
 #include <LongBow/runtime.h>
@@ -42,268 +63,1855 @@
 #include <ccnx/api/ccnx_Portal/ccnx_PortalRTA.h>
 
 #include <parc/algol/parc_Memory.h>
+#include <parc/security/parc_Security.h>
+#include <parc/security/parc_Signer.h>
 
 #include <ccnx/common/ccnx_Name.h>
+#include <ccnx/common/ccnx_NameSegmentNumber.h>
 #include <ccnx/common/ccnx_ContentObject.h>
 
+/**
+ * The settings given to tutorial_Server on the command line.
+ */
+typedef struct {
+    bool useMemoryMapping;          // Serve file chunks as zero-copy slices of memory mapped files.
+    size_t contentStoreByteBudget;  // The size of the in-process content store. 0 disables it.
+    unsigned workerCount;           // The number of threads building responses. 0 answers Interests in the receiving thread.
+    uint32_t chunkSize;             // The largest chunk size to serve files with.
+    bool shouldPublish;             // Publish the files in the directory instead of serving them.
+    size_t batchSize;               // The most Interests the single-threaded server answers before sending its responses.
+    bool shouldReportBatchStats;    // Periodically print the size and latency of the single-threaded server's batches.
+    TutorialCompressionCodec compressionCodec; // The codec to offer files that compress well with, or None.
+} _TutorialServerOptions;
+
+/**
+ * The state used to answer Interests. It is created by _serveDirectory() and passed down to the
+ * functions that build responses.
+ */
+typedef struct {
+    const char *directoryPath;          // The directory being served.
+    TutorialFileCache *fileCache;       // Open descriptors for the files being served.
+    TutorialContentStore *contentStore; // Recently built fetch responses, or NULL if disabled.
+    TutorialDirectoryWatcher *watcher;  // Reports changes to the files in the directory being served.
+    TutorialPathIndex *pathIndex;       // Resolves the names of the files being served, kept up to date from `watcher`.
+    TutorialDirectoryListing *listing;  // The listing of the directory being served, kept up to date from `watcher`.
+    TutorialCatalog *catalog;           // The metadata of the files being served, kept up to date from `watcher`.
+    TutorialFileReader *fileReader;     // Reads file chunks asynchronously, or NULL to read them in the calling thread.
+    TutorialReadAhead *readAhead;       // Spots clients fetching files in order, or NULL if there's no content store to read ahead into, or chunks are mapped.
+    TutorialPublishedStore *publishedStore; // Chunks that were encoded and signed ahead of time.
+    TutorialCompressionCodec compressionCodec; // The codec to offer files that compress well with, or None.
+} _TutorialServerState;
+
+/**
+ * A file being published. Each chunk is read from the file, and its ContentObject is encoded and signed.
+ */
+typedef struct {
+    int fileDescriptor;
+    CCNxName *chunkName;        // The name of a chunk of the file. Each chunk's name is made from it.
+    TutorialMetadata metadata;
+    PARCSigner *signer;         // Signs with the same identity the server's Portal signs with.
+} _TutorialServerPublication;
+
+/**
+ * The keystore holding the server's identity, which signs the ContentObjects it sends and publishes.
+ */
+static const char *_serverKeystoreName = "tutorialServer_keystore";
+static const char *_serverKeystorePassword = "keystore_password";
+static const char *_serverSubjectName = "tutorialServer";
+
+/**
+ * The number of chunks of a file read at once while building its manifest.
+ */
+static const size_t _manifestBlockChunkCount = 256;
+
+/**
+ * The number of file chunk reads the single-threaded server can have in flight at once.
+ */
+static const size_t _fileReaderQueueDepth = 64;
+
+/**
+ * The most worker threads the pipelined server can be asked to build responses with. Each one has its own
+ * stack and, without a content store, its own buffer pool, so a mistyped -t shouldn't be able to start millions.
+ */
+static const unsigned _maximumWorkerCount = 1024;
+
+/**
+ * The number of threads that walk the directory being served, and the directories below it, to index its files.
+ * Walking is mostly waiting for the file system, so this doesn't depend on the number of CPUs.
+ */
+static const unsigned _pathIndexWalkerCount = 8;
+
+/**
+ * The longest the thread applying changes to the directory being served waits for one, before it checks whether
+ * the server is stopping. Where changes can't be waited for, this is also how often the directory is checked.
+ */
+static const uint32_t _directoryWatchIntervalMilliseconds = 250;
+
+/**
+ * The number of payload buffers in each thread's TutorialBufferPool. This covers the responses waiting in a
+ * batch, those being read, and those the Portal is still sending.
+ */
+static const size_t _bufferPoolCapacity = 256;
+
+/**
+ * The number of Interests the single-threaded server takes from the Portal before sending the responses to
+ * them, unless it is given another batch size with -b.
+ */
+static const size_t _defaultBatchSize = 64;
+
+/**
+ * How often, in seconds, the single-threaded server prints its batch statistics when asked to with -b.
+ */
+static const double _batchStatsInterval = 10.0;
+
+/**
+ * The most of the start of a file that is compressed to decide whether to offer the file compressed.
+ */
+static const size_t _compressionSampleLength = 64 * 1024;
+
+/**
+ * The number of buckets in the batch latency histogram. Bucket i counts the batches that took less than 2^i
+ * microseconds, and the last bucket also counts any slower batches.
+ */
+#define _batchLatencyBucketCount 24
+
+/**
+ * The number, size and latency of the batches answered by the single-threaded server since they were last
+ * reported. A batch's latency is the time from taking its first Interest from the Portal to sending its last
+ * response.
+ */
+typedef struct {
+    uint64_t batchCount;
+    uint64_t interestCount;
+    uint64_t totalNanoseconds;
+    uint64_t maximumNanoseconds;
+    uint64_t latencyHistogram[_batchLatencyBucketCount];
+} _TutorialServerBatchStats;
+
+typedef struct tutorial_server_pending_fetch _TutorialServerPendingFetch;
+
+/**
+ * The responses to a batch of Interests. The single-threaded server takes every Interest waiting on the Portal,
+ * up to `capacity` of them, without blocking. It builds and queues the response to each, and then sends them
+ * all together with _flushBatch().
+ *
+ * The batch also holds the thread's reusable per-Interest state: the buffers that file chunks are read into, and
+ * the records of the fetches waiting for them. There is never more than one fetch per read in flight, plus the
+ * one being submitted, so a record is always free.
+ */
+typedef struct {
+    CCNxPortal *portal;
+    CCNxMetaMessage **responses;   // Response messages waiting to be sent.
+    size_t responseCount;
+    size_t capacity;               // The batch size. The batch is also sent if this many responses are waiting.
+
+    TutorialBufferPool *bufferPool;         // Payload buffers for file chunks, or NULL if they aren't pooled.
+    _TutorialServerPendingFetch *fetches;   // _fileReaderQueueDepth + 1 records of pending fetches.
+    uint64_t reusedFetchCount;              // The number of times a record was used, each one an allocation avoided.
+} _TutorialServerBatch;
+
+/**
+ * A fetch response waiting for its chunk to be read from the file, when the server is reading asynchronously.
+ */
+struct tutorial_server_pending_fetch {
+    bool isInUse;
+    _TutorialServerBatch *batch; // The batch to queue the response on.
+    _TutorialServerState *server;
+    CCNxName *name;             // The name of the Interest being answered.
+    TutorialMetadata metadata;
+    struct stat fileInfo;
+};
+
+/**
+ * The number of messages that can be waiting between two stages of the pipelined server.
+ */
+static const size_t _pipelineQueueCapacity = 1024;
+
+/**
+ * The stages of the pipelined server are connected by two queues. The receiving thread puts inbound Interest
+ * messages on `interests`, a pool of worker threads builds a response to each and puts it on `responses`, and
+ * a sending thread writes the responses to the Portal. A slow disk read then only holds up one worker, while
+ * the others keep answering.
+ */
+typedef struct {
+    CCNxPortal *portal;
+    const CCNxName *domainPrefix;
+    _TutorialServerState *server;
+
+    TutorialWorkQueue *interests;  // CCNxMetaMessages containing Interests, from the receiver to the workers.
+    TutorialWorkQueue *responses;  // CCNxMetaMessages containing ContentObjects, from the workers to the sender.
+
+    size_t bufferSize;             // The size of the payload buffers in each worker's TutorialBufferPool, or 0 if they aren't pooled.
+    TutorialBufferPoolStats bufferPoolStats; // The sum of the workers' pool counts, added to as each one exits.
+
+    bool hasAnsweredInterest;      // Set by the sending thread.
+} _TutorialServerPipeline;
+
+/**
+ * Return the most to read ahead of a stream at once. Chunks read ahead wait in the content store until they are
+ * asked for, so each stream may use only a small part of it, leaving room for other streams and other files.
+ *
+ * @param [in] options The server's options, including the size of its content store.
+ *
+ * @return The maximum number of bytes to read ahead for a stream.
+ */
+static size_t
+_getReadAheadLimit(const _TutorialServerOptions *options)
+{
+    size_t result = options->contentStoreByteBudget / 8;
+    return (result < tutorialReadAhead_DefaultMaximumBytes) ? result : tutorialReadAhead_DefaultMaximumBytes;
+}
+
+/**
+ * Create a new CCNxPortalFactory instance using a randomly generated identity saved to
+ * the specified keystore.
+ *
+ * @return A new CCNxPortalFactory instance which must eventually be released by calling ccnxPortalFactory_Release().
+ */
+static CCNxPortalFactory *
+_setupServerPortalFactory(void)
+{
+    return tutorialCommon_SetupPortalFactory(_serverKeystoreName, _serverKeystorePassword, _serverSubjectName);
+}
+
+/**
+ * Given the size of some data and a chunk size, calculate the number of chunks that would be
+ * required to contain the data.
+ *
+ * @param [in] dataLength The size of the data being chunked.
+ * @param [in] chunkSize The size of the chunks to break the data in to.
+ *
+ * @return The number of chunks required to contain the specified data length.
+ */
+static uint64_t
+_getNumberOfChunksRequired(uint64_t dataLength, uint32_t chunkSize)
+{
+    uint64_t chunks = (dataLength / chunkSize) + (dataLength % chunkSize > 0 ? 1 : 0);
+    return (chunks == 0) ? 1 : chunks;
+}
+
+/**
+ * Write the full path of the file named in a parsed Interest name into the caller's buffer. The file name
+ * is taken straight from the name's bytes, so nothing is allocated.
+ *
+ * @param [in] server The state of the server, including the directory being served.
+ * @param [in] nameView The parsed Interest name, containing the file name.
+ * @param [out] filePath The buffer to write the path into.
+ * @param [in] filePathSize The size of `filePath`, in bytes.
+ *
+ * @return true If the name has a file name and its path fit in the buffer.
+ */
+static bool
+_formatFilePath(const _TutorialServerState *server, const TutorialNameView *nameView, char *filePath, size_t filePathSize)
+{
+    if (nameView->fileName == NULL || nameView->fileNameLength > INT_MAX) {
+        return false;
+    }
+
+    // Combine the directoryPath and fileName into the full path name of the desired file
+    int length = snprintf(filePath, filePathSize, "%s/%.*s", server->directoryPath, (int) nameView->fileNameLength, nameView->fileName);
+
+    return (length > 0 && (size_t) length < filePathSize);
+}
+
+/**
+ * Given a Name, a payload, and the number of the last chunk, create a CCNxContentObject suitable for
+ * passing to the Portal. This new CCNxContentObject must eventually be released by calling
+ * ccnxContentObject_Release().
+ *
+ * @param name [in] The CCNxName to use when creating the new ContentObject.
+ * @param payload [in] A PARCBuffer to use as the payload of the new ContentObject.
+ * @param finalChunkNumber [in] The number of the final chunk that will be required to completely transfer
+ *        the requested content.
+ *
+ * @return A newly created CCNxContentObject with the specified name, payload, and finalChunkNumber.
+ */
+static CCNxContentObject *
+_createContentObject(const CCNxName *name, PARCBuffer *payload, uint64_t finalChunkNumber)
+{
+    // In the call below, we are un-const'ing name for ccnxContentObject_CreateWithDataPayload()
+    // but we will not be changing it.
+    CCNxContentObject *result = ccnxContentObject_CreateWithDataPayload((CCNxName *) name, payload);
+    ccnxContentObject_SetFinalChunkNumber(result, finalChunkNumber);
+
+    return result;
+}
+
+/**
+ * Apply a change reported by the server's TutorialDirectoryWatcher to the state derived from the directory.
+ * This is a TutorialDirectoryChangeHandler.
+ *
+ * @param [in] serverArg A pointer to the _TutorialServerState.
+ * @param [in] changeType The kind of change.
+ * @param [in] fileName The path of the changed file or directory, or NULL if everything should be rebuilt.
+ */
+static void
+_handleDirectoryChange(void *serverArg, TutorialDirectoryChangeType changeType, const char *fileName)
+{
+    _TutorialServerState *server = serverArg;
+
+    // The listing is built from the path index, so the index is brought up to date first.
+    switch (changeType) {
+        case TutorialDirectoryChange_Modified:
+            tutorialPathIndex_UpdatePath(server->pathIndex, fileName);
+            tutorialDirectoryListing_UpdateFile(server->listing, fileName);
+            tutorialCatalog_UpdateFile(server->catalog, fileName);
+            break;
+        case TutorialDirectoryChange_Removed:
+            if (tutorialPathIndex_RemovePath(server->pathIndex, fileName)) {
+                tutorialCatalog_Clear(server->catalog); // A whole directory has gone. The rest is cataloged again as it is asked for.
+            } else {
+                tutorialCatalog_RemoveFile(server->catalog, fileName);
+            }
+            tutorialDirectoryListing_RemoveFile(server->listing, fileName);
+            break;
+        case TutorialDirectoryChange_Rescan:
+            tutorialPathIndex_Rescan(server->pathIndex);
+            tutorialDirectoryListing_Rescan(server->listing);
+            tutorialCatalog_Clear(server->catalog);
+            break;
+    }
+}
+
+/**
+ * The thread that applies the changes reported by the server's TutorialDirectoryWatcher, and how to stop it.
+ */
+typedef struct {
+    _TutorialServerState *server;
+    pthread_t thread;
+    pthread_mutex_t lock;
+    bool isStopping;
+} _TutorialServerDirectoryWatch;
+
+static bool
+_isDirectoryWatchStopping(_TutorialServerDirectoryWatch *watch)
+{
+    pthread_mutex_lock(&watch->lock);
+    bool result = watch->isStopping;
+    pthread_mutex_unlock(&watch->lock);
+
+    return result;
+}
+
+/**
+ * Wait for changes to the directory being served, and bring the state derived from it up to date with them as
+ * they happen, until the server stops. Changes are applied here, rather than as Interests arrive, so that
+ * answering an Interest never waits on the watcher or makes a system call to check it.
+ *
+ * @param [in] watchArg A pointer to the _TutorialServerDirectoryWatch.
+ */
+static void *
+_watchDirectory(void *watchArg)
+{
+    _TutorialServerDirectoryWatch *watch = watchArg;
+
+    while (_isDirectoryWatchStopping(watch) == false) {
+        if (tutorialDirectoryWatcher_WaitForChanges(watch->server->watcher, _directoryWatchIntervalMilliseconds)) {
+            tutorialDirectoryWatcher_ProcessChanges(watch->server->watcher, _handleDirectoryChange, watch->server);
+        }
+    }
+
+    return NULL;
+}
+
+static void
+_startDirectoryWatch(_TutorialServerDirectoryWatch *watch, _TutorialServerState *server)
+{
+    watch->server = server;
+    watch->isStopping = false;
+    pthread_mutex_init(&watch->lock, NULL);
+
+    int failure = pthread_create(&watch->thread, NULL, _watchDirectory, watch);
+    assertTrue(failure == 0, "pthread_create() failed: %s", strerror(failure));
+}
+
+static void
+_stopDirectoryWatch(_TutorialServerDirectoryWatch *watch)
+{
+    pthread_mutex_lock(&watch->lock);
+    watch->isStopping = true;
+    pthread_mutex_unlock(&watch->lock);
+
+    pthread_join(watch->thread, NULL);
+    pthread_mutex_destroy(&watch->lock);
+}
+
+/**
+ * Find the file named in a fetch request in the server's catalog. Its name was resolved to its path when the
+ * Interest's name was parsed.
+ *
+ * A client fetches a file with the chunk size from the metadata it read before starting, and names it in each
+ * Interest. The catalog chooses a file's chunk size from its current size, so it may have changed since, e.g.
+ * if the file was still being written. The returned metadata then has the client's chunk size, and the final
+ * chunk number that goes with it, so the file is split the way the client expects.
+ *
+ * @param [in] server The state of the server, including the directory in which to find the specified file.
+ * @param [in] nameView The parsed Interest name, containing the name of the file.
+ * @param [out] filePath The buffer to write the full path of the file into.
+ * @param [in] filePathSize The size of `filePath`, in bytes.
+ * @param [out] metadata Filled in with the file's metadata, including its chunk size and final chunk number.
+ * @param [out] fileInfo Filled in with the stat() metadata the file was cataloged with.
+ *
+ * @return true If the file is available, and the chunk size named in the request, if any, can be served.
+ */
+static bool
+_lookupFetchedFile(_TutorialServerState *server, const TutorialNameView *nameView, char *filePath, size_t filePathSize,
+                   TutorialMetadata *metadata, struct stat *fileInfo)
+{
+    if (nameView->hasChunkSize && (nameView->chunkSize == 0 || nameView->chunkSize > tutorialCommon_MaximumChunkSize)) {
+        return false;
+    }
+
+    if (_formatFilePath(server, nameView, filePath, filePathSize) == false
+        || tutorialCatalog_Lookup(server->catalog, nameView->fileName, nameView->fileNameLength, metadata, fileInfo) == false) {
+        return false;
+    }
+
+    if (nameView->hasChunkSize) {
+        metadata->chunkSize = (uint32_t) nameView->chunkSize;
+        metadata->finalChunkNumber = _getNumberOfChunksRequired(metadata->fileSize, metadata->chunkSize) - 1;
+    }
+
+    return true;
+}
+
+/**
+ * Create a fetch response containing a chunk that has been read from a file, and remember it in the content
+ * store if the server has one. A chunk that is a slice of a memory mapping isn't remembered: the response could
+ * be sent again long after the file was truncated, and reading the slice then would raise SIGBUS. The new
+ * CCnxContentObject must eventually be released by calling ccnxContentObject_Release().
+ *
+ * @param [in] name The CCNxName to use when creating the new CCNxContentObject.
+ * @param [in] server The state of the server.
+ * @param [in] payload The chunk of the file.
+ * @param [in] isPayloadMapped True if `payload` is a slice of a memory mapping of the file.
+ * @param [in] metadata The file's metadata, containing its final chunk number.
+ * @param [in] fileInfo The stat() metadata of the file, that the content store validates the response against.
+ *
+ * @return A new CCNxContentObject.
+ */
+static CCNxContentObject *
+_createFetchResponseWithChunk(const CCNxName *name, _TutorialServerState *server, PARCBuffer *payload, bool isPayloadMapped,
+                              const TutorialMetadata *metadata, const struct stat *fileInfo)
+{
+    CCNxContentObject *result = _createContentObject(name, payload, metadata->finalChunkNumber);
+
+    if (server->contentStore != NULL && isPayloadMapped == false) {
+        tutorialContentStore_Put(server->contentStore, result, fileInfo);
+    }
+
+    return result;
+}
+
+/**
+ * Create the name of another chunk of the same file, by replacing the chunk segment at the end of a chunk's name.
+ * The new CCNxName must eventually be released by calling ccnxName_Release().
+ *
+ * @param [in] name The name of a chunk of the file.
+ * @param [in] chunkNumber The number of the chunk to name.
+ *
+ * @return A new CCNxName.
+ */
+static CCNxName *
+_createChunkName(const CCNxName *name, uint64_t chunkNumber)
+{
+    CCNxName *result = ccnxName_Copy(name);
+    ccnxName_Trim(result, 1);
+
+    CCNxNameSegment *chunkSegment = ccnxNameSegmentNumber_Create(CCNxNameLabelType_CHUNK, chunkNumber);
+    ccnxName_Append(result, chunkSegment);
+    ccnxNameSegment_Release(&chunkSegment);
+
+    return result;
+}
+
+/**
+ * Return the published ContentObject for a fetch request, if the file was published since it last changed.
+ * It was encoded and signed when it was published, and keeps its wire format, so it is sent as it was stored
+ * rather than being signed again. The new CCnxContentObject must eventually be released by calling
+ * ccnxContentObject_Release().
+ *
+ * @param [in] server The state of the server, including its published store.
+ * @param [in] nameView The parsed Interest name, containing the name of the file and the number of the requested chunk.
+ * @param [in] metadata The file's metadata, containing the chunk size it is served with.
+ * @param [in] fileInfo The stat() metadata of the file, that the published chunks are validated against.
+ *
+ * @return A new CCNxContentObject, or NULL if the chunk hasn't been published.
+ */
+static CCNxContentObject *
+_getPublishedResponse(_TutorialServerState *server, const TutorialNameView *nameView,
+                      const TutorialMetadata *metadata, const struct stat *fileInfo)
+{
+    CCNxContentObject *result = NULL;
+
+    // Published chunks are named with the chunk size they were published with, so they only answer names that have one.
+    if (nameView->hasChunkSize == false) {
+        return NULL;
+    }
+
+    PARCBuffer *wireFormat = tutorialPublishedStore_GetChunk(server->publishedStore, nameView->fileName, nameView->fileNameLength,
+                                                             fileInfo, metadata->chunkSize, nameView->chunkNumber);
+    if (wireFormat != NULL) {
+        CCNxMetaMessage *message = ccnxMetaMessage_CreateFromWireFormatBuffer(wireFormat);
+        if (message != NULL) {
+            if (ccnxMetaMessage_IsContentObject(message)) {
+                result = ccnxContentObject_Acquire(ccnxMetaMessage_GetContentObject(message));
+            }
+            ccnxMetaMessage_Release(&message);
+        }
+        parcBuffer_Release(&wireFormat);
+    }
+
+    return result;
+}
+
+/**
+ * If a fetch request is part of a stream reading the file in order, choose the chunks the stream will ask for next,
+ * to be read in one large read. The kernel is also told to start reading the batch after that, so it is already in
+ * the page cache when the stream gets there.
+ *
+ * @param [in] server The state of the server, including its read-ahead state.
+ * @param [in] nameView The parsed Interest name, containing the number of the requested chunk.
+ * @param [in] filePath The full path of the file.
+ * @param [in] metadata The file's metadata.
+ * @param [in] fileInfo The stat() metadata of the file.
+ * @param [out] firstChunkNumber Set to the number of the first chunk to read ahead.
+ * @param [out] chunkCount Set to the number of chunks to read ahead.
+ *
+ * @return true If chunks should be read ahead.
+ */
+static bool
+_planReadAhead(_TutorialServerState *server, const TutorialNameView *nameView, const char *filePath,
+               const TutorialMetadata *metadata, const struct stat *fileInfo,
+               uint64_t *firstChunkNumber, uint64_t *chunkCount)
+{
+    if (server->readAhead == NULL
+        || tutorialReadAhead_RecordRequest(server->readAhead, fileInfo, metadata->chunkSize, nameView->chunkNumber,
+                                           metadata->finalChunkNumber, firstChunkNumber, chunkCount) == false) {
+        return false;
+    }
+
+    size_t length = *chunkCount * metadata->chunkSize;
+    tutorialFileCache_AdviseWillNeed(server->fileCache, filePath, fileInfo,
+                                     *firstChunkNumber * metadata->chunkSize + length, length);
+    return true;
+}
+
+/**
+ * Put a response for each chunk of a block that was read ahead into the content store.
+ *
+ * @param [in] name The name of the Interest that the block was read ahead for.
+ * @param [in] server The state of the server, including its content store.
+ * @param [in] block The chunks read ahead, starting with chunk `firstChunkNumber`.
+ * @param [in] firstChunkNumber The number of the first chunk in `block`.
+ * @param [in] chunkCount The number of chunks that were read ahead.
+ * @param [in] metadata The file's metadata.
+ * @param [in] fileInfo The stat() metadata of the file.
+ */
+static void
+_storeReadAheadBlock(const CCNxName *name, _TutorialServerState *server, PARCBuffer *block,
+                     uint64_t firstChunkNumber, uint64_t chunkCount,
+                     const TutorialMetadata *metadata, const struct stat *fileInfo)
+{
+    size_t chunkSize = metadata->chunkSize;
+    size_t blockLength = parcBuffer_Limit(block);
+
+    for (uint64_t i = 0; i < chunkCount && i * chunkSize < blockLength; i++) {
+        size_t chunkEnd = (blockLength - i * chunkSize < chunkSize) ? blockLength : (i + 1) * chunkSize;
+
+        // Each payload is a slice of the block, so the chunks share its memory rather than being copied.
+        parcBuffer_SetLimit(block, chunkEnd);
+        parcBuffer_SetPosition(block, i * chunkSize);
+        PARCBuffer *payload = parcBuffer_Slice(block);
+
+        CCNxName *chunkName = _createChunkName(name, firstChunkNumber + i);
+        CCNxContentObject *response = _createFetchResponseWithChunk(chunkName, server, payload, false, metadata, fileInfo);
+
+        ccnxContentObject_Release(&response);
+        ccnxName_Release(&chunkName);
+        parcBuffer_Release(&payload);
+    }
+}
+
+/**
+ * Read ahead of a stream fetching a file in order, waiting for the read. This is used by the worker threads, which
+ * each answer one Interest at a time.
+ *
+ * @param [in] name The name of the Interest being answered.
+ * @param [in] server The state of the server, including its read-ahead state and content store.
+ * @param [in] nameView The parsed `name`, containing the number of the requested chunk.
+ * @param [in] filePath The full path of the file.
+ * @param [in] metadata The file's metadata.
+ * @param [in] fileInfo The stat() metadata of the file.
+ */
+static void
+_readAhead(const CCNxName *name, _TutorialServerState *server, const TutorialNameView *nameView,
+           const char *filePath, const TutorialMetadata *metadata, const struct stat *fileInfo)
+{
+    uint64_t firstChunkNumber;
+    uint64_t chunkCount;
+
+    if (_planReadAhead(server, nameView, filePath, metadata, fileInfo, &firstChunkNumber, &chunkCount)) {
+        PARCBuffer *block = tutorialFileCache_GetKnownFileRange(server->fileCache, filePath, fileInfo,
+                                                                firstChunkNumber * metadata->chunkSize,
+                                                                chunkCount * metadata->chunkSize);
+        if (block != NULL) {
+            _storeReadAheadBlock(name, server, block, firstChunkNumber, chunkCount, metadata, fileInfo);
+            parcBuffer_Release(&block);
+        }
+    }
+}
+
+/**
+ * The state of a read-ahead submitted by _startReadAhead(), kept until the block has been read.
+ */
+typedef struct {
+    _TutorialServerState *server;
+    CCNxName *name;
+    TutorialMetadata metadata;
+    struct stat fileInfo;
+    uint64_t firstChunkNumber;
+    uint64_t chunkCount;
+} _TutorialServerReadAhead;
+
+static void
+_finishReadAhead(void *readAheadArg, PARCBuffer *block)
+{
+    _TutorialServerReadAhead *readAhead = readAheadArg;
+
+    if (block != NULL) {
+        _storeReadAheadBlock(readAhead->name, readAhead->server, block, readAhead->firstChunkNumber,
+                             readAhead->chunkCount, &readAhead->metadata, &readAhead->fileInfo);
+    }
+
+    ccnxName_Release(&readAhead->name);
+    parcMemory_Deallocate((void **) &readAhead);
+}
+
+/**
+ * Read ahead of a stream fetching a file in order, by submitting the read to the server's file reader rather than
+ * waiting for it. The responses are put into the content store by _finishReadAhead() once the block has been read,
+ * so the event loop isn't held up by the read.
+ *
+ * @param [in] name The name of the Interest being answered.
+ * @param [in] server The state of the server, including its file reader.
+ * @param [in] nameView The parsed `name`, containing the number of the requested chunk.
+ * @param [in] filePath The full path of the file.
+ * @param [in] metadata The file's metadata.
+ * @param [in] fileInfo The stat() metadata of the file.
+ */
+static void
+_startReadAhead(const CCNxName *name, _TutorialServerState *server, const TutorialNameView *nameView,
+                const char *filePath, const TutorialMetadata *metadata, const struct stat *fileInfo)
+{
+    uint64_t firstChunkNumber;
+    uint64_t chunkCount;
+
+    if (_planReadAhead(server, nameView, filePath, metadata, fileInfo, &firstChunkNumber, &chunkCount) == false) {
+        return;
+    }
+
+    _TutorialServerReadAhead *readAhead = parcMemory_Allocate(sizeof(_TutorialServerReadAhead));
+    assertNotNull(readAhead, "parcMemory_Allocate(%zu) returned NULL", sizeof(_TutorialServerReadAhead));
+    readAhead->server = server;
+    readAhead->name = ccnxName_Acquire(name);
+    readAhead->metadata = *metadata;
+    readAhead->fileInfo = *fileInfo;
+    readAhead->firstChunkNumber = firstChunkNumber;
+    readAhead->chunkCount = chunkCount;
+
+    if (tutorialFileCache_ReadKnownFileRange(server->fileCache, server->fileReader, filePath, fileInfo,
+                                             firstChunkNumber * metadata->chunkSize, chunkCount * metadata->chunkSize,
+                                             _finishReadAhead, readAhead) == false) {
+        ccnxName_Release(&readAhead->name);
+        parcMemory_Deallocate((void **) &readAhead);
+    }
+}
+
+/**
+ * Given a CCNxName, a file name, and a requested chunk number, return a new CCNxContentObject
+ * with that CCNxName and containing the specified chunk of the file. The new CCNxContentObject will also
+ * contain the number of the last chunk required to transfer the complete file.
+ *
+ * The file's size and final chunk number come from the server's catalog, which is refreshed whenever the
+ * directory watcher reports that the file has changed, so the file can still be growing as we transfer it.
+ * A file that is already cataloged and open is served without any stat() calls.
+ *
+ * A chunk of a file that has been published is returned just as it was stored, already signed. Otherwise,
+ * if the server has a content store, a previously built response for the same name is returned instead,
+ * as long as the file hasn't changed since it was built. Chunks of files being fetched in order are read
+ * ahead into the content store.
+ * The new CCnxContentObject must eventually be released by calling ccnxContentObject_Release().
+ *
+ * @param [in] name The CCNxName to use when creating the new CCNxContentObject.
+ * @param [in] server The state of the server, including the directory in which to find the specified file.
+ * @param [in] nameView The parsed `name`, containing the name of the file and the number of the requested chunk.
+ * @param [in] bufferPool The calling thread's TutorialBufferPool, to read the chunk into.
+ *
+ * @return A new CCNxContentObject instance containing the request chunk of the specified file, or NULL if
+ *         the file did not exist or was otherwise unavailable.
+ */
+static CCNxContentObject *
+_createFetchResponse(const CCNxName *name, _TutorialServerState *server, const TutorialNameView *nameView,
+                     TutorialBufferPool *bufferPool)
+{
+    CCNxContentObject *result = NULL;
+
+    // The file's metadata tells us its chunk size, and whether a response we built earlier is still valid.
+    char fullFilePath[PATH_MAX];
+    TutorialMetadata metadata;
+    struct stat fileInfo;
+    bool isFileAvailable = _lookupFetchedFile(server, nameView, fullFilePath, sizeof(fullFilePath), &metadata, &fileInfo);
+
+    // If the file has been published, its chunks are already built and signed.
+    if (isFileAvailable) {
+        result = _getPublishedResponse(server, nameView, &metadata, &fileInfo);
+        if (result != NULL) {
+            return result;
+        }
+    }
+
+    // If we've built this chunk before, and the file hasn't changed since, just send it again.
+    if (isFileAvailable && server->contentStore != NULL) {
+        result = tutorialContentStore_Get(server->contentStore, name, &fileInfo);
+    }
+
+    if (isFileAvailable && result == NULL) {
+        // Get the actual contents of the specified chunk of the file. The file cache keeps the file open
+        // between requests, and returns NULL if the file doesn't exist or isn't accessible.
+        PARCBuffer *payload = tutorialFileCache_GetKnownFileChunk(server->fileCache, bufferPool, fullFilePath, &fileInfo,
+                                                                  metadata.chunkSize, nameView->chunkNumber);
+
+        if (payload != NULL) {
+            result = _createFetchResponseWithChunk(name, server, payload, tutorialFileCache_IsMemoryMapped(server->fileCache),
+                                                   &metadata, &fileInfo);
+            parcBuffer_Release(&payload);
+        }
+    }
+
+    if (isFileAvailable) {
+        _readAhead(name, server, nameView, fullFilePath, &metadata, &fileInfo);
+    }
+
+    return result; // Could be NULL if there was no payload
+}
+
+/**
+ * Decide whether to offer a file compressed, by compressing the start of it with the server's codec.
+ * Already compressed files (images, archives, video) would only cost CPU time on both ends, so they are
+ * offered without compression.
+ *
+ * @param [in] server The state of the server, including its codec and file cache.
+ * @param [in] filePath The full path of the file.
+ * @param [in] metadata The file's metadata, giving its size.
+ * @param [in] fileInfo The stat() metadata of the file.
+ *
+ * @return The server's codec if the sample compressed well, or TutorialCompressionCodec_None.
+ */
+static TutorialCompressionCodec
+_probeCompression(_TutorialServerState *server, const char *filePath, const TutorialMetadata *metadata, const struct stat *fileInfo)
+{
+    TutorialCompressionCodec result = TutorialCompressionCodec_None;
+
+    size_t sampleLength = (metadata->fileSize < _compressionSampleLength) ? (size_t) metadata->fileSize : _compressionSampleLength;
+    if (sampleLength > 0) {
+        PARCBuffer *sample = tutorialFileCache_GetKnownFileRange(server->fileCache, filePath, fileInfo, 0, sampleLength);
+        if (sample != NULL) {
+            result = tutorialCompression_ProbeCodec(server->compressionCodec, sample);
+            parcBuffer_Release(&sample);
+        }
+    }
+
+    return result;
+}
+
+/**
+ * Given a CCNxName, a file name, and a requested chunk number, return a new CCNxContentObject with that CCNxName
+ * containing the specified chunk of the file, compressed on its own with the codec offered in the file's
+ * metadata (see tutorial_Compression.h). Chunks are compressed independently, so each still lands at its own
+ * offset in the file, and the client checks it against the manifest once it has decompressed it.
+ *
+ * Compressed responses are kept in the content store alongside the uncompressed ones, under their 'cfetch' names,
+ * so a chunk is only compressed once while the file is unchanged. They are neither published nor read ahead.
+ * The new CCnxContentObject must eventually be released by calling ccnxContentObject_Release().
+ *
+ * @param [in] name The CCNxName to use when creating the new CCNxContentObject.
+ * @param [in] server The state of the server, including the directory in which to find the specified file.
+ * @param [in] nameView The parsed `name`, containing the name of the file and the number of the requested chunk.
+ * @param [in] bufferPool The calling thread's TutorialBufferPool, to read the chunk into.
+ *
+ * @return A new CCNxContentObject, or NULL if the file did not exist or was otherwise unavailable.
+ */
+static CCNxContentObject *
+_createCompressedFetchResponse(const CCNxName *name, _TutorialServerState *server, const TutorialNameView *nameView,
+                               TutorialBufferPool *bufferPool)
+{
+    CCNxContentObject *result = NULL;
+
+    char fullFilePath[PATH_MAX];
+    TutorialMetadata metadata;
+    struct stat fileInfo;
+    if (_lookupFetchedFile(server, nameView, fullFilePath, sizeof(fullFilePath), &metadata, &fileInfo) == false) {
+        return NULL;
+    }
+
+    if (server->contentStore != NULL) {
+        result = tutorialContentStore_Get(server->contentStore, name, &fileInfo);
+    }
+
+    if (result == NULL) {
+        PARCBuffer *chunk = tutorialFileCache_GetKnownFileChunk(server->fileCache, bufferPool, fullFilePath, &fileInfo,
+                                                                metadata.chunkSize, nameView->chunkNumber);
+        if (chunk != NULL) {
+            // A client can ask before the file has been probed, e.g. after the server restarted, so fall back to
+            // the server's own codec. The client reads the codec from each payload, not from the metadata.
+            TutorialCompressionCodec codec =
+                (metadata.compression != TutorialCompressionCodec_None) ? metadata.compression : server->compressionCodec;
+            PARCBuffer *payload = tutorialCompression_CompressChunk(codec, chunk);
+            parcBuffer_Release(&chunk);
+
+            result = _createFetchResponseWithChunk(name, server, payload, false, &metadata, &fileInfo);
+            parcBuffer_Release(&payload);
+        }
+    }
+
+    return result;
+}
+
+/**
+ * Given a CCNxName and a file name, return a new CCNxContentObject with that CCNxName containing the file's
+ * metadata: its size, the chunk size it is served with, its final chunk number, and its modification time.
+ * Clients fetch this before fetching the file, so they know where each chunk goes. If the server was given a
+ * codec, the metadata also names it for files whose start compresses well, and the client fetches those with
+ * the 'cfetch' command.
+ * The new CCnxContentObject must eventually be released by calling ccnxContentObject_Release().
+ *
+ * @param [in] name The CCNxName to use when creating the new CCNxContentObject.
+ * @param [in] server The state of the server, including the catalog of the files being served.
+ * @param [in] nameView The parsed `name`, containing the name of the file.
+ *
+ * @return A new CCNxContentObject instance containing the file's metadata, or NULL if the file did not exist
+ *         or was otherwise unavailable.
+ */
+static CCNxContentObject *
+_createMetadataResponse(const CCNxName *name, _TutorialServerState *server, const TutorialNameView *nameView)
+{
+    CCNxContentObject *result = NULL;
+
+    char fullFilePath[PATH_MAX];
+    TutorialMetadata metadata;
+    struct stat fileInfo;
+    if (_lookupFetchedFile(server, nameView, fullFilePath, sizeof(fullFilePath), &metadata, &fileInfo)) {
+        if (server->compressionCodec != TutorialCompressionCodec_None
+            && tutorialCatalog_IsCompressionKnown(server->catalog, nameView->fileName, nameView->fileNameLength) == false) {
+            metadata.compression = _probeCompression(server, fullFilePath, &metadata, &fileInfo);
+            tutorialCatalog_SetCompression(server->catalog, nameView->fileName, nameView->fileNameLength,
+                                           &fileInfo, metadata.compression);
+        }
+
+        PARCBuffer *payload = tutorialMetadata_CreateBuffer(&metadata);
+        result = _createContentObject(name, payload, 0); // Metadata always fits in a single chunk.
+        parcBuffer_Release(&payload);
+    }
+
+    return result;
+}
+
+/**
+ * Build the manifest of a file, by reading the file in large blocks and hashing each chunk of them.
+ * The new TutorialManifest must eventually be released by calling tutorialManifest_Release().
+ *
+ * @param [in] server The state of the server, including its file cache.
+ * @param [in] filePath The full path of the file.
+ * @param [in] metadata The file's metadata, giving its size and chunk size.
+ * @param [in] fileInfo The stat() metadata of the file.
+ *
+ * @return A new TutorialManifest, or NULL if the file couldn't be read, or became shorter while it was being read.
+ */
+static TutorialManifest *
+_createManifest(_TutorialServerState *server, const char *filePath, const TutorialMetadata *metadata, const struct stat *fileInfo)
+{
+    TutorialManifest *result = tutorialManifest_Create(metadata);
+
+    size_t blockLength = _manifestBlockChunkCount * metadata->chunkSize;
+
+    for (uint64_t chunkNumber = 0; chunkNumber <= metadata->finalChunkNumber && result != NULL; chunkNumber += _manifestBlockChunkCount) {
+        uint64_t offset = chunkNumber * metadata->chunkSize;
+        size_t expectedLength = (metadata->fileSize - offset < blockLength) ? (size_t) (metadata->fileSize - offset) : blockLength;
+
+        PARCBuffer *block = tutorialFileCache_GetKnownFileRange(server->fileCache, filePath, fileInfo, offset, blockLength);
+        if (block != NULL && parcBuffer_Remaining(block) == expectedLength) {
+            tutorialManifest_AddChunks(result, chunkNumber, block);
+        } else {
+            tutorialManifest_Release(&result);
+        }
+
+        if (block != NULL) {
+            parcBuffer_Release(&block);
+        }
+    }
+
+    return result;
+}
+
+/**
+ * Given a CCNxName and a file name, return a new CCNxContentObject with that CCNxName containing the requested
+ * chunk of the file's manifest: the SHA-256 digest of each of its chunks. The manifest is sent in chunks of the
+ * file's chunk size. Building it means reading the whole file, so if the server has a content store, every
+ * chunk of the manifest is put in it at once, and the rest of the manifest is served from there.
+ * The new CCnxContentObject must eventually be released by calling ccnxContentObject_Release().
+ *
+ * @param [in] name The CCNxName to use when creating the new CCNxContentObject.
+ * @param [in] server The state of the server, including the catalog of the files being served.
+ * @param [in] nameView The parsed `name`, containing the name of the file and the number of the requested chunk.
+ *
+ * @return A new CCNxContentObject instance containing the chunk of the file's manifest, or NULL if the file did not
+ *         exist or was otherwise unavailable.
+ */
+static CCNxContentObject *
+_createManifestResponse(const CCNxName *name, _TutorialServerState *server, const TutorialNameView *nameView)
+{
+    CCNxContentObject *result = NULL;
+
+    char fullFilePath[PATH_MAX];
+    TutorialMetadata metadata;
+    struct stat fileInfo;
+    if (_lookupFetchedFile(server, nameView, fullFilePath, sizeof(fullFilePath), &metadata, &fileInfo) == false) {
+        return NULL;
+    }
+
+    if (server->contentStore != NULL) {
+        result = tutorialContentStore_Get(server->contentStore, name, &fileInfo);
+        if (result != NULL) {
+            return result;
+        }
+    }
+
+    TutorialManifest *manifest = _createManifest(server, fullFilePath, &metadata, &fileInfo);
+    if (manifest != NULL) {
+        PARCBuffer *contents = tutorialManifest_CreateBuffer(manifest);
+        size_t contentsLength = parcBuffer_Limit(contents);
+        size_t chunkSize = metadata.chunkSize;
+        uint64_t finalChunkNumber = _getNumberOfChunksRequired(contentsLength, metadata.chunkSize) - 1;
+
+        for (uint64_t chunkNumber = 0; chunkNumber <= finalChunkNumber; chunkNumber++) {
+            if (server->contentStore == NULL && chunkNumber != nameView->chunkNumber) {
+                continue; // Without a content store, there's nowhere to keep the other chunks.
+            }
+
+            size_t chunkStart = (size_t) chunkNumber * chunkSize;
+            parcBuffer_SetLimit(contents, (contentsLength - chunkStart < chunkSize) ? contentsLength : chunkStart + chunkSize);
+            parcBuffer_SetPosition(contents, chunkStart);
+            PARCBuffer *payload = parcBuffer_Slice(contents);
+
+            CCNxName *chunkName = _createChunkName(name, chunkNumber);
+            CCNxContentObject *response = _createContentObject(chunkName, payload, finalChunkNumber);
+            if (server->contentStore != NULL) {
+                tutorialContentStore_Put(server->contentStore, response, &fileInfo);
+            }
+            if (chunkNumber == nameView->chunkNumber) {
+                result = ccnxContentObject_Acquire(response);
+            }
+
+            ccnxContentObject_Release(&response);
+            ccnxName_Release(&chunkName);
+            parcBuffer_Release(&payload);
+        }
+
+        parcBuffer_Release(&contents);
+        tutorialManifest_Release(&manifest);
+    }
+
+    return result;
+}
+
+/**
+ * Given a CCNxName and a requested chunk number, return the specified chunk of the directory listing as the payload
+ * of a newly created CCNxContentObject. The listing is kept in memory, already encoded into chunks that each hold
+ * whole entries (see tutorial_ListingChunk.h), and only updated when files in the directory change, so each chunk
+ * is served as a slice of the same listing rather than by listing the directory again.
+ *
+ * If the 'list' command has arguments, they are a TutorialListingQuery, and the chunk is of the part of the listing
+ * that meets its conditions. That is found from the same sorted listing, without looking at the directory.
+ * The new CCnxContentObject must eventually be released by calling ccnxContentObject_Release().
+ *
+ * @param [in] name The CCNxName to use when creating the new CCNxContentObject.
+ * @param [in] server The state of the server, including the listing of the directory being served.
+ * @param [in] nameView The parsed `name`, containing the query's arguments, if any, and the number of the requested chunk.
+ *
+ * @return A new CCNxContentObject instance containing the request chunk of the directory listing, or NULL if the
+ *         query isn't valid or has no such chunk.
+ */
+static CCNxContentObject *
+_createListResponse(CCNxName *name, _TutorialServerState *server, const TutorialNameView *nameView)
+{
+    CCNxContentObject *result = NULL;
+
+    TutorialListingQuery query;
+    if (tutorialListingQuery_Parse(name, nameView, &query) == false) {
+        return NULL;
+    }
+
+    uint64_t requestedChunkNumber = nameView->chunkNumber;
+    uint64_t finalChunkNumber;
+    PARCBuffer *chunk;
+    if (nameView->argumentCount == 0) {
+        chunk = tutorialDirectoryListing_AcquireChunk(server->listing, requestedChunkNumber, &finalChunkNumber);
+    } else {
+        chunk = tutorialDirectoryListing_AcquireQueryChunk(server->listing, &query, requestedChunkNumber, &finalChunkNumber);
+    }
+    if (chunk != NULL) {
+        printf("tutorialServer: Responding to 'list' command with chunk %llu/%llu\n",
+               (unsigned long long) requestedChunkNumber, (unsigned long long) finalChunkNumber + 1);
+
+        result = _createContentObject(name, chunk, finalChunkNumber);
+        parcBuffer_Release(&chunk);
+    }
+
+    return result;
+}
+
+/**
+ * Parse the name of a CCnxInterest that matched our domain prefix, and log what it asks for.
+ *
+ * This is called for every Interest, so the name is parsed into a TutorialNameView that borrows the bytes
+ * of its segments, and nothing is allocated just to find out what is being asked for. The segments naming a file
+ * are resolved to the file's path with the server's TutorialPathIndex, which the view then borrows instead. If
+ * they don't name a file being served, including if they would lead out of the directory, the view has no file name.
+ *
+ * @param [in] interest A CCNxInterest that matched the specified domain prefix.
+ * @param [in] domainPrefix A CCNxName containing the domain prefix.
+ * @param [in] server The state of the server, including the path index of the files being served.
+ * @param [out] nameView Filled in with the parsed name.
+ * @param [out] filePath A buffer to copy the path of the file named by the Interest into. The view's file name points to it.
+ * @param [in] filePathSize The size of `filePath`, in bytes.
+ *
+ * @return true If the name is one we know how to answer.
+ */
+static bool
+_parseInterestName(const CCNxInterest *interest, const CCNxName *domainPrefix, _TutorialServerState *server, TutorialNameView *nameView,
+                   char *filePath, size_t filePathSize)
+{
+    CCNxName *name = ccnxInterest_GetName(interest);
+    if (tutorialCommon_ParseName(name, domainPrefix, nameView) == false || nameView->hasChunkNumber == false) {
+        return false;
+    }
+
+    // The arguments of 'list' are a query rather than a file name.
+    if (tutorialCommon_NameViewHasCommand(nameView, tutorialCommon_CommandList) == false && nameView->argumentCount > 0) {
+        if (tutorialPathIndex_ResolveName(server->pathIndex, name, nameView->argumentIndex, nameView->argumentCount,
+                                          filePath, filePathSize, &nameView->fileNameLength)) {
+            nameView->fileName = filePath;
+        } else {
+            nameView->fileName = NULL;
+            nameView->fileNameLength = 0;
+        }
+    }
+
+    printf("tutorialServer: received Interest for chunk %llu of '%.*s', command = %.*s\n",
+           (unsigned long long) nameView->chunkNumber, (int) nameView->fileNameLength, nameView->fileName != NULL ? nameView->fileName : "",
+           (int) nameView->commandLength, nameView->command);
+
+    return true;
+}
+
+/**
+ * Given the parsed name of an Interest, see what the embedded command is and create a corresponding
+ * CCNxContentObject as a response. The resulting CCNxContentObject must eventually be released by
+ * calling ccnxContentObject_Release().
+ *
+ * @param [in] name The name of the Interest.
+ * @param [in] nameView The parsed `name`.
+ * @param [in] server The state of the server, including the path to the directory being served.
+ * @param [in] bufferPool The calling thread's TutorialBufferPool, to read file chunks into.
+ *
+ * @return A newly creatd CCNxContentObject contaning a response to the specified Interest,
+ *         or NULL if the Interest couldn't be answered.
+ */
+static CCNxContentObject *
+_createNamedResponse(CCNxName *name, const TutorialNameView *nameView, _TutorialServerState *server,
+                     TutorialBufferPool *bufferPool)
+{
+    CCNxContentObject *result = NULL;
+
+    if (tutorialCommon_NameViewHasCommand(nameView, tutorialCommon_CommandList)) {
+        // This was a 'list' command. We should return the requested chunk of the directory listing.
+        result = _createListResponse(name, server, nameView);
+    } else if (tutorialCommon_NameViewHasCommand(nameView, tutorialCommon_CommandFetch)) {
+        // This was a 'fetch' command. We should return the requested chunk of the file specified.
+        result = _createFetchResponse(name, server, nameView, bufferPool);
+    } else if (tutorialCommon_NameViewHasCommand(nameView, tutorialCommon_CommandFetchCompressed)) {
+        // This was a 'cfetch' command. We should return the requested chunk of the file specified, compressed.
+        result = _createCompressedFetchResponse(name, server, nameView, bufferPool);
+    } else if (tutorialCommon_NameViewHasCommand(nameView, tutorialCommon_CommandMeta)) {
+        // This was a 'meta' command. We should return the metadata of the file specified.
+        result = _createMetadataResponse(name, server, nameView);
+    } else if (tutorialCommon_NameViewHasCommand(nameView, tutorialCommon_CommandManifest)) {
+        // This was a 'manifest' command. We should return the requested chunk of the file's manifest.
+        result = _createManifestResponse(name, server, nameView);
+    }
+
+    return result;
+}
+
+/**
+ * Given a CCnxInterest that matched our domain prefix, see what the embedded command is and
+ * create a corresponding CCNxContentObject as a response. The resulting CCNxContentObject
+ * must eventually be released by calling ccnxContentObject_Release().
+ *
+ * @param [in] interest A CCNxInterest that matched the specified domain prefix.
+ * @param [in] domainPrefix A CCNxName containing the domain prefix.
+ * @param [in] server The state of the server, including the path to the directory being served.
+ * @param [in] bufferPool The calling thread's TutorialBufferPool, to read file chunks into.
+ *
+ * @return A newly creatd CCNxContentObject contaning a response to the specified Interest,
+ *         or NULL if the Interest couldn't be answered.
+ */
+static CCNxContentObject *
+_createInterestResponse(const CCNxInterest *interest, const CCNxName *domainPrefix, _TutorialServerState *server,
+                        TutorialBufferPool *bufferPool)
+{
+    TutorialNameView nameView;
+    char filePath[PATH_MAX];
+    if (_parseInterestName(interest, domainPrefix, server, &nameView, filePath, sizeof(filePath)) == false) {
+        return NULL; // Not something we know how to answer.
+    }
+
+    return _createNamedResponse(ccnxInterest_GetName(interest), &nameView, server, bufferPool);
+}
+
+/**
+ * Write a response message to the Portal, reporting an error if it can't be sent.
+ *
+ * @param [in] portal The CCNxPortal to write to.
+ * @param [in] responseMessage A CCNxMetaMessage containing the ContentObject to send.
+ */
+static void
+_sendResponse(CCNxPortal *portal, CCNxMetaMessage *responseMessage)
+{
+    if (ccnxPortal_Send(portal, responseMessage, CCNxStackTimeout_Never) == false) {
+        fprintf(stderr, "ccnxPortal_Send failed (error %d). Is the Forwarder running?\n", ccnxPortal_GetError(portal));
+    }
+}
+
+/**
+ * Send every response queued on a batch to its Portal, one after another, and empty the batch.
+ *
+ * @param [in] batch The _TutorialServerBatch to send.
+ */
+static void
+_flushBatch(_TutorialServerBatch *batch)
+{
+    for (size_t i = 0; i < batch->responseCount; i++) {
+        _sendResponse(batch->portal, batch->responses[i]);
+        ccnxMetaMessage_Release(&batch->responses[i]);
+    }
+    batch->responseCount = 0;
+}
+
+/**
+ * Queue a ContentObject to be sent with the rest of a batch. If the batch is full, it is sent first.
+ *
+ * @param [in] batch The _TutorialServerBatch to queue the response on.
+ * @param [in] response The CCNxContentObject to send.
+ */
+static void
+_queueResponse(_TutorialServerBatch *batch, CCNxContentObject *response)
+{
+    if (batch->responseCount == batch->capacity) {
+        _flushBatch(batch);
+    }
+    batch->responses[batch->responseCount++] = ccnxMetaMessage_CreateFromContentObject(response);
+}
+
+/**
+ * Take a free pending fetch record from a batch.
+ */
+static _TutorialServerPendingFetch *
+_takePendingFetch(_TutorialServerBatch *batch)
+{
+    // There are only as many records as reads in flight, so a linear scan for a free one is cheap.
+    _TutorialServerPendingFetch *result = NULL;
+    for (size_t i = 0; i <= _fileReaderQueueDepth && result == NULL; i++) {
+        if (batch->fetches[i].isInUse == false) {
+            result = &batch->fetches[i];
+        }
+    }
+    assertNotNull(result, "More than %zu fetches are pending", _fileReaderQueueDepth + 1);
+
+    result->isInUse = true;
+    batch->reusedFetchCount++;
+
+    return result;
+}
+
+/**
+ * Release a pending fetch record's reference to its name, and return it to its batch.
+ */
+static void
+_returnPendingFetch(_TutorialServerPendingFetch *fetch)
+{
+    ccnxName_Release(&fetch->name);
+    fetch->isInUse = false;
+}
+
+/**
+ * Queue the response to a fetch request whose chunk has been read from the file. This is a TutorialFileReadCompletion.
+ *
+ * @param [in] fetchArg A pointer to the _TutorialServerPendingFetch, which is returned to its batch.
+ * @param [in] chunk The chunk of the file, or NULL if it couldn't be read.
+ */
+static void
+_finishFetch(void *fetchArg, PARCBuffer *chunk)
+{
+    _TutorialServerPendingFetch *fetch = fetchArg;
+
+    if (chunk != NULL) {
+        CCNxContentObject *response = _createFetchResponseWithChunk(fetch->name, fetch->server, chunk,
+                                                                    tutorialFileCache_IsMemoryMapped(fetch->server->fileCache),
+                                                                    &fetch->metadata, &fetch->fileInfo);
+        _queueResponse(fetch->batch, response);
+        ccnxContentObject_Release(&response);
+    }
+
+    _returnPendingFetch(fetch);
+}
+
+/**
+ * Start answering a fetch request by submitting a read of the requested chunk to the server's file reader, rather
+ * than waiting for it. The response is queued by _finishFetch() once the chunk has been read. A response that is
+ * published, or already in the content store, is queued straight away. Chunks of files being fetched in order are read ahead
+ * into the content store through the file reader too.
+ *
+ * @param [in] batch The batch to queue the response on.
+ * @param [in] name The name of the Interest being answered.
+ * @param [in] server The state of the server, including its file reader.
+ * @param [in] nameView The parsed `name`, containing the name of the file and the number of the requested chunk.
+ *
+ * @return true If a response has been, or will be, queued.
+ */
+static bool
+_startFetch(_TutorialServerBatch *batch, const CCNxName *name, _TutorialServerState *server, const TutorialNameView *nameView)
+{
+    char fullFilePath[PATH_MAX];
+    TutorialMetadata metadata;
+    struct stat fileInfo;
+    if (_lookupFetchedFile(server, nameView, fullFilePath, sizeof(fullFilePath), &metadata, &fileInfo) == false) {
+        return false;
+    }
+
+    CCNxContentObject *response = _getPublishedResponse(server, nameView, &metadata, &fileInfo);
+    bool isPublished = (response != NULL);
+
+    if (response == NULL && server->contentStore != NULL) {
+        response = tutorialContentStore_Get(server->contentStore, name, &fileInfo);
+    }
+
+    bool result = true;
+    if (response != NULL) {
+        _queueResponse(batch, response);
+        ccnxContentObject_Release(&response);
+    } else {
+        _TutorialServerPendingFetch *fetch = _takePendingFetch(batch);
+        fetch->batch = batch;
+        fetch->server = server;
+        fetch->name = ccnxName_Acquire(name);
+        fetch->metadata = metadata;
+        fetch->fileInfo = fileInfo;
+
+        result = tutorialFileCache_ReadKnownFileChunk(server->fileCache, server->fileReader, batch->bufferPool,
+                                                      fullFilePath, &fileInfo, metadata.chunkSize, nameView->chunkNumber,
+                                                      _finishFetch, fetch);
+        if (result == false) {
+            _returnPendingFetch(fetch);
+        }
+    }
+
+    if (result && isPublished == false) {
+        _startReadAhead(name, server, nameView, fullFilePath, &metadata, &fileInfo);
+    }
+
+    return result;
+}
 
 /**
- * Create a new CCNxPortalFactory instance using a randomly generated identity saved to
- * the specified keystore.
+ * Answer an Interest that matched our domain prefix, queueing the response on a batch. If the server has a file
+ * reader, fetch requests are answered asynchronously, and the others straight away.
  *
- * @return A new CCNxPortalFactory instance which must eventually be released by calling ccnxPortalFactory_Release().
+ * @param [in] batch The batch to queue the response on.
+ * @param [in] interest A CCNxInterest that matched the specified domain prefix.
+ * @param [in] domainPrefix A CCNxName containing the domain prefix.
+ * @param [in] server The state of the server, including the path to the directory being served.
+ *
+ * @return true If a response has been, or will be, queued.
  */
-static CCNxPortalFactory *
-_setupServerPortalFactory(void)
+static bool
+_answerInterest(_TutorialServerBatch *batch, const CCNxInterest *interest, const CCNxName *domainPrefix, _TutorialServerState *server)
 {
-    const char *keystoreName = "tutorialServer_keystore";
-    const char *keystorePassword = "keystore_password";
-    const char *subjectName = "tutorialServer";
+    TutorialNameView nameView;
+    char filePath[PATH_MAX];
+    if (_parseInterestName(interest, domainPrefix, server, &nameView, filePath, sizeof(filePath)) == false) {
+        return false; // Not something we know how to answer.
+    }
+
+    CCNxName *interestName = ccnxInterest_GetName(interest);
+
+    if (server->fileReader != NULL && tutorialCommon_NameViewHasCommand(&nameView, tutorialCommon_CommandFetch)) {
+        return _startFetch(batch, interestName, server, &nameView);
+    }
+
+    CCNxContentObject *response = _createNamedResponse(interestName, &nameView, server, batch->bufferPool);
+
+    // At this point, response has either the requested chunk of the request file/command,
+    // or remains NULL.
 
-    return tutorialCommon_SetupPortalFactory(keystoreName, keystorePassword, subjectName);
+    if (response != NULL) {
+        // We had a response, so queue it to be sent back through the Portal with the rest of the batch.
+        _queueResponse(batch, response);
+        ccnxContentObject_Release(&response);
+    }
+
+    return (response != NULL);
 }
 
 /**
- * Given the size of some data and a chunk size, calculate the number of chunks that would be
- * required to contain the data.
- *
- * @param [in] dataLength The size of the data being chunked.
- * @param [in] chunkSize The size of the chunks to break the data in to.
+ * Return the number of nanoseconds that have passed since the specified time, as measured by CLOCK_MONOTONIC.
+ */
+static uint64_t
+_getNanosecondsSince(const struct timespec *start)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t) ((now.tv_sec - start->tv_sec) * 1000000000LL + (now.tv_nsec - start->tv_nsec));
+}
+
+/**
+ * Add a batch to the batch statistics.
  *
- * @return The number of chunks required to contain the specified data length.
+ * @param [in,out] stats The _TutorialServerBatchStats to add to.
+ * @param [in] interestCount The number of Interests in the batch.
+ * @param [in] nanoseconds The latency of the batch.
+ */
+static void
+_recordBatch(_TutorialServerBatchStats *stats, size_t interestCount, uint64_t nanoseconds)
+{
+    stats->batchCount++;
+    stats->interestCount += interestCount;
+    stats->totalNanoseconds += nanoseconds;
+    if (nanoseconds > stats->maximumNanoseconds) {
+        stats->maximumNanoseconds = nanoseconds;
+    }
+
+    size_t bucket = 0;
+    while (bucket < _batchLatencyBucketCount - 1 && (nanoseconds / 1000) >= (1ULL << bucket)) {
+        bucket++;
+    }
+    stats->latencyHistogram[bucket]++;
+}
+
+/**
+ * Return the latency, in microseconds, that the specified fraction of batches took less than. The latency is
+ * rounded up to the power of 2 at the top of its histogram bucket.
  */
 static uint64_t
-_getNumberOfChunksRequired(uint64_t dataLength, uint32_t chunkSize)
+_getBatchLatencyPercentile(const _TutorialServerBatchStats *stats, double fraction)
 {
-    uint64_t chunks = (dataLength / chunkSize) + (dataLength % chunkSize > 0 ? 1 : 0);
-    return (chunks == 0) ? 1 : chunks;
+    uint64_t count = 0;
+    size_t bucket = 0;
+    while (bucket < _batchLatencyBucketCount - 1) {
+        count += stats->latencyHistogram[bucket];
+        if (count >= fraction * stats->batchCount) {
+            break;
+        }
+        bucket++;
+    }
+    return 1ULL << bucket;
+}
+
+/**
+ * Print the batch statistics gathered since they were last printed, if any, and start gathering them again.
+ *
+ * @param [in,out] stats The _TutorialServerBatchStats to print and reset.
+ */
+static void
+_reportBatchStats(_TutorialServerBatchStats *stats)
+{
+    if (stats->batchCount > 0) {
+        printf("tutorial_Server: %llu batches, %llu Interests (%.1f per batch), latency mean %.1f us, "
+               "p50 < %llu us, p99 < %llu us, max %.1f us\n",
+               (unsigned long long) stats->batchCount, (unsigned long long) stats->interestCount,
+               (double) stats->interestCount / stats->batchCount, stats->totalNanoseconds / 1000.0 / stats->batchCount,
+               (unsigned long long) _getBatchLatencyPercentile(stats, 0.5),
+               (unsigned long long) _getBatchLatencyPercentile(stats, 0.99), stats->maximumNanoseconds / 1000.0);
+    }
+    memset(stats, 0, sizeof(*stats));
 }
 
 /**
- * Given the full path to a file, calculate and return the number of the final chunk in the file.
- * The final chunk nunber is a function of the size of the file and the specified chunk size. It
- * is 0-based and is never negative. A file of size 0 has a final chunk number of 0.
+ * Create a thread's TutorialBufferPool, if payload buffers are pooled. They aren't when the server has a content
+ * store: each response it builds is kept in the store, holding on to its payload, so a pooled buffer would
+ * hardly ever come back to be reused, and the pool would only add its bookkeeping to each allocation.
  *
- * @param [in] filePath The full path to a file.
- * @param [in] chunkSize The size of the chunks to break the file in to.
+ * @param [in] options The server's options, including its content store budget and chunk size.
  *
- * @return The number of the final chunk required to transfer the specified file.
+ * @return A new TutorialBufferPool, or NULL if payload buffers aren't pooled.
  */
-static u_int64_t
-_getFinalChunkNumberOfFile(const char *filePath, uint32_t chunkSize)
+static TutorialBufferPool *
+_createBufferPool(const _TutorialServerOptions *options)
 {
-    size_t fileSize = tutorialFileIO_GetFileSize(filePath);
-    uint64_t totalNumberOfChunksInFile = _getNumberOfChunksRequired(fileSize, chunkSize);
+    return (options->contentStoreByteBudget == 0) ? tutorialBufferPool_Create(_bufferPoolCapacity, options->chunkSize) : NULL;
+}
 
-    // If the file size == 0, the the final chunk number is 0. Else, it's one less
-    // than the number of chunks in the file.
+/**
+ * Print how many per-Interest allocations a thread's TutorialBufferPool and pending fetch records have saved.
+ *
+ * @param [in] stats The counts of the TutorialBufferPool, or the sum of several, or NULL if payload buffers aren't pooled.
+ * @param [in] reusedFetchCount The number of pending fetch records used, or 0 if the thread has none.
+ */
+static void
+_reportAllocationStats(const TutorialBufferPoolStats *stats, uint64_t reusedFetchCount)
+{
+    if (stats == NULL && reusedFetchCount == 0) {
+        return;
+    }
 
-    return totalNumberOfChunksInFile > 0 ? (totalNumberOfChunksInFile - 1) : 0;
+    printf("tutorial_Server:");
+    if (stats != NULL) {
+        printf(" payload buffers reused %llu times (%llu allocated for the pool, %llu outside it)",
+               (unsigned long long) stats->reusedCount, (unsigned long long) stats->allocatedCount,
+               (unsigned long long) stats->unpooledCount);
+    }
+    if (reusedFetchCount > 0) {
+        printf("%s fetch records reused %llu times", (stats != NULL) ? "," : "", (unsigned long long) reusedFetchCount);
+    }
+    printf("\n");
 }
 
 /**
- * Given a Name, a payload, and the number of the last chunk, create a CCNxContentObject suitable for
- * passing to the Portal. This new CCNxContentObject must eventually be released by calling
- * ccnxContentObject_Release().
+ * Listen for arriving Interests and respond to them if possible. We expect that the Portal we are passed is
+ * listening for messages matching the specified domainPrefix.
  *
- * @param name [in] The CCNxName to use when creating the new ContentObject.
- * @param payload [in] A PARCBuffer to use as the payload of the new ContentObject.
- * @param finalChunkNumber [in] The number of the final chunk that will be required to completely transfer
- *        the requested content.
+ * Interests are answered in batches. Once an Interest arrives, we keep taking Interests without blocking until
+ * none are waiting or we have `batchSize` of them. The response to each is queued as it is built, the reads of
+ * the fetch requests in the batch are submitted to the server's file reader together, and then the batch's
+ * responses are sent one after another. While reads are in flight, we keep taking Interests. Once none are
+ * waiting, we wait for the reads to finish and send their responses.
  *
- * @return A newly created CCNxContentObject with the specified name, payload, and finalChunkNumber.
+ * @param [in] portal The CCNxPortal that we will read from.
+ * @param [in] domainPrefix A CCNxName containing the domain prefix that the specified `portal` is listening for.
+ * @param [in] server The state of the server, including the path to the directory being served.
+ * @param [in] options The server's options, including its batch size.
+ *
+ * @return true if at least one Interest is received and responded to, false otherwise.
  */
-static CCNxContentObject *
-_createContentObject(const CCNxName *name, PARCBuffer *payload, uint64_t finalChunkNumber)
+static bool
+_receiveAndAnswerInterests(CCNxPortal *portal, const CCNxName *domainPrefix, _TutorialServerState *server,
+                           const _TutorialServerOptions *options)
 {
-    // In the call below, we are un-const'ing name for ccnxContentObject_CreateWithDataPayload()
-    // but we will not be changing it.
-    CCNxContentObject *result = ccnxContentObject_CreateWithDataPayload((CCNxName *) name, payload);
-    ccnxContentObject_SetFinalChunkNumber(result, finalChunkNumber);
+    bool result = false;
+
+    _TutorialServerBatch batch = {
+        .portal = portal,
+        .responses = parcMemory_Allocate(options->batchSize * sizeof(CCNxMetaMessage *)),
+        .responseCount = 0,
+        .capacity = options->batchSize,
+        .bufferPool = _createBufferPool(options),
+        .fetches = parcMemory_AllocateAndClear((_fileReaderQueueDepth + 1) * sizeof(_TutorialServerPendingFetch)),
+        .reusedFetchCount = 0
+    };
+    assertNotNull(batch.responses, "parcMemory_Allocate(%zu) returned NULL", options->batchSize * sizeof(CCNxMetaMessage *));
+    assertNotNull(batch.fetches, "parcMemory_AllocateAndClear(%zu) returned NULL",
+                  (_fileReaderQueueDepth + 1) * sizeof(_TutorialServerPendingFetch));
+
+    _TutorialServerBatchStats stats = { 0 };
+    struct timespec reportTime;
+    clock_gettime(CLOCK_MONOTONIC, &reportTime);
+
+    while (true) {
+        bool isReading = tutorialFileIO_GetPendingFileChunkReadCount(server->fileReader) > 0;
+
+        CCNxMetaMessage *inboundMessage = ccnxPortal_Receive(portal, isReading ? CCNxStackTimeout_Immediate : CCNxStackTimeout_Never);
+
+        if (inboundMessage == NULL) {
+            if (isReading == false) {
+                break;
+            }
+            // No Interests are waiting, so wait for the reads in flight to finish and send their responses.
+            tutorialFileIO_CompleteFileChunkReads(server->fileReader, true);
+            _flushBatch(&batch);
+            continue;
+        }
+
+        struct timespec batchStartTime;
+        clock_gettime(CLOCK_MONOTONIC, &batchStartTime);
+
+        size_t messageCount = 0;
+        size_t interestCount = 0;
+        do {
+            if (ccnxMetaMessage_IsInterest(inboundMessage)) {
+                CCNxInterest *interest = ccnxMetaMessage_GetInterest(inboundMessage);
+                interestCount++;
+
+                if (_answerInterest(&batch, interest, domainPrefix, server)) {
+                    result = true; // We have received, and responded to, at least one Interest.
+                }
+            }
+            ccnxMetaMessage_Release(&inboundMessage);
+            messageCount++;
+        } while (messageCount < options->batchSize
+                 && (inboundMessage = ccnxPortal_Receive(portal, CCNxStackTimeout_Immediate)) != NULL);
+
+        // Submit the batch's reads together, and send the responses of any that have already finished with the rest.
+        tutorialFileIO_CompleteFileChunkReads(server->fileReader, false);
+        _flushBatch(&batch);
+
+        if (options->shouldReportBatchStats) {
+            _recordBatch(&stats, interestCount, _getNanosecondsSince(&batchStartTime));
+            if (_getNanosecondsSince(&reportTime) / 1e9 >= _batchStatsInterval) {
+                TutorialBufferPoolStats poolStats;
+                if (batch.bufferPool != NULL) {
+                    tutorialBufferPool_GetStats(batch.bufferPool, &poolStats);
+                }
+
+                _reportBatchStats(&stats);
+                _reportAllocationStats((batch.bufferPool != NULL) ? &poolStats : NULL, batch.reusedFetchCount);
+                clock_gettime(CLOCK_MONOTONIC, &reportTime);
+            }
+        }
+    }
+
+    if (options->shouldReportBatchStats) {
+        _reportBatchStats(&stats);
+    }
+
+    TutorialBufferPoolStats poolStats;
+    if (batch.bufferPool != NULL) {
+        tutorialBufferPool_GetStats(batch.bufferPool, &poolStats);
+    }
+    _reportAllocationStats((batch.bufferPool != NULL) ? &poolStats : NULL, batch.reusedFetchCount);
+
+    if (batch.bufferPool != NULL) {
+        tutorialBufferPool_Release(&batch.bufferPool);
+    }
+    parcMemory_Deallocate((void **) &batch.fetches);
+    parcMemory_Deallocate((void **) &batch.responses);
 
     return result;
 }
 
 /**
- * Given a CCNxName, a directory path, a file name, and a requested chunk number, return a new CCNxContentObject
- * with that CCNxName and containing the specified chunk of the file. The new CCNxContentObject will also
- * contain the number of the last chunk required to transfer the complete file. Note that the last chunk of the
- * file being retrieved is calculated each time we retrieve a chunk so the file can be growing in size as we
- * transfer it.
- * The new CCnxContentObject must eventually be released by calling ccnxContentObject_Release().
+ * The body of each worker thread of the pipelined server. Take Interest messages from the pipeline, build a
+ * response to each, and pass the responses on to the sending thread. Unless the server has a content store, each
+ * worker reads file chunks into its own TutorialBufferPool, so workers don't contend for the allocator. Returns
+ * when the Interest queue is closed and empty.
  *
- * @param [in] name The CCNxName to use when creating the new CCNxContentObject.
- * @param [in] directoryPath The directory in which to find the specified file.
- * @param [in] fileName The name of the file.
- * @param [in] requestedChunkNumber The number of the requested chunk from the file.
+ * @param [in] pipelineArg A pointer to the _TutorialServerPipeline.
  *
- * @return A new CCNxContentObject instance containing the request chunk of the specified file, or NULL if
- *         the file did not exist or was otherwise unavailable.
+ * @return NULL
  */
-static CCNxContentObject *
-_createFetchResponse(const CCNxName *name, const char *directoryPath, const char *fileName, uint64_t requestedChunkNumber)
+static void *
+_pipelineWorker(void *pipelineArg)
 {
-    CCNxContentObject *result = NULL;
-    uint64_t finalChunkNumber = 0;
-
-    // Combine the directoryPath and fileName into the full path name of the desired file
-    size_t filePathBufferSize = strlen(fileName) + strlen(directoryPath) + 2; // +2 for '/' and trailing null.
-    char *fullFilePath = parcMemory_Allocate(filePathBufferSize);
-    assertNotNull(fullFilePath, "parcMemory_Allocate(%zu) returned NULL", filePathBufferSize);
-    snprintf(fullFilePath, filePathBufferSize, "%s/%s", directoryPath, fileName);
+    _TutorialServerPipeline *pipeline = pipelineArg;
+    TutorialBufferPool *bufferPool = (pipeline->bufferSize > 0) ? tutorialBufferPool_Create(_bufferPoolCapacity, pipeline->bufferSize) : NULL;
+    CCNxMetaMessage *inboundMessage = NULL;
 
-    // Make sure the file exists and is accessible before creating a ContentObject response.
-    if (tutorialFileIO_IsFileAvailable(fullFilePath)) {
-        // Since the file's length can change (e.g. if it is being written to while we're fetching
-        // it), the final chunk number can change between requests for content chunks. So, update
-        // it each time this function is called.
-        finalChunkNumber = _getFinalChunkNumberOfFile(fullFilePath, tutorialCommon_ChunkSize);
+    while ((inboundMessage = tutorialWorkQueue_Take(pipeline->interests)) != NULL) {
+        CCNxInterest *interest = ccnxMetaMessage_GetInterest(inboundMessage);
 
-        // Get the actual contents of the specified chunk of the file.
-        PARCBuffer *payload = tutorialFileIO_GetFileChunk(fullFilePath, tutorialCommon_ChunkSize, requestedChunkNumber);
+        CCNxContentObject *response = _createInterestResponse(interest, pipeline->domainPrefix, pipeline->server, bufferPool);
 
-        if (payload != NULL) {
-            result = _createContentObject(name, payload, finalChunkNumber);
-            parcBuffer_Release(&payload);
+        if (response != NULL) {
+            tutorialWorkQueue_Put(pipeline->responses, ccnxMetaMessage_CreateFromContentObject(response));
+            ccnxContentObject_Release(&response);
         }
+
+        ccnxMetaMessage_Release(&inboundMessage);
     }
 
-    parcMemory_Deallocate((void **) &fullFilePath);
+    if (bufferPool != NULL) {
+        TutorialBufferPoolStats stats;
+        tutorialBufferPool_GetStats(bufferPool, &stats);
+        __atomic_add_fetch(&pipeline->bufferPoolStats.reusedCount, stats.reusedCount, __ATOMIC_RELAXED);
+        __atomic_add_fetch(&pipeline->bufferPoolStats.allocatedCount, stats.allocatedCount, __ATOMIC_RELAXED);
+        __atomic_add_fetch(&pipeline->bufferPoolStats.unpooledCount, stats.unpooledCount, __ATOMIC_RELAXED);
 
-    return result; // Could be NULL if there was no payload
+        tutorialBufferPool_Release(&bufferPool);
+    }
+
+    return NULL;
 }
 
 /**
- * Given a CCNxName, a directory path, and a requested chunk number, create a directory listing and return the specified
- * chunk of the directory listing as the payload of a newly created CCNxContentObject.
- * The new CCnxContentObject must eventually be released by calling ccnxContentObject_Release().
+ * The body of the sending thread of the pipelined server. Take response messages from the pipeline and write
+ * them to the Portal. Returns when the response queue is closed and empty.
  *
- * @param [in] name The CCNxName to use when creating the new CCNxContentObject.
- * @param [in] directoryPath The directory whose contents are being listed.
- * @param [in] requestedChunkNumber The number of the requested chunk from the complete directory listing.
+ * @param [in] pipelineArg A pointer to the _TutorialServerPipeline.
  *
- * @return A new CCNxContentObject instance containing the request chunk of the directory listing.
+ * @return NULL
  */
-static CCNxContentObject *
-_createListResponse(CCNxName *name, const char *directoryPath, uint64_t requestedChunkNumber)
+static void *
+_pipelineSender(void *pipelineArg)
 {
-    CCNxContentObject *result = NULL;
+    _TutorialServerPipeline *pipeline = pipelineArg;
+    CCNxMetaMessage *responseMessage = NULL;
+
+    while ((responseMessage = tutorialWorkQueue_Take(pipeline->responses)) != NULL) {
+        _sendResponse(pipeline->portal, responseMessage);
+        ccnxMetaMessage_Release(&responseMessage);
 
-    PARCBuffer *directoryList = tutorialFileIO_CreateDirectoryListing(directoryPath);
+        pipeline->hasAnsweredInterest = true;
+    }
 
-    uint64_t totalChunksInDirList = _getNumberOfChunksRequired(parcBuffer_Limit(directoryList), tutorialCommon_ChunkSize);
-    if (requestedChunkNumber < totalChunksInDirList) {
-        // Set the buffer's position to the start of the desired chunk.
-        parcBuffer_SetPosition(directoryList, (requestedChunkNumber * tutorialCommon_ChunkSize));
+    return NULL;
+}
 
-        // See if we have more than 1 chunk's worth of data to in the buffer. If so, set the buffer's limit
-        // to the end of the chunk.
-        size_t chunkLen = parcBuffer_Remaining(directoryList);
+/**
+ * Listen for arriving Interests and respond to them using a pipeline of threads: this thread receives Interests,
+ * `workerCount` worker threads build the responses, and another thread sends them. We expect that the Portal we
+ * are passed is listening for messages matching the specified domainPrefix.
+ *
+ * @param [in] portal The CCNxPortal that we will read from and write to.
+ * @param [in] domainPrefix A CCNxName containing the domain prefix that the specified `portal` is listening for.
+ * @param [in] server The state of the server, including the path to the directory being served.
+ * @param [in] options The server's options, including the number of worker threads to build responses with.
+ *
+ * @return true if at least one Interest is received and responded to, false otherwise.
+ */
+static bool
+_receiveAndAnswerInterestsPipelined(CCNxPortal *portal, const CCNxName *domainPrefix, _TutorialServerState *server,
+                                    const _TutorialServerOptions *options)
+{
+    _TutorialServerPipeline pipeline = {
+        .portal = portal,
+        .domainPrefix = domainPrefix,
+        .server = server,
+        .interests = tutorialWorkQueue_Create(_pipelineQueueCapacity),
+        .responses = tutorialWorkQueue_Create(_pipelineQueueCapacity),
+        .bufferSize = (options->contentStoreByteBudget == 0) ? options->chunkSize : 0,
+        .bufferPoolStats = { 0 },
+        .hasAnsweredInterest = false
+    };
+    unsigned workerCount = options->workerCount;
+
+    pthread_t *workers = parcMemory_Allocate(workerCount * sizeof(pthread_t));
+    assertNotNull(workers, "parcMemory_Allocate(%zu) returned NULL", workerCount * sizeof(pthread_t));
+    pthread_t sender;
+
+    for (unsigned i = 0; i < workerCount; i++) {
+        int error = pthread_create(&workers[i], NULL, _pipelineWorker, &pipeline);
+        assertTrue(error == 0, "Couldn't start worker thread %u: %s", i, strerror(error));
+    }
+    int error = pthread_create(&sender, NULL, _pipelineSender, &pipeline);
+    assertTrue(error == 0, "Couldn't start the sending thread: %s", strerror(error));
 
-        if (chunkLen > tutorialCommon_ChunkSize) {
-            parcBuffer_SetLimit(directoryList, parcBuffer_Position(directoryList) + tutorialCommon_ChunkSize);
+    CCNxMetaMessage *inboundMessage = NULL;
+    while ((inboundMessage = ccnxPortal_Receive(portal, CCNxStackTimeout_Never)) != NULL) {
+        if (ccnxMetaMessage_IsInterest(inboundMessage)) {
+            tutorialWorkQueue_Put(pipeline.interests, inboundMessage); // The worker releases it.
+        } else {
+            ccnxMetaMessage_Release(&inboundMessage);
         }
+    }
+
+    // The Portal has stopped delivering messages. Let the workers and then the sender finish what's queued.
+    tutorialWorkQueue_Close(pipeline.interests);
+    for (unsigned i = 0; i < workerCount; i++) {
+        pthread_join(workers[i], NULL);
+    }
+    tutorialWorkQueue_Close(pipeline.responses);
+    pthread_join(sender, NULL);
+    parcMemory_Deallocate((void **) &workers);
 
-        printf("tutorialServer: Responding to 'list' command with chunk %ld/%ld\n", (unsigned long) requestedChunkNumber, (unsigned long) totalChunksInDirList);
+    tutorialWorkQueue_Release(&pipeline.interests);
+    tutorialWorkQueue_Release(&pipeline.responses);
 
-        // Calculate the final chunk number
-        uint64_t finalChunkNumber = (totalChunksInDirList > 0) ? totalChunksInDirList - 1 : 0; // the final chunk, 0-based
+    _reportAllocationStats((pipeline.bufferSize > 0) ? &pipeline.bufferPoolStats : NULL, 0);
 
-        // At this point, dirListBuf has its position and limit set to the beginning and end of the
-        // specified chunk.
-        result = _createContentObject(name, directoryList, finalChunkNumber);
-    }
+    return pipeline.hasAnsweredInterest;
+}
+
+/**
+ * Create the name of the first chunk of a file, as a client would ask for it: the domain prefix, the fetch
+ * command, the file name (a segment for each part of its path), the chunk size and the chunk number. The new
+ * CCNxName must eventually be released by calling ccnxName_Release().
+ *
+ * @param [in] fileName The path of the file, relative to the directory being published.
+ * @param [in] chunkSize The chunk size the file is published with.
+ *
+ * @return A new CCNxName.
+ */
+static CCNxName *
+_createPublishedChunkName(const char *fileName, uint32_t chunkSize)
+{
+    CCNxName *result = ccnxName_CreateFromURI(tutorialCommon_DomainPrefix);
+
+    CCNxNameSegment *commandSegment = ccnxNameSegment_CreateTypeValueArray(CCNxNameLabelType_NAME, strlen(tutorialCommon_CommandFetch),
+                                                                           tutorialCommon_CommandFetch);
+    ccnxName_Append(result, commandSegment);
+    ccnxNameSegment_Release(&commandSegment);
 
-    parcBuffer_Release(&directoryList);
+    tutorialCommon_AppendFilePath(result, fileName);
+    tutorialCommon_AppendChunkSize(result, chunkSize);
+
+    CCNxNameSegment *chunkSegment = ccnxNameSegmentNumber_Create(CCNxNameLabelType_CHUNK, 0);
+    ccnxName_Append(result, chunkSegment);
+    ccnxNameSegment_Release(&chunkSegment);
 
     return result;
 }
 
 /**
- * Given a CCnxInterest that matched our domain prefix, see what the embedded command is and
- * create a corresponding CCNxContentObject as a response. The resulting CCNxContentObject
- * must eventually be released by calling ccnxContentObject_Release().
+ * Read a chunk of the file being published, and encode and sign its ContentObject exactly as it would be sent.
+ * This is a TutorialPublishedChunkEncoder.
  *
- * @param [in] interest A CCNxInterest that matched the specified domain prefix.
- * @param [in] domainPrefix A CCNxName containing the domain prefix.
- * @param [in] directoryPath A string containing the path to the directory being served.
+ * @param [in] publicationArg A pointer to the _TutorialServerPublication.
+ * @param [in] chunkNumber The number of the chunk to encode.
  *
- * @return A newly creatd CCNxContentObject contaning a response to the specified Interest,
- *         or NULL if the Interest couldn't be answered.
+ * @return A new PARCBuffer containing the wire format of the chunk's ContentObject, or NULL if it couldn't be read.
  */
-static CCNxContentObject *
-_createInterestResponse(const CCNxInterest *interest, const CCNxName *domainPrefix, const char *directoryPath)
+static PARCBuffer *
+_encodePublishedChunk(void *publicationArg, uint64_t chunkNumber)
 {
-    CCNxName *interestName = ccnxInterest_GetName(interest);
-
-    char *command = tutorialCommon_CreateCommandStringFromName(interestName, domainPrefix);
+    _TutorialServerPublication *publication = publicationArg;
+    PARCBuffer *result = NULL;
 
-    uint64_t requestedChunkNumber = tutorialCommon_GetChunkNumberFromName(interestName);
+    PARCBuffer *payload = tutorialFileIO_GetFileChunkFromDescriptor(publication->fileDescriptor, publication->metadata.chunkSize, chunkNumber);
+    if (payload != NULL) {
+        CCNxName *chunkName = _createChunkName(publication->chunkName, chunkNumber);
+        CCNxContentObject *contentObject = _createContentObject(chunkName, payload, publication->metadata.finalChunkNumber);
+        CCNxMetaMessage *message = ccnxMetaMessage_CreateFromContentObject(contentObject);
 
-    char *interestNameString = ccnxName_ToString(interestName);
-    printf("tutorialServer: received Interest for chunk %d of %s, command = %s\n",
-           (int) requestedChunkNumber, interestNameString, command);
-    parcMemory_Deallocate((void **) &interestNameString);
+        result = ccnxMetaMessage_CreateWireFormatBuffer(message, publication->signer);
 
-    CCNxContentObject *result = NULL;
-    if (strncasecmp(command, tutorialCommon_CommandList, strlen(command)) == 0) {
-        // This was a 'list' command. We should return the requested chunk of the directory listing.
-        result = _createListResponse(interestName, directoryPath, requestedChunkNumber);
-    } else if (strncasecmp(command, tutorialCommon_CommandFetch, strlen(command)) == 0) {
-        // This was a 'fetch' command. We should return the requested chunk of the file specified.
-        char *fileName = tutorialCommon_CreateFileNameFromName(interestName);
-        result = _createFetchResponse(interestName, directoryPath, fileName, requestedChunkNumber);
-        parcMemory_Deallocate((void **) &fileName);
+        ccnxMetaMessage_Release(&message);
+        ccnxContentObject_Release(&contentObject);
+        ccnxName_Release(&chunkName);
+        parcBuffer_Release(&payload);
     }
 
-    parcMemory_Deallocate((void **) &command);
-
     return result;
 }
 
 /**
- * Listen for arriving Interests and respond to them if possible. We expect that the Portal we are passed is
- * listening for messages matching the specified domainPrefix.
+ * Publish every chunk of a file, so the server can send them without signing each one on request.
  *
- * @param [in] portal The CCNxPortal that we will read from.
- * @param [in] domainPrefix A CCNxName containing the domain prefix that the specified `portal` is listening for.
- * @param [in] directoryPath A string containing the path to the directory being served.
+ * @param [in] store The TutorialPublishedStore to publish to.
+ * @param [in] catalog The catalog of the directory, giving the file's chunk size and final chunk number.
+ * @param [in] fileName The name of the file, relative to the directory.
+ * @param [in] filePath The full path of the file.
+ * @param [in] signer The PARCSigner to sign each chunk with.
  *
- * @return true if at least one Interest is received and responded to, false otherwise.
+ * @return true If the file was published. Entries that aren't readable regular files are skipped, and return false.
  */
 static bool
-_receiveAndAnswerInterests(CCNxPortal *portal, const CCNxName *domainPrefix, const char *directoryPath)
+_publishFile(TutorialPublishedStore *store, TutorialCatalog *catalog, const char *fileName, const char *filePath, PARCSigner *signer)
 {
-    bool result = false;
-    CCNxMetaMessage *inboundMessage = NULL;
+    _TutorialServerPublication publication = { .signer = signer };
+    struct stat fileInfo;
 
-    while ((inboundMessage = ccnxPortal_Receive(portal, CCNxStackTimeout_Never)) != NULL) {
-        if (ccnxMetaMessage_IsInterest(inboundMessage)) {
-            CCNxInterest *interest = ccnxMetaMessage_GetInterest(inboundMessage);
+    if (tutorialCatalog_Lookup(catalog, fileName, strlen(fileName), &publication.metadata, &fileInfo) == false) {
+        return false;
+    }
 
-            CCNxContentObject *response = _createInterestResponse(interest, domainPrefix, directoryPath);
+    publication.fileDescriptor = open(filePath, O_RDONLY);
+    if (publication.fileDescriptor < 0) {
+        return false;
+    }
+    publication.chunkName = _createPublishedChunkName(fileName, publication.metadata.chunkSize);
 
-            // At this point, response has either the requested chunk of the request file/command,
-            // or remains NULL.
+    // If the file changes while it is being published, its sidecar won't match it and won't be used.
+    bool result = tutorialPublishedStore_PublishFile(store, fileName, &fileInfo, publication.metadata.chunkSize,
+                                                     publication.metadata.finalChunkNumber + 1, _encodePublishedChunk, &publication);
 
-            if (response != NULL) {
-                // We had a response, so send it back through the Portal.
-                CCNxMetaMessage *responseMessage = ccnxMetaMessage_CreateFromContentObject(response);
+    ccnxName_Release(&publication.chunkName);
+    close(publication.fileDescriptor);
 
-                if (ccnxPortal_Send(portal, responseMessage, CCNxStackTimeout_Never) == false) {
-                    fprintf(stderr, "ccnxPortal_Send failed (error %d). Is the Forwarder running?\n", ccnxPortal_GetError(portal));
-                }
+    return result;
+}
 
-                ccnxMetaMessage_Release(&responseMessage);
-                ccnxContentObject_Release(&response);
+/**
+ * The state of publishing a directory, shared by the files in it.
+ */
+typedef struct {
+    const char *directoryPath;
+    TutorialPublishedStore *store;
+    TutorialCatalog *catalog;
+    PARCSigner *signer;
+    bool hasPublishedEveryFile;
+} _TutorialServerPublishing;
 
-                result = true; // We have received, and responded to, at least one Interest.
-            }
-        }
-        ccnxMetaMessage_Release(&inboundMessage);
+/**
+ * Publish one of the files found in the directory being published. This is a TutorialPathIndexVisitor.
+ *
+ * @param [in] publishingArg A pointer to the _TutorialServerPublishing.
+ * @param [in] file The file's path, relative to the directory.
+ */
+static void
+_publishIndexedFile(void *publishingArg, const TutorialListingEntry *file)
+{
+    _TutorialServerPublishing *publishing = publishingArg;
+
+    char filePath[PATH_MAX];
+    int length = snprintf(filePath, sizeof(filePath), "%s/%s", publishing->directoryPath, file->fileName);
+
+    if (length > 0 && (size_t) length < sizeof(filePath)
+        && _publishFile(publishing->store, publishing->catalog, file->fileName, filePath, publishing->signer)) {
+        printf("tutorial_Server: published %s\n", file->fileName);
+    } else {
+        printf("tutorial_Server: could not publish %s\n", file->fileName);
+        publishing->hasPublishedEveryFile = false;
     }
+}
 
-    return result;
+/**
+ * Publish every file in a directory, and in the directories below it: encode and sign each chunk of each file ahead
+ * of time, and store them in the directory's published store. A server later serving the directory sends the stored
+ * chunks, until a file changes.
+ *
+ * @param [in] directoryPath A string containing the path to the directory to publish.
+ * @param [in] options The settings given on the command line, including the chunk size to publish with.
+ *
+ * @return true if every file in the directory was published, false otherwise.
+ */
+static bool
+_publishDirectory(const char *directoryPath, const _TutorialServerOptions *options)
+{
+    DIR *directory = opendir(directoryPath);
+    if (directory == NULL) {
+        printf("tutorial_Server: Could not open directory '%s'.\n", directoryPath);
+        return false;
+    }
+    closedir(directory);
+
+    PARCIdentity *identity = tutorialCommon_CreateAndGetIdentity(_serverKeystoreName, _serverKeystorePassword, _serverSubjectName);
+    parcSecurity_Init();
+
+    // Only the files that would be served are published. The published store's own directory is hidden, so it isn't.
+    TutorialPathIndex *pathIndex = tutorialPathIndex_Create(directoryPath, _pathIndexWalkerCount);
+
+    PARCSigner *signer = parcIdentity_CreateSigner(identity);
+    PARCKeyId *signerKeyId = parcSigner_CreateKeyId(signer);
+
+    _TutorialServerPublishing publishing = {
+        .directoryPath         = directoryPath,
+        .store                 = tutorialPublishedStore_Create(directoryPath, signerKeyId),
+        .catalog               = tutorialCatalog_Create(directoryPath, options->chunkSize),
+        .signer                = signer,
+        .hasPublishedEveryFile = true
+    };
+
+    tutorialPathIndex_VisitFiles(pathIndex, "", _publishIndexedFile, &publishing);
+
+    tutorialPublishedStore_Release(&publishing.store);
+    tutorialCatalog_Release(&publishing.catalog);
+    parcKeyId_Release(&signerKeyId);
+    parcSigner_Release(&publishing.signer);
+    tutorialPathIndex_Release(&pathIndex);
+    parcSecurity_Fini();
+    parcIdentity_Release(&identity);
+
+    return publishing.hasPublishedEveryFile;
 }
 
 /**
@@ -311,11 +1919,12 @@ _receiveAndAnswerInterests(CCNxPortal *portal, const CCNxName *domainPrefix, con
  * The specified directoryPath is the location of the directory from which file and listing responses will originate.
  *
  * @param [in] directoryPath A string containing the path to the directory being served.
+ * @param [in] options The settings given on the command line.
  *
  * @return true if at least one Interest is received and responded to, false otherwise.
  */
 static bool
-_serveDirectory(const char *directoryPath)
+_serveDirectory(const char *directoryPath, const _TutorialServerOptions *options)
 {
     bool result = false;
 
@@ -327,11 +1936,84 @@ _serveDirectory(const char *directoryPath)
 
     CCNxName *domainPrefix = ccnxName_CreateFromURI(tutorialCommon_DomainPrefix);
 
+    // Published chunks are only sent if they were signed with the key the Portal signs with.
+    PARCSigner *signer = parcIdentity_CreateSigner(ccnxPortalFactory_GetIdentity(factory));
+    PARCKeyId *signerKeyId = parcSigner_CreateKeyId(signer);
+    parcSigner_Release(&signer);
+
+    // Watch the tree before walking it, so that nothing that changes while it is being walked is missed.
+    TutorialDirectoryWatcher *watcher = tutorialDirectoryWatcher_Create(directoryPath);
+    TutorialPathIndex *pathIndex = tutorialPathIndex_Create(directoryPath, _pathIndexWalkerCount);
+
+    _TutorialServerState server = {
+        .directoryPath = directoryPath,
+
+        // Keep recently requested files open, so each chunk request doesn't have to re-open the file.
+        .fileCache = tutorialFileCache_Create(tutorialFileCache_DefaultCapacity, options->useMemoryMapping),
+
+        // Keep recently built responses, so repeated requests for a chunk don't have to rebuild it.
+        .contentStore = (options->contentStoreByteBudget > 0) ? tutorialContentStore_Create(options->contentStoreByteBudget) : NULL,
+
+        // Index the tree and build its listing once, and then keep them up to date as files change.
+        .watcher = watcher,
+        .pathIndex = pathIndex,
+        .listing = tutorialDirectoryListing_Create(pathIndex, tutorialCommon_ChunkSize),
+
+        // Catalog each file the first time it is requested, and then keep its metadata up to date as it changes.
+        .catalog = tutorialCatalog_Create(directoryPath, options->chunkSize),
+
+        // Without worker threads, read file chunks asynchronously so many reads can be in flight at once.
+        .fileReader = (options->workerCount == 0) ? tutorialFileIO_CreateFileReader(_fileReaderQueueDepth) : NULL,
+
+        // Read ahead of clients fetching files in order, into the content store. Memory mapped chunks aren't kept
+        // there, and the kernel already reads ahead of faults in a mapping.
+        .readAhead = (options->contentStoreByteBudget > 0 && options->useMemoryMapping == false)
+                     ? tutorialReadAhead_Create(_getReadAheadLimit(options)) : NULL,
+
+        // Send the chunks of published files as they were signed when they were published.
+        .publishedStore = tutorialPublishedStore_Create(directoryPath, signerKeyId),
+
+        .compressionCodec = options->compressionCodec
+    };
+
+    // Keep the index, listing and catalog up to date as the directory changes, on a thread of their own.
+    _TutorialServerDirectoryWatch directoryWatch;
+    _startDirectoryWatch(&directoryWatch, &server);
+
     if (ccnxPortal_Listen(portal, domainPrefix, 365 * 86400, CCNxStackTimeout_Never)) {
-        printf("tutorial_Server: now serving files from %s\n", directoryPath);
-        result = _receiveAndAnswerInterests(portal, domainPrefix, directoryPath);
+        bool isUsingIoUring = (server.fileReader != NULL && tutorialFileIO_IsFileReaderAsynchronous(server.fileReader));
+        printf("tutorial_Server: now serving files from %s%s%s", directoryPath,
+               options->useMemoryMapping ? " (memory mapped)" : "", isUsingIoUring ? " (io_uring)" : "");
+        if (options->compressionCodec != TutorialCompressionCodec_None) {
+            printf(" (%s compression)", tutorialCompression_GetCodecName(options->compressionCodec));
+        }
+        printf("\n");
+        if (options->workerCount > 0) {
+            result = _receiveAndAnswerInterestsPipelined(portal, domainPrefix, &server, options);
+        } else {
+            result = _receiveAndAnswerInterests(portal, domainPrefix, &server, options);
+        }
     }
 
+    _stopDirectoryWatch(&directoryWatch);
+
+    if (server.fileReader != NULL) {
+        tutorialFileIO_ReleaseFileReader(&server.fileReader); // Finishes any reads still in flight.
+    }
+    if (server.readAhead != NULL) {
+        tutorialReadAhead_Release(&server.readAhead);
+    }
+    tutorialPublishedStore_Release(&server.publishedStore);
+    parcKeyId_Release(&signerKeyId);
+    tutorialCatalog_Release(&server.catalog);
+    tutorialDirectoryListing_Release(&server.listing);
+    tutorialPathIndex_Release(&server.pathIndex);
+    tutorialDirectoryWatcher_Release(&server.watcher);
+    if (server.contentStore != NULL) {
+        tutorialContentStore_Release(&server.contentStore);
+    }
+    tutorialFileCache_Release(&server.fileCache);
+    ccnxName_Release(&domainPrefix);
     ccnxPortal_Release(&portal);
     ccnxPortalFactory_Release(&factory);
 
@@ -352,8 +2034,31 @@ _displayUsage(char *programName)
     printf(" A CCNx forwarder (e.g. Metis) must be running before running it. Once running, the peer\n");
     printf(" tutorialClient application can request a listing or a specified file.\n\n");
 
-    printf("Usage: %s [-h] [-v] <directory path>\n", programName);
-    printf("  '%s ~/files' will serve the files in ~/files\n", programName);
+    printf("Usage: %s [-h] [-v] [-m] [-p] [-c <megabytes>] [-t <threads>] [-s <bytes>] [-b <interests>] [-z <codec>] <directory path>\n", programName);
+    printf("  '%s ~/files' will serve the files in ~/files, and in the directories below it. ~/files/logs/app.log\n", programName);
+    printf("      is named lci:/ccnx/tutorial/fetch/logs/app.log. Hidden directories and links to directories aren't served\n");
+    printf("  '%s -m ~/files' will serve the files in ~/files from memory mappings, without copying each chunk\n", programName);
+    printf("      Chunks of a file truncated while it is being served are refused, but a truncation in the moment a chunk\n");
+    printf("      is being sent still stops the server with SIGBUS. Mapped chunks aren't kept in the content store\n");
+    printf("  '%s -c 256 ~/files' will keep up to 256 MB of recently sent chunks in memory (default %zu, 0 disables)\n",
+           programName, tutorialContentStore_DefaultByteBudget / (1024 * 1024));
+    printf("  '%s -t 8 ~/files' will build responses on 8 worker threads (at most %u), with separate receive and send threads\n",
+           programName, _maximumWorkerCount);
+    printf("  '%s -s 8192 ~/files' will serve files in chunks of up to 8192 bytes (default %u, at most %u)\n",
+           programName, tutorialCommon_ChunkSize, tutorialCommon_MaximumChunkSize);
+    printf("  '%s -b 256 ~/files' will answer up to 256 waiting Interests before sending their responses (default %zu),\n",
+           programName, _defaultBatchSize);
+    printf("      and print the size and latency of the batches every %.0f seconds. Not used with -t\n", _batchStatsInterval);
+    printf("  '%s -p ~/files' will sign every chunk of the files in ~/files ahead of time and exit. Serving ~/files\n", programName);
+    printf("      afterwards sends the signed chunks, without signing them again, until a file changes\n");
+    printf("  '%s -z zstd ~/files' will offer the files in ~/files whose start compresses well in compressed chunks.\n", programName);
+    printf("      The codecs built in are:");
+    for (TutorialCompressionCodec codec = TutorialCompressionCodec_Zstd; codec <= TutorialCompressionCodec_Lz4; codec++) {
+        if (tutorialCompression_IsCodecAvailable(codec)) {
+            printf(" %s", tutorialCompression_GetCodecName(codec));
+        }
+    }
+    printf(" (make USE_ZSTD=1 and USE_LZ4=1 build them in)\n");
     printf("  '%s -v' will show the tutorial demo code version\n", programName);
     printf("  '%s -h' will show this help\n\n", programName);
 }
@@ -368,7 +2073,25 @@ main(int argc, char *argv[argc])
     bool needToShowUsage = false;
     bool shouldExit = false;
 
-    status = tutorialCommon_processCommandLineArguments(argc, argv, &commandArgCount, commandArgs, &needToShowUsage, &shouldExit);
+    const char *memoryMapOption = NULL;
+    const char *contentStoreSizeOption = NULL;
+    const char *workerCountOption = NULL;
+    const char *chunkSizeOption = NULL;
+    const char *publishOption = NULL;
+    const char *batchSizeOption = NULL;
+    const char *compressionOption = NULL;
+    TutorialCommonOption options[] = {
+        { .option = 'm', .takesValue = false, .value = &memoryMapOption },
+        { .option = 'c', .takesValue = true,  .value = &contentStoreSizeOption },
+        { .option = 't', .takesValue = true,  .value = &workerCountOption },
+        { .option = 's', .takesValue = true,  .value = &chunkSizeOption },
+        { .option = 'p', .takesValue = false, .value = &publishOption },
+        { .option = 'b', .takesValue = true,  .value = &batchSizeOption },
+        { .option = 'z', .takesValue = true,  .value = &compressionOption },
+        { .option = '\0' }
+    };
+
+    status = tutorialCommon_processCommandLineArguments(argc, argv, options, &commandArgCount, commandArgs, &needToShowUsage, &shouldExit);
 
     if (needToShowUsage) {
         _displayUsage(argv[0]);
@@ -379,7 +2102,51 @@ main(int argc, char *argv[argc])
     }
 
     if (commandArgCount == 1) {
-        status = (_serveDirectory(commandArgs[0]) ? EXIT_SUCCESS : EXIT_FAILURE);
+        _TutorialServerOptions serverOptions = {
+            .useMemoryMapping = (memoryMapOption != NULL),
+            .contentStoreByteBudget = tutorialContentStore_DefaultByteBudget,
+            .chunkSize = tutorialCommon_ChunkSize,
+            .shouldPublish = (publishOption != NULL),
+            .batchSize = _defaultBatchSize,
+            .shouldReportBatchStats = (batchSizeOption != NULL)
+        };
+        if (contentStoreSizeOption != NULL) {
+            serverOptions.contentStoreByteBudget = strtoul(contentStoreSizeOption, NULL, 10) * 1024 * 1024;
+        }
+        if (workerCountOption != NULL) {
+            unsigned long workerCount = strtoul(workerCountOption, NULL, 10);
+            if (workerCount > _maximumWorkerCount) {
+                printf("tutorial_Server: The number of worker threads must be at most %u.\n", _maximumWorkerCount);
+                exit(EXIT_FAILURE);
+            }
+            serverOptions.workerCount = (unsigned) workerCount;
+        }
+        if (chunkSizeOption != NULL) {
+            unsigned long chunkSize = strtoul(chunkSizeOption, NULL, 10);
+            if (chunkSize == 0 || chunkSize > tutorialCommon_MaximumChunkSize) {
+                printf("tutorial_Server: The chunk size must be between 1 and %u bytes.\n", tutorialCommon_MaximumChunkSize);
+                exit(EXIT_FAILURE);
+            }
+            serverOptions.chunkSize = (uint32_t) chunkSize;
+        }
+        if (batchSizeOption != NULL) {
+            serverOptions.batchSize = strtoul(batchSizeOption, NULL, 10);
+            if (serverOptions.batchSize == 0) {
+                printf("tutorial_Server: The batch size must be at least 1.\n");
+                exit(EXIT_FAILURE);
+            }
+        }
+        if (compressionOption != NULL
+            && tutorialCompression_FindCodec(compressionOption, &serverOptions.compressionCodec) == false) {
+            printf("tutorial_Server: The '%s' codec isn't built into this server. See -h for the codecs that are.\n", compressionOption);
+            exit(EXIT_FAILURE);
+        }
+
+        if (serverOptions.shouldPublish) {
+            status = (_publishDirectory(commandArgs[0], &serverOptions) ? EXIT_SUCCESS : EXIT_FAILURE);
+        } else {
+            status = (_serveDirectory(commandArgs[0], &serverOptions) ? EXIT_SUCCESS : EXIT_FAILURE);
+        }
     } else {
         status = EXIT_FAILURE;
         _displayUsage(argv[0]);
@@ -0,0 +1,276 @@
+/*
+ * Copyright (c) 2014-2015, Xerox Corporation (Xerox)and Palo Alto Research Center (PARC)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Patent rights are not granted under this agreement. Patent rights are
+ *       available under FRAND terms.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL XEROX or PARC BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+/**
+ * @author Alan Walendowski, Palo Alto Research Center (Xerox PARC)
+ * @copyright 2014-2015, Xerox Corporation (Xerox)and Palo Alto Research Center (PARC).  All rights reserved.
+ */
+#include <pthread.h>
+#include <sched.h>
+#include <stdint.h>
+
+#include <LongBow/runtime.h>
+#include <parc/algol/parc_Memory.h>
+
+#include "tutorial_WorkQueue.h"
+
+/**
+ * The queue is an array of cells used as a ring buffer, as described by Dmitry Vyukov. Each cell carries a
+ * sequence number that says whether it is ready to be written (sequence == position) or ready to be read
+ * (sequence == position + 1) by the producer or consumer that claims that position.
+ */
+typedef struct {
+    size_t sequence;
+    void *item;
+} _TutorialWorkQueueCell;
+
+/**
+ * How many times a blocking put or take yields and retries before going to sleep. A short spin avoids
+ * the cost of sleeping and being signalled when the other side of the queue is keeping up.
+ */
+static const int _spinCount = 16;
+
+struct tutorial_work_queue {
+    _TutorialWorkQueueCell *cells;
+    size_t mask;  // capacity - 1
+
+    // Keep the producer and consumer positions on separate cache lines, as they're written by different threads.
+    char padding0[64];
+    size_t tail;  // The next position to put an item in.
+    char padding1[64];
+    size_t head;  // The next position to take an item from.
+    char padding2[64];
+
+    // Only used when a thread has to sleep.
+    pthread_mutex_t lock;
+    pthread_cond_t notEmpty;
+    pthread_cond_t notFull;
+    unsigned waitingConsumers;
+    unsigned waitingProducers;
+    bool isClosed;
+};
+
+TutorialWorkQueue *
+tutorialWorkQueue_Create(size_t capacity)
+{
+    assertTrue(capacity > 0, "The capacity of a TutorialWorkQueue must be greater than 0");
+
+    size_t roundedCapacity = 1;
+    while (roundedCapacity < capacity) {
+        roundedCapacity <<= 1;
+    }
+
+    TutorialWorkQueue *result = parcMemory_AllocateAndClear(sizeof(TutorialWorkQueue));
+    assertNotNull(result, "parcMemory_AllocateAndClear(%zu) returned NULL", sizeof(TutorialWorkQueue));
+
+    result->cells = parcMemory_AllocateAndClear(roundedCapacity * sizeof(_TutorialWorkQueueCell));
+    assertNotNull(result->cells, "parcMemory_AllocateAndClear(%zu) returned NULL", roundedCapacity * sizeof(_TutorialWorkQueueCell));
+
+    for (size_t i = 0; i < roundedCapacity; i++) {
+        result->cells[i].sequence = i;
+    }
+    result->mask = roundedCapacity - 1;
+
+    pthread_mutex_init(&result->lock, NULL);
+    pthread_cond_init(&result->notEmpty, NULL);
+    pthread_cond_init(&result->notFull, NULL);
+
+    return result;
+}
+
+void
+tutorialWorkQueue_Release(TutorialWorkQueue **queueP)
+{
+    TutorialWorkQueue *queue = *queueP;
+
+    pthread_cond_destroy(&queue->notFull);
+    pthread_cond_destroy(&queue->notEmpty);
+    pthread_mutex_destroy(&queue->lock);
+
+    parcMemory_Deallocate((void **) &queue->cells);
+    parcMemory_Deallocate((void **) queueP);
+}
+
+/**
+ * Wake one thread sleeping on the specified condition, if any thread is waiting for it.
+ */
+static void
+_wakeWaiter(TutorialWorkQueue *queue, pthread_cond_t *condition, const unsigned *waiterCount)
+{
+    if (__atomic_load_n(waiterCount, __ATOMIC_SEQ_CST) > 0) {
+        pthread_mutex_lock(&queue->lock);
+        pthread_cond_signal(condition);
+        pthread_mutex_unlock(&queue->lock);
+    }
+}
+
+static bool
+_tryPut(TutorialWorkQueue *queue, void *item)
+{
+    bool result = false;
+    size_t position = __atomic_load_n(&queue->tail, __ATOMIC_RELAXED);
+
+    for (;;) {
+        _TutorialWorkQueueCell *cell = &queue->cells[position & queue->mask];
+        size_t sequence = __atomic_load_n(&cell->sequence, __ATOMIC_ACQUIRE);
+        intptr_t difference = (intptr_t) sequence - (intptr_t) position;
+
+        if (difference == 0) {
+            // The cell is free. Claim this position, unless another producer got it first.
+            if (__atomic_compare_exchange_n(&queue->tail, &position, position + 1, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+                cell->item = item;
+                __atomic_store_n(&cell->sequence, position + 1, __ATOMIC_RELEASE);
+                result = true;
+                break;
+            }
+        } else if (difference < 0) {
+            break; // The queue is full.
+        } else {
+            position = __atomic_load_n(&queue->tail, __ATOMIC_RELAXED);
+        }
+    }
+
+    return result;
+}
+
+static void *
+_tryTake(TutorialWorkQueue *queue)
+{
+    void *result = NULL;
+    size_t position = __atomic_load_n(&queue->head, __ATOMIC_RELAXED);
+
+    for (;;) {
+        _TutorialWorkQueueCell *cell = &queue->cells[position & queue->mask];
+        size_t sequence = __atomic_load_n(&cell->sequence, __ATOMIC_ACQUIRE);
+        intptr_t difference = (intptr_t) sequence - (intptr_t) (position + 1);
+
+        if (difference == 0) {
+            // The cell holds an item. Claim this position, unless another consumer got it first.
+            if (__atomic_compare_exchange_n(&queue->head, &position, position + 1, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+                result = cell->item;
+                __atomic_store_n(&cell->sequence, position + queue->mask + 1, __ATOMIC_RELEASE);
+                break;
+            }
+        } else if (difference < 0) {
+            break; // The queue is empty.
+        } else {
+            position = __atomic_load_n(&queue->head, __ATOMIC_RELAXED);
+        }
+    }
+
+    return result;
+}
+
+bool
+tutorialWorkQueue_TryPut(TutorialWorkQueue *queue, void *item)
+{
+    bool result = _tryPut(queue, item);
+
+    if (result) {
+        _wakeWaiter(queue, &queue->notEmpty, &queue->waitingConsumers);
+    }
+
+    return result;
+}
+
+void *
+tutorialWorkQueue_TryTake(TutorialWorkQueue *queue)
+{
+    void *result = _tryTake(queue);
+
+    if (result != NULL) {
+        _wakeWaiter(queue, &queue->notFull, &queue->waitingProducers);
+    }
+
+    return result;
+}
+
+void
+tutorialWorkQueue_Put(TutorialWorkQueue *queue, void *item)
+{
+    assertNotNull(item, "Cannot put a NULL item in a TutorialWorkQueue");
+
+    bool isPut = _tryPut(queue, item);
+    for (int spin = 0; spin < _spinCount && isPut == false; spin++) {
+        sched_yield();
+        isPut = _tryPut(queue, item);
+    }
+
+    if (isPut == false) {
+        pthread_mutex_lock(&queue->lock);
+        __atomic_add_fetch(&queue->waitingProducers, 1, __ATOMIC_SEQ_CST);
+
+        // Consumers check waitingProducers after taking an item, so re-trying after announcing that we're
+        // waiting means we can't miss a wakeup.
+        while (_tryPut(queue, item) == false) {
+            pthread_cond_wait(&queue->notFull, &queue->lock);
+        }
+
+        __atomic_sub_fetch(&queue->waitingProducers, 1, __ATOMIC_SEQ_CST);
+        pthread_mutex_unlock(&queue->lock);
+    }
+
+    _wakeWaiter(queue, &queue->notEmpty, &queue->waitingConsumers);
+}
+
+void *
+tutorialWorkQueue_Take(TutorialWorkQueue *queue)
+{
+    void *result = _tryTake(queue);
+    for (int spin = 0; spin < _spinCount && result == NULL && __atomic_load_n(&queue->isClosed, __ATOMIC_ACQUIRE) == false; spin++) {
+        sched_yield();
+        result = _tryTake(queue);
+    }
+
+    if (result == NULL) {
+        pthread_mutex_lock(&queue->lock);
+        __atomic_add_fetch(&queue->waitingConsumers, 1, __ATOMIC_SEQ_CST);
+
+        // Producers check waitingConsumers after putting an item, so re-trying after announcing that we're
+        // waiting means we can't miss a wakeup.
+        while ((result = _tryTake(queue)) == NULL && queue->isClosed == false) {
+            pthread_cond_wait(&queue->notEmpty, &queue->lock);
+        }
+
+        __atomic_sub_fetch(&queue->waitingConsumers, 1, __ATOMIC_SEQ_CST);
+        pthread_mutex_unlock(&queue->lock);
+    }
+
+    if (result != NULL) {
+        _wakeWaiter(queue, &queue->notFull, &queue->waitingProducers);
+    }
+
+    return result;
+}
+
+void
+tutorialWorkQueue_Close(TutorialWorkQueue *queue)
+{
+    pthread_mutex_lock(&queue->lock);
+    __atomic_store_n(&queue->isClosed, true, __ATOMIC_RELEASE);
+    pthread_cond_broadcast(&queue->notEmpty);
+    pthread_mutex_unlock(&queue->lock);
+}
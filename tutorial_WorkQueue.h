@@ -0,0 +1,111 @@
+/*
+ * Copyright (c) 2014-2015, Xerox Corporation (Xerox)and Palo Alto Research Center (PARC)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Patent rights are not granted under this agreement. Patent rights are
+ *       available under FRAND terms.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL XEROX or PARC BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+/**
+ * @author Alan Walendowski, Palo Alto Research Center (Xerox PARC)
+ * @copyright 2014-2015, Xerox Corporation (Xerox)and Palo Alto Research Center (PARC).  All rights reserved.
+ */
+
+#ifndef tutorial_WorkQueue_h
+#define tutorial_WorkQueue_h
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/**
+ * A TutorialWorkQueue is a bounded, multi-producer, multi-consumer FIFO queue of pointers, used to pass work
+ * between the stages of the server's pipeline. Putting and taking items is lock-free. A thread only takes
+ * the queue's lock when it has to sleep because the queue is empty (or full), and it is only woken when
+ * another thread actually has to signal it.
+ *
+ * Once a queue has been closed, tutorialWorkQueue_Take() returns the remaining items and then NULL, so
+ * consumers can drain the queue and exit.
+ */
+typedef struct tutorial_work_queue TutorialWorkQueue;
+
+/**
+ * Create a new, empty, TutorialWorkQueue that can hold at least `capacity` items. The capacity is rounded
+ * up to a power of 2. The returned instance must eventually be released by calling tutorialWorkQueue_Release().
+ *
+ * @param [in] capacity The minimum number of items the queue can hold. Must be greater than 0.
+ *
+ * @return A new TutorialWorkQueue instance.
+ */
+TutorialWorkQueue *tutorialWorkQueue_Create(size_t capacity);
+
+/**
+ * Release the memory used by the specified TutorialWorkQueue. No thread may be using the queue, and
+ * any items still in it are not released.
+ *
+ * @param [in,out] queueP A pointer to the pointer to the TutorialWorkQueue to release. It will be set to NULL.
+ */
+void tutorialWorkQueue_Release(TutorialWorkQueue **queueP);
+
+/**
+ * Add an item to the tail of the queue if there is room for it, without blocking.
+ *
+ * @param [in] queue The TutorialWorkQueue to add to.
+ * @param [in] item The item to add. Must not be NULL.
+ *
+ * @return true If the item was added.
+ * @return false If the queue was full.
+ */
+bool tutorialWorkQueue_TryPut(TutorialWorkQueue *queue, void *item);
+
+/**
+ * Remove and return the item at the head of the queue, without blocking.
+ *
+ * @param [in] queue The TutorialWorkQueue to take from.
+ *
+ * @return The item at the head of the queue, or NULL if the queue was empty.
+ */
+void *tutorialWorkQueue_TryTake(TutorialWorkQueue *queue);
+
+/**
+ * Add an item to the tail of the queue, waiting for room if the queue is full.
+ *
+ * @param [in] queue The TutorialWorkQueue to add to.
+ * @param [in] item The item to add. Must not be NULL.
+ */
+void tutorialWorkQueue_Put(TutorialWorkQueue *queue, void *item);
+
+/**
+ * Remove and return the item at the head of the queue, waiting for one if the queue is empty.
+ *
+ * @param [in] queue The TutorialWorkQueue to take from.
+ *
+ * @return The item at the head of the queue, or NULL if the queue is empty and has been closed.
+ */
+void *tutorialWorkQueue_Take(TutorialWorkQueue *queue);
+
+/**
+ * Close the queue, waking any threads waiting in tutorialWorkQueue_Take(). Items already in the queue
+ * can still be taken.
+ *
+ * @param [in] queue The TutorialWorkQueue to close.
+ */
+void tutorialWorkQueue_Close(TutorialWorkQueue *queue);
+#endif // tutorial_WorkQueue_h